@@ -524,11 +524,7 @@ int main()
 		core::OwenSampler sampler(Channels, 0xdeadbeefu);
 
 		auto out = reinterpret_cast<uint32_t*>(sampleSequence->getPointer());
-		for (uint32_t c = 0; c < Channels; ++c)
-		for (uint32_t i = 0; i < MaxSamples; i++)
-		{
-			out[Channels*i + c] = sampler.sample(c, i);
-		}
+		sampler.generateTable(out, Channels, MaxSamples);
 		auto gpuSequenceBuffer = driver->createFilledDeviceLocalGPUBufferOnDedMem(sampleSequence->getSize(), sampleSequence->getPointer());
 		gpuSequenceBufferView = driver->createGPUBufferView(gpuSequenceBuffer.get(), asset::EF_R32G32B32_UINT);
 	}
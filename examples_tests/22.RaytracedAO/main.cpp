@@ -247,9 +247,7 @@ int main()
 
 			uint32_t (&out)[][Channels] = *reinterpret_cast<uint32_t(*)[][Channels]>(sampleSequence->getPointer());
 			for (auto realdim=0u; realdim<Renderer::MaxDimensions/Channels; realdim++)
-			for (auto c=0u; c<Channels; c++)
-			for (uint32_t i=0; i<MaxSamples; i++)
-				out[realdim*MaxSamples+i][c] = sampler.sample(realdim*Channels+c,i);
+				sampler.generateTable(out[realdim*MaxSamples],Channels,MaxSamples,realdim*Channels);
 
 			io::IWriteFile* cacheFile = device->getFileSystem()->createAndWriteFile("../../tmp/rtSamples.bin");
 			if (cacheFile)
@@ -305,11 +305,7 @@ int main()
 		//core::SobolSampler sampler(MaxDimensions);
 
 		auto out = reinterpret_cast<uint32_t*>(sampleSequence->getPointer());
-		for (auto dim=0u; dim<MaxDimensions; dim++)
-		for (uint32_t i=0; i<MaxSamples; i++)
-		{
-			out[i*MaxDimensions+dim] = sampler.sample(dim,i);
-		}
+		sampler.generateTable(out, MaxDimensions, MaxSamples);
 		auto gpuSequenceBuffer = driver->createFilledDeviceLocalGPUBufferOnDedMem(sampleSequence->getSize(), sampleSequence->getPointer());
 		gpuSequenceBufferView = driver->createGPUBufferView(gpuSequenceBuffer.get(), asset::EF_R32G32B32_UINT);
 	}
@@ -0,0 +1,92 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include <nabla.h>
+#include "CConcurrentObjectCache.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+
+using namespace nbl;
+
+class RefCounted : public core::IReferenceCounted {};
+
+constexpr uint32_t KEY_COUNT = 1u<<12u;
+constexpr uint32_t OPS_PER_THREAD = 1u<<18u;
+// out of 256 operations, how many modify the cache, the rest are lookups like the asset manager does when loading
+constexpr uint32_t WRITES_PER_256_OPS = 8u;
+
+template<class CacheT>
+double benchmark(const core::vector<std::string>& keys, const core::vector<RefCounted*>& objects, const uint32_t threadCount)
+{
+	auto greet = [](RefCounted* _obj) { _obj->grab(); };
+	auto dispose = [](RefCounted* _obj) { _obj->drop(); };
+	CacheT cache(greet,dispose);
+	for (uint32_t i=0u; i<KEY_COUNT; i++)
+		cache.insert(keys[i],objects[i]);
+
+	auto work = [&](const uint32_t threadID) -> void
+	{
+		std::mt19937 generator(threadID);
+		std::uniform_int_distribution<uint32_t> keyDistribution(0u,KEY_COUNT-1u);
+		std::uniform_int_distribution<uint32_t> opDistribution(0u,255u);
+		for (uint32_t i=0u; i<OPS_PER_THREAD; i++)
+		{
+			const uint32_t k = keyDistribution(generator);
+			if (opDistribution(generator)<WRITES_PER_256_OPS)
+			{
+				// every object lives under its own key, so swapping it out and back in keeps the cache contents stable
+				if (cache.removeObject(objects[k],keys[k]))
+					cache.insert(keys[k],objects[k]);
+			}
+			else
+			{
+				RefCounted* found[4];
+				size_t storageSize = 4ull;
+				cache.findAndStoreRange(keys[k],storageSize,found);
+			}
+		}
+	};
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	core::vector<std::thread> threads;
+	for (uint32_t i=0u; i<threadCount; i++)
+		threads.emplace_back(work,i);
+	for (auto& thread : threads)
+		thread.join();
+	const auto end = std::chrono::high_resolution_clock::now();
+
+	assert(cache.getSize()==KEY_COUNT);
+	return std::chrono::duration<double,std::milli>(end-start).count();
+}
+
+int main()
+{
+	core::vector<std::string> keys(KEY_COUNT);
+	core::vector<RefCounted*> objects(KEY_COUNT);
+	for (uint32_t i=0u; i<KEY_COUNT; i++)
+	{
+		keys[i] = "../../media/asset_" + std::to_string(i) + ".png";
+		objects[i] = new RefCounted();
+	}
+
+	using single_lock_t = core::CConcurrentMultiObjectCache<std::string,RefCounted*,std::multimap>;
+	using sharded_t = core::CShardedConcurrentMultiObjectCache<std::string,RefCounted*,std::multimap>;
+	const uint32_t maxThreads = core::max(std::thread::hardware_concurrency(),1u);
+	for (uint32_t threadCount=1u; threadCount<=maxThreads; threadCount<<=1u)
+	{
+		const double singleLock = benchmark<single_lock_t>(keys,objects,threadCount);
+		const double sharded = benchmark<sharded_t>(keys,objects,threadCount);
+		std::cout << threadCount << " threads:\tsingle lock " << singleLock << " ms,\tsharded " << sharded << " ms,\tspeedup " << singleLock/sharded << "x\n";
+	}
+
+	for (auto* object : objects)
+	{
+		assert(object->getReferenceCount()==1);
+		object->drop();
+	}
+	return 0;
+}
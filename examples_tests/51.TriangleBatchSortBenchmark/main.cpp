@@ -0,0 +1,139 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include <nabla.h>
+#include "nbl/core/math/morton.h"
+
+#include <chrono>
+#include <execution>
+#include <iostream>
+#include <random>
+
+using namespace nbl;
+
+// mirrors `IMeshPacker::constructTriangleBatches`, just without a mesh buffer to fetch the triangles from
+struct Triangle
+{
+	uint32_t oldIndices[3];
+};
+
+struct SSyntheticMesh
+{
+	core::vector<Triangle> triangles;
+	core::vector<core::vectorSIMDf> centroids;
+	core::vector<float> areas;
+};
+
+SSyntheticMesh createMesh(const uint32_t triCnt)
+{
+	SSyntheticMesh mesh;
+	mesh.triangles.resize(triCnt);
+	mesh.centroids.resize(triCnt);
+	mesh.areas.resize(triCnt);
+
+	std::mt19937 generator(triCnt);
+	std::uniform_real_distribution<float> position(0.f,1.f);
+	std::uniform_real_distribution<float> logArea(-20.f,0.f);
+	for (uint32_t i=0u; i<triCnt; i++)
+	{
+		mesh.triangles[i] = {{i*3u,i*3u+1u,i*3u+2u}};
+		mesh.centroids[i] = core::vectorSIMDf(position(generator),position(generator),position(generator));
+		mesh.areas[i] = std::exp2(logArea(generator));
+	}
+	return mesh;
+}
+
+inline uint64_t mortonKey(const core::vectorSIMDf& centroid, const float area, const float maxArea)
+{
+	const core::vectorSIMDf fixedPointPos = centroid*65535.f;
+	const uint16_t logRelArea = uint16_t(65535.5f+core::clamp(0.5f*std::log2f(area/maxArea),-65535.5f,0.f));
+	return core::morton4d_encode<uint64_t>(uint64_t(fixedPointPos.x),uint64_t(fixedPointPos.y),uint64_t(fixedPointPos.z),logRelArea);
+}
+
+//! The old path, triangles and their keys interleaved and sorted with `std::sort`, then copied out
+core::vector<Triangle> sortAoS(const SSyntheticMesh& mesh)
+{
+	struct TriangleMortonCodePair
+	{
+		Triangle triangle;
+		uint64_t key;
+
+		inline bool operator<(const TriangleMortonCodePair& other) const
+		{
+			return key<other.key;
+		}
+	};
+
+	const uint32_t triCnt = mesh.triangles.size();
+	core::vector<TriangleMortonCodePair> triangles(triCnt);
+	float maxArea = 0.f;
+	for (uint32_t i=0u; i<triCnt; i++)
+	{
+		triangles[i].triangle = mesh.triangles[i];
+		maxArea = core::max(maxArea,mesh.areas[i]);
+	}
+	for (uint32_t i=0u; i<triCnt; i++)
+		triangles[i].key = mortonKey(mesh.centroids[i],mesh.areas[i],maxArea);
+	std::sort(triangles.begin(),triangles.end());
+
+	core::vector<Triangle> retval(triCnt);
+	for (uint32_t i=0u; i<triCnt; i++)
+		retval[i] = triangles[i].triangle;
+	return retval;
+}
+
+//! The new path, keys and triangles in separate arrays, radix sorted together
+core::vector<Triangle> sortSoA(const SSyntheticMesh& mesh)
+{
+	const uint32_t triCnt = mesh.triangles.size();
+	core::vector<uint64_t> keys(triCnt*2u);
+	core::vector<Triangle> triangles(mesh.triangles);
+
+	const float maxArea = *std::max_element(std::execution::par_unseq,mesh.areas.begin(),mesh.areas.end());
+	std::transform(std::execution::par_unseq,mesh.centroids.begin(),mesh.centroids.end(),mesh.areas.begin(),keys.begin(),[maxArea](const core::vectorSIMDf& centroid, const float area) -> uint64_t
+	{
+		return mortonKey(centroid,area,maxArea);
+	});
+
+	core::vector<Triangle> retval(triCnt);
+	const Triangle* sorted = core::radix_sort(keys.data(),keys.data()+triCnt,triangles.data(),retval.data(),triCnt).second;
+	if (sorted!=retval.data())
+		retval = std::move(triangles);
+	return retval;
+}
+
+template<typename F>
+double measure(F&& f, core::vector<Triangle>& result)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+	result = f();
+	const auto end = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double,std::milli>(end-start).count();
+}
+
+int main()
+{
+	for (uint32_t triCnt=1u<<14u; triCnt<=(1u<<22u); triCnt<<=2u)
+	{
+		const auto mesh = createMesh(triCnt);
+
+		core::vector<Triangle> aos,soa;
+		const double aosTime = measure([&mesh](){return sortAoS(mesh);},aos);
+		const double soaTime = measure([&mesh](){return sortSoA(mesh);},soa);
+
+		// the radix sort is stable and `std::sort` isn't, so only the keys have to come out in the same order
+		const float maxArea = *std::max_element(mesh.areas.begin(),mesh.areas.end());
+		bool sameOrder = true;
+		for (uint32_t i=0u; i<triCnt && sameOrder; i++)
+		{
+			const uint32_t a = aos[i].oldIndices[0]/3u;
+			const uint32_t b = soa[i].oldIndices[0]/3u;
+			sameOrder = mortonKey(mesh.centroids[a],mesh.areas[a],maxArea)==mortonKey(mesh.centroids[b],mesh.areas[b],maxArea);
+		}
+
+		std::cout << triCnt << " triangles:\tAoS std::sort " << aosTime << " ms,\tSoA radix sort " << soaTime << " ms,\tspeedup " << aosTime/soaTime << "x";
+		std::cout << (sameOrder ? "\n":"\tORDER MISMATCH!\n");
+	}
+	return 0;
+}
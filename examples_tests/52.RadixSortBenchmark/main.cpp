@@ -0,0 +1,83 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include <nabla.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+
+using namespace nbl;
+
+template<typename F>
+double measure(F&& f)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+	f();
+	const auto end = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double,std::milli>(end-start).count();
+}
+
+//! `keyMask` limits the key bits in use, so that the passes over the constant digits get skipped
+template<typename key_t>
+void benchmark(const size_t count, const key_t keyMask)
+{
+	std::mt19937_64 generator(count);
+	core::vector<key_t> keys(count);
+	for (auto& key : keys)
+		key = static_cast<key_t>(generator())&keyMask;
+
+	// keys only
+	core::vector<key_t> stdSorted(keys);
+	const double stdTime = measure([&](){std::sort(stdSorted.begin(),stdSorted.end());});
+
+	core::vector<key_t> radixKeys(keys);
+	radixKeys.resize(count*2ull);
+	const key_t* radixSorted = nullptr;
+	const double radixTime = measure([&](){radixSorted = core::radix_sort(radixKeys.data(),radixKeys.data()+count,count);});
+	const bool keysMatch = std::equal(stdSorted.begin(),stdSorted.end(),radixSorted);
+
+	// keys with 32bit payloads, `std::sort` needs them interleaved while the radix sort takes them as separate arrays
+	struct KeyValuePair
+	{
+		key_t key;
+		uint32_t value;
+
+		inline bool operator<(const KeyValuePair& other) const
+		{
+			return key<other.key;
+		}
+	};
+	core::vector<KeyValuePair> pairs(count);
+	for (size_t i=0ull; i<count; i++)
+		pairs[i] = {keys[i],static_cast<uint32_t>(i)};
+	const double stdPairTime = measure([&](){std::stable_sort(pairs.begin(),pairs.end());});
+
+	std::copy(keys.begin(),keys.end(),radixKeys.begin());
+	core::vector<uint32_t> values(count*2ull);
+	std::iota(values.begin(),values.begin()+count,0u);
+	std::pair<key_t*,uint32_t*> kvSorted;
+	const double radixPairTime = measure([&](){kvSorted = core::radix_sort(radixKeys.data(),radixKeys.data()+count,values.data(),values.data()+count,count);});
+	// both sorts are stable, so the payloads have to match too
+	bool pairsMatch = true;
+	for (size_t i=0ull; i<count && pairsMatch; i++)
+		pairsMatch = pairs[i].key==kvSorted.first[i] && pairs[i].value==kvSorted.second[i];
+
+	std::cout << count << " x " << sizeof(key_t)*8ull << "bit keys (mask 0x" << std::hex << uint64_t(keyMask) << std::dec << "):\n";
+	std::cout << "\tkeys\tstd::sort " << stdTime << " ms,\tradix sort " << radixTime << " ms,\tspeedup " << stdTime/radixTime << "x" << (keysMatch ? "\n":"\tMISMATCH!\n");
+	std::cout << "\tpairs\tstd::stable_sort " << stdPairTime << " ms,\tradix sort " << radixPairTime << " ms,\tspeedup " << stdPairTime/radixPairTime << "x" << (pairsMatch ? "\n":"\tMISMATCH!\n");
+}
+
+int main()
+{
+	std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << "\n";
+	for (size_t count=1ull<<10ull; count<=(1ull<<24ull); count<<=2ull)
+	{
+		benchmark<uint32_t>(count,~0u);
+		benchmark<uint64_t>(count,~0ull);
+		benchmark<uint64_t>(count,0xffffffull);
+	}
+	return 0;
+}
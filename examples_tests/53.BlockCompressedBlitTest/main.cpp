@@ -0,0 +1,125 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include <nabla.h>
+
+#include <iostream>
+
+using namespace nbl;
+using namespace core;
+using namespace asset;
+
+/*
+	Blits a smooth gradient into BC4/BC5 through kernels with fewer than 4 channels and checks the decoded blocks
+	against the input, so the block encoder gets fed whole texels whatever the kernels' channel count.
+*/
+
+// not a multiple of the block size, so the edge replication gets tested too
+constexpr uint32_t EXTENT = 10u;
+// an endpoint pair per block and 8 interpolated values in between is plenty for a gentle gradient
+constexpr double TOLERANCE = 1.0/32.0;
+
+smart_refctd_ptr<ICPUImage> createImage(const E_FORMAT format)
+{
+	ICPUImage::SCreationParams imgParams;
+	imgParams.flags = static_cast<ICPUImage::E_CREATE_FLAGS>(0u);
+	imgParams.type = ICPUImage::ET_2D;
+	imgParams.format = format;
+	imgParams.extent = {EXTENT,EXTENT,1u};
+	imgParams.mipLevels = 1u;
+	imgParams.arrayLayers = 1u;
+	imgParams.samples = ICPUImage::ESCF_1_BIT;
+	auto image = ICPUImage::create(ICPUImage::SCreationParams(imgParams));
+
+	auto regions = make_refctd_dynamic_array<smart_refctd_dynamic_array<IImage::SBufferCopy> >(1u);
+	{
+		auto& region = regions->front();
+		region.bufferOffset = 0u;
+		region.bufferRowLength = 0u;
+		region.bufferImageHeight = 0u;
+		region.imageSubresource.mipLevel = 0u;
+		region.imageSubresource.baseArrayLayer = 0u;
+		region.imageSubresource.layerCount = 1u;
+		region.imageOffset = {0u,0u,0u};
+		region.imageExtent = imgParams.extent;
+	}
+	const auto blocks = image->getTexelBlockInfo().convertTexelsToBlocks(vectorSIMDu32(EXTENT,EXTENT,1u));
+	auto buffer = make_smart_refctd_ptr<ICPUBuffer>(blocks.x*blocks.y*getTexelOrBlockBytesize(format));
+	memset(buffer->getPointer(),0,buffer->getSize());
+	image->setBufferAndRegions(std::move(buffer),regions);
+	return image;
+}
+
+double gradient(const uint32_t x, const uint32_t y, const uint32_t channel)
+{
+	const double t = channel ? double(y):double(x);
+	return 0.25+0.5*t/double(EXTENT-1u);
+}
+
+template<class... ChannelKernels>
+bool testBlit(const E_FORMAT inFormat, const E_FORMAT outFormat)
+{
+	using Kernel = CChannelIndependentImageFilterKernel<ChannelKernels...>;
+	constexpr uint32_t channelCount = Kernel::MaxChannels;
+
+	auto inImage = createImage(inFormat);
+	{
+		float* texels = reinterpret_cast<float*>(inImage->getBuffer()->getPointer());
+		for (uint32_t y=0u; y<EXTENT; y++)
+		for (uint32_t x=0u; x<EXTENT; x++)
+		for (uint32_t c=0u; c<channelCount; c++)
+			texels[(y*EXTENT+x)*channelCount+c] = gradient(x,y,c);
+	}
+	auto outImage = createImage(outFormat);
+
+	using BLIT_FILTER = CBlitImageFilter<false,false,DefaultSwizzle,IdentityDither,Kernel,Kernel,Kernel>;
+	typename BLIT_FILTER::state_type state(Kernel(ChannelKernels{}...),Kernel(ChannelKernels{}...),Kernel(ChannelKernels{}...));
+	const auto extentLayerCount = vectorSIMDu32(0u,0u,0u,1u)+inImage->getMipSize(0u);
+	state.inOffsetBaseLayer = vectorSIMDu32();
+	state.inExtentLayerCount = extentLayerCount;
+	state.inImage = inImage.get();
+	state.outOffsetBaseLayer = vectorSIMDu32();
+	state.outExtentLayerCount = extentLayerCount;
+	state.outImage = outImage.get();
+	state.inMipLevel = 0u;
+	state.outMipLevel = 0u;
+	state.axisWraps[0] = state.axisWraps[1] = state.axisWraps[2] = ISampler::ETC_CLAMP_TO_EDGE;
+	state.scratchMemoryByteSize = BLIT_FILTER::getRequiredScratchByteSize(&state);
+	state.scratchMemory = reinterpret_cast<uint8_t*>(_NBL_ALIGNED_MALLOC(state.scratchMemoryByteSize,32));
+
+	const bool executed = BLIT_FILTER::execute(std::execution::par_unseq,&state);
+	_NBL_ALIGNED_FREE(state.scratchMemory);
+	if (!executed)
+	{
+		std::cout << "Blit to " << (outFormat==EF_BC4_UNORM_BLOCK ? "BC4":"BC5") << " failed to execute!" << std::endl;
+		return false;
+	}
+
+	bool success = true;
+	for (uint32_t y=0u; y<EXTENT; y++)
+	for (uint32_t x=0u; x<EXTENT; x++)
+	{
+		vectorSIMDu32 blockCoord;
+		const void* srcPix[4] = {outImage->getTexelBlockData(0u,vectorSIMDu32(x,y,0u),blockCoord),nullptr,nullptr,nullptr};
+		double decoded[4] = {};
+		decodePixelsRuntime(outFormat,srcPix,decoded,blockCoord.x,blockCoord.y);
+		for (uint32_t c=0u; c<channelCount; c++)
+		if (std::abs(decoded[c]-gradient(x,y,c))>TOLERANCE)
+		{
+			std::cout << (outFormat==EF_BC4_UNORM_BLOCK ? "BC4":"BC5") << " texel (" << x << "," << y << ") channel " << c
+				<< " expected " << gradient(x,y,c) << " got " << decoded[c] << std::endl;
+			success = false;
+		}
+	}
+	return success;
+}
+
+int main()
+{
+	bool success = testBlit<CBoxImageFilterKernel>(EF_R32_SFLOAT,EF_BC4_UNORM_BLOCK);
+	success = testBlit<CBoxImageFilterKernel,CBoxImageFilterKernel>(EF_R32G32_SFLOAT,EF_BC5_UNORM_BLOCK) && success;
+
+	std::cout << (success ? "All block compressed blits passed":"Some block compressed blits failed") << std::endl;
+	return success ? 0:1;
+}
@@ -0,0 +1,142 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include <nabla.h>
+
+#include <iostream>
+#include <random>
+
+using namespace nbl;
+using namespace core;
+using namespace asset;
+
+/*
+	Converts between every pair of formats the batched codecs handle with CSwizzleAndConvertImageFilter and checks the output
+	is bit for bit what decoding and encoding every texel on its own gives, whether the filter took the batched path or not.
+*/
+
+constexpr uint32_t WIDTH = 1024u;
+constexpr uint32_t HEIGHT = 256u;
+constexpr uint32_t TEXEL_COUNT = WIDTH*HEIGHT;
+
+constexpr E_FORMAT FORMATS[] = {EF_R8G8B8A8_UNORM,EF_R8G8B8A8_SRGB,EF_R16_UNORM,EF_R16G16_UNORM,EF_R16G16B16A16_SFLOAT,EF_R32G32B32A32_SFLOAT};
+constexpr const char* FORMAT_NAMES[] = {"R8G8B8A8_UNORM","R8G8B8A8_SRGB","R16_UNORM","R16G16_UNORM","R16G16B16A16_SFLOAT","R32G32B32A32_SFLOAT"};
+
+smart_refctd_ptr<ICPUImage> createImage(const E_FORMAT format)
+{
+	ICPUImage::SCreationParams imgParams;
+	imgParams.flags = static_cast<ICPUImage::E_CREATE_FLAGS>(0u);
+	imgParams.type = ICPUImage::ET_2D;
+	imgParams.format = format;
+	imgParams.extent = {WIDTH,HEIGHT,1u};
+	imgParams.mipLevels = 1u;
+	imgParams.arrayLayers = 1u;
+	imgParams.samples = ICPUImage::ESCF_1_BIT;
+	auto image = ICPUImage::create(ICPUImage::SCreationParams(imgParams));
+
+	auto regions = make_refctd_dynamic_array<smart_refctd_dynamic_array<IImage::SBufferCopy> >(1u);
+	{
+		auto& region = regions->front();
+		region.bufferOffset = 0u;
+		region.bufferRowLength = 0u;
+		region.bufferImageHeight = 0u;
+		region.imageSubresource.mipLevel = 0u;
+		region.imageSubresource.baseArrayLayer = 0u;
+		region.imageSubresource.layerCount = 1u;
+		region.imageOffset = {0u,0u,0u};
+		region.imageExtent = imgParams.extent;
+	}
+	auto buffer = make_smart_refctd_ptr<ICPUBuffer>(TEXEL_COUNT*getTexelOrBlockBytesize(format));
+	memset(buffer->getPointer(),0,buffer->getSize());
+	image->setBufferAndRegions(std::move(buffer),regions);
+	return image;
+}
+
+// random bits hit NaNs, infinities, denormals and values way out of the normalized range, the float formats also get some in and around [0,1]
+void fillTexels(ICPUImage* image, std::mt19937& generator)
+{
+	const auto format = image->getCreationParameters().format;
+	auto* const data = reinterpret_cast<uint8_t*>(image->getBuffer()->getPointer());
+	const size_t byteSize = image->getBuffer()->getSize();
+	for (size_t i=0u; i<byteSize; i++)
+		data[i] = generator();
+
+	std::uniform_real_distribution<float> sane(-0.5f,1.5f);
+	if (format==EF_R32G32B32A32_SFLOAT)
+	{
+		float* values = reinterpret_cast<float*>(data);
+		for (uint32_t i=0u; i<TEXEL_COUNT*2u; i++)
+			values[i] = sane(generator);
+	}
+	else if (format==EF_R16G16B16A16_SFLOAT)
+	{
+		uint16_t* values = reinterpret_cast<uint16_t*>(data);
+		for (uint32_t i=0u; i<0x10000u; i++)
+			values[i] = i;
+		for (uint32_t i=0x10000u; i<TEXEL_COUNT*2u; i++)
+			values[i] = Float16Compressor::compress(sane(generator));
+	}
+}
+
+int main()
+{
+	using CONVERSION_FILTER = CSwizzleAndConvertImageFilter<EF_UNKNOWN,EF_UNKNOWN>;
+
+	std::mt19937 generator(0x45u);
+	bool success = true;
+	for (uint32_t i=0u; i<std::size(FORMATS); i++)
+	{
+		auto inImage = createImage(FORMATS[i]);
+		fillTexels(inImage.get(),generator);
+		const uint8_t* const inData = reinterpret_cast<const uint8_t*>(inImage->getBuffer()->getPointer());
+		const uint32_t inTexelSize = getTexelOrBlockBytesize(FORMATS[i]);
+
+		for (uint32_t o=0u; o<std::size(FORMATS); o++)
+		{
+			auto outImage = createImage(FORMATS[o]);
+			const uint32_t outTexelSize = getTexelOrBlockBytesize(FORMATS[o]);
+
+			CONVERSION_FILTER::state_type state;
+			state.inImage = inImage.get();
+			state.outImage = outImage.get();
+			state.inOffset = {0u,0u,0u};
+			state.inBaseLayer = 0u;
+			state.outOffset = {0u,0u,0u};
+			state.outBaseLayer = 0u;
+			state.extent = {WIDTH,HEIGHT,1u};
+			state.layerCount = 1u;
+			state.inMipLevel = 0u;
+			state.outMipLevel = 0u;
+			if (!CONVERSION_FILTER::execute(std::execution::par_unseq,&state))
+			{
+				std::cout << FORMAT_NAMES[i] << " -> " << FORMAT_NAMES[o] << " failed to execute!" << std::endl;
+				success = false;
+				continue;
+			}
+
+			core::vector<uint8_t> reference(TEXEL_COUNT*outTexelSize,0u);
+			for (uint32_t t=0u; t<TEXEL_COUNT; t++)
+			{
+				const void* srcPix[4] = {inData+size_t(t)*inTexelSize,nullptr,nullptr,nullptr};
+				double decoded[4] = {};
+				decodePixelsRuntime(FORMATS[i],srcPix,decoded,0u,0u);
+				encodePixelsRuntime(FORMATS[o],reference.data()+size_t(t)*outTexelSize,decoded);
+			}
+
+			const uint8_t* const outData = reinterpret_cast<const uint8_t*>(outImage->getBuffer()->getPointer());
+			uint32_t mismatches = 0u;
+			for (uint32_t t=0u; t<TEXEL_COUNT; t++)
+			if (memcmp(outData+size_t(t)*outTexelSize,reference.data()+size_t(t)*outTexelSize,outTexelSize))
+				mismatches++;
+			if (mismatches)
+			{
+				std::cout << FORMAT_NAMES[i] << " -> " << FORMAT_NAMES[o] << " differs from the per texel conversion in " << mismatches << " texels" << std::endl;
+				success = false;
+			}
+		}
+	}
+
+	std::cout << (success ? "All conversions match the per texel path":"Some conversions don't match the per texel path") << std::endl;
+	return success ? 0:1;
+}
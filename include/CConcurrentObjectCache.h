@@ -55,10 +55,11 @@ namespace impl
 
         using BaseCache::BaseCache;
 
+        template<bool GreetOnInsert = true>
         inline bool insert(const typename BaseCache::KeyType_impl& _key, const typename BaseCache::ValueType_impl& _val)
         {
             this->m_lock.lockWrite();
-            const bool r = BaseCache::insert(_key, _val);
+            const bool r = BaseCache::template insert<GreetOnInsert>(_key, _val);
             this->m_lock.unlockWrite();
             return r;
         }
@@ -79,6 +80,15 @@ namespace impl
             return r;
         }
 
+        //! Number of objects cached under `_key`
+        inline size_t getKeyRangeSize(const typename BaseCache::KeyType_impl& _key) const
+        {
+            this->m_lock.lockRead();
+            const size_t r = static_cast<const BaseCache&>(*this).findRange(_key).size();
+            this->m_lock.unlockRead();
+            return r;
+        }
+
         inline void clear()
         {
             this->m_lock.lockWrite();
@@ -97,16 +107,32 @@ namespace impl
 
         bool getAndStoreKeyRangeOrReserve(const typename BaseCache::KeyType_impl& _key, size_t& _inOutStorageSize, typename BaseCache::ValueType_impl* _out, bool* _gotAll)
         {
+            // the key is usually there already, so only take the write lock if we actually have to reserve
+            this->m_lock.lockRead();
+            {
+                const auto rng = static_cast<const BaseCache&>(*this).findRange(_key);
+                if (rng.size()!=0u)
+                {
+                    const bool gotAll = BaseCache::outputRange(rng, _inOutStorageSize, _out);
+                    this->m_lock.unlockRead();
+                    if (_gotAll)
+                        *_gotAll = gotAll;
+                    return true;
+                }
+            }
+            this->m_lock.unlockRead();
+
             this->m_lock.lockWrite();
             const bool r = BaseCache::getAndStoreKeyRangeOrReserve(_key, _inOutStorageSize, _out, _gotAll);
             this->m_lock.unlockWrite();
             return r;
         }
 
+        template<bool DisposeOnRemove = true>
         inline bool removeObject(const typename BaseCache::ValueType_impl& _obj, const typename BaseCache::KeyType_impl& _key)
         {
             this->m_lock.lockWrite();
-            const bool r = BaseCache::removeObject(_obj, _key);
+            const bool r = BaseCache::template removeObject<DisposeOnRemove>(_obj, _key);
             this->m_lock.unlockWrite();
             return r;
         }
@@ -159,6 +185,165 @@ namespace impl
             return r;
         }
     };
+
+    //! Partitions the keys between `ShardCount` independently locked concurrent caches
+    /**
+        Operations on a single key only ever lock the shard the key hashes to, so threads working on different keys
+        rarely contend. Whole-cache operations (`getSize`, `contains`, `clear`, `outputAll`) visit the shards one by one
+        and are not atomic with respect to concurrent modifications.
+    */
+    template<typename CacheT, uint32_t ShardCount>
+    class CMakeCacheSharded
+    {
+        static_assert(ShardCount && (ShardCount&(ShardCount-1u))==0u, "ShardCount must be a power of two!");
+
+        using ShardType = CMakeCacheConcurrent<CacheT>;
+        // the `_impl` typedefs of the caches are protected, so recreate them from the container's value type
+        using K = std::remove_const_t<typename ShardType::PairType::first_type>;
+        using V = typename ShardType::PairType::second_type;
+        using ImmutableV = std::conditional_t<std::is_pointer<V>::value,const std::remove_pointer_t<V>*,const V>;
+
+        // own cacheline per shard, so the lock counters don't false-share
+        struct alignas(64) SShard : ShardType
+        {
+            using ShardType::ShardType;
+        };
+
+    public:
+        using IteratorType = typename ShardType::IteratorType;
+        using ConstIteratorType = typename ShardType::ConstIteratorType;
+        using RevIteratorType = typename ShardType::RevIteratorType;
+        using ConstRevIteratorType = typename ShardType::ConstRevIteratorType;
+        using RangeType = typename ShardType::RangeType;
+        using ConstRangeType = typename ShardType::ConstRangeType;
+        using PairType = typename ShardType::PairType;
+        using MutablePairType = typename ShardType::MutablePairType;
+        using CachedType = typename ShardType::CachedType;
+        using KeyType = typename ShardType::KeyType;
+
+        //! Every shard gets constructed with the same arguments (e.g. greeting and disposal functions)
+        template<typename... Args>
+        explicit CMakeCacheSharded(const Args&... args)
+        {
+            for (auto& shard : m_shards)
+                shard = new SShard(args...);
+        }
+        ~CMakeCacheSharded()
+        {
+            for (auto* shard : m_shards)
+                delete shard;
+        }
+        CMakeCacheSharded(const CMakeCacheSharded&) = delete;
+        CMakeCacheSharded(CMakeCacheSharded&&) = delete;
+        CMakeCacheSharded& operator=(const CMakeCacheSharded&) = delete;
+        CMakeCacheSharded& operator=(CMakeCacheSharded&&) = delete;
+
+        inline bool insert(const K& _key, const V& _val)
+        {
+            return getShard(_key).insert(_key, _val);
+        }
+
+        inline bool contains(ImmutableV& _object) const
+        {
+            for (const auto* shard : m_shards)
+            if (shard->contains(_object))
+                return true;
+            return false;
+        }
+
+        inline size_t getSize() const
+        {
+            size_t r = 0ull;
+            for (const auto* shard : m_shards)
+                r += shard->getSize();
+            return r;
+        }
+
+        //! Only locks the shard `_key` belongs to, unlike `getSize`
+        inline size_t getKeyRangeSize(const K& _key) const
+        {
+            return getShard(_key).getKeyRangeSize(_key);
+        }
+
+        inline void clear()
+        {
+            for (auto* shard : m_shards)
+                shard->clear();
+        }
+
+        //! Returns true if had to insert
+        bool swapObjectValue(const K& _key, const ImmutableV& _obj, const V& _val)
+        {
+            return getShard(_key).swapObjectValue(_key, _obj, _val);
+        }
+
+        bool getAndStoreKeyRangeOrReserve(const K& _key, size_t& _inOutStorageSize, V* _out, bool* _gotAll)
+        {
+            return getShard(_key).getAndStoreKeyRangeOrReserve(_key, _inOutStorageSize, _out, _gotAll);
+        }
+
+        inline bool removeObject(const V& _obj, const K& _key)
+        {
+            return getShard(_key).removeObject(_obj, _key);
+        }
+
+        inline bool findAndStoreRange(const K& _key, size_t& _inOutStorageSize, MutablePairType* _out) const
+        {
+            return getShard(_key).findAndStoreRange(_key, _inOutStorageSize, _out);
+        }
+
+        inline bool findAndStoreRange(const K& _key, size_t& _inOutStorageSize, V* _out) const
+        {
+            return getShard(_key).findAndStoreRange(_key, _inOutStorageSize, _out);
+        }
+
+        inline bool outputAll(size_t& _inOutStorageSize, MutablePairType* _out) const
+        {
+            if (!_out)
+            {
+                _inOutStorageSize = getSize();
+                return false;
+            }
+
+            size_t written = 0ull;
+            bool gotAll = true;
+            for (const auto* shard : m_shards)
+            {
+                size_t shardStorageSize = _inOutStorageSize-written;
+                gotAll = shard->outputAll(shardStorageSize, _out+written) && gotAll;
+                written += shardStorageSize;
+            }
+            _inOutStorageSize = written;
+            return gotAll;
+        }
+
+        //! When the keys land in different shards the object is briefly absent from both, but it is never greeted or disposed
+        inline bool changeObjectKey(const V& _obj, const K& _key, const K& _newKey)
+        {
+            auto& shard = getShard(_key);
+            auto& newShard = getShard(_newKey);
+            if (&shard==&newShard)
+                return shard.changeObjectKey(_obj, _key, _newKey);
+
+            constexpr bool DoGreetOrDispose = false;
+            if (shard.template removeObject<DoGreetOrDispose>(_obj, _key))
+            {
+                newShard.template insert<DoGreetOrDispose>(_newKey, _obj);
+                return true;
+            }
+            return false;
+        }
+
+    private:
+        inline ShardType& getShard(const K& _key) const
+        {
+            // the hash may be an identity (pointers), so scramble it before picking the shard by the top bits
+            const uint64_t hash = static_cast<uint64_t>(std::hash<K>()(_key))*0x9E3779B97F4A7C15ull;
+            return *m_shards[ShardCount>1u ? (hash>>(64u-core::findMSB(ShardCount))):0ull];
+        }
+
+        SShard* m_shards[ShardCount];
+    };
 }
 
 template<
@@ -183,6 +368,32 @@ using CConcurrentMultiObjectCache =
         CMultiObjectCache<K, T, ContainerT_T, Alloc>
     >;
 
+template<
+    typename K,
+    typename T,
+    template<typename...> class ContainerT_T = std::vector,
+    typename Alloc = core::allocator<typename impl::key_val_pair_type_for<ContainerT_T, K, T>::type>,
+    uint32_t ShardCount = 16u
+>
+using CShardedConcurrentObjectCache =
+    impl::CMakeCacheSharded<
+        CObjectCache<K, T, ContainerT_T, Alloc>,
+        ShardCount
+    >;
+
+template<
+    typename K,
+    typename T,
+    template<typename...> class ContainerT_T = std::vector,
+    typename Alloc = core::allocator<typename impl::key_val_pair_type_for<ContainerT_T, K, T>::type>,
+    uint32_t ShardCount = 16u
+>
+using CShardedConcurrentMultiObjectCache =
+    impl::CMakeCacheSharded<
+        CMultiObjectCache<K, T, ContainerT_T, Alloc>,
+        ShardCount
+    >;
+
 }}
 
 #endif
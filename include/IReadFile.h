@@ -25,6 +25,15 @@ namespace io
 		\return How many bytes were read. */
 		virtual int32_t read(void* buffer, uint32_t sizeToRead) = 0;
 
+		//! Reads an amount of bytes from an absolute position in the file.
+		/** Neither uses nor changes the current position, so unlike seek() followed by read() it can be called
+		from many threads at once, for example to read several entries of one archive in parallel.
+		\param offset Position in the file to start reading from.
+		\param buffer Pointer to buffer where read bytes are written to.
+		\param sizeToRead Amount of bytes to read from the file, may be larger than 4GB.
+		\return How many bytes were read. */
+		virtual size_t readAt(size_t offset, void* buffer, size_t sizeToRead) = 0;
+
 		//! Changes position in file
 		/** \param finalPos Destination position in the file.
 		\param relativeMovement If set to true, the position in the file is
@@ -44,6 +53,12 @@ namespace io
 		//! Get name of file.
 		/** \return File name as zero terminated character string. */
 		virtual const io::path& getFileName() const = 0;
+
+		//! Get the whole file contents without copying, if the file lives in memory.
+		/** Loaders can parse straight out of this pointer instead of reading the file into a buffer first.
+		\return Pointer to the first byte of the file (not the current position), valid for `getSize()` bytes
+		as long as the file object is alive, or nullptr if the file can only be accessed with read(). */
+		virtual const void* getMappedPointer() const { return nullptr; }
 	};
 
 } // end namespace io
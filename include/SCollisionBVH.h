@@ -0,0 +1,551 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_S_COLLISION_BVH_H_INCLUDED__
+#define __NBL_S_COLLISION_BVH_H_INCLUDED__
+
+#include <algorithm>
+#include <numeric>
+
+#include "nbl/core/Types.h"
+#include "vectorSIMD.h"
+#include "aabbox3d.h"
+
+namespace nbl
+{
+namespace core
+{
+
+//! 4-wide bounding volume hierarchy over axis aligned boxes, accelerates ray queries against colliders
+/**
+The hierarchy gets built top-down with a binned surface area heuristic into a binary tree, which then gets collapsed
+into nodes of 4 children stored in SoA layout. A single ray tests all children of a node with one set of SIMD slab tests,
+a packet of 4 rays tests one child for all its rays at once.
+Primitives are only ever seen through their bounding boxes and referenced by index, so moving them only needs a refit().
+*/
+class SCollisionBVH
+{
+    public:
+        _NBL_STATIC_INLINE_CONSTEXPR uint32_t MaxLeafSize = 4u;
+        _NBL_STATIC_INLINE_CONSTEXPR uint32_t InvalidIndex = 0xffffffffu;
+
+        //! Four rays traversed together, in SoA layout
+        struct SRayPacket
+        {
+            SRayPacket() {}
+            //! Inactive lanes are simply not meant to be tested, their contents don't matter
+            SRayPacket(const vectorSIMDf* origins, const vectorSIMDf* directions, uint32_t rayCount)
+            {
+                for (uint32_t r=0u; r<4u; r++)
+                {
+                    const uint32_t src = core::min(r,rayCount-1u);
+                    const vectorSIMDf rcp = safeReciprocal(directions[src]);
+                    for (uint32_t j=0u; j<3u; j++)
+                    {
+                        origin[j].pointer[r] = origins[src].pointer[j];
+                        directionReciprocal[j].pointer[r] = rcp.pointer[j];
+                    }
+                }
+            }
+
+            vectorSIMDf origin[3];
+            vectorSIMDf directionReciprocal[3];
+        };
+
+        //! Builds the hierarchy over `count` primitive bounding boxes
+        inline void build(const aabbox3df* boxes, uint32_t count)
+        {
+            nodes.clear();
+            primitives.resize(count);
+            std::iota(primitives.begin(),primitives.end(),0u);
+            if (!count)
+                return;
+
+            core::vector<SBounds> bounds(count);
+            for (uint32_t i=0u; i<count; i++)
+                bounds[i] = SBounds(boxes[i]);
+
+            core::vector<SBuildNode> buildNodes;
+            buildNodes.reserve(2u*count);
+            buildNodes.emplace_back();
+            buildNodes[0].first = 0u;
+            buildNodes[0].count = count;
+            buildNodes[0].depth = 0u;
+            for (uint32_t i=0u; i<count; i++)
+                buildNodes[0].bounds.extend(bounds[i]);
+
+            core::vector<uint32_t> toSplit = {0u};
+            while (!toSplit.empty())
+            {
+                const uint32_t nodeIx = toSplit.back();
+                toSplit.pop_back();
+
+                uint32_t mid;
+                if (!split(buildNodes[nodeIx],bounds,mid))
+                    continue;
+
+                const SBuildNode parent = buildNodes[nodeIx];
+                for (uint32_t c=0u; c<2u; c++)
+                {
+                    SBuildNode child;
+                    child.first = c ? mid:parent.first;
+                    child.count = c ? (parent.first+parent.count-mid):(mid-parent.first);
+                    child.depth = parent.depth+1u;
+                    for (uint32_t i=child.first; i<child.first+child.count; i++)
+                        child.bounds.extend(bounds[primitives[i]]);
+                    buildNodes[nodeIx].children[c] = static_cast<uint32_t>(buildNodes.size());
+                    toSplit.push_back(static_cast<uint32_t>(buildNodes.size()));
+                    buildNodes.push_back(child);
+                }
+            }
+
+            collapse(buildNodes,0u);
+        }
+
+        //! Recomputes all node bounds from new primitive boxes, without changing the topology
+        /** Much cheaper than a rebuild, but the tree quality degrades if the primitives move a lot relative to each other.*/
+        inline void refit(const aabbox3df* boxes)
+        {
+            // children always come after their parents
+            for (size_t n=nodes.size(); n--; )
+            {
+                SNode& node = nodes[n];
+                for (uint32_t i=0u; i<4u; i++)
+                {
+                    if (!(node.slotMask&(0x1u<<i)))
+                        continue;
+
+                    SBounds slotBounds;
+                    if (node.count[i])
+                    {
+                        for (uint32_t p=node.child[i]; p<node.child[i]+node.count[i]; p++)
+                            slotBounds.extend(SBounds(boxes[primitives[p]]));
+                    }
+                    else
+                        slotBounds = nodes[node.child[i]].getBounds();
+                    node.setSlot(i,slotBounds);
+                }
+            }
+        }
+
+        //! Permutes per-primitive data into leaf order, afterwards primitive indices passed to intersectors are positions in that order
+        /** Keeps the primitives of a leaf next to each other in memory, after this refit() expects boxes in the new order too.*/
+        template<typename T>
+        inline void reorderPrimitives(core::vector<T>& perPrimitiveData)
+        {
+            core::vector<T> reordered;
+            reordered.reserve(primitives.size());
+            for (const uint32_t p : primitives)
+                reordered.push_back(perPrimitiveData[p]);
+            perPrimitiveData = std::move(reordered);
+            std::iota(primitives.begin(),primitives.end(),0u);
+        }
+
+        inline bool empty() const { return nodes.empty(); }
+
+        //! Finds the closest hit of a ray
+        /**
+        @param[in] origin Start of the ray.
+        @param[in] direction Direction of the ray, does not have to be normalized.
+        @param[in,out] tMax Ray length in multiples of `direction`, gets shortened to the closest hit.
+        @param[in] intersect `bool(uint32_t primitive, float& tMax)` has to test a primitive, shorten `tMax` and return true on a closer hit.
+        @returns Whether any primitive got hit.
+        */
+        template<class Intersector>
+        inline bool traverse(const vectorSIMDf& origin, const vectorSIMDf& direction, float& tMax, Intersector&& intersect) const
+        {
+            if (nodes.empty())
+                return false;
+
+            const vectorSIMDf rcp = safeReciprocal(direction);
+            const vectorSIMDf o[3] = {vectorSIMDf(origin.x),vectorSIMDf(origin.y),vectorSIMDf(origin.z)};
+            const vectorSIMDf r[3] = {vectorSIMDf(rcp.x),vectorSIMDf(rcp.y),vectorSIMDf(rcp.z)};
+
+            bool hit = false;
+            uint32_t stack[StackSize];
+            uint32_t stackSize = 0u;
+            stack[stackSize++] = 0u;
+            while (stackSize)
+            {
+                const SNode& node = nodes[stack[--stackSize]];
+
+                vectorSIMDf tNear,tFar;
+                node.intersect(tNear,tFar,o,r,vectorSIMDf(tMax));
+                uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(tNear.getAsRegister(),tFar.getAsRegister())))&node.slotMask;
+
+                // visit front to back, so that closer hits cull the children further away
+                uint32_t order[4];
+                uint32_t hitCount = 0u;
+                for (; mask; mask&=mask-1u)
+                {
+                    const uint32_t slot = findLSB(mask);
+                    uint32_t j = hitCount++;
+                    for (; j && tNear.pointer[order[j-1u]]>tNear.pointer[slot]; j--)
+                        order[j] = order[j-1u];
+                    order[j] = slot;
+                }
+
+                uint32_t innerChildren[4];
+                uint32_t innerCount = 0u;
+                for (uint32_t j=0u; j<hitCount; j++)
+                {
+                    const uint32_t slot = order[j];
+                    if (tNear.pointer[slot]>tMax)
+                        break;
+                    if (node.count[slot])
+                    {
+                        for (uint32_t p=node.child[slot]; p<node.child[slot]+node.count[slot]; p++)
+                            hit = intersect(primitives[p],tMax) || hit;
+                    }
+                    else
+                        innerChildren[innerCount++] = node.child[slot];
+                }
+                while (innerCount)
+                    stack[stackSize++] = innerChildren[--innerCount];
+            }
+            return hit;
+        }
+
+        //! Finds the closest hits of up to 4 rays at once
+        /**
+        @param[in] packet The rays.
+        @param[in,out] tMax Per-ray lengths, get shortened by the intersector.
+        @param[in] activeMask Bitmask of rays which are to be traced.
+        @param[in] intersect `void(uint32_t primitive, uint32_t rayMask, vectorSIMDf& tMax)` has to test a primitive against the masked rays and shorten their `tMax` on closer hits.
+        */
+        template<class Intersector>
+        inline void traverse(const SRayPacket& packet, vectorSIMDf& tMax, uint32_t activeMask, Intersector&& intersect) const
+        {
+            if (nodes.empty() || !(activeMask&=0xfu))
+                return;
+
+            uint32_t stack[StackSize];
+            uint32_t stackSize = 0u;
+            stack[stackSize++] = 0u;
+            while (stackSize)
+            {
+                const SNode& node = nodes[stack[--stackSize]];
+                for (uint32_t slot=0u; slot<4u; slot++)
+                {
+                    if (!(node.slotMask&(0x1u<<slot)))
+                        continue;
+
+                    const vectorSIMDf lo[3] = {vectorSIMDf(node.minX.pointer[slot]),vectorSIMDf(node.minY.pointer[slot]),vectorSIMDf(node.minZ.pointer[slot])};
+                    const vectorSIMDf hi[3] = {vectorSIMDf(node.maxX.pointer[slot]),vectorSIMDf(node.maxY.pointer[slot]),vectorSIMDf(node.maxZ.pointer[slot])};
+                    vectorSIMDf tNear,tFar;
+                    slabTest(tNear,tFar,lo,hi,packet.origin,packet.directionReciprocal,tMax);
+                    const uint32_t rayMask = static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(tNear.getAsRegister(),tFar.getAsRegister())))&activeMask;
+                    if (!rayMask)
+                        continue;
+
+                    if (node.count[slot])
+                    {
+                        for (uint32_t p=node.child[slot]; p<node.child[slot]+node.count[slot]; p++)
+                            intersect(primitives[p],rayMask,tMax);
+                    }
+                    else
+                        stack[stackSize++] = node.child[slot];
+                }
+            }
+        }
+
+        //! Reciprocal of a direction with zero components nudged away from zero, so slab tests never produce 0*inf
+        static inline vectorSIMDf safeReciprocal(vectorSIMDf direction)
+        {
+            for (uint32_t j=0u; j<3u; j++)
+            if (std::abs(direction.pointer[j])<1e-30f)
+                direction.pointer[j] = std::copysign(1e-30f,direction.pointer[j]);
+            direction.w = 1.f;
+            return vectorSIMDf(1.f).preciseDivision(direction);
+        }
+
+    private:
+        _NBL_STATIC_INLINE_CONSTEXPR uint32_t BinCount = 16u;
+        // past this depth splits go down the middle, which bounds the depth of the whole tree and therefore the traversal stack
+        _NBL_STATIC_INLINE_CONSTEXPR uint32_t MaxSAHDepth = 48u;
+        _NBL_STATIC_INLINE_CONSTEXPR uint32_t StackSize = 3u*(MaxSAHDepth+32u)+1u;
+        // cost of visiting a node relative to testing a primitive
+        _NBL_STATIC_INLINE_CONSTEXPR float TraversalCost = 1.f;
+
+        struct SBounds
+        {
+            SBounds() : lo(FLT_MAX), hi(-FLT_MAX) {}
+            explicit SBounds(const aabbox3df& box)
+            {
+                lo.set(box.MinEdge.X,box.MinEdge.Y,box.MinEdge.Z);
+                hi.set(box.MaxEdge.X,box.MaxEdge.Y,box.MaxEdge.Z);
+            }
+
+            inline void extend(const SBounds& other)
+            {
+                lo = core::min(lo,other.lo);
+                hi = core::max(hi,other.hi);
+            }
+            inline vectorSIMDf centroid() const { return (lo+hi)*0.5f; }
+            inline float area() const
+            {
+                const vectorSIMDf e = core::max(hi-lo,vectorSIMDf(0.f));
+                return e.x*e.y+e.y*e.z+e.z*e.x;
+            }
+
+            vectorSIMDf lo,hi;
+        };
+
+        struct SBuildNode
+        {
+            SBounds bounds;
+            uint32_t children[2] = {InvalidIndex,InvalidIndex};
+            uint32_t first;
+            uint32_t count;
+            uint32_t depth;
+
+            inline bool isLeaf() const { return children[0]==InvalidIndex; }
+        };
+
+        struct SNode
+        {
+            SNode() : minX(FLT_MAX), minY(FLT_MAX), minZ(FLT_MAX), maxX(-FLT_MAX), maxY(-FLT_MAX), maxZ(-FLT_MAX), slotMask(0u)
+            {
+                std::fill_n(child,4u,InvalidIndex);
+                std::fill_n(count,4u,0u);
+            }
+
+            inline void setSlot(uint32_t slot, const SBounds& bounds)
+            {
+                minX.pointer[slot] = bounds.lo.x;
+                minY.pointer[slot] = bounds.lo.y;
+                minZ.pointer[slot] = bounds.lo.z;
+                maxX.pointer[slot] = bounds.hi.x;
+                maxY.pointer[slot] = bounds.hi.y;
+                maxZ.pointer[slot] = bounds.hi.z;
+            }
+            inline SBounds getBounds() const
+            {
+                SBounds retval;
+                for (uint32_t i=0u; i<4u; i++)
+                if (slotMask&(0x1u<<i))
+                {
+                    retval.lo = core::min(retval.lo,vectorSIMDf(minX.pointer[i],minY.pointer[i],minZ.pointer[i]));
+                    retval.hi = core::max(retval.hi,vectorSIMDf(maxX.pointer[i],maxY.pointer[i],maxZ.pointer[i]));
+                }
+                return retval;
+            }
+
+            //! slab test of one ray against all 4 children
+            inline void intersect(vectorSIMDf& tNear, vectorSIMDf& tFar, const vectorSIMDf* o, const vectorSIMDf* r, const vectorSIMDf& tMax) const
+            {
+                const vectorSIMDf lo[3] = {minX,minY,minZ};
+                const vectorSIMDf hi[3] = {maxX,maxY,maxZ};
+                slabTest(tNear,tFar,lo,hi,o,r,tMax);
+            }
+
+            // child bounds in SoA layout
+            vectorSIMDf minX,minY,minZ;
+            vectorSIMDf maxX,maxY,maxZ;
+            //! index of the child node, or of the first primitive in `primitives` for leaves
+            uint32_t child[4];
+            //! amount of primitives in leaf slots, 0 for inner nodes
+            uint32_t count[4];
+            uint32_t slotMask;
+        };
+
+        static inline void slabTest(vectorSIMDf& tNear, vectorSIMDf& tFar, const vectorSIMDf* lo, const vectorSIMDf* hi, const vectorSIMDf* o, const vectorSIMDf* r, const vectorSIMDf& tMax)
+        {
+            tNear = vectorSIMDf(0.f);
+            tFar = tMax;
+            for (uint32_t j=0u; j<3u; j++)
+            {
+                const vectorSIMDf t0 = (lo[j]-o[j])*r[j];
+                const vectorSIMDf t1 = (hi[j]-o[j])*r[j];
+                tNear = core::max(tNear,core::min(t0,t1));
+                tFar = core::min(tFar,core::max(t0,t1));
+            }
+        }
+
+        //! Partitions the primitives of a node, returns false if it should stay a leaf
+        inline bool split(const SBuildNode& node, const core::vector<SBounds>& bounds, uint32_t& mid)
+        {
+            if (node.count<=1u)
+                return false;
+
+            SBounds centroidBounds;
+            for (uint32_t i=node.first; i<node.first+node.count; i++)
+            {
+                const vectorSIMDf c = bounds[primitives[i]].centroid();
+                centroidBounds.lo = core::min(centroidBounds.lo,c);
+                centroidBounds.hi = core::max(centroidBounds.hi,c);
+            }
+            const vectorSIMDf extent = centroidBounds.hi-centroidBounds.lo;
+            uint32_t longestAxis = 0u;
+            for (uint32_t j=1u; j<3u; j++)
+            if (extent.pointer[j]>extent.pointer[longestAxis])
+                longestAxis = j;
+
+            // all centroids in one spot, nothing to split by
+            if (extent.pointer[longestAxis]<=0.f)
+            {
+                if (node.count<=MaxLeafSize)
+                    return false;
+                mid = node.first+node.count/2u;
+                return true;
+            }
+
+            auto begin = primitives.begin()+node.first;
+            auto end = begin+node.count;
+            auto medianSplit = [&]() -> bool
+            {
+                mid = node.first+node.count/2u;
+                std::nth_element(begin,primitives.begin()+mid,end,[&](uint32_t a, uint32_t b)
+                {
+                    return bounds[a].centroid().pointer[longestAxis]<bounds[b].centroid().pointer[longestAxis];
+                });
+                return true;
+            };
+            if (node.depth>=MaxSAHDepth)
+                return medianSplit();
+
+            struct SBin
+            {
+                SBounds bounds;
+                uint32_t count = 0u;
+            };
+            float bestCost = FLT_MAX;
+            uint32_t bestAxis = 0u, bestSplit = 0u;
+            for (uint32_t axis=0u; axis<3u; axis++)
+            {
+                if (extent.pointer[axis]<=0.f)
+                    continue;
+
+                const float scale = float(BinCount)/extent.pointer[axis];
+                auto binOf = [&](uint32_t prim)
+                {
+                    const float offset = bounds[prim].centroid().pointer[axis]-centroidBounds.lo.pointer[axis];
+                    return core::min(static_cast<uint32_t>(offset*scale),BinCount-1u);
+                };
+
+                SBin bins[BinCount];
+                for (uint32_t i=node.first; i<node.first+node.count; i++)
+                {
+                    SBin& bin = bins[binOf(primitives[i])];
+                    bin.bounds.extend(bounds[primitives[i]]);
+                    bin.count++;
+                }
+
+                // sweep from the right to get the cost of everything past each split plane
+                float rightCost[BinCount];
+                SBounds accumulated;
+                uint32_t accumulatedCount = 0u;
+                for (uint32_t b=BinCount-1u; b>0u; b--)
+                {
+                    accumulated.extend(bins[b].bounds);
+                    accumulatedCount += bins[b].count;
+                    rightCost[b] = accumulatedCount ? accumulated.area()*float(accumulatedCount):0.f;
+                }
+                accumulated = SBounds();
+                accumulatedCount = 0u;
+                for (uint32_t b=0u; b<BinCount-1u; b++)
+                {
+                    accumulated.extend(bins[b].bounds);
+                    accumulatedCount += bins[b].count;
+                    if (!accumulatedCount || accumulatedCount==node.count)
+                        continue;
+                    const float cost = accumulated.area()*float(accumulatedCount)+rightCost[b+1u];
+                    if (cost<bestCost)
+                    {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = b;
+                    }
+                }
+            }
+
+            const float leafCost = float(node.count);
+            const float parentArea = node.bounds.area();
+            const float splitCost = parentArea>0.f ? (TraversalCost+bestCost/parentArea):FLT_MAX;
+            if (node.count<=MaxLeafSize && splitCost>=leafCost)
+                return false;
+            if (bestCost==FLT_MAX || parentArea<=0.f)
+                return medianSplit();
+
+            const float scale = float(BinCount)/extent.pointer[bestAxis];
+            auto midIt = std::partition(begin,end,[&](uint32_t prim)
+            {
+                const float offset = bounds[prim].centroid().pointer[bestAxis]-centroidBounds.lo.pointer[bestAxis];
+                return core::min(static_cast<uint32_t>(offset*scale),BinCount-1u)<=bestSplit;
+            });
+            mid = static_cast<uint32_t>(midIt-primitives.begin());
+            if (mid==node.first || mid==node.first+node.count)
+                return medianSplit();
+            return true;
+        }
+
+        //! Turns a binary node into a 4-wide one by opening up its children with the largest surface area, returns the new node's index
+        inline uint32_t collapse(const core::vector<SBuildNode>& buildNodes, uint32_t buildNodeIx)
+        {
+            const uint32_t nodeIx = static_cast<uint32_t>(nodes.size());
+            nodes.emplace_back();
+
+            uint32_t slots[4];
+            uint32_t slotCount = 0u;
+            const SBuildNode& root = buildNodes[buildNodeIx];
+            if (root.isLeaf())
+                slots[slotCount++] = buildNodeIx;
+            else
+            {
+                slots[slotCount++] = root.children[0];
+                slots[slotCount++] = root.children[1];
+            }
+            while (slotCount<4u)
+            {
+                uint32_t largest = InvalidIndex;
+                float largestArea = -1.f;
+                for (uint32_t i=0u; i<slotCount; i++)
+                {
+                    const SBuildNode& candidate = buildNodes[slots[i]];
+                    if (!candidate.isLeaf() && candidate.bounds.area()>largestArea)
+                    {
+                        largest = i;
+                        largestArea = candidate.bounds.area();
+                    }
+                }
+                if (largest==InvalidIndex)
+                    break;
+                const SBuildNode& opened = buildNodes[slots[largest]];
+                slots[largest] = opened.children[0];
+                slots[slotCount++] = opened.children[1];
+            }
+
+            for (uint32_t i=0u; i<slotCount; i++)
+            {
+                const SBuildNode& slot = buildNodes[slots[i]];
+                uint32_t child,count;
+                if (slot.isLeaf())
+                {
+                    child = slot.first;
+                    count = slot.count;
+                }
+                else
+                {
+                    child = collapse(buildNodes,slots[i]);
+                    count = 0u;
+                }
+                // `nodes` might have been reallocated by the recursion
+                SNode& node = nodes[nodeIx];
+                node.setSlot(i,slot.bounds);
+                node.child[i] = child;
+                node.count[i] = count;
+                node.slotMask |= 0x1u<<i;
+            }
+            return nodeIx;
+        }
+
+        core::vector<SNode> nodes;
+        //! leaves reference ranges of this permutation of primitive indices
+        core::vector<uint32_t> primitives;
+};
+
+}
+}
+
+#endif
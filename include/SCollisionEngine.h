@@ -5,8 +5,11 @@
 #ifndef __NBL_S_COLLISION_ENGINE_H_INCLUDED__
 #define __NBL_S_COLLISION_ENGINE_H_INCLUDED__
 
+#include <execution>
+
 #include "nabla.h"
 #include "SCompoundCollider.h"
+#include "SCollisionBVH.h"
 #include "SViewFrustum.h"
 
 namespace nbl
@@ -17,8 +20,28 @@ namespace core
 class SCollisionEngine : public AllocationOverrideDefault
 {
         core::vector<core::smart_refctd_ptr<SCompoundCollider> > colliders;
+        //! over the world space bounding boxes of `colliders`, only used while `bvhValid`
+        SCollisionBVH bvh;
+        core::vector<aabbox3df> worldBoxes;
+        bool bvhValid = false;
 
     public:
+        //! A ray for FastCollideBatch
+        struct SRayQuery
+        {
+            vectorSIMDf origin;
+            vectorSIMDf direction;
+            float maxRayLen = FLT_MAX;
+        };
+        //! Result of a single ray from FastCollideBatch
+        struct SRayHit
+        {
+            SColliderData data;
+            //! `maxRayLen` of the query if nothing got hit
+            float distance;
+            bool hit;
+        };
+
 		//! Destructor.
 		~SCollisionEngine() = default;
 
@@ -114,6 +137,7 @@ class SCollisionEngine : public AllocationOverrideDefault
                 return;
 
             colliders.insert(found,std::move(collider));
+            bvhValid = false;
         }
 
 		//! Removes collider pointed by `collider`
@@ -131,16 +155,36 @@ class SCollisionEngine : public AllocationOverrideDefault
 			}
 
             colliders.erase(found);
+            bvhValid = false;
         }
 
 		//! Gets current amount of colliders
 		/** @rturns Current amount of colliders. */
         inline size_t getColliderCount() const { return colliders.size(); }
 
+		//! Updates the acceleration structure after colliders got added, removed or their scene nodes moved
+		/**
+		Until this gets called after adding or removing colliders, queries fall back to testing every collider.
+		If only the transformations changed the hierarchy just gets refit, which is much cheaper than rebuilding it.
+		@param[in] forceRebuild Rebuild even if a refit would do, worth it after large relative movements between colliders.
+		*/
+        inline void UpdateTransformation(bool forceRebuild=false)
+        {
+            worldBoxes.resize(colliders.size());
+            for (size_t i=0; i<colliders.size(); i++)
+                worldBoxes[i] = getWorldBoundingBox(colliders[i].get());
+
+            if (bvhValid && !forceRebuild)
+                bvh.refit(worldBoxes.data());
+            else
+                bvh.build(worldBoxes.data(),static_cast<uint32_t>(worldBoxes.size()));
+            bvhValid = true;
+        }
+
 		//! Performs collision test with a given ray defined by `origin`, `direction` and `maxRayLen` parameters
 		/**
 		@param[out] hitPointObjectData Data of collider with which the collision occured. Does not get touched if no collision occured.
-		@param[out] collisionDistance If no collision occured - gets value of `maxRayLen` parameter. Otherwise - ???
+		@param[out] collisionDistance If no collision occured - gets value of `maxRayLen` parameter. Otherwise - distance to the closest hit along the ray.
 		@param[in] origin Start point point of the input ray
 		@param[in] direction Normalized vector denoting direction of the input ray
 		@param[in] maxRayLen Length of the input ray
@@ -150,6 +194,23 @@ class SCollisionEngine : public AllocationOverrideDefault
             bool retval = false;
 
             collisionDistance = maxRayLen;
+            if (bvhValid)
+            {
+                const SCompoundCollider* closest = nullptr;
+                retval = bvh.traverse(origin,direction,collisionDistance,[&](uint32_t colliderIx, float& tMax) -> bool
+                {
+                    float tmpDist;
+                    if (!colliders[colliderIx]->CollideWithRay(tmpDist,origin,direction,tMax) || tmpDist>=tMax)
+                        return false;
+                    tMax = tmpDist;
+                    closest = colliders[colliderIx].get();
+                    return true;
+                });
+                if (retval)
+                    hitPointObjectData = closest->getColliderData();
+                return retval;
+            }
+
             for (size_t i=0; i<colliders.size(); i++)
             {
                 float tmpDist;
@@ -163,6 +224,97 @@ class SCollisionEngine : public AllocationOverrideDefault
 
             return retval;
         }
+
+		//! Performs FastCollide for many rays at once
+		/**
+		Rays get traversed in packets of 4, so the batch is fastest when neighbouring rays are coherent (e.g. adjacent pixels).
+		Packets are distributed over all cores, so this must not race with UpdateTransformation or adding/removing colliders.
+		@param[out] hits One result per ray.
+		@param[in] rays The rays to test.
+		@param[in] count Number of rays.
+		*/
+        inline void FastCollideBatch(SRayHit* hits, const SRayQuery* rays, size_t count) const
+        {
+            if (!bvhValid)
+            {
+                std::for_each(std::execution::par_unseq,hits,hits+count,[&](SRayHit& hit)
+                {
+                    const SRayQuery& ray = rays[&hit-hits];
+                    hit.hit = FastCollide(hit.data,hit.distance,ray.origin,ray.direction,ray.maxRayLen);
+                });
+                return;
+            }
+
+            constexpr uint32_t PacketSize = 4u;
+            core::vector<size_t> packets((count+PacketSize-1u)/PacketSize);
+            std::iota(packets.begin(),packets.end(),0u);
+            std::for_each(std::execution::par,packets.begin(),packets.end(),[&](size_t packetIx)
+            {
+                const size_t first = packetIx*PacketSize;
+                const uint32_t rayCount = static_cast<uint32_t>(core::min<size_t>(count-first,PacketSize));
+
+                vectorSIMDf origins[PacketSize],directions[PacketSize];
+                vectorSIMDf tMax;
+                const SCompoundCollider* closest[PacketSize] = {};
+                for (uint32_t r=0u; r<rayCount; r++)
+                {
+                    origins[r] = rays[first+r].origin;
+                    directions[r] = rays[first+r].direction;
+                    tMax.pointer[r] = rays[first+r].maxRayLen;
+                }
+
+                const SCollisionBVH::SRayPacket packet(origins,directions,rayCount);
+                bvh.traverse(packet,tMax,(0x1u<<rayCount)-1u,[&](uint32_t colliderIx, uint32_t rayMask, vectorSIMDf& tMax) -> void
+                {
+                    for (; rayMask; rayMask&=rayMask-1u)
+                    {
+                        const uint32_t r = findLSB(rayMask);
+                        float tmpDist;
+                        if (colliders[colliderIx]->CollideWithRay(tmpDist,origins[r],directions[r],tMax.pointer[r]) && tmpDist<tMax.pointer[r])
+                        {
+                            tMax.pointer[r] = tmpDist;
+                            closest[r] = colliders[colliderIx].get();
+                        }
+                    }
+                });
+
+                for (uint32_t r=0u; r<rayCount; r++)
+                {
+                    SRayHit& hit = hits[first+r];
+                    hit.hit = closest[r]!=nullptr;
+                    hit.distance = tMax.pointer[r];
+                    if (hit.hit)
+                        hit.data = closest[r]->getColliderData();
+                }
+            });
+        }
+
+    private:
+        //! Bounds of the collider in world space, conservative for rotated scene nodes
+        static inline aabbox3df getWorldBoundingBox(const SCompoundCollider* collider)
+        {
+            const aabbox3df& localBox = collider->getBoundingBox().Box;
+            const scene::ISceneNode* node = collider->getColliderData().attachedNode;
+            if (!node)
+                return localBox;
+
+            matrix3x4SIMD transform;
+            transform.set(const_cast<scene::ISceneNode*>(node)->getAbsoluteTransformation());
+
+            const vectorSIMDf minEdge(localBox.MinEdge.X,localBox.MinEdge.Y,localBox.MinEdge.Z);
+            const vectorSIMDf maxEdge(localBox.MaxEdge.X,localBox.MaxEdge.Y,localBox.MaxEdge.Z);
+            const vectorSIMDf center((minEdge+maxEdge)*0.5f);
+            const vectorSIMDf extent((maxEdge-minEdge)*0.5f);
+            // each world axis' half extent is the sum of the absolute projections of the local half extents
+            vectorSIMDf worldCenter,worldExtent;
+            for (uint32_t i=0u; i<3u; i++)
+            {
+                const vectorSIMDf& row = transform.rows[i];
+                worldCenter.pointer[i] = dot(row,center).x+row.w;
+                worldExtent.pointer[i] = dot(core::abs(row),extent).x;
+            }
+            return aabbox3df((worldCenter-worldExtent).getAsVector3df(),(worldCenter+worldExtent).getAsVector3df());
+        }
 };
 
 }
@@ -183,6 +183,18 @@ class SCompoundCollider : public IReferenceCounted
             }
 
 
+            // shapes may overlap, so all of them need testing to find the closest hit
+            bool retval = false;
+            float closest = dirMaxMultiplier;
+            float dist;
+            auto hit = [&](float newDist)
+            {
+                if (newDist<closest)
+                {
+                    closest = newDist;
+                    retval = true;
+                }
+            };
             for (size_t i=0; i<Shapes.size(); i++)
             {
                 switch (Shapes[i].objectType)
@@ -190,29 +202,29 @@ class SCompoundCollider : public IReferenceCounted
                     case SCollisionShapeDef::ECST_AABOX:
                         {
                             SAABoxCollider* tmp = static_cast<SAABoxCollider*>(Shapes[i].object);
-                            if (tmp->CollideWithRay(collisionDistance,origin,direction,dirMaxMultiplier,direction_reciprocal))
-                                return true;
+                            if (tmp->CollideWithRay(dist,origin,direction,closest,direction_reciprocal))
+                                hit(dist);
                         }
                         break;
                     case SCollisionShapeDef::ECST_ELLIPSOID:
                         {
                             SEllipsoidCollider* tmp = static_cast<SEllipsoidCollider*>(Shapes[i].object);
-                            if (tmp->CollideWithRay(collisionDistance,origin,direction,dirMaxMultiplier))
-                                return true;
+                            if (tmp->CollideWithRay(dist,origin,direction,closest))
+                                hit(dist);
                         }
                         break;
                     case SCollisionShapeDef::ECST_TRIANGLE:
                         {
                             STriangleCollider* tmp = static_cast<STriangleCollider*>(Shapes[i].object);
-                            if (tmp->CollideWithRay(collisionDistance,origin,direction,dirMaxMultiplier))
-                                return true;
+                            if (tmp->CollideWithRay(dist,origin,direction,closest))
+                                hit(dist);
                         }
                         break;
                     case SCollisionShapeDef::ECST_TRIANGLE_MESH:
                         {
                             STriangleMeshCollider* tmp = static_cast<STriangleMeshCollider*>(Shapes[i].object);
-                            if (tmp->CollideWithRay(collisionDistance,origin,direction,dirMaxMultiplier))
-                                return true;
+                            if (tmp->CollideWithRay(dist,origin,direction,closest))
+                                hit(dist);
                         }
                         break;
                     case SCollisionShapeDef::ECST_COUNT:
@@ -220,7 +232,9 @@ class SCompoundCollider : public IReferenceCounted
                         break;
                 }
             }
-            return false;
+            if (retval)
+                collisionDistance = closest;
+            return retval;
         }
 
 		inline size_t getShapeCount() const { return Shapes.size(); }
@@ -6,6 +6,7 @@
 #define __NBL_S_TRIANGLE_MESH_COLLIDER_H_INCLUDED__
 
 #include "SAABoxCollider.h"
+#include "SCollisionBVH.h"
 #include "nbl/core/IReferenceCounted.h"
 
 namespace nbl
@@ -44,7 +45,7 @@ class STriangleCollider// : public AllocationOverrideDefault EBO inheritance pro
 			origin.makeSafe3D();
 
             const float NdotD = dot(direction,planeEq).X;
-            if (NdotD!=0.f)
+            if (NdotD==0.f)
                 return false;
 
             const float NdotOrigin = dot(origin,planeEq).X;
@@ -60,7 +61,7 @@ class STriangleCollider// : public AllocationOverrideDefault EBO inheritance pro
             const vectorSIMDf outPointW1 = outPoint|reinterpret_cast<const vectorSIMDu32&>(extraComponent);
 
             const float distToEdge[2] ={dot(outPointW1,boundaryPlanes[0])[0],dot(outPointW1,boundaryPlanes[1])[0]};
-            if (distToEdge[0]<0.f||distToEdge[1]<0.f||(distToEdge[0]+distToEdge[1])>1.f)
+            if (distToEdge[0]>=0.f&&distToEdge[1]>=0.f&&(distToEdge[0]+distToEdge[1])<=1.f)
             {
                 collisionDistance = t;
                 return true;
@@ -82,6 +83,8 @@ class STriangleMeshCollider : public IReferenceCounted
         ///matrix4x3 cachedTransformInverse;
         ///matrix4x3 cachedTransform;
         vector<STriangleCollider> triangles;
+        //! over `triangles`, which are kept in the order of its leaves
+        SCollisionBVH bvh;
     public:
         STriangleMeshCollider() : BBox(core::aabbox3df()) {}
 
@@ -92,58 +95,36 @@ class STriangleMeshCollider : public IReferenceCounted
 
         inline bool Init(float* vertices, const size_t &indexCount, uint32_t* indices=NULL)
         {
-            bool firstPoint = true;
-            if (indices)
+            core::vector<aabbox3df> triangleBoxes;
+            triangleBoxes.reserve(indexCount/3);
+            triangles.reserve(indexCount/3);
+            for (size_t i=0; i+2<indexCount; i+=3)
             {
-                for (size_t i=0; i<indexCount; i+=3)
+                const size_t ix[3] = {indices ? indices[i+0]:(i+0),indices ? indices[i+1]:(i+1),indices ? indices[i+2]:(i+2)};
+                vectorSIMDf A(vertices[ix[0]*3+0],vertices[ix[0]*3+1],vertices[ix[0]*3+2]);
+                vectorSIMDf B(vertices[ix[1]*3+0],vertices[ix[1]*3+1],vertices[ix[1]*3+2]);
+                vectorSIMDf C(vertices[ix[2]*3+0],vertices[ix[2]*3+1],vertices[ix[2]*3+2]);
+
+                bool useful = false;
+                STriangleCollider triangle(A,B,C,useful);
+                if (useful)
                 {
-                    vectorSIMDf A(vertices[indices[i+0]*3+0],vertices[indices[i+0]*3+1],vertices[indices[i+0]*3+2]);
-                    vectorSIMDf B(vertices[indices[i+1]*3+0],vertices[indices[i+1]*3+1],vertices[indices[i+1]*3+2]);
-                    vectorSIMDf C(vertices[indices[i+2]*3+0],vertices[indices[i+2]*3+1],vertices[indices[i+2]*3+2]);
-
-                    bool useful = false;
-                    STriangleCollider triangle(A,B,C,useful);
-                    if (useful)
-                    {
-                        if (firstPoint)
-                        {
-                            BBox.Box.reset(A.getAsVector3df());
-                            firstPoint = false;
-                        }
-                        else
-                            BBox.Box.addInternalPoint(A.getAsVector3df());
-                        BBox.Box.addInternalPoint(B.getAsVector3df());
-                        BBox.Box.addInternalPoint(C.getAsVector3df());
-                        triangles.push_back(triangle);
-                    }
-                }
-            }
-            else
-            {
-                for (size_t i=0; i<indexCount; i+=3)
-                {
-                    vectorSIMDf A(vertices[(i+0)*3+0],vertices[(i+0)*3+1],vertices[(i+0)*3+2]);
-                    vectorSIMDf B(vertices[(i+1)*3+0],vertices[(i+1)*3+1],vertices[(i+1)*3+2]);
-                    vectorSIMDf C(vertices[(i+2)*3+0],vertices[(i+2)*3+1],vertices[(i+2)*3+2]);
-
-                    bool useful;
-                    STriangleCollider triangle(A,B,C,useful);
-                    if (useful)
-                    {
-                        if (firstPoint)
-                        {
-                            BBox.Box.reset(A.getAsVector3df());
-                            firstPoint = false;
-                        }
-                        else
-                            BBox.Box.addInternalPoint(A.getAsVector3df());
-                        BBox.Box.addInternalPoint(B.getAsVector3df());
-                        BBox.Box.addInternalPoint(C.getAsVector3df());
-                        triangles.push_back(triangle);
-                    }
+                    aabbox3df triangleBox(A.getAsVector3df());
+                    triangleBox.addInternalPoint(B.getAsVector3df());
+                    triangleBox.addInternalPoint(C.getAsVector3df());
+                    if (triangles.size())
+                        BBox.Box.addInternalBox(triangleBox);
+                    else
+                        BBox.Box = triangleBox;
+                    triangleBoxes.push_back(triangleBox);
+                    triangles.push_back(triangle);
                 }
             }
 
+            bvh.build(triangleBoxes.data(),static_cast<uint32_t>(triangleBoxes.size()));
+            // triangles of a leaf end up next to each other in memory
+            bvh.reorderPrimitives(triangles);
+
             return triangles.size();
         }
 
@@ -152,19 +133,25 @@ class STriangleMeshCollider : public IReferenceCounted
             return CollideWithRay(collisionDistance,origin,direction,dirMaxMultiplier,reciprocal_approxim(direction));
         }
 
+        //! Finds the closest triangle hit by the ray
         inline bool CollideWithRay(float& collisionDistance, const vectorSIMDf& origin, const vectorSIMDf& direction, const float& dirMaxMultiplier, const vectorSIMDf& direction_reciprocal) const
         {
             float dummyDist;
             if (!BBox.CollideWithRay(dummyDist,origin,direction,dirMaxMultiplier,direction_reciprocal))
                 return false;
 
-            for (size_t i=0; i<triangles.size(); i++)
+            float closest = dirMaxMultiplier;
+            const bool retval = bvh.traverse(origin,direction,closest,[&](uint32_t triangleIx, float& tMax) -> bool
             {
-                if (triangles[i].CollideWithRay(collisionDistance,origin,direction,dirMaxMultiplier))
-                    return true;
-            }
-
-            return false;
+                float dist;
+                if (!triangles[triangleIx].CollideWithRay(dist,origin,direction,tMax))
+                    return false;
+                tMax = dist;
+                return true;
+            });
+            if (retval)
+                collisionDistance = closest;
+            return retval;
         }
 /**
         inline bool UpdateTransformation(const matrix4x3& newTransform)
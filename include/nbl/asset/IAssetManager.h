@@ -6,7 +6,11 @@
 #define __NBL_ASSET_I_ASSET_MANAGER_H_INCLUDED__
 
 #include <array>
+#include <atomic>
+#include <future>
+#include <mutex>
 #include <ostream>
+#include <thread>
 
 #include "nbl/core/core.h"
 #include "CConcurrentObjectCache.h"
@@ -20,6 +24,7 @@
 
 #include "nbl/asset/utils/IGLSLCompiler.h"
 #include "nbl/asset/utils/IGeometryCreator.h"
+#include "nbl/asset/utils/CAssetDeduplicator.h"
 
 
 #define USE_MAPS_FOR_PATH_BASED_CACHE //benchmark and choose, paths can be full system paths
@@ -38,9 +43,9 @@ std::function<void(SAssetBundle&)> makeAssetDisposeFunc(const IAssetManager* con
 
 //! Class responsible for handling loading of assets from file system or other resources
 /**
-	It provides a loading, writing and creation functionality that is almost thread-safe.
-	There is one issue with threading, starting loading the same asset at the exact same time 
-	may end up with two copies in the cache.
+	It provides a loading, writing and creation functionality that is thread-safe.
+	Loads which would end up in the cache are tracked while in flight, so if another thread
+	asks for the same cache key in the meantime it waits for the first load and gets the same SAssetBundle.
 
 	IAssetManager performs caching of CPU assets associated with resource handles such as names, 
 	filenames, UUIDs. However there are separate caches for each asset type.
@@ -55,13 +60,14 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
         friend std::function<void(SAssetBundle&)> makeAssetDisposeFunc(const IAssetManager* const _mgr);
 
     public:
+        // sharded so that loader threads looking up different keys don't contend on one lock
 #ifdef USE_MAPS_FOR_PATH_BASED_CACHE
-        using AssetCacheType = core::CConcurrentMultiObjectCache<std::string, SAssetBundle, std::multimap>;
+        using AssetCacheType = core::CShardedConcurrentMultiObjectCache<std::string, SAssetBundle, std::multimap>;
 #else
         using AssetCacheType = core::CConcurrentMultiObjectCache<std::string, IAssetBundle, std::vector>;
 #endif //USE_MAPS_FOR_PATH_BASED_CACHE
 
-        using CpuGpuCacheType = core::CConcurrentObjectCache<const IAsset*, core::smart_refctd_ptr<core::IReferenceCounted> >;
+        using CpuGpuCacheType = core::CShardedConcurrentObjectCache<const IAsset*, core::smart_refctd_ptr<core::IReferenceCounted> >;
 
     private:
         struct WriterKey
@@ -120,6 +126,23 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
         friend class IAssetLoader;
         friend class IAssetLoader::IAssetLoaderOverride; // for access to non-const findAssets
 
+        //! Loads which will put their result into the cache, keyed by the cache key (the filename)
+        struct SInFlightLoad
+        {
+            std::shared_future<SAssetBundle> result;
+            std::thread::id loader; // a loader can't wait on itself
+        };
+        std::mutex m_inFlightLoadsMutex;
+        core::unordered_map<std::string, SInFlightLoad> m_inFlightLoads;
+        std::atomic_uint64_t m_trackedLoadCount = 0u;
+        std::atomic_uint64_t m_deduplicatedLoadCount = 0u;
+
+        //! Makes assets with the same contents but different cache keys share one instance
+        mutable std::mutex m_deduplicatorMutex;
+        core::smart_refctd_ptr<CAssetDeduplicator> m_deduplicator;
+        std::atomic_bool m_contentDeduplication = false;
+        void deduplicateLoadedBundle(SAssetBundle& _bundle);
+
         core::smart_refctd_ptr<IGeometryCreator> m_geometryCreator;
         core::smart_refctd_ptr<IMeshManipulator> m_meshManipulator;
         core::smart_refctd_ptr<IGLSLCompiler> m_glslCompiler;
@@ -130,7 +153,8 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
         //! Constructor
         explicit IAssetManager(core::smart_refctd_ptr<io::IFileSystem>&& _fs) :
             m_fileSystem(std::move(_fs)),
-            m_defaultLoaderOverride(this)
+            m_defaultLoaderOverride(this),
+            m_deduplicator(core::make_smart_refctd_ptr<CAssetDeduplicator>())
         {
             initializeMeshTools();
 
@@ -149,6 +173,35 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
         IMeshManipulator* getMeshManipulator();
         IGLSLCompiler* getGLSLCompiler() const { return m_glslCompiler.get(); }
 
+        //! Number of loads which were tracked as in flight, so other threads asking for the same cache key could wait on them
+        inline uint64_t getTrackedLoadCount() const { return m_trackedLoadCount.load(); }
+        //! Number of loads which didn't happen because the same cache key was already being loaded by another thread
+        inline uint64_t getDeduplicatedLoadCount() const { return m_deduplicatedLoadCount.load(); }
+
+        //! When enabled, buffers, images, image views and mesh buffers of every loaded asset get replaced by identical ones loaded before, even from other paths
+        /** Top-level assets of bundles with metadata keep their identity (metadata is looked up by pointer), only what they reference gets replaced.
+        Off by default, because it costs hashing all the loaded data and keeps the first instance of everything alive until `clearDeduplicationCache()`. */
+        inline void setContentDeduplication(bool _enable) { m_contentDeduplication = _enable; }
+        inline bool getContentDeduplication() const { return m_contentDeduplication.load(); }
+
+        //! Deduplicates what the cached assets of the given types reference, the cached assets themselves keep their identity
+        /** \return statistics of this pass only, `getContentDeduplicationStatistics()` has the totals. */
+        CAssetDeduplicator::SStatistics deduplicateCachedAssets(const uint64_t& _assetTypeBitFlags = 0xffffffffffffffffull);
+
+        //! Everything deduplicated since construction or the last `clearDeduplicationCache()`, by load-time deduplication and `deduplicateCachedAssets()`
+        inline CAssetDeduplicator::SStatistics getContentDeduplicationStatistics() const
+        {
+            std::lock_guard<std::mutex> lock(m_deduplicatorMutex);
+            return m_deduplicator->getStatistics();
+        }
+
+        //! Lets go of the canonical instances kept around for matching and resets the statistics, assets already deduplicated stay shared
+        inline void clearDeduplicationCache()
+        {
+            std::lock_guard<std::mutex> lock(m_deduplicatorMutex);
+            m_deduplicator->clear();
+        }
+
     protected:
 		virtual ~IAssetManager()
 		{
@@ -228,6 +281,21 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
             const uint64_t levelFlags = params.cacheFlags >> ((uint64_t)_hierarchyLevel * 2ull);
 
             SAssetBundle bundle;
+            // if we end up tracking this load, waiters get woken up as soon as the result is in the cache, or on any early return
+            std::promise<SAssetBundle> inFlightLoad;
+            bool ownsInFlightLoad = false;
+            auto finishInFlightLoad = [this,&inFlightLoad,&ownsInFlightLoad,&filename,&bundle]() -> void
+            {
+                if (!ownsInFlightLoad)
+                    return;
+                ownsInFlightLoad = false;
+                {
+                    std::lock_guard<std::mutex> lock(m_inFlightLoadsMutex);
+                    m_inFlightLoads.erase(filename);
+                }
+                inFlightLoad.set_value(bundle);
+            };
+            auto inFlightLoadExiter = core::makeRAIIExiter(finishInFlightLoad);
             if ((levelFlags & IAssetLoader::ECF_DUPLICATE_TOP_LEVEL) != IAssetLoader::ECF_DUPLICATE_TOP_LEVEL)
             {
                 auto found = findAssets(filename);
@@ -235,6 +303,41 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
                     return _override->chooseRelevantFromFound(found->begin(), found->end(), ctx, _hierarchyLevel);
                 else if (!(bundle = _override->handleSearchFail(filename, ctx, _hierarchyLevel)).getContents().empty())
                     return bundle;
+
+                // only loads which end up in the cache can be shared, everyone else asking for the same key in the meantime waits for ours
+                if (file && (levelFlags & IAssetLoader::ECF_DONT_CACHE_TOP_LEVEL) != IAssetLoader::ECF_DONT_CACHE_TOP_LEVEL)
+                {
+                    std::shared_future<SAssetBundle> pending;
+                    {
+                        std::lock_guard<std::mutex> lock(m_inFlightLoadsMutex);
+                        auto inserted = m_inFlightLoads.try_emplace(filename, SInFlightLoad{inFlightLoad.get_future().share(),std::this_thread::get_id()});
+                        if (inserted.second)
+                            ownsInFlightLoad = true;
+                        else if (inserted.first->second.loader != std::this_thread::get_id())
+                            pending = inserted.first->second.result;
+                    }
+                    if (pending.valid())
+                    {
+                        // the other load's raw result doesn't go through our override, take it from the cache exactly like a cache hit would
+                        pending.wait();
+                        found = findAssets(filename);
+                        if (found->size())
+                        {
+                            m_deduplicatedLoadCount++;
+                            return _override->chooseRelevantFromFound(found->begin(), found->end(), ctx, _hierarchyLevel);
+                        }
+                        // it failed or didn't get cached, so try loading ourselves like we would have without the race
+                    }
+                    else
+                    {
+                        m_trackedLoadCount++;
+
+                        // another load could have finished between the cache lookup and registering ours
+                        found = findAssets(filename);
+                        if (found->size())
+                            return bundle = _override->chooseRelevantFromFound(found->begin(), found->end(), ctx, _hierarchyLevel);
+                    }
+                }
             }
 
             // if at this point, and after looking for an asset in cache, file is still nullptr, then return nullptr
@@ -254,6 +357,9 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
                     break;
             }
 
+            if (!bundle.getContents().empty() && m_contentDeduplication.load())
+                deduplicateLoadedBundle(bundle);
+
             if (!bundle.getContents().empty() && 
                 ((levelFlags & IAssetLoader::ECF_DONT_CACHE_TOP_LEVEL) != IAssetLoader::ECF_DONT_CACHE_TOP_LEVEL) &&
                 ((levelFlags & IAssetLoader::ECF_DUPLICATE_TOP_LEVEL) != IAssetLoader::ECF_DUPLICATE_TOP_LEVEL))
@@ -267,6 +373,7 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
                 if (!bundle.getContents().empty() && addToCache)
                     _override->insertAssetIntoCache(bundle, filename, ctx, _hierarchyLevel);
             }
+            finishInFlightLoad();
 
             auto whole_bundle_not_dummy = [restoreLevels](const SAssetBundle& _b) {
                 auto rng = _b.getContents();
@@ -489,14 +596,14 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
                 while ((_types[i] != (IAsset::E_TYPE)0u))
                 {
                     const uint32_t typeIx = IAsset::typeFlagToIndex(_types[i]);
-                    reqSz += m_assetCache[typeIx]->getSize();
+                    reqSz += m_assetCache[typeIx]->getKeyRangeSize(_key);
                     ++i;
                 }
             }
             else
             {
                 for (const auto& cache : m_assetCache)
-                    reqSz += cache->getSize();
+                    reqSz += cache->getKeyRangeSize(_key);
             }
 			auto res = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<SAssetBundle> >(reqSz);
             findAssets(reqSz, res->data(), _key, _types);
@@ -754,6 +861,12 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
                 delete[] storage;
             }
             */
+            _outs << "Tracked loads: " << getTrackedLoadCount() << ", deduplicated loads: " << getDeduplicatedLoadCount() << '\n';
+            {
+                const auto stats = getContentDeduplicationStatistics();
+                _outs << "Content deduplication: " << stats.buffersDeduplicated << " buffers, " << stats.imagesDeduplicated << " images, "
+                    << stats.imageViewsDeduplicated << " image views, " << stats.meshBuffersDeduplicated << " mesh buffers, " << stats.bytesSaved << " bytes saved\n";
+            }
             _outs << "Loaders vector:\n";
             for (const auto& ldr : m_loaders.vector)
                 _outs << '\t' << static_cast<void*>(ldr.get()) << '\n';
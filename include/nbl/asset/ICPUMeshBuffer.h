@@ -56,6 +56,43 @@ namespace impl
         default: return EF_UNKNOWN;
         }
     }
+
+    //! Layout of normalized formats whose channels are bitfields of a single 32bit word, lets the batched attribute accessors decode them with SIMD
+    struct SPackedAttribLayout
+    {
+        uint32_t channelCount;
+        bool isSigned;
+        uint32_t offset[4];
+        uint32_t width[4];
+        float scale[4];
+    };
+    inline bool getPackedAttribLayout(E_FORMAT _fmt, SPackedAttribLayout& _layout)
+    {
+        auto set = [&_layout](uint32_t channelCount, bool isSigned, std::initializer_list<uint32_t> widths, std::initializer_list<float> scales) -> bool
+        {
+            _layout.channelCount = channelCount;
+            _layout.isSigned = isSigned;
+            uint32_t offset = 0u;
+            for (uint32_t i=0u; i<channelCount; i++)
+            {
+                _layout.offset[i] = offset;
+                _layout.width[i] = widths.begin()[i];
+                _layout.scale[i] = scales.begin()[i];
+                offset += _layout.width[i];
+            }
+            return true;
+        };
+        switch (_fmt)
+        {
+        case EF_R8G8B8A8_UNORM: return set(4u, false, {8u,8u,8u,8u}, {255.f,255.f,255.f,255.f});
+        case EF_R8G8B8A8_SNORM: return set(4u, true, {8u,8u,8u,8u}, {127.f,127.f,127.f,127.f});
+        case EF_A2B10G10R10_UNORM_PACK32: return set(4u, false, {10u,10u,10u,2u}, {1023.f,1023.f,1023.f,3.f});
+        case EF_A2B10G10R10_SNORM_PACK32: return set(4u, true, {10u,10u,10u,2u}, {511.f,511.f,511.f,1.f});
+        case EF_R16G16_UNORM: return set(2u, false, {16u,16u}, {65535.f,65535.f});
+        case EF_R16G16_SNORM: return set(2u, true, {16u,16u}, {32767.f,32767.f});
+        default: return false;
+        }
+    }
 }
 
 class ICPUMeshBuffer final : public IMeshBuffer<ICPUBuffer,ICPUDescriptorSet,ICPURenderpassIndependentPipeline,ICPUSkeleton>, public BlobSerializable, public IAsset
@@ -659,6 +696,224 @@ class ICPUMeshBuffer final : public IMeshBuffer<ICPUBuffer,ICPUDescriptorSet,ICP
             return setAttribute(_input, dst, getAttribFormat(attrId));
         }
 
+        //! Decodes `count` vertices of an attribute laid out `stride` bytes apart into SoA arrays.
+        /** @param[out] output Four arrays of at least `count` floats, `output[c]` receives channel `c` of every vertex. Null entries are skipped.
+        Channels missing from the format come out as in getAttribute(), 0 or 1 for the fourth.
+        @returns How many vertices were decoded, 0 if the format can't be decoded to floats.
+        */
+        static inline size_t getAttributeRange(float* const* output, const void* src, size_t stride, size_t count, E_FORMAT format)
+        {
+            if (!src)
+                return 0u;
+
+            const uint8_t* in = reinterpret_cast<const uint8_t*>(src);
+            auto fillMissingChannels = [&](uint32_t channelCount) -> void
+            {
+                for (uint32_t c=channelCount; c<4u; c++)
+                if (output[c])
+                    std::fill_n(output[c],count,c!=3u ? 0.f:1.f);
+            };
+
+            switch (format)
+            {
+                case EF_R32_SFLOAT:
+                case EF_R32G32_SFLOAT:
+                case EF_R32G32B32_SFLOAT:
+                case EF_R32G32B32A32_SFLOAT:
+                {
+                    const uint32_t channelCount = getFormatChannelCount(format);
+                    for (uint32_t c=0u; c<channelCount; c++)
+                    if (output[c])
+                    {
+                        const uint8_t* channelIn = in+c*sizeof(float);
+                        for (size_t i=0u; i<count; i++)
+                            memcpy(output[c]+i,channelIn+i*stride,sizeof(float));
+                    }
+                    fillMissingChannels(channelCount);
+                    return count;
+                }
+                default:
+                    break;
+            }
+
+            impl::SPackedAttribLayout layout;
+            if (impl::getPackedAttribLayout(format,layout))
+            {
+                // 4 vertices at a time, every channel is a shift left to drop the bits above it and a (sign extending) shift right to drop the ones below
+                size_t i = 0u;
+                for (; i+4u<=count; i+=4u)
+                {
+                    alignas(16) uint32_t words[4];
+                    for (uint32_t j=0u; j<4u; j++)
+                        memcpy(words+j,in+(i+j)*stride,sizeof(uint32_t));
+                    const __m128i packed = _mm_load_si128(reinterpret_cast<const __m128i*>(words));
+                    for (uint32_t c=0u; c<layout.channelCount; c++)
+                    {
+                        if (!output[c])
+                            continue;
+                        __m128i bits = _mm_sll_epi32(packed,_mm_cvtsi32_si128(32u-layout.offset[c]-layout.width[c]));
+                        const __m128i rightShift = _mm_cvtsi32_si128(32u-layout.width[c]);
+                        bits = layout.isSigned ? _mm_sra_epi32(bits,rightShift):_mm_srl_epi32(bits,rightShift);
+                        _mm_storeu_ps(output[c]+i,_mm_div_ps(_mm_cvtepi32_ps(bits),_mm_set1_ps(layout.scale[c])));
+                    }
+                }
+                for (; i<count; i++)
+                {
+                    uint32_t word;
+                    memcpy(&word,in+i*stride,sizeof(uint32_t));
+                    for (uint32_t c=0u; c<layout.channelCount; c++)
+                    {
+                        if (!output[c])
+                            continue;
+                        const uint32_t bits = word<<(32u-layout.offset[c]-layout.width[c]);
+                        const int32_t value = layout.isSigned ? (static_cast<int32_t>(bits)>>(32u-layout.width[c])):static_cast<int32_t>(bits>>(32u-layout.width[c]));
+                        output[c][i] = static_cast<float>(value)/layout.scale[c];
+                    }
+                }
+                fillMissingChannels(layout.channelCount);
+                return count;
+            }
+
+            // no dedicated kernel, at least the format checks get done once
+            if (!isNormalizedFormat(format) && !isFloatingPointFormat(format) && !isScaledFormat(format))
+                return 0u;
+            core::vectorSIMDf tmp;
+            for (size_t i=0u; i<count; i++)
+            {
+                getAttribute(tmp,in+i*stride,format);
+                for (uint32_t c=0u; c<4u; c++)
+                if (output[c])
+                    output[c][i] = tmp.pointer[c];
+            }
+            return count;
+        }
+
+        //! Batched getAttribute(), decodes vertices [firstIx,firstIx+count) of an attribute into SoA arrays. Index numbers are incremented by `baseVertex`.
+        /** Common float, normalized and packed formats have SIMD kernels, and the per vertex format dispatch is gone for all others.
+        @param[out] output Four arrays of at least `count` floats, one per channel, null entries are skipped.
+        @param[in] attrId Atrribute id.
+        @param[in] firstIx First index which is to be accessed.
+        @param[in] count Number of vertices to decode.
+        @returns Number of vertices decoded, fewer than `count` if the range runs past the end of the buffer and 0 on error.
+        @see @ref getAttribute()
+        */
+        inline size_t getAttributeRange(float* const* output, uint32_t attrId, size_t firstIx, size_t count) const
+        {
+            if (!m_pipeline || !isAttributeEnabled(attrId))
+                return 0u;
+
+            const uint8_t* src = getAttribPointer(attrId);
+            const ICPUBuffer* buf = base_t::getAttribBoundBuffer(attrId).buffer.get();
+            if (!src || !buf)
+                return 0u;
+
+            const size_t stride = getAttribStride(attrId);
+            src += firstIx*stride;
+            const uint8_t* const end = reinterpret_cast<const uint8_t*>(buf->getPointer())+buf->getSize();
+            const E_FORMAT format = getAttribFormat(attrId);
+            const size_t fmtSize = getTexelOrBlockBytesize(format);
+            if (src>=end || size_t(end-src)<fmtSize)
+                return 0u;
+            // last vertex must fit whole, not just start inside the buffer
+            if (stride)
+                count = core::min<size_t>(count,(size_t(end-src)-fmtSize)/stride+1u);
+
+            return getAttributeRange(output,src,stride,count,format);
+        }
+
+        //! Encodes `count` vertices from SoA arrays into an attribute laid out `stride` bytes apart.
+        /** @param[in] input Four arrays of at least `count` floats, one per channel. Entries for channels the format doesn't have may be null.
+        @returns How many vertices were encoded, 0 if the format can't be encoded from floats.
+        */
+        static inline size_t setAttributeRange(const float* const* input, void* dst, size_t stride, size_t count, E_FORMAT format)
+        {
+            if (!dst)
+                return 0u;
+
+            uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+            switch (format)
+            {
+                case EF_R32_SFLOAT:
+                case EF_R32G32_SFLOAT:
+                case EF_R32G32B32_SFLOAT:
+                case EF_R32G32B32A32_SFLOAT:
+                {
+                    const uint32_t channelCount = getFormatChannelCount(format);
+                    for (uint32_t c=0u; c<channelCount; c++)
+                    {
+                        uint8_t* channelOut = out+c*sizeof(float);
+                        for (size_t i=0u; i<count; i++)
+                            memcpy(channelOut+i*stride,input[c]+i,sizeof(float));
+                    }
+                    return count;
+                }
+                default:
+                    break;
+            }
+
+            impl::SPackedAttribLayout layout;
+            if (impl::getPackedAttribLayout(format,layout))
+            {
+                // same truncating conversion as encodePixels, so both paths produce identical bits
+                for (size_t i=0u; i<count; i++)
+                {
+                    uint32_t word = 0u;
+                    for (uint32_t c=0u; c<layout.channelCount; c++)
+                    {
+                        const uint32_t mask = (0x1u<<layout.width[c])-1u;
+                        const int64_t value = static_cast<int64_t>(static_cast<double>(input[c][i])*static_cast<double>(layout.scale[c]));
+                        word |= (static_cast<uint32_t>(value)&mask)<<layout.offset[c];
+                    }
+                    memcpy(out+i*stride,&word,sizeof(uint32_t));
+                }
+                return count;
+            }
+
+            if (!isFloatingPointFormat(format) && !isNormalizedFormat(format) && !isScaledFormat(format))
+                return 0u;
+            core::vectorSIMDf tmp;
+            for (size_t i=0u; i<count; i++)
+            {
+                for (uint32_t c=0u; c<4u; c++)
+                    tmp.pointer[c] = input[c] ? input[c][i]:0.f;
+                setAttribute(tmp,out+i*stride,format);
+            }
+            return count;
+        }
+
+        //! Batched setAttribute(), encodes vertices [firstIx,firstIx+count) of an attribute from SoA arrays. Index numbers are incremented by `baseVertex`.
+        /** @param[in] input Four arrays of at least `count` floats, one per channel. Entries for channels the format doesn't have may be null.
+        @param[in] attrId Atrribute id.
+        @param[in] firstIx First index which is to be set.
+        @param[in] count Number of vertices to encode.
+        @returns Number of vertices encoded, fewer than `count` if the range runs past the end of the buffer and 0 on error.
+        @see @ref setAttribute() getAttributeRange()
+        */
+        inline size_t setAttributeRange(const float* const* input, uint32_t attrId, size_t firstIx, size_t count)
+        {
+            assert(!isImmutable_debug());
+            if (!m_pipeline || !isAttributeEnabled(attrId))
+                return 0u;
+
+            uint8_t* dst = getAttribPointer(attrId);
+            const ICPUBuffer* buf = getAttribBoundBuffer(attrId).buffer.get();
+            if (!dst || !buf)
+                return 0u;
+
+            const size_t stride = getAttribStride(attrId);
+            dst += firstIx*stride;
+            const uint8_t* const end = reinterpret_cast<const uint8_t*>(buf->getPointer())+buf->getSize();
+            const E_FORMAT format = getAttribFormat(attrId);
+            const size_t fmtSize = getTexelOrBlockBytesize(format);
+            if (dst>=end || size_t(end-dst)<fmtSize)
+                return 0u;
+            // last vertex must fit whole, not just start inside the buffer
+            if (stride)
+                count = core::min<size_t>(count,(size_t(end-dst)-fmtSize)/stride+1u);
+
+            return setAttributeRange(input,dst,stride,count,format);
+        }
+
 		//!
 		inline const core::matrix3x4SIMD* getInverseBindPoses() const
 		{
@@ -24,7 +24,10 @@ namespace asset
 			EBCT_LZ4 = 0x02,
 			EBCT_LZ4_AES128_GCM = 0x03,
 			EBCT_LZMA = 0x04,
-			EBCT_LZMA_AES128_GCM = 0x05
+			EBCT_LZMA_AES128_GCM = 0x05,
+			//! LZ4 stream compressed with the HC match finder, better ratio than EBCT_LZ4 and decodes just as fast
+			EBCT_LZ4HC = 0x08,
+			EBCT_LZ4HC_AES128_GCM = 0x09
 		};
 		//! Type of blob enumeration
 		enum E_BLOB_TYPE
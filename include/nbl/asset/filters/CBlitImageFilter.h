@@ -9,6 +9,7 @@
 
 #include <type_traits>
 #include <algorithm>
+#include <limits>
 
 #include "nbl/asset/filters/CMatchedSizeInOutImageFilterCommon.h"
 #include "nbl/asset/filters/CSwizzleAndConvertImageFilter.h"
@@ -51,6 +52,7 @@ class CBlitImageFilterBase : public impl::CSwizzleableAndDitherableFilterBase<No
 				E_ALPHA_SEMANTIC					alphaSemantic = EAS_NONE_OR_PREMULTIPLIED;
 				double								alphaRefValue = 0.5; // only required to make sense if `alphaSemantic==EAS_REFERENCE_OR_COVERAGE`
 				uint32_t							alphaChannel = 3u; // index of the alpha channel (could be different cause of swizzles)
+				bool								precomputeKernelWeights = true; // evaluate the kernel once per resampling phase instead of once per output texel, only valid for kernels which are linear in the samples
 		};
 
 	protected:
@@ -197,12 +199,17 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 		};
 		using state_type = CState;
 		
-		static inline uint32_t getRequiredScratchByteSize(const state_type* state)
+		// with a parallel policy, providing scratch for `concurrentLayers` lets that many layers get blitted at once
+		static inline uint32_t getRequiredScratchByteSize(const state_type* state, const uint32_t concurrentLayers=1u)
 		{
 			// need to add the memory for ping pong buffers
 			uint32_t retval = getScratchOffset(state,true);
 			retval += CBlitImageFilterBase<value_type,Normalize,Clamp,Swizzle,Dither>::getRequiredScratchByteSize(state->alphaSemantic,state->outExtentLayerCount);
-			return retval;
+			// no scratch buffer could be big enough, make `validate` fail instead of wrapping around
+			const uint64_t total = uint64_t(retval)*uint64_t(concurrentLayers);
+			if (total>uint64_t(std::numeric_limits<uint32_t>::max()))
+				return std::numeric_limits<uint32_t>::max();
+			return static_cast<uint32_t>(total);
 		}
 
 		static inline bool validate(state_type* state)
@@ -232,9 +239,20 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 			if (state->alphaSemantic!=CState::EAS_NONE_OR_PREMULTIPLIED && (getFormatChannelCount(inFormat)!=4u||getFormatChannelCount(outFormat)!=4u))
 				return false;
 
-			// TODO: remove this later when we can actually write/encode to block formats
+			// block compressed outputs get encoded a whole block at a time, so we can only write whole blocks
 			if (isBlockCompressionFormat(outFormat))
-				return false;
+			{
+				if (!isBlockEncodable(outFormat))
+					return false;
+				const auto outBlockDims = asset::getBlockDimensions(outFormat);
+				const auto outMipExtent = state->outImage->getMipSize(state->outMipLevel);
+				if (state->outOffset.x%outBlockDims.x || state->outOffset.y%outBlockDims.y)
+					return false;
+				if (state->outExtent.width%outBlockDims.x && state->outOffset.x+state->outExtent.width!=outMipExtent.x)
+					return false;
+				if (state->outExtent.height%outBlockDims.y && state->outOffset.y+state->outExtent.height!=outMipExtent.y)
+					return false;
+			}
 
 			return state->kernelX.validate(state->inImage,state->outImage)&&state->kernelY.validate(state->inImage,state->outImage)&&state->kernelZ.validate(state->inImage,state->outImage);
 		}
@@ -303,19 +321,18 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 				intermediateExtent[1]-core::vectorSIMDi32(1,1,1,0),
 				intermediateExtent[2]-core::vectorSIMDi32(1,1,1,0)
 			};
-			value_type* const intermediateStorage[3] = {
-				reinterpret_cast<value_type*>(state->scratchMemory),
-				reinterpret_cast<value_type*>(state->scratchMemory+getScratchOffset(state,false)),
-				reinterpret_cast<value_type*>(state->scratchMemory)
-			};
 			const core::vectorSIMDu32 intermediateStrides[3] = {
 				core::vectorSIMDu32(MaxChannels*intermediateExtent[0].y,MaxChannels,MaxChannels*intermediateExtent[0].x*intermediateExtent[0].y,0u),
 				core::vectorSIMDu32(MaxChannels*intermediateExtent[1].y*intermediateExtent[1].z,MaxChannels*intermediateExtent[1].z,MaxChannels,0u),
 				core::vectorSIMDu32(MaxChannels,MaxChannels*intermediateExtent[2].x,MaxChannels*intermediateExtent[2].x*intermediateExtent[2].y,0u)
 			};
+			// every layer worker gets its own slice of the scratch memory, so layers can be blitted concurrently
+			constexpr bool is_seq_policy_v = std::is_same_v<std::remove_reference_t<ExecutionPolicy>,std::execution::sequenced_policy>;
+			const uint32_t layerScratchByteSize = getRequiredScratchByteSize(state);
+			const uint32_t layerWorkers = is_seq_policy_v ? 1u:core::clamp(state->scratchMemoryByteSize/layerScratchByteSize,1u,layerCount);
+			const uint64_t samplerSeed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
 			// storage
-			core::RandomSampler sampler(std::chrono::high_resolution_clock::now().time_since_epoch().count());
-			auto storeToTexel = [state,nonPremultBlendSemantic,alphaChannel,outFormat](value_type* const sample, void* const dstPix, const core::vectorSIMDu32& localOutPos) -> void
+			auto unpremultiply = [nonPremultBlendSemantic,alphaChannel](value_type* const sample) -> void
 			{
 				if (nonPremultBlendSemantic && sample[alphaChannel]>FLT_MIN*1024.0*512.0)
 				{
@@ -323,11 +340,49 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 					if (i!=alphaChannel)
 						sample[i] /= sample[alphaChannel];
 				}
-
+			};
+			auto storeToTexel = [state,unpremultiply,outFormat](value_type* const sample, void* const dstPix, const core::vectorSIMDu32& localOutPos) -> void
+			{
+				unpremultiply(sample);
 				impl::CSwizzleAndConvertImageFilterBase<Normalize, Clamp, Swizzle, Dither>::onEncode(outFormat, state, dstPix, sample, localOutPos, 0, 0, MaxChannels);
 			};
+			// block compressed outputs can't be written texel by texel, so gather whole blocks from the last pass' intermediate storage instead
+			// texels past the edge of the mip-map replicate the edge, there's no dithering because the encoder quantizes whole blocks at once
+			const bool blockEncode = isBlockCompressionFormat(outFormat);
+			auto storeToBlocks = [policy,unpremultiply,alphaChannel,outFormat,outBlockDims,outExtent,intermediateStrides,outMipLevel,outImg](const value_type* const finalStorage, const int axis, const core::vectorSIMDu32& outOffsetLayer, const value_type alphaScale) -> void
+			{
+				const uint32_t blockCount[3] = {(outExtent.width+outBlockDims.x-1u)/outBlockDims.x,(outExtent.height+outBlockDims.y-1u)/outBlockDims.y,outExtent.depth};
+				const uint32_t blockEnd[3] = {0u,0u,blockCount[2]};
+				CBasicImageFilterCommon::BlockIterator<3u> begin(blockCount);
+				CBasicImageFilterCommon::BlockIterator<3u> end(blockCount,blockEnd);
+				std::for_each(policy,begin,end,[&](const uint32_t* blockCoord) -> void
+				{
+					// the block encoders always read 4 channels per texel, whatever the kernels' channel count
+					static_assert(MaxChannels<=4u, "Block encoding expects at most 4 channels per texel!");
+					value_type texels[impl::BCTexelCount*4u];
+					for (uint32_t y=0u; y<outBlockDims.y; y++)
+					for (uint32_t x=0u; x<outBlockDims.x; x++)
+					{
+						const core::vectorSIMDi32 localCoord(
+							core::min(blockCoord[0]*outBlockDims.x+x,outExtent.width-1u),
+							core::min(blockCoord[1]*outBlockDims.y+y,outExtent.height-1u),
+							blockCoord[2],0
+						);
+						const auto* const first = finalStorage+core::dot(static_cast<const core::vectorSIMDi32&>(intermediateStrides[axis]),localCoord)[0];
+						value_type* const sample = texels+(y*outBlockDims.x+x)*4u;
+						std::copy(first,first+MaxChannels,sample);
+						std::fill(sample+MaxChannels,sample+4u,value_type(0));
+						sample[alphaChannel] *= alphaScale;
+						unpremultiply(sample);
+					}
+
+					core::vectorSIMDu32 dummy;
+					const core::vectorSIMDu32 outPos = core::vectorSIMDu32(blockCoord[0]*outBlockDims.x,blockCoord[1]*outBlockDims.y,blockCoord[2],0u)+outOffsetLayer;
+					encodeBlock(outFormat,outImg->getTexelBlockData(outMipLevel,outPos,dummy),texels);
+				});
+			};
 			const core::SRange<const IImage::SBufferCopy> outRegions = outImg->getRegions(outMipLevel);
-			auto storeToImage = [policy,coverageSemantic,outExtent,intermediateStorage,&sampler,outFormat,alphaRefValue,outData,intermediateStrides,alphaChannel,storeToTexel,outMipLevel,outOffset,outRegions,outImg](const core::rational<>& inverseCoverage, const int axis, const core::vectorSIMDu32& outOffsetLayer) -> void
+			auto storeToImage = [policy,coverageSemantic,outExtent,outFormat,alphaRefValue,outData,intermediateStrides,alphaChannel,storeToTexel,blockEncode,storeToBlocks,outMipLevel,outOffset,outRegions,outImg](value_type* const* intermediateStorage, core::RandomSampler& sampler, const core::rational<>& inverseCoverage, const int axis, const core::vectorSIMDu32& outOffsetLayer) -> void
 			{
 				// little thing for the coverage adjustment trick suggested by developer of The Witness
 				assert(coverageSemantic);
@@ -346,6 +401,11 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 				std::nth_element(policy,begin,nth,end);
 				// scale all alpha texels to work with new reference value
 				const auto coverageScale = alphaRefValue/(*nth);
+				if (blockEncode)
+				{
+					storeToBlocks(intermediateStorage[axis],axis,outOffsetLayer,coverageScale);
+					return;
+				}
 				auto scaleCoverage = [outData,outOffsetLayer,intermediateStrides,axis,intermediateStorage,alphaChannel,coverageScale,storeToTexel](uint32_t writeBlockArrayOffset, core::vectorSIMDu32 writeBlockPos) -> void
 				{
 					void* const dstPix = outData+writeBlockArrayOffset;
@@ -372,13 +432,88 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 				return core::vectorSIMDi32(kernelX.getWindowMinCoord(halfTexelOffset).x-1,kernelY.getWindowMinCoord(halfTexelOffset).y-1,kernelZ.getWindowMinCoord(halfTexelOffset).z-1,0);
 			}();
 			const auto windowMinCoordBase = inOffsetBaseLayer+startCoord;
-			for (uint32_t layer=0; layer!=layerCount; layer++) // TODO: could be parallelized
+			auto getAxisScale = [state,&fScale](IImage::E_TYPE axis) -> IImageFilterKernel::ScaleFactorUserData
 			{
+				IImageFilterKernel::ScaleFactorUserData scale(1.f/fScale[axis]);
+				const IImageFilterKernel::ScaleFactorUserData* otherScale = nullptr;
+				switch (axis)
+				{
+					case IImage::ET_1D:
+						otherScale = IImageFilterKernel::ScaleFactorUserData::cast(state->kernelX.getUserData());
+						break;
+					case IImage::ET_2D:
+						otherScale = IImageFilterKernel::ScaleFactorUserData::cast(state->kernelY.getUserData());
+						break;
+					case IImage::ET_3D:
+						otherScale = IImageFilterKernel::ScaleFactorUserData::cast(state->kernelZ.getUserData());
+						break;
+				}
+				if (otherScale)
+				for (auto k=0; k<MaxChannels; k++)
+					scale.factor[k] *= otherScale->factor[k];
+				return scale;
+			};
+			// the weights only depend on the output coordinate and they repeat with a period of `outExtent/gcd(inExtent,outExtent)`,
+			// so evaluate the kernel once per phase and share the tables between all lines and layers
+			SPhasedWeights phasedWeights[3];
+			auto precomputeWeights = [&](IImage::E_TYPE axis, const auto& kernel) -> void
+			{
+				if (!state->precomputeKernelWeights || axis>inImageType)
+					return;
+
+				auto& phased = phasedWeights[axis];
+				const uint32_t periodGCD = core::gcd<uint32_t>(inExtentLayerCount[axis],outExtentLayerCount[axis]);
+				phased.phaseCount = outExtentLayerCount[axis]/periodGCD;
+				phased.phaseStride = inExtentLayerCount[axis]/periodGCD;
+				const auto windowSize = kernel.getWindowSize()[axis];
+				phased.windowStart.resize(phased.phaseCount);
+				phased.weights.resize(size_t(phased.phaseCount)*windowSize*MaxChannels);
+
+				const auto scale = getAxisScale(axis);
+				// feeding ones through the kernel gives back its weights
+				auto loadOne = [](value_type* windowSample, const core::vectorSIMDf& unused0, const core::vectorSIMDi32& unused1, const IImageFilterKernel::UserData* userData) -> void
+				{
+					std::fill_n(windowSample,MaxChannels,value_type(1));
+				};
+				for (uint32_t phase=0u; phase<phased.phaseCount; phase++)
+				{
+					core::vectorSIMDf tmp;
+					tmp[axis] = float(phase)+0.5f;
+					core::vectorSIMDi32 windowCoord;
+					windowCoord[axis] = phased.windowStart[phase] = kernel.getWindowMinCoord(tmp*fScale,tmp)[axis];
+					auto relativePos = tmp[axis]-float(windowCoord[axis]);
+					value_type* weight = phased.weights.data()+size_t(phase)*windowSize*MaxChannels;
+					for (auto h=0; h<windowSize; h++,weight+=MaxChannels)
+					{
+						auto storeWeight = [weight](const value_type* windowSample, const core::vectorSIMDf& unused0, const core::vectorSIMDi32& unused1, const IImageFilterKernel::UserData* userData) -> void
+						{
+							std::copy_n(windowSample,MaxChannels,weight);
+						};
+						value_type windowSample[MaxChannels];
+
+						core::vectorSIMDf tmp(relativePos,0.f,0.f);
+						kernel.evaluateImpl(loadOne,storeWeight,windowSample,tmp,windowCoord,&scale);
+						relativePos -= 1.f;
+						windowCoord[axis]++;
+					}
+				}
+			};
+			precomputeWeights(IImage::ET_1D,kernelX);
+			precomputeWeights(IImage::ET_2D,kernelY);
+			precomputeWeights(IImage::ET_3D,kernelZ);
+			auto blitLayer = [&](const uint32_t layer, uint8_t* const scratchMemory) -> void
+			{
+				value_type* const intermediateStorage[3] = {
+					reinterpret_cast<value_type*>(scratchMemory),
+					reinterpret_cast<value_type*>(scratchMemory+getScratchOffset(state,false)),
+					reinterpret_cast<value_type*>(scratchMemory)
+				};
+				core::RandomSampler sampler(samplerSeed+layer);
+
 				const core::vectorSIMDi32 vLayer(0,0,0,layer);
 				const auto windowMinCoord = windowMinCoordBase+vLayer;
 				const auto outOffsetLayer = outOffsetBaseLayer+vLayer;
 				// reset coverage counter
-				constexpr bool is_seq_policy_v = std::is_same_v<std::remove_reference_t<ExecutionPolicy>,std::execution::sequenced_policy>;
 				using cond_atomic_int32_t = std::conditional_t<is_seq_policy_v,int32_t,std::atomic_int32_t>;
 				using cond_atomic_uint32_t = std::conditional_t<is_seq_policy_v,uint32_t,std::atomic_uint32_t>;
 				cond_atomic_uint32_t inv_cvg_num(0u);
@@ -392,82 +527,30 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 					const bool lastPass = inImageType==axis;
 					const auto windowSize = kernel.getWindowSize()[axis];
 
-					IImageFilterKernel::ScaleFactorUserData scale(1.f/fScale[axis]);
-					const IImageFilterKernel::ScaleFactorUserData* otherScale = nullptr;
-					switch (axis)
-					{
-						case IImage::ET_1D:
-							otherScale = IImageFilterKernel::ScaleFactorUserData::cast(state->kernelX.getUserData());
-							break;
-						case IImage::ET_2D:
-							otherScale = IImageFilterKernel::ScaleFactorUserData::cast(state->kernelY.getUserData());
-							break;
-						case IImage::ET_3D:
-							otherScale = IImageFilterKernel::ScaleFactorUserData::cast(state->kernelZ.getUserData());
-							break;
-					}
-					if (otherScale)
-					for (auto k=0; k<MaxChannels; k++)
-						scale.factor[k] *= otherScale->factor[k];
+					const auto scale = getAxisScale(axis);
+					const auto& phased = phasedWeights[axis];
 						
 					// z y x output along x
 					// z x y output along y
 					// x y z output along z
 					const int loopCoordID[2] = {/*axis,*/axis!=IImage::ET_2D ? 1:0,axis!=IImage::ET_3D ? 2:0};
-					//
-					assert(is_seq_policy_v || std::thread::hardware_concurrency()<=64u);
-					uint64_t decodeScratchAllocs[VectorizationBoundSTL];
-					std::fill_n(decodeScratchAllocs,VectorizationBoundSTL,~0u);
-					std::mutex scratchLock;
-					auto alloc_decode_scratch = [is_seq_policy_v,&scratchLock,&decodeScratchAllocs]() -> int32_t
+					// the lines are split into contiguous slabs, the first pass needs a decode buffer per slab so their count is bounded
+					const uint32_t lineExtent[2] = {intermediateExtent[axis][loopCoordID[0]],intermediateExtent[axis][loopCoordID[1]]};
+					const uint32_t lineCount = lineExtent[0]*lineExtent[1];
+					const uint32_t slabCount = is_seq_policy_v ? 1u:core::min(lineCount,getDecodeSlotCount());
+					auto filterLine = [&](const uint32_t line, value_type* const decodeBuffer) -> void
 					{
-						if /*constexpr*/ (is_seq_policy_v)
-							return 0;
-						else
-						{
-							std::unique_lock<std::mutex> lock(scratchLock);
-							for (uint32_t j=0u; j<VectorizationBoundSTL; j++)
-							{
-								int32_t firstFree = core::findLSB(decodeScratchAllocs[j]);
-								if (firstFree==-1)
-									continue;
-								decodeScratchAllocs[j] ^= 0x1u<<firstFree;
-								return j*64u+firstFree;
-							}
-							assert(false);
-							return 0xdeadbeef;
-						}
-					};
-					auto free_decode_scratch = [is_seq_policy_v,&scratchLock,&decodeScratchAllocs](int32_t addr)
-					{
-						if /*constexpr*/ (!is_seq_policy_v)
-						{
-							std::unique_lock<std::mutex> lock(scratchLock);
-							decodeScratchAllocs[addr/64u] ^= 0x1u<<(addr%64u);
-						}
-					};
-					//
-					constexpr uint32_t batch_dims = 2u;
-					const uint32_t batchExtent[batch_dims] = {intermediateExtent[axis][loopCoordID[0]],intermediateExtent[axis][loopCoordID[1]]};
-					CBasicImageFilterCommon::BlockIterator<batch_dims> begin(batchExtent);
-					const uint32_t spaceFillingEnd[batch_dims] = {0u,batchExtent[1]};
-					CBasicImageFilterCommon::BlockIterator<batch_dims> end(begin.getExtentBatches(),spaceFillingEnd);
-					std::for_each(policy,begin,end,[&](const uint32_t* batchCoord) -> void
-					{
-						// we need some tmp memory for threads in the first pass so that they dont step on each other
-						uint32_t decode_offset;
 						// whole line plus window borders
 						value_type* lineBuffer;
-						core::vectorSIMDi32 localTexCoord;
-						localTexCoord[loopCoordID[0]] = batchCoord[0];
-						localTexCoord[loopCoordID[1]] = batchCoord[1];
+						core::vectorSIMDi32 localTexCoord(0);
+						localTexCoord[loopCoordID[0]] = line%lineExtent[0];
+						localTexCoord[loopCoordID[1]] = line/lineExtent[0];
 						if (axis!=IImage::ET_1D)
 							lineBuffer = intermediateStorage[axis-1]+core::dot(static_cast<const core::vectorSIMDi32&>(intermediateStrides[axis-1]),localTexCoord)[0];
 						else
 						{
 							const auto windowEnd = inExtent.width+window_last.x;
-							decode_offset = alloc_decode_scratch();
-							lineBuffer = intermediateStorage[1]+decode_offset*MaxChannels*windowEnd;
+							lineBuffer = decodeBuffer;
 							for (auto& i=localTexCoord.x; i<windowEnd; i++)
 							{
 								core::vectorSIMDi32 globalTexelCoord(localTexCoord+windowMinCoord);
@@ -508,46 +591,70 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 							// get output pixel
 							auto* const value = intermediateStorage[axis]+core::dot(static_cast<const core::vectorSIMDi32&>(intermediateStrides[axis]),localTexCoord)[0];
 							std::fill(value,value+MaxChannels,value_type(0));
-							// kernel load functor
-							auto load = [axis,&windowMinCoord,lineBuffer](value_type* windowSample, const core::vectorSIMDf& unused0, const core::vectorSIMDi32& globalTexelCoord, const IImageFilterKernel::UserData* userData) -> void
-							{
-								for (auto h=0; h<MaxChannels; h++)
-									windowSample[h] = lineBuffer[(globalTexelCoord[axis]-windowMinCoord[axis])*MaxChannels+h];
-							};
-							// kernel evaluation functor
-							auto evaluate = [value](const value_type* windowSample, const core::vectorSIMDf& unused0, const core::vectorSIMDi32& unused1, const IImageFilterKernel::UserData* userData) -> void
+							if (phased.phaseCount)
 							{
-								for (auto h=0; h<MaxChannels; h++)
-									value[h] += windowSample[h];
-							};
-							// do the filtering 
-							core::vectorSIMDf tmp;
-							tmp[axis] = float(i)+0.5f;
-							core::vectorSIMDi32 windowCoord;
-							windowCoord[axis] = kernel.getWindowMinCoord(tmp*fScale,tmp)[axis];
-							auto relativePos = tmp[axis]-float(windowCoord[axis]);
-							for (auto h=0; h<windowSize; h++)
+								const uint32_t phase = i%phased.phaseCount;
+								const int32_t windowStart = phased.windowStart[phase]+int32_t(i/phased.phaseCount)*phased.phaseStride;
+								const value_type* weight = phased.weights.data()+size_t(phase)*windowSize*MaxChannels;
+								const value_type* windowSample = lineBuffer+(windowStart-windowMinCoord[axis])*MaxChannels;
+								for (auto h=0; h<windowSize; h++,weight+=MaxChannels,windowSample+=MaxChannels)
+								for (auto c=0; c<MaxChannels; c++)
+									value[c] += windowSample[c]*weight[c];
+							}
+							else
 							{
-								value_type windowSample[MaxChannels];
+								// kernel load functor
+								auto load = [axis,&windowMinCoord,lineBuffer](value_type* windowSample, const core::vectorSIMDf& unused0, const core::vectorSIMDi32& globalTexelCoord, const IImageFilterKernel::UserData* userData) -> void
+								{
+									for (auto h=0; h<MaxChannels; h++)
+										windowSample[h] = lineBuffer[(globalTexelCoord[axis]-windowMinCoord[axis])*MaxChannels+h];
+								};
+								// kernel evaluation functor
+								auto evaluate = [value](const value_type* windowSample, const core::vectorSIMDf& unused0, const core::vectorSIMDi32& unused1, const IImageFilterKernel::UserData* userData) -> void
+								{
+									for (auto h=0; h<MaxChannels; h++)
+										value[h] += windowSample[h];
+								};
+								// do the filtering 
+								core::vectorSIMDf tmp;
+								tmp[axis] = float(i)+0.5f;
+								core::vectorSIMDi32 windowCoord;
+								windowCoord[axis] = kernel.getWindowMinCoord(tmp*fScale,tmp)[axis];
+								auto relativePos = tmp[axis]-float(windowCoord[axis]);
+								for (auto h=0; h<windowSize; h++)
+								{
+									value_type windowSample[MaxChannels];
 
-								core::vectorSIMDf tmp(relativePos,0.f,0.f);
-								kernel.evaluateImpl(load,evaluate,windowSample,tmp,windowCoord,&scale);
-								relativePos -= 1.f;
-								windowCoord[axis]++;
+									core::vectorSIMDf tmp(relativePos,0.f,0.f);
+									kernel.evaluateImpl(load,evaluate,windowSample,tmp,windowCoord,&scale);
+									relativePos -= 1.f;
+									windowCoord[axis]++;
+								}
 							}
-							if (!coverageSemantic && lastPass) // store to image, we're done
+							if (!coverageSemantic && !blockEncode && lastPass) // store to image, we're done
 							{
 								core::vectorSIMDu32 dummy;
-								const core::vectorSIMDu32 localOutPos = localTexCoord + outOffsetBaseLayer;
+								const core::vectorSIMDu32 localOutPos = localTexCoord + outOffsetLayer;
 								storeToTexel(value,outImg->getTexelBlockData(outMipLevel,localOutPos,dummy),localOutPos);
 							}
 						}
-						if (axis==IImage::ET_1D)
-							free_decode_scratch(decode_offset);
+					};
+					// every line is computed the same way regardless of the slab it lands in, so the result does not depend on the policy
+					CBasicImageFilterCommon::BlockIterator<1u> begin(&slabCount);
+					CBasicImageFilterCommon::BlockIterator<1u> end(&slabCount,&slabCount);
+					std::for_each(policy,begin,end,[&](const uint32_t* slab) -> void
+					{
+						// we need some tmp memory for threads in the first pass so that they dont step on each other
+						value_type* const decodeBuffer = intermediateStorage[1]+slab[0]*MaxChannels*(inExtent.width+window_last.x);
+						const uint32_t lineEnd = (uint64_t(slab[0])+1ull)*lineCount/slabCount;
+						for (uint32_t line=uint64_t(slab[0])*lineCount/slabCount; line<lineEnd; line++)
+							filterLine(line,decodeBuffer);
 					});
-					// we'll only get here if we have to do coverage adjustment
+					// we'll only get here if we have to do coverage adjustment or encode whole blocks
 					if (coverageSemantic && lastPass)
-						storeToImage(core::rational<>(inv_cvg_num,inv_cvg_den),axis,outOffsetLayer);
+						storeToImage(intermediateStorage,sampler,core::rational<>(inv_cvg_num,inv_cvg_den),axis,outOffsetLayer);
+					else if (blockEncode && lastPass)
+						storeToBlocks(intermediateStorage[axis],axis,outOffsetLayer,value_type(1));
 				};
 				// filter in X-axis
 				filterAxis(IImage::ET_1D,kernelX);
@@ -556,7 +663,16 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 				// filter in Z-axis
 				assert(inImageType!=IImage::ET_3D); // TODO: Need to test this in the future
 				filterAxis(IImage::ET_3D,kernelZ);
-			}
+			};
+			// layers are independent, every worker strides over them with its own scratch
+			CBasicImageFilterCommon::BlockIterator<1u> begin(&layerWorkers);
+			CBasicImageFilterCommon::BlockIterator<1u> end(&layerWorkers,&layerWorkers);
+			std::for_each(policy,begin,end,[&](const uint32_t* worker) -> void
+			{
+				uint8_t* const scratchMemory = state->scratchMemory+size_t(worker[0])*layerScratchByteSize;
+				for (uint32_t layer=worker[0]; layer<layerCount; layer+=layerWorkers)
+					blitLayer(layer,scratchMemory);
+			});
 			return true;
 		}
 		static inline bool execute(state_type* state)
@@ -565,7 +681,21 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 		}
 
 	private:
+		// kernel weights of every resampling phase along one axis, output texel `i` uses phase `i%phaseCount` with the window moved by `(i/phaseCount)*phaseStride`
+		struct SPhasedWeights
+		{
+			uint32_t phaseCount = 0u;
+			int32_t phaseStride = 0;
+			core::vector<int32_t> windowStart;
+			core::vector<value_type> weights;
+		};
+
 		static inline constexpr uint32_t VectorizationBoundSTL = /*AVX2*/16u;
+		// how many lines of the first pass can be decoded at once, each gets its own buffer in the second pong
+		static inline uint32_t getDecodeSlotCount()
+		{
+			return core::max(std::thread::hardware_concurrency(),1u)*VectorizationBoundSTL;
+		}
 		// the blit filter will filter one axis at a time, hence necessitating "ping ponging" between two scratch buffers
 		static inline uint32_t getScratchOffset(const state_type* state, bool secondPong)
 		{
@@ -584,7 +714,7 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 			auto texelCount = state->outExtent.width*core::max<uint32_t>((state->inExtent.height+window_last[1])*(state->inExtent.depth+window_last[2]),state->outExtent.height*state->outExtent.depth);
 			// the second pass will result in an image that has the width and height equal to `outExtent`
 			if (secondPong)
-				texelCount += core::max<uint32_t>(state->outExtent.width*state->outExtent.height*(state->inExtent.depth+window_last[2]),(state->inExtent.width+window_last[0])*std::thread::hardware_concurrency()*VectorizationBoundSTL);
+				texelCount += core::max<uint32_t>(state->outExtent.width*state->outExtent.height*(state->inExtent.depth+window_last[2]),(state->inExtent.width+window_last[0])*getDecodeSlotCount());
 			// obviously we have multiple channels and each channel has a certain type for arithmetic
 			return texelCount*MaxChannels*sizeof(value_type);
 		}
@@ -29,7 +29,7 @@ class CMipMapGenerationImageFilter : public CImageFilter<CMipMapGenerationImageF
 	public:
 		virtual ~CMipMapGenerationImageFilter() {}
 
-		// TODO: Improve and implement the cached convolution kernel
+		// TODO: Improve and implement the convolution of resampling and reconstruction kernels (the blit already caches the weights of each resampling phase)
 		using KernelX = ResamplingKernelX;//CKernelConvolution<ResamplingKernelX, ReconstructionKernelX>;
 		using KernelY = ResamplingKernelY;//CKernelConvolution<ResamplingKernelY, ReconstructionKernelY>;
 		using KernelZ = ResamplingKernelZ;//CKernelConvolution<ResamplingKernelZ, ReconstructionKernelZ>;
@@ -48,10 +48,10 @@ class CMipMapGenerationImageFilter : public CImageFilter<CMipMapGenerationImageF
 		using state_type = CState;
 		
 		// since the only thing the mip map generator does is call the blit filter, the scratch memory amount is the same
-		static inline uint32_t getRequiredScratchByteSize(const state_type* state)
+		static inline uint32_t getRequiredScratchByteSize(const state_type* state, const uint32_t concurrentLayers=1u)
 		{
 			auto blit = buildBlitState(state,state->startMipLevel);
-			return CBlitImageFilter<Normalize,Clamp,Swizzle,Dither,KernelX>::getRequiredScratchByteSize(&blit);
+			return CBlitImageFilter<Normalize,Clamp,Swizzle,Dither,KernelX>::getRequiredScratchByteSize(&blit,concurrentLayers);
 		}
 
 		static inline bool validate(state_type* state)
@@ -70,8 +70,9 @@ class CMipMapGenerationImageFilter : public CImageFilter<CMipMapGenerationImageF
 			if (state->startMipLevel>=state->endMipLevel || state->endMipLevel>params.mipLevels)
 				return false;
 
-			// TODO: remove this later when we can actually write/encode to block formats
-			if (isBlockCompressionFormat(state->inOutImage->getCreationParameters().format))
+			// every level gets decoded again to produce the next one, and there's no BC7 decoder yet
+			const auto format = params.format;
+			if (isBlockCompressionFormat(format) && (!isBlockEncodable(format) || format==EF_BC7_UNORM_BLOCK || format==EF_BC7_SRGB_BLOCK))
 				return false;
 			
 			for (auto inMipLevel=state->startMipLevel; inMipLevel!=state->endMipLevel; inMipLevel++)
@@ -48,6 +48,73 @@ namespace impl
 
 				return true;
 			}
+
+		protected:
+			/*
+				The batched codecs decode and encode whole rows with SIMD, but they know nothing of swizzles, dithers, normalization or clamping.
+				They encode and decode bit for bit like the per-texel path, but they pass the values on as `float` instead of `double`, so to keep
+				the output identical they only get used for plain conversions from or to a float format, where the detour through `float` loses nothing.
+			*/
+			static inline bool canConvertBatched(const state_type* state, const E_FORMAT inFormat, const E_FORMAT outFormat)
+			{
+				if constexpr (!std::is_same_v<Dither,IdentityDither> || Normalize || Clamp)
+					return false;
+
+				if constexpr (std::is_same_v<Swizzle,DefaultSwizzle>)
+				{
+					const auto& mapping = static_cast<const DefaultSwizzle&>(*state).swizzle;
+					for (auto i=0u; i<SwizzleBase::MaxChannels; i++)
+					{
+						const auto component = (&mapping.r)[i];
+						if (component!=ICPUImageView::SComponentMapping::ES_IDENTITY && component!=ICPUImageView::SComponentMapping::ES_R+i)
+							return false;
+					}
+				}
+				else if constexpr (!std::is_same_v<Swizzle,VoidSwizzle>)
+					return false;
+
+				auto isFloatFormat = [](const E_FORMAT format) -> bool
+				{
+					return format==EF_R16G16B16A16_SFLOAT || format==EF_R32G32B32A32_SFLOAT;
+				};
+				return (isFloatFormat(inFormat) || isFloatFormat(outFormat)) && isBatchDecodable(inFormat) && isBatchEncodable(outFormat);
+			}
+
+			//! Converts whole rows at once, only valid when `canConvertBatched` returned true
+			template<class ExecutionPolicy>
+			static inline void convertBatched(ExecutionPolicy&& policy, const CMatchedSizeInOutImageFilterCommon::CommonExecuteData& commonExecuteData, CBasicImageFilterCommon::clip_region_functor_t& clip)
+			{
+				const TexelBlockInfo inBlockInfo(commonExecuteData.inFormat);
+				for (auto it=commonExecuteData.inRegions.begin(); it!=commonExecuteData.inRegions.end(); it++)
+				{
+					IImage::SBufferCopy region = *it;
+					if (!clip(region,it))
+						continue;
+
+					const auto strides = region.getByteStrides(inBlockInfo);
+					const core::vectorSIMDu32 regionOffset(region.imageOffset.x,region.imageOffset.y,region.imageOffset.z,region.imageSubresource.baseArrayLayer);
+					const uint32_t rowLength = region.imageExtent.width;
+					const uint32_t rowExtent[3] = {region.imageExtent.height,region.imageExtent.depth,region.imageSubresource.layerCount};
+					const uint32_t rowEnd[3] = {0u,0u,rowExtent[2]};
+					CBasicImageFilterCommon::BlockIterator<3u> begin(rowExtent);
+					CBasicImageFilterCommon::BlockIterator<3u> end(rowExtent,rowEnd);
+					std::for_each(policy,begin,end,[&](const uint32_t* rowCoord) -> void
+					{
+						const core::vectorSIMDu32 localCoord(0u,rowCoord[0],rowCoord[1],rowCoord[2]);
+						const uint8_t* srcRow = commonExecuteData.inData+region.getByteOffset(localCoord,strides);
+						uint8_t* dstRow = commonExecuteData.outData+commonExecuteData.oit->getByteOffset(localCoord+regionOffset+commonExecuteData.offsetDifference,commonExecuteData.outByteStrides);
+
+						constexpr uint32_t ChunkTexels = 64u;
+						alignas(_NBL_SIMD_ALIGNMENT) float chunk[ChunkTexels*SwizzleBase::MaxChannels];
+						for (uint32_t x=0u; x<rowLength; x+=ChunkTexels)
+						{
+							const uint32_t count = core::min(rowLength-x,ChunkTexels);
+							decodePixelsBatched(commonExecuteData.inFormat,srcRow+size_t(x)*commonExecuteData.inBlockByteSize,chunk,count);
+							encodePixelsBatched(commonExecuteData.outFormat,dstRow+size_t(x)*commonExecuteData.outBlockByteSize,chunk,count);
+						}
+					});
+				}
+			}
 	};
 }
 
@@ -92,9 +159,15 @@ class CSwizzleAndConvertImageFilter : public CImageFilter<CSwizzleAndConvertImag
 
 			typedef std::conditional<asset::isIntegerFormat<inFormat>(), uint64_t, double>::type decodeBufferType;
 			typedef std::conditional<asset::isIntegerFormat<outFormat>(), uint64_t, double>::type encodeBufferType;
+			const bool batched = impl::CSwizzleAndConvertImageFilterBase<Normalize,Clamp,Swizzle,Dither>::canConvertBatched(state,inFormat,outFormat);
 			
-			auto perOutputRegion = [policy,&blockDims,&state](const CMatchedSizeInOutImageFilterCommon::CommonExecuteData& commonExecuteData, CBasicImageFilterCommon::clip_region_functor_t& clip) -> bool
+			auto perOutputRegion = [policy,&blockDims,&state,batched](const CMatchedSizeInOutImageFilterCommon::CommonExecuteData& commonExecuteData, CBasicImageFilterCommon::clip_region_functor_t& clip) -> bool
 			{
+				if (batched)
+				{
+					impl::CSwizzleAndConvertImageFilterBase<Normalize,Clamp,Swizzle,Dither>::convertBatched(policy,commonExecuteData,clip);
+					return true;
+				}
 				constexpr uint32_t outChannelsAmount = asset::getFormatChannelCount<outFormat>();
 
 				auto swizzle = [&commonExecuteData,&blockDims,&state,&outChannelsAmount](uint32_t readBlockArrayOffset, core::vectorSIMDu32 readBlockPos)
@@ -159,8 +232,14 @@ class CSwizzleAndConvertImageFilter<EF_UNKNOWN,EF_UNKNOWN,Swizzle,Normalize,Clam
 				assert(blockDims.z==1u);
 				assert(blockDims.w==1u);
 			#endif
-			auto perOutputRegion = [policy,&blockDims,inFormat,outFormat,outChannelsAmount,&state](const CMatchedSizeInOutImageFilterCommon::CommonExecuteData& commonExecuteData, CBasicImageFilterCommon::clip_region_functor_t& clip) -> bool
+			const bool batched = impl::CSwizzleAndConvertImageFilterBase<Normalize,Clamp,Swizzle,Dither>::canConvertBatched(state,inFormat,outFormat);
+			auto perOutputRegion = [policy,&blockDims,inFormat,outFormat,outChannelsAmount,&state,batched](const CMatchedSizeInOutImageFilterCommon::CommonExecuteData& commonExecuteData, CBasicImageFilterCommon::clip_region_functor_t& clip) -> bool
 			{
+				if (batched)
+				{
+					impl::CSwizzleAndConvertImageFilterBase<Normalize,Clamp,Swizzle,Dither>::convertBatched(policy,commonExecuteData,clip);
+					return true;
+				}
 				auto swizzle = [&commonExecuteData,&blockDims,inFormat,outFormat,outChannelsAmount,&state](uint32_t readBlockArrayOffset, core::vectorSIMDu32 readBlockPos)
 				{
 					constexpr auto MaxPlanes = 4;
@@ -230,9 +309,15 @@ class CSwizzleAndConvertImageFilter<EF_UNKNOWN,outFormat,Swizzle,Normalize,Clamp
 			#endif
 
 			typedef std::conditional<asset::isIntegerFormat<outFormat>(), uint64_t, double>::type encodeBufferType;
+			const bool batched = impl::CSwizzleAndConvertImageFilterBase<Normalize,Clamp,Swizzle,Dither>::canConvertBatched(state,inFormat,outFormat);
 
-			auto perOutputRegion = [policy,&blockDims,inFormat,&state](const CMatchedSizeInOutImageFilterCommon::CommonExecuteData& commonExecuteData, CBasicImageFilterCommon::clip_region_functor_t& clip) -> bool
+			auto perOutputRegion = [policy,&blockDims,inFormat,&state,batched](const CMatchedSizeInOutImageFilterCommon::CommonExecuteData& commonExecuteData, CBasicImageFilterCommon::clip_region_functor_t& clip) -> bool
 			{
+				if (batched)
+				{
+					impl::CSwizzleAndConvertImageFilterBase<Normalize,Clamp,Swizzle,Dither>::convertBatched(policy,commonExecuteData,clip);
+					return true;
+				}
 				constexpr uint32_t outChannelsAmount = asset::getFormatChannelCount<outFormat>();
 
 				auto swizzle = [&commonExecuteData,&blockDims,inFormat,&outChannelsAmount,&state](uint32_t readBlockArrayOffset, core::vectorSIMDu32 readBlockPos)
@@ -305,9 +390,15 @@ class CSwizzleAndConvertImageFilter<inFormat,EF_UNKNOWN,Swizzle,Normalize,Clamp,
 			#endif
 
 			typedef std::conditional<asset::isIntegerFormat<inFormat>(), uint64_t, double>::type decodeBufferType;
+			const bool batched = impl::CSwizzleAndConvertImageFilterBase<Normalize,Clamp,Swizzle,Dither>::canConvertBatched(state,inFormat,outFormat);
 
-			auto perOutputRegion = [policy,&blockDims,&outFormat,outChannelsAmount,&state](const CMatchedSizeInOutImageFilterCommon::CommonExecuteData& commonExecuteData, CBasicImageFilterCommon::clip_region_functor_t& clip) -> bool
+			auto perOutputRegion = [policy,&blockDims,&outFormat,outChannelsAmount,&state,batched](const CMatchedSizeInOutImageFilterCommon::CommonExecuteData& commonExecuteData, CBasicImageFilterCommon::clip_region_functor_t& clip) -> bool
 			{
+				if (batched)
+				{
+					impl::CSwizzleAndConvertImageFilterBase<Normalize,Clamp,Swizzle,Dither>::convertBatched(policy,commonExecuteData,clip);
+					return true;
+				}
 				const uint32_t outChannelsAmount = asset::getFormatChannelCount(outFormat);
 
 				auto swizzle = [&commonExecuteData,&blockDims,&outFormat,&outChannelsAmount,&state](uint32_t readBlockArrayOffset, core::vectorSIMDu32 readBlockPos)
@@ -11,6 +11,7 @@
 #include "nbl/asset/format/EFormat.h"
 #include "decodePixels.h"
 #include "encodePixels.h"
+#include "encodeBlocks.h"
 
 #ifdef __GNUC__
     #pragma GCC diagnostic push
@@ -7,6 +7,7 @@
 
 #include <type_traits>
 #include <cstdint>
+#include <array>
 
 #include "nbl/core/core.h"
 #include "nbl/asset/format/EFormat.h"
@@ -1160,33 +1161,39 @@ namespace asset
 
             uint16_t r0, g0, b0, r1, g1, b1;
 
+            // endpoints are stored with red in the high bits, which is the reverse of what `EF_B5G6R5_UNORM_PACK16` decodes to
             const void* input = &col.c0;
             decodePixels<asset::EF_B5G6R5_UNORM_PACK16, uint64_t>(&input, p[0].c, 0u, 0u);
+            std::swap(p[0].r, p[0].b);
+            p[0].a = 1;
 			r0 = static_cast<uint16_t>(p[0].r);
 			g0 = static_cast<uint16_t>(p[0].g);
 			b0 = static_cast<uint16_t>(p[0].b);
             input = &col.c1;
             decodePixels<asset::EF_B5G6R5_UNORM_PACK16, uint64_t>(&input, p[1].c, 0u, 0u);
+            std::swap(p[1].r, p[1].b);
+            p[1].a = 1;
 			r1 = static_cast<uint16_t>(p[1].r);
 			g1 = static_cast<uint16_t>(p[1].g);
 			b1 = static_cast<uint16_t>(p[1].b);
+            // alpha is already normalized, the callers only rescale the color channels
             if (col.c0 > col.c1)
             {
                 p[2].r = (2 * r0 + 1 * r1) / 3;
                 p[2].g = (2 * g0 + 1 * g1) / 3;
                 p[2].b = (2 * b0 + 1 * b1) / 3;
-                p[2].a = 0xff;
+                p[2].a = 1;
                 p[3].r = (1 * r0 + 2 * r1) / 3;
                 p[3].g = (1 * g0 + 2 * g1) / 3;
                 p[3].b = (1 * b0 + 2 * b1) / 3;
-                p[3].a = 0xff;
+                p[3].a = 1;
             }
             else
             {
                 p[2].r = (r0 + r1) / 2;
                 p[2].g = (g0 + g1) / 2;
                 p[2].b = (b0 + b1) / 2;
-                p[2].a = 0xff;
+                p[2].a = 1;
                 p[3].r = 0;
                 p[3].g = 0;
                 p[3].b = 0;
@@ -1210,22 +1217,23 @@ namespace asset
             const uint32_t av = 0xfu & (pix[byI] >> (bitI & 7u));
             _output[3] = av;
         }
-        template<typename T>
+        //! `EndpointT` is `uint8_t` for the UNORM and `int8_t` for the SNORM variants, the output is left unnormalized
+        template<typename T, typename EndpointT=uint8_t>
         inline void decodeBC4(const void* _pix, T* _output, int _offset, uint32_t _x, uint32_t _y)
         {
             struct
             {
-                uint8_t a0, a1;
+                EndpointT a0, a1;
                 uint8_t lut[6];
             } b;
-            uint16_t a0, a1;
-            uint8_t a[8];
+            int32_t a0, a1;
+            int32_t a[8];
             memcpy(&b, _pix, sizeof(b));
 
             a0 = b.a0;
             a1 = b.a1;
-            a[0] = (uint8_t)a0;
-            a[1] = (uint8_t)a1;
+            a[0] = a0;
+            a[1] = a1;
             if (a0 > a1)
             {
                 a[2] = (6 * a0 + 1 * a1) / 7;
@@ -1241,8 +1249,8 @@ namespace asset
                 a[3] = (3 * a0 + 2 * a1) / 5;
                 a[4] = (2 * a0 + 3 * a1) / 5;
                 a[5] = (1 * a0 + 4 * a1) / 5;
-                a[6] = 0;
-                a[7] = 0xff;
+                a[6] = std::is_signed<EndpointT>::value ? -127 : 0;
+                a[7] = std::is_signed<EndpointT>::value ? 127 : 0xff;
             }
 
             const uint32_t idx = 4u*_y + _x;
@@ -1256,7 +1264,7 @@ namespace asset
             else
             {
                 int lut = int(b.lut[3]) | int(b.lut[4] << 8) | int(b.lut[5] << 16);
-                int aw = 7 & (lut >> (3 * idx));
+                int aw = 7 & (lut >> (3 * (idx - 8u)));
                 _output[_offset] = a[aw];
             }
         }
@@ -1367,7 +1375,7 @@ namespace asset
         memcpy(pix, _pix, sizeof(pix));
         pix[0] = reinterpret_cast<const uint8_t*>(pix[0])+8;
         decodePixels<asset::EF_BC1_RGBA_UNORM_BLOCK, double>(pix, _output, _x, _y);
-        impl::decodeBC4(_pix, _output, 3, _x, _y);
+        impl::decodeBC4(_pix[0], _output, 3, _x, _y);
         _output[3] /= 255.;
     }
 
@@ -1378,6 +1386,40 @@ namespace asset
         impl::SRGB2lin(_output);
     }
 
+    template<>
+    inline void decodePixels<asset::EF_BC4_UNORM_BLOCK, double>(const void* _pix[4], double* _output, uint32_t _x, uint32_t _y)
+    {
+        impl::decodeBC4(_pix[0], _output, 0, _x, _y);
+        _output[0] /= 255.;
+    }
+
+    template<>
+    inline void decodePixels<asset::EF_BC4_SNORM_BLOCK, double>(const void* _pix[4], double* _output, uint32_t _x, uint32_t _y)
+    {
+        impl::decodeBC4<double, int8_t>(_pix[0], _output, 0, _x, _y);
+        _output[0] = core::max(_output[0] / 127., -1.);
+    }
+
+    template<>
+    inline void decodePixels<asset::EF_BC5_UNORM_BLOCK, double>(const void* _pix[4], double* _output, uint32_t _x, uint32_t _y)
+    {
+        const uint8_t* pix = reinterpret_cast<const uint8_t*>(_pix[0]);
+        impl::decodeBC4(pix, _output, 0, _x, _y);
+        impl::decodeBC4(pix+8, _output, 1, _x, _y);
+        _output[0] /= 255.;
+        _output[1] /= 255.;
+    }
+
+    template<>
+    inline void decodePixels<asset::EF_BC5_SNORM_BLOCK, double>(const void* _pix[4], double* _output, uint32_t _x, uint32_t _y)
+    {
+        const uint8_t* pix = reinterpret_cast<const uint8_t*>(_pix[0]);
+        impl::decodeBC4<double, int8_t>(pix, _output, 0, _x, _y);
+        impl::decodeBC4<double, int8_t>(pix+8, _output, 1, _x, _y);
+        _output[0] = core::max(_output[0] / 127., -1.);
+        _output[1] = core::max(_output[1] / 127., -1.);
+    }
+
     template<>
     inline void decodePixels<asset::EF_ASTC_4x4_UNORM_BLOCK, double>(const void* _pix[4], double* _output, uint32_t _x, uint32_t _y)
     {
@@ -1658,6 +1700,10 @@ namespace asset
             case asset::EF_BC2_SRGB_BLOCK: decodePixels<asset::EF_BC2_SRGB_BLOCK, double>(_pix, _output, _blockX, _blockY); return true;
             case asset::EF_BC3_UNORM_BLOCK: decodePixels<asset::EF_BC3_UNORM_BLOCK, double>(_pix, _output, _blockX, _blockY); return true;
             case asset::EF_BC3_SRGB_BLOCK: decodePixels<asset::EF_BC3_SRGB_BLOCK, double>(_pix, _output, _blockX, _blockY); return true;
+            case asset::EF_BC4_UNORM_BLOCK: decodePixels<asset::EF_BC4_UNORM_BLOCK, double>(_pix, _output, _blockX, _blockY); return true;
+            case asset::EF_BC4_SNORM_BLOCK: decodePixels<asset::EF_BC4_SNORM_BLOCK, double>(_pix, _output, _blockX, _blockY); return true;
+            case asset::EF_BC5_UNORM_BLOCK: decodePixels<asset::EF_BC5_UNORM_BLOCK, double>(_pix, _output, _blockX, _blockY); return true;
+            case asset::EF_BC5_SNORM_BLOCK: decodePixels<asset::EF_BC5_SNORM_BLOCK, double>(_pix, _output, _blockX, _blockY); return true;
             case asset::EF_G8_B8_R8_3PLANE_420_UNORM: decodePixels<asset::EF_G8_B8_R8_3PLANE_420_UNORM, double>(_pix, _output, _blockX, _blockY); return true;
             case asset::EF_G8_B8R8_2PLANE_420_UNORM: decodePixels<asset::EF_G8_B8R8_2PLANE_420_UNORM, double>(_pix, _output, _blockX, _blockY); return true;
             case asset::EF_G8_B8_R8_3PLANE_422_UNORM: decodePixels<asset::EF_G8_B8_R8_3PLANE_422_UNORM, double>(_pix, _output, _blockX, _blockY); return true;
@@ -1740,6 +1786,148 @@ namespace asset
     }
 
 
+    //! Batched decode
+    /*
+        Row-wide entry points for the formats we convert most often, each texel is decoded with SSE instead of going through the per-texel switch and `double` arithmetic.
+        The output always has 4 channels per texel, channels missing from the format are set to 0.
+        Every value is the per-texel `decodePixels<double>` result rounded to `float`, signaling NaNs come out quiet just like they do when widened to `double`.
+        Only non-block formats with one texel per block qualify, so `_pix` points to `_texelCount` tightly packed texels.
+    */
+
+    inline bool isBatchDecodable(asset::E_FORMAT _fmt)
+    {
+        #ifdef __NBL_COMPILE_WITH_X86_SIMD_
+        switch (_fmt)
+        {
+            case asset::EF_R8G8B8A8_UNORM:
+            case asset::EF_R8G8B8A8_SRGB:
+            case asset::EF_R16_UNORM:
+            case asset::EF_R16G16_UNORM:
+            case asset::EF_R16G16B16A16_SFLOAT:
+            case asset::EF_R32G32B32A32_SFLOAT:
+                return true;
+            default:
+                break;
+        }
+        #endif
+        return false;
+    }
+
+    #ifdef __NBL_COMPILE_WITH_X86_SIMD_
+    namespace impl
+    {
+        //! SSE4.1 port of `core::Float16Compressor::decompress`, bit-exact with it, the halves sit in the low 16 bits of every lane
+        inline __m128 decompressHalf4(__m128i _halves)
+        {
+            const __m128i signC = _mm_set1_epi32(0x00008000);
+            const __m128i subC = _mm_set1_epi32(0x003FF);
+            const __m128i maxC = _mm_set1_epi32(0x23BFF);
+            const __m128i norC = _mm_set1_epi32(0x00400);
+            const __m128i minD = _mm_set1_epi32(0x1C000);
+            const __m128i maxD = _mm_set1_epi32(0x1C000);
+            const __m128 mulC = _mm_castsi128_ps(_mm_set1_epi32(0x33800000));
+
+            __m128i v = _halves;
+            __m128i sign = _mm_and_si128(v,signC);
+            v = _mm_xor_si128(v,sign);
+            sign = _mm_slli_epi32(sign,16);
+            v = _mm_xor_si128(v,_mm_and_si128(_mm_xor_si128(_mm_add_epi32(v,minD),v),_mm_cmpgt_epi32(v,subC)));
+            v = _mm_xor_si128(v,_mm_and_si128(_mm_xor_si128(_mm_add_epi32(v,maxD),v),_mm_cmpgt_epi32(v,maxC)));
+            const __m128i s = _mm_castps_si128(_mm_mul_ps(mulC,_mm_cvtepi32_ps(v)));
+            const __m128i mask = _mm_cmpgt_epi32(norC,v);
+            v = _mm_slli_epi32(v,13);
+            v = _mm_xor_si128(v,_mm_and_si128(_mm_xor_si128(s,v),mask));
+            return _mm_castsi128_ps(_mm_or_si128(v,sign));
+        }
+
+        //! what a round trip through `double` does to a `float`, sets the quiet bit of signaling NaNs
+        inline __m128 quietNaN4(const __m128 _value)
+        {
+            return _mm_or_ps(_value,_mm_and_ps(_mm_cmpunord_ps(_value,_value),_mm_castsi128_ps(_mm_set1_epi32(0x00400000))));
+        }
+
+        inline const float* getSRGBToLinearTable()
+        {
+            static const auto table = []() -> std::array<float,256u>
+            {
+                std::array<float,256u> retval;
+                for (uint32_t i=0u; i<256u; i++)
+                    retval[i] = core::srgb2lin(i/255.);
+                return retval;
+            }();
+            return table.data();
+        }
+    }
+    #endif
+
+    inline bool decodePixelsBatched(asset::E_FORMAT _fmt, const void* _pix, float* _output, uint32_t _texelCount)
+    {
+        #ifdef __NBL_COMPILE_WITH_X86_SIMD_
+        const uint8_t* pix = reinterpret_cast<const uint8_t*>(_pix);
+        switch (_fmt)
+        {
+            case asset::EF_R8G8B8A8_UNORM:
+            {
+                const __m128 maxValue = _mm_set1_ps(255.f);
+                for (uint32_t i=0u; i<_texelCount; i++,pix+=4u,_output+=4u)
+                {
+                    int32_t texel;
+                    memcpy(&texel,pix,sizeof(texel));
+                    _mm_storeu_ps(_output,_mm_div_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(texel))),maxValue));
+                }
+                return true;
+            }
+            case asset::EF_R8G8B8A8_SRGB:
+            {
+                const float* toLinear = impl::getSRGBToLinearTable();
+                for (uint32_t i=0u; i<_texelCount; i++,pix+=4u,_output+=4u)
+                    _mm_storeu_ps(_output,_mm_setr_ps(toLinear[pix[0]],toLinear[pix[1]],toLinear[pix[2]],pix[3]/255.f));
+                return true;
+            }
+            case asset::EF_R16_UNORM:
+            {
+                const __m128 maxValue = _mm_set1_ps(65535.f);
+                for (uint32_t i=0u; i<_texelCount; i++,pix+=2u,_output+=4u)
+                {
+                    uint16_t texel;
+                    memcpy(&texel,pix,sizeof(texel));
+                    _mm_storeu_ps(_output,_mm_div_ps(_mm_cvtepi32_ps(_mm_cvtsi32_si128(texel)),maxValue));
+                }
+                return true;
+            }
+            case asset::EF_R16G16_UNORM:
+            {
+                const __m128 maxValue = _mm_set1_ps(65535.f);
+                for (uint32_t i=0u; i<_texelCount; i++,pix+=4u,_output+=4u)
+                {
+                    int32_t texel;
+                    memcpy(&texel,pix,sizeof(texel));
+                    _mm_storeu_ps(_output,_mm_div_ps(_mm_cvtepi32_ps(_mm_cvtepu16_epi32(_mm_cvtsi32_si128(texel))),maxValue));
+                }
+                return true;
+            }
+            case asset::EF_R16G16B16A16_SFLOAT:
+            {
+                for (uint32_t i=0u; i<_texelCount; i++,pix+=8u,_output+=4u)
+                    _mm_storeu_ps(_output,impl::quietNaN4(impl::decompressHalf4(_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pix))))));
+                return true;
+            }
+            case asset::EF_R32G32B32A32_SFLOAT:
+            {
+                for (uint32_t i=0u; i<_texelCount; i++,pix+=16u,_output+=4u)
+                    _mm_storeu_ps(_output,impl::quietNaN4(_mm_loadu_ps(reinterpret_cast<const float*>(pix))));
+                return true;
+            }
+            default:
+                break;
+        }
+        #endif
+        return false;
+    }
+
+
+
+
 }
 }
 
@@ -0,0 +1,446 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_ASSET_ENCODE_BLOCKS_H_INCLUDED__
+#define __NBL_ASSET_ENCODE_BLOCKS_H_INCLUDED__
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <cstring>
+
+#include "nbl/core/core.h"
+#include "nbl/asset/format/EFormat.h"
+
+namespace nbl
+{
+namespace asset
+{
+	// Block Compression encoders
+	namespace impl
+	{
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t BCTexelCount = 16u;
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t BCAllTexelsMask = 0xffffu;
+
+		//! Range fit along the principal axis of the texels selected by `_mask`, `_hi` ends up at the positive end of the axis
+		inline void fitEndpointsPCA(const core::vectorSIMDf* _texels, const uint32_t _mask, core::vectorSIMDf& _hi, core::vectorSIMDf& _lo)
+		{
+			core::vectorSIMDf mean(0.f), minimum(FLT_MAX), maximum(-FLT_MAX);
+			float count = 0.f;
+			for (uint32_t i=0u; i<BCTexelCount; i++)
+			if (_mask&(0x1u<<i))
+			{
+				mean += _texels[i];
+				minimum = core::min(minimum,_texels[i]);
+				maximum = core::max(maximum,_texels[i]);
+				count += 1.f;
+			}
+			mean /= core::vectorSIMDf(count);
+
+			// power iteration on the covariance matrix, without ever forming it
+			core::vectorSIMDf axis = maximum-minimum;
+			for (uint32_t iteration=0u; iteration<8u; iteration++)
+			{
+				core::vectorSIMDf next(0.f);
+				for (uint32_t i=0u; i<BCTexelCount; i++)
+				if (_mask&(0x1u<<i))
+				{
+					const auto centered = _texels[i]-mean;
+					next += centered*core::dot(centered,axis);
+				}
+				const float scale = core::max(core::max(core::abs(next.x),core::abs(next.y)),core::max(core::abs(next.z),core::abs(next.w)));
+				if (scale<=FLT_MIN)
+					break;
+				axis = next/core::vectorSIMDf(scale);
+			}
+			const float axisLengthSq = core::dot(axis,axis).x;
+			if (axisLengthSq<=FLT_MIN)
+			{
+				_hi = _lo = mean;
+				return;
+			}
+
+			float tMin = FLT_MAX, tMax = -FLT_MAX;
+			for (uint32_t i=0u; i<BCTexelCount; i++)
+			if (_mask&(0x1u<<i))
+			{
+				const float t = core::dot(_texels[i]-mean,axis).x;
+				tMin = core::min(t,tMin);
+				tMax = core::max(t,tMax);
+			}
+			_hi = mean+axis*core::vectorSIMDf(tMax/axisLengthSq);
+			_lo = mean+axis*core::vectorSIMDf(tMin/axisLengthSq);
+		}
+
+		//! Least squares endpoints for fixed interpolation factors, `_t[i]` is the weight of `_e1` in texel `i`
+		inline bool refineEndpoints(const core::vectorSIMDf* _texels, const float* _t, const uint32_t _mask, core::vectorSIMDf& _e0, core::vectorSIMDf& _e1)
+		{
+			float aa = 0.f, ab = 0.f, bb = 0.f;
+			core::vectorSIMDf ax(0.f), bx(0.f);
+			for (uint32_t i=0u; i<BCTexelCount; i++)
+			if (_mask&(0x1u<<i))
+			{
+				const float a = 1.f-_t[i];
+				const float b = _t[i];
+				aa += a*a;
+				ab += a*b;
+				bb += b*b;
+				ax += _texels[i]*core::vectorSIMDf(a);
+				bx += _texels[i]*core::vectorSIMDf(b);
+			}
+			const float det = aa*bb-ab*ab;
+			if (core::abs(det)<=FLT_EPSILON)
+				return false;
+			const core::vectorSIMDf invDet(1.f/det);
+			_e0 = (ax*core::vectorSIMDf(bb)-bx*core::vectorSIMDf(ab))*invDet;
+			_e1 = (bx*core::vectorSIMDf(aa)-ax*core::vectorSIMDf(ab))*invDet;
+			return true;
+		}
+
+		//! Squared distances to every palette entry, returns the closest one
+		inline uint32_t findClosest(const core::vectorSIMDf& _texel, const core::vectorSIMDf* _palette, const uint32_t _paletteSize, float& _error)
+		{
+			uint32_t closest = 0u;
+			_error = FLT_MAX;
+			for (uint32_t j=0u; j<_paletteSize; j++)
+			{
+				const auto diff = _texel-_palette[j];
+				const float error = core::dot(diff,diff).x;
+				if (error<_error)
+				{
+					_error = error;
+					closest = j;
+				}
+			}
+			return closest;
+		}
+
+		inline uint16_t quantizeRGB565(const core::vectorSIMDf& _color)
+		{
+			const auto clamped = core::clamp(_color,core::vectorSIMDf(0.f),core::vectorSIMDf(1.f))*core::vectorSIMDf(31.f,63.f,31.f,0.f)+core::vectorSIMDf(0.5f);
+			return (uint16_t(clamped.x)<<11u)|(uint16_t(clamped.y)<<5u)|uint16_t(clamped.z);
+		}
+		inline core::vectorSIMDf dequantizeRGB565(const uint16_t _color)
+		{
+			return core::vectorSIMDf(float(_color>>11u)/31.f,float((_color>>5u)&0x3fu)/63.f,float(_color&0x1fu)/31.f,0.f);
+		}
+
+		//! BC1 color block, texels need their alpha zeroed, transparent texels are left out of `_opaqueMask`
+		inline void encodeBC1Color(const core::vectorSIMDf* _texels, const uint32_t _opaqueMask, const bool _allowThreeColor, uint8_t* _out)
+		{
+			uint16_t color[2] = {0u,0u};
+			uint32_t indices = 0u;
+			if (_opaqueMask)
+			{
+				// transparent texels are only expressible with the 3 color palette
+				const bool threeColor = _allowThreeColor && _opaqueMask!=BCAllTexelsMask;
+				core::vectorSIMDf endpoint[2];
+				fitEndpointsPCA(_texels,_opaqueMask,endpoint[0],endpoint[1]);
+
+				float bestError = FLT_MAX;
+				for (uint32_t iteration=0u; iteration<2u; iteration++)
+				{
+					uint16_t candidate[2] = {quantizeRGB565(endpoint[0]),quantizeRGB565(endpoint[1])};
+					if (threeColor ? (candidate[0]>candidate[1]):(candidate[0]<candidate[1]))
+						std::swap(candidate[0],candidate[1]);
+
+					core::vectorSIMDf palette[4] = {dequantizeRGB565(candidate[0]),dequantizeRGB565(candidate[1])};
+					float paletteT[4] = {0.f,1.f,0.f,0.f};
+					uint32_t paletteSize;
+					if (threeColor)
+					{
+						palette[2] = (palette[0]+palette[1])*core::vectorSIMDf(0.5f);
+						paletteT[2] = 0.5f;
+						paletteSize = 3u;
+					}
+					else
+					{
+						palette[2] = (palette[0]*core::vectorSIMDf(2.f)+palette[1])/core::vectorSIMDf(3.f);
+						palette[3] = (palette[0]+palette[1]*core::vectorSIMDf(2.f))/core::vectorSIMDf(3.f);
+						paletteT[2] = 1.f/3.f;
+						paletteT[3] = 2.f/3.f;
+						// equal endpoints switch the decoder to the 3 color palette, where only the first entry is still valid
+						paletteSize = candidate[0]!=candidate[1] ? 4u:1u;
+					}
+
+					uint32_t candidateIndices = 0u;
+					float candidateError = 0.f;
+					float t[BCTexelCount];
+					for (uint32_t i=0u; i<BCTexelCount; i++)
+					{
+						uint32_t index = 3u;
+						if (_opaqueMask&(0x1u<<i))
+						{
+							float error;
+							index = findClosest(_texels[i],palette,paletteSize,error);
+							candidateError += error;
+						}
+						candidateIndices |= index<<(2u*i);
+						t[i] = paletteT[index&0x3u];
+					}
+
+					if (candidateError<bestError)
+					{
+						bestError = candidateError;
+						color[0] = candidate[0];
+						color[1] = candidate[1];
+						indices = candidateIndices;
+					}
+					if (!refineEndpoints(_texels,t,_opaqueMask,endpoint[0],endpoint[1]))
+						break;
+				}
+			}
+			else
+				indices = ~0u; // all transparent
+
+			memcpy(_out,color,sizeof(color));
+			memcpy(_out+sizeof(color),&indices,sizeof(indices));
+		}
+
+		//! BC4 block for one channel, used for BC3 alpha and both BC5 channels as well
+		inline void encodeBC4Channel(const float* _values, const bool _signed, uint8_t* _out)
+		{
+			const float scale = _signed ? 127.f:255.f;
+			const float lowest = _signed ? -1.f:0.f;
+			float minimum = FLT_MAX, maximum = -FLT_MAX;
+			for (uint32_t i=0u; i<BCTexelCount; i++)
+			{
+				minimum = core::min(_values[i],minimum);
+				maximum = core::max(_values[i],maximum);
+			}
+			const int32_t a0 = core::round<float,int32_t>(core::clamp(maximum,lowest,1.f)*scale);
+			const int32_t a1 = core::round<float,int32_t>(core::clamp(minimum,lowest,1.f)*scale);
+			_out[0] = uint8_t(a0);
+			_out[1] = uint8_t(a1);
+
+			// with a0>a1 we get the 8 value palette, equal endpoints make every index map to a0
+			int32_t palette[8] = {a0,a1};
+			for (int32_t i=2; i<8; i++)
+				palette[i] = ((8-i)*a0+(i-1)*a1)/7;
+			uint64_t indices = 0ull;
+			if (a0!=a1)
+			for (uint32_t i=0u; i<BCTexelCount; i++)
+			{
+				const float value = _values[i]*scale;
+				uint64_t closest = 0ull;
+				float bestError = FLT_MAX;
+				for (uint32_t j=0u; j<8u; j++)
+				{
+					const float error = core::abs(value-float(palette[j]));
+					if (error<bestError)
+					{
+						bestError = error;
+						closest = j;
+					}
+				}
+				indices |= closest<<(3ull*i);
+			}
+			memcpy(_out+2u,&indices,6u);
+		}
+
+		//! BC7 mode 6, a single subset with 7 bit RGBA endpoints, a P-bit per endpoint and 4 bit indices
+		inline void encodeBC7Mode6(const core::vectorSIMDf* _texels, uint8_t* _out)
+		{
+			constexpr uint32_t Weights[16] = {0u,4u,9u,13u,17u,21u,26u,30u,34u,38u,43u,47u,51u,55u,60u,64u};
+
+			struct SQuantizedEndpoint
+			{
+				uint32_t value[4];
+				uint32_t pBit;
+			};
+			auto quantize = [](const core::vectorSIMDf& endpoint) -> SQuantizedEndpoint
+			{
+				const auto clamped = core::clamp(endpoint,core::vectorSIMDf(0.f),core::vectorSIMDf(1.f))*core::vectorSIMDf(255.f);
+				SQuantizedEndpoint best;
+				float bestError = FLT_MAX;
+				for (uint32_t pBit=0u; pBit<2u; pBit++)
+				{
+					SQuantizedEndpoint candidate;
+					candidate.pBit = pBit;
+					float error = 0.f;
+					for (uint32_t c=0u; c<4u; c++)
+					{
+						candidate.value[c] = core::clamp<int32_t,int32_t>(core::round<float,int32_t>((clamped.pointer[c]-float(pBit))*0.5f),0,127);
+						const float diff = float((candidate.value[c]<<1u)|pBit)-clamped.pointer[c];
+						error += diff*diff;
+					}
+					if (error<bestError)
+					{
+						bestError = error;
+						best = candidate;
+					}
+				}
+				return best;
+			};
+
+			core::vectorSIMDf endpoint[2];
+			fitEndpointsPCA(_texels,BCAllTexelsMask,endpoint[1],endpoint[0]);
+
+			SQuantizedEndpoint bestEndpoints[2];
+			uint8_t bestIndices[BCTexelCount];
+			float bestError = FLT_MAX;
+			for (uint32_t iteration=0u; iteration<2u; iteration++)
+			{
+				const SQuantizedEndpoint quantized[2] = {quantize(endpoint[0]),quantize(endpoint[1])};
+				core::vectorSIMDf palette[16];
+				for (uint32_t j=0u; j<16u; j++)
+				for (uint32_t c=0u; c<4u; c++)
+				{
+					const uint32_t e0 = (quantized[0].value[c]<<1u)|quantized[0].pBit;
+					const uint32_t e1 = (quantized[1].value[c]<<1u)|quantized[1].pBit;
+					palette[j].pointer[c] = float(((64u-Weights[j])*e0+Weights[j]*e1+32u)>>6u)/255.f;
+				}
+
+				uint8_t indices[BCTexelCount];
+				float t[BCTexelCount];
+				float error = 0.f;
+				for (uint32_t i=0u; i<BCTexelCount; i++)
+				{
+					float texelError;
+					indices[i] = findClosest(_texels[i],palette,16u,texelError);
+					t[i] = float(Weights[indices[i]])/64.f;
+					error += texelError;
+				}
+
+				if (error<bestError)
+				{
+					bestError = error;
+					std::copy_n(quantized,2u,bestEndpoints);
+					std::copy_n(indices,BCTexelCount,bestIndices);
+				}
+				if (!refineEndpoints(_texels,t,BCAllTexelsMask,endpoint[0],endpoint[1]))
+					break;
+			}
+
+			// the first index has an implicit zero MSB
+			if (bestIndices[0]&0x8u)
+			{
+				std::swap(bestEndpoints[0],bestEndpoints[1]);
+				for (auto& index : bestIndices)
+					index = 15u-index;
+			}
+
+			uint64_t bits[2] = {0ull,0ull};
+			uint32_t bitOffset = 0u;
+			auto write = [&bits,&bitOffset](const uint64_t value, const uint32_t bitCount) -> void
+			{
+				for (uint32_t i=0u; i<bitCount; i++,bitOffset++)
+					bits[bitOffset>>6u] |= ((value>>i)&0x1ull)<<(bitOffset&63u);
+			};
+			write(0x1u<<6u,7u); // mode 6
+			for (uint32_t c=0u; c<4u; c++)
+			{
+				write(bestEndpoints[0].value[c],7u);
+				write(bestEndpoints[1].value[c],7u);
+			}
+			write(bestEndpoints[0].pBit,1u);
+			write(bestEndpoints[1].pBit,1u);
+			write(bestIndices[0],3u);
+			for (uint32_t i=1u; i<BCTexelCount; i++)
+				write(bestIndices[i],4u);
+			memcpy(_out,bits,sizeof(bits));
+		}
+	}
+
+	inline bool isBlockEncodable(asset::E_FORMAT _fmt)
+	{
+		switch (_fmt)
+		{
+			case asset::EF_BC1_RGB_UNORM_BLOCK:
+			case asset::EF_BC1_RGB_SRGB_BLOCK:
+			case asset::EF_BC1_RGBA_UNORM_BLOCK:
+			case asset::EF_BC1_RGBA_SRGB_BLOCK:
+			case asset::EF_BC3_UNORM_BLOCK:
+			case asset::EF_BC3_SRGB_BLOCK:
+			case asset::EF_BC4_UNORM_BLOCK:
+			case asset::EF_BC4_SNORM_BLOCK:
+			case asset::EF_BC5_UNORM_BLOCK:
+			case asset::EF_BC5_SNORM_BLOCK:
+			case asset::EF_BC7_UNORM_BLOCK:
+			case asset::EF_BC7_SRGB_BLOCK:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	//! Compresses a whole 4x4 block at once
+	/*
+		`_texels` holds the 16 texels of the block in row-major order, 4 linear channels each, just like the decoders output them.
+		Texels of blocks sticking out of the image should be filled by replicating the edge.
+		Returns false without writing anything if the format has no encoder.
+	*/
+	template<typename T>
+	inline bool encodeBlock(asset::E_FORMAT _fmt, void* _block, const T* _texels)
+	{
+		if (!isBlockEncodable(_fmt))
+			return false;
+
+		const bool isSigned = isSignedFormat(_fmt);
+		const bool isSRGB = isSRGBFormat(_fmt);
+		core::vectorSIMDf texels[impl::BCTexelCount];
+		for (uint32_t i=0u; i<impl::BCTexelCount; i++)
+		{
+			const T* texel = _texels+i*4u;
+			for (uint32_t c=0u; c<4u; c++)
+				texels[i].pointer[c] = static_cast<float>(isSRGB&&c<3u ? core::lin2srgb(texel[c]):texel[c]);
+			texels[i] = core::clamp(texels[i],core::vectorSIMDf(isSigned ? -1.f:0.f),core::vectorSIMDf(1.f));
+		}
+
+		uint8_t* out = reinterpret_cast<uint8_t*>(_block);
+		auto encodeChannel = [&texels,isSigned](const uint32_t channel, uint8_t* dst) -> void
+		{
+			float values[impl::BCTexelCount];
+			for (uint32_t i=0u; i<impl::BCTexelCount; i++)
+				values[i] = texels[i].pointer[channel];
+			impl::encodeBC4Channel(values,isSigned,dst);
+		};
+		auto encodeColor = [&texels](const bool allowThreeColor, uint8_t* dst) -> void
+		{
+			uint32_t opaqueMask = impl::BCAllTexelsMask;
+			core::vectorSIMDf colors[impl::BCTexelCount];
+			for (uint32_t i=0u; i<impl::BCTexelCount; i++)
+			{
+				if (allowThreeColor && texels[i].w<0.5f)
+					opaqueMask ^= 0x1u<<i;
+				colors[i] = texels[i];
+				colors[i].w = 0.f;
+			}
+			impl::encodeBC1Color(colors,opaqueMask,allowThreeColor,dst);
+		};
+		switch (_fmt)
+		{
+			case asset::EF_BC1_RGB_UNORM_BLOCK:
+			case asset::EF_BC1_RGB_SRGB_BLOCK:
+				encodeColor(false,out);
+				break;
+			case asset::EF_BC1_RGBA_UNORM_BLOCK:
+			case asset::EF_BC1_RGBA_SRGB_BLOCK:
+				encodeColor(true,out);
+				break;
+			case asset::EF_BC3_UNORM_BLOCK:
+			case asset::EF_BC3_SRGB_BLOCK:
+				encodeChannel(3u,out);
+				encodeColor(false,out+8u);
+				break;
+			case asset::EF_BC4_UNORM_BLOCK:
+			case asset::EF_BC4_SNORM_BLOCK:
+				encodeChannel(0u,out);
+				break;
+			case asset::EF_BC5_UNORM_BLOCK:
+			case asset::EF_BC5_SNORM_BLOCK:
+				encodeChannel(0u,out);
+				encodeChannel(1u,out+8u);
+				break;
+			default: // BC7
+				impl::encodeBC7Mode6(texels,out);
+				break;
+		}
+		return true;
+	}
+
+}
+}
+
+#endif
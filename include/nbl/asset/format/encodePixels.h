@@ -2640,6 +2640,185 @@ namespace asset
     }
 
 
+    //! Batched encode
+    /*
+        Row-wide counterparts of `encodePixels` for the formats we convert most often, each texel is encoded with SSE.
+        The input always has 4 channels per texel, the ones missing from the format are ignored.
+        The output is bit for bit what `encodePixels<double>` makes of the input widened to `double`, so normalized channels truncate and wrap around too.
+        Only non-block formats with one texel per block qualify, so `_pix` receives `_texelCount` tightly packed texels.
+    */
+
+    inline bool isBatchEncodable(asset::E_FORMAT _fmt)
+    {
+        #ifdef __NBL_COMPILE_WITH_X86_SIMD_
+        switch (_fmt)
+        {
+            case asset::EF_R8G8B8A8_UNORM:
+            case asset::EF_R8G8B8A8_SRGB:
+            case asset::EF_R16_UNORM:
+            case asset::EF_R16G16_UNORM:
+            case asset::EF_R16G16B16A16_SFLOAT:
+            case asset::EF_R32G32B32A32_SFLOAT:
+                return true;
+            default:
+                break;
+        }
+        #endif
+        return false;
+    }
+
+    #ifdef __NBL_COMPILE_WITH_X86_SIMD_
+    namespace impl
+    {
+        //! SSE4.1 port of `core::Float16Compressor::compress`, bit-exact with it, the halves land in the low 16 bits of every lane
+        inline __m128i compressHalf4(__m128 _floats)
+        {
+            const __m128i signN = _mm_set1_epi32(0x80000000);
+            const __m128i infN = _mm_set1_epi32(0x7F800000);
+            const __m128i maxN = _mm_set1_epi32(0x477FE000);
+            const __m128i minN = _mm_set1_epi32(0x38800000);
+            const __m128i nanN = _mm_set1_epi32(0x7F802000);
+            const __m128i maxC = _mm_set1_epi32(0x23BFF);
+            const __m128i subC = _mm_set1_epi32(0x003FF);
+            const __m128i maxD = _mm_set1_epi32(0x1C000);
+            const __m128i minD = _mm_set1_epi32(0x1C000);
+            const __m128 mulN = _mm_castsi128_ps(_mm_set1_epi32(0x52000000));
+
+            __m128i v = _mm_castps_si128(_floats);
+            __m128i sign = _mm_and_si128(v,signN);
+            v = _mm_xor_si128(v,sign);
+            sign = _mm_srli_epi32(sign,16);
+            const __m128i s = _mm_cvttps_epi32(_mm_mul_ps(mulN,_mm_castsi128_ps(v))); // correct subnormals
+            v = _mm_xor_si128(v,_mm_and_si128(_mm_xor_si128(s,v),_mm_cmpgt_epi32(minN,v)));
+            v = _mm_xor_si128(v,_mm_and_si128(_mm_xor_si128(infN,v),_mm_and_si128(_mm_cmpgt_epi32(infN,v),_mm_cmpgt_epi32(v,maxN))));
+            v = _mm_xor_si128(v,_mm_and_si128(_mm_xor_si128(nanN,v),_mm_and_si128(_mm_cmpgt_epi32(nanN,v),_mm_cmpgt_epi32(v,infN))));
+            v = _mm_srli_epi32(v,13);
+            v = _mm_xor_si128(v,_mm_and_si128(_mm_xor_si128(_mm_sub_epi32(v,maxD),v),_mm_cmpgt_epi32(v,maxC)));
+            v = _mm_xor_si128(v,_mm_and_si128(_mm_xor_si128(_mm_sub_epi32(v,minD),v),_mm_cmpgt_epi32(v,subC)));
+            return _mm_or_si128(v,sign);
+        }
+
+        //! the per-texel `uint64_t(value*maxValue)` in `double`, lanes which are negative or don't fit 31 bits come out negative
+        inline __m128i quantizeUNORM4(const __m128d _lo, const __m128d _hi, const __m128d _maxValue)
+        {
+            return _mm_unpacklo_epi64(_mm_cvttpd_epi32(_mm_mul_pd(_lo,_maxValue)),_mm_cvttpd_epi32(_mm_mul_pd(_hi,_maxValue)));
+        }
+        inline __m128i quantizeUNORM4(const __m128 _value, const __m128d _maxValue)
+        {
+            return quantizeUNORM4(_mm_cvtps_pd(_value),_mm_cvtps_pd(_mm_movehl_ps(_value,_value)),_maxValue);
+        }
+
+        //! for the texels `quantizeUNORM4` can't handle, what `uint64_t` makes of those is up to the compiler so let it do it
+        template<asset::E_FORMAT fmt>
+        inline void encodePixelWidened(void* _pix, const float* _input)
+        {
+            const double input[4] = {_input[0],_input[1],_input[2],_input[3]};
+            encodePixels<fmt,double>(_pix,input);
+        }
+    }
+    #endif
+
+    inline bool encodePixelsBatched(asset::E_FORMAT _fmt, void* _pix, const float* _input, uint32_t _texelCount)
+    {
+        #ifdef __NBL_COMPILE_WITH_X86_SIMD_
+        uint8_t* pix = reinterpret_cast<uint8_t*>(_pix);
+        switch (_fmt)
+        {
+            case asset::EF_R8G8B8A8_UNORM:
+            {
+                const __m128d maxValue = _mm_set1_pd(255.);
+                const __m128i mask = _mm_set1_epi32(0xff);
+                for (uint32_t i=0u; i<_texelCount; i++,pix+=4u,_input+=4u)
+                {
+                    const __m128i texel = impl::quantizeUNORM4(_mm_loadu_ps(_input),maxValue);
+                    if (_mm_movemask_ps(_mm_castsi128_ps(texel)))
+                    {
+                        impl::encodePixelWidened<asset::EF_R8G8B8A8_UNORM>(pix,_input);
+                        continue;
+                    }
+                    const __m128i wrapped = _mm_and_si128(texel,mask);
+                    const int32_t packed = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packus_epi32(wrapped,wrapped),wrapped));
+                    memcpy(pix,&packed,sizeof(packed));
+                }
+                return true;
+            }
+            case asset::EF_R8G8B8A8_SRGB:
+            {
+                const __m128d maxValue = _mm_set1_pd(255.);
+                const __m128i mask = _mm_set1_epi32(0xff);
+                for (uint32_t i=0u; i<_texelCount; i++,pix+=4u,_input+=4u)
+                {
+                    // the transfer function needs `pow`, which SSE lacks
+                    const __m128d lo = _mm_setr_pd(core::lin2srgb(_input[0]),core::lin2srgb(_input[1]));
+                    const __m128d hi = _mm_setr_pd(core::lin2srgb(_input[2]),_input[3]);
+                    const __m128i texel = impl::quantizeUNORM4(lo,hi,maxValue);
+                    if (_mm_movemask_ps(_mm_castsi128_ps(texel)))
+                    {
+                        impl::encodePixelWidened<asset::EF_R8G8B8A8_SRGB>(pix,_input);
+                        continue;
+                    }
+                    const __m128i wrapped = _mm_and_si128(texel,mask);
+                    const int32_t packed = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packus_epi32(wrapped,wrapped),wrapped));
+                    memcpy(pix,&packed,sizeof(packed));
+                }
+                return true;
+            }
+            case asset::EF_R16_UNORM:
+            {
+                const __m128d maxValue = _mm_set1_pd(65535.);
+                for (uint32_t i=0u; i<_texelCount; i++,pix+=2u,_input+=4u)
+                {
+                    const __m128i texel = impl::quantizeUNORM4(_mm_loadu_ps(_input),maxValue);
+                    if (_mm_movemask_ps(_mm_castsi128_ps(texel))&0x1)
+                    {
+                        impl::encodePixelWidened<asset::EF_R16_UNORM>(pix,_input);
+                        continue;
+                    }
+                    const uint16_t packed = _mm_cvtsi128_si32(texel);
+                    memcpy(pix,&packed,sizeof(packed));
+                }
+                return true;
+            }
+            case asset::EF_R16G16_UNORM:
+            {
+                const __m128d maxValue = _mm_set1_pd(65535.);
+                const __m128i mask = _mm_set1_epi32(0xffff);
+                for (uint32_t i=0u; i<_texelCount; i++,pix+=4u,_input+=4u)
+                {
+                    const __m128i texel = impl::quantizeUNORM4(_mm_loadu_ps(_input),maxValue);
+                    if (_mm_movemask_ps(_mm_castsi128_ps(texel))&0x3)
+                    {
+                        impl::encodePixelWidened<asset::EF_R16G16_UNORM>(pix,_input);
+                        continue;
+                    }
+                    const __m128i wrapped = _mm_and_si128(texel,mask);
+                    const int32_t packed = _mm_cvtsi128_si32(_mm_packus_epi32(wrapped,wrapped));
+                    memcpy(pix,&packed,sizeof(packed));
+                }
+                return true;
+            }
+            case asset::EF_R16G16B16A16_SFLOAT:
+            {
+                for (uint32_t i=0u; i<_texelCount; i++,pix+=8u,_input+=4u)
+                {
+                    const __m128i texel = impl::compressHalf4(_mm_loadu_ps(_input));
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(pix),_mm_packus_epi32(texel,texel));
+                }
+                return true;
+            }
+            case asset::EF_R32G32B32A32_SFLOAT:
+                memcpy(pix,_input,sizeof(float)*4ull*_texelCount);
+                return true;
+            default:
+                break;
+        }
+        #endif
+        return false;
+    }
+
+
+
+
 }
 }
 
@@ -26,6 +26,7 @@ namespace asset
 	E_WRITER_FLAGS::EWF_COMPRESSED means that it has to write in a way that consumes less disk space if possible.
 	E_WRITER_FLAGS::EWF_ENCRYPTED means that it has to write in encrypted way if possible.
 	E_WRITER_FLAGS::EWF_BINARY means that it has to write in binary format rather than text if possible.
+	E_WRITER_FLAGS::EWF_FAST_DECOMPRESSION means that compression should favour decoding speed over size if possible.
 */
 enum E_WRITER_FLAGS : uint32_t
 {
@@ -36,7 +37,10 @@ enum E_WRITER_FLAGS : uint32_t
     EWF_BINARY = 1u << 2u,
 
     //!< specifies the incoming orientation of loaded mesh we want to write. Flipping will be performed if needed in dependency of format extension orientation	
-    EWF_MESH_IS_RIGHT_HANDED = 1u << 3u
+    EWF_MESH_IS_RIGHT_HANDED = 1u << 3u,
+
+    //! when compressing, prefer codecs which decompress fast over the ones with the best ratio (if possible), the result may not be readable by older loaders
+    EWF_FAST_DECOMPRESSION = 1u << 4u
 };
 
 //! A class that defines rules during Asset-writing (saving) process
@@ -675,6 +675,23 @@ public:
 		//one element for each input IR root node
 		core::unordered_map<const IR::INode*, instr_streams_t> streams;
 
+		//what didn't have to be emitted because structurally identical IR subtrees (same parameters and textures) got compiled once
+		struct SDeduplicationStatistics
+		{
+			//IR nodes (including backend's temporary ones) found identical to a node seen before
+			uint32_t nodes = 0u;
+			//roots sharing all instruction streams of an identical root compiled before
+			uint32_t roots = 0u;
+			uint32_t instructions = 0u;
+			uint32_t prefetchInstructions = 0u;
+			uint32_t bsdfDataEntries = 0u;
+
+			inline size_t getByteSize() const
+			{
+				return instructions*sizeof(instr_stream::instr_t)+prefetchInstructions*sizeof(instr_stream::tex_prefetch::prefetch_instr_t)+bsdfDataEntries*sizeof(instr_stream::SBSDFUnion);
+			}
+		} deduplicated;
+
 		//has to go after #version and before required user-provided descriptors and functions
 		std::string fragmentShaderSource_declarations;
 		//has to go after required user-provided descriptors and functions and before the rest of shader (especially entry point function)
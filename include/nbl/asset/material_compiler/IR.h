@@ -9,7 +9,6 @@
 #include <nbl/core/containers/refctd_dynamic_array.h>
 #include <nbl/asset/ICPUImageView.h>
 #include <nbl/asset/ICPUSampler.h>
-#include <nbl/core/alloc/LinearAddressAllocator.h>
 
 namespace nbl {
 namespace asset {
@@ -18,93 +17,90 @@ namespace material_compiler
 
 class IR : public core::IReferenceCounted
 {
+    //! Chunked arena, chunks never move so node pointers stay valid no matter how big the IR grows.
+    //! Nodes are addressed by offsets (`handle_t`) from the start of the first chunk as if all chunks were one contiguous block.
     class SBackingMemManager
     {
-        _NBL_STATIC_INLINE_CONSTEXPR size_t INITIAL_MEM_SIZE = 1ull<<20;
-        _NBL_STATIC_INLINE_CONSTEXPR size_t MAX_MEM_SIZE = 1ull<<20;
-        _NBL_STATIC_INLINE_CONSTEXPR size_t ALIGNMENT = _NBL_SIMD_ALIGNMENT;
+        _NBL_STATIC_INLINE_CONSTEXPR uint32_t CHUNK_SIZE_LOG2 = 20u;
+        _NBL_STATIC_INLINE_CONSTEXPR uint32_t CHUNK_SIZE = 1u<<CHUNK_SIZE_LOG2;
+        _NBL_STATIC_INLINE_CONSTEXPR uint32_t ALIGNMENT = _NBL_SIMD_ALIGNMENT;
 
-        uint8_t* mem;
-        size_t currSz;
-        using addr_alctr_t = core::LinearAddressAllocator<uint32_t>;
-        addr_alctr_t addrAlctr;
+        core::vector<uint8_t*> chunks;
+        uint32_t cursor;
 
     public:
-        SBackingMemManager() : mem(nullptr), currSz(INITIAL_MEM_SIZE), addrAlctr(nullptr, 0u, 0u, ALIGNMENT, MAX_MEM_SIZE) {
-            mem = reinterpret_cast<uint8_t*>(_NBL_ALIGNED_MALLOC(currSz, ALIGNMENT));
-        }
+        using handle_t = uint32_t;
+        _NBL_STATIC_INLINE_CONSTEXPR handle_t invalid_handle = ~0u;
+
+        SBackingMemManager() : cursor(0u) {}
+        SBackingMemManager(const SBackingMemManager&) = delete;
+        SBackingMemManager& operator=(const SBackingMemManager&) = delete;
         ~SBackingMemManager() {
-            _NBL_ALIGNED_FREE(mem);
+            for (auto* chunk : chunks)
+                _NBL_ALIGNED_FREE(chunk);
         }
 
-        uint8_t* alloc(size_t bytes)
+        handle_t alloc(size_t bytes)
         {
-            auto addr = addrAlctr.alloc_addr(bytes, ALIGNMENT);
-            assert(addr != addr_alctr_t::invalid_address);
-            //TODO reallocation will invalidate all pointers to nodes, so...
-            //1) never reallocate (just have reasonably big buffer for nodes)
-            //2) make some node_handle class that will work as pointer but is based on offset instead of actual address
-            if (addr+bytes > currSz) {
-                size_t newSz = currSz<<1;
-                if (newSz > MAX_MEM_SIZE) {
-                    addrAlctr.free_addr(addr, bytes);
-                    return nullptr;
-                }
-
-                void* newMem = _NBL_ALIGNED_MALLOC(newSz, ALIGNMENT);
-                memcpy(newMem, mem, currSz);
-                _NBL_ALIGNED_FREE(mem);
-                mem = reinterpret_cast<uint8_t*>(newMem);
-                currSz = newSz;
-            }
+            assert(bytes <= CHUNK_SIZE);
+            handle_t addr = core::roundUp(cursor, ALIGNMENT);
+            // allocations never straddle two chunks
+            if ((addr&(CHUNK_SIZE-1u))+bytes > CHUNK_SIZE)
+                addr = core::roundUp(addr, CHUNK_SIZE);
+            if (uint64_t(addr)+bytes >= uint64_t(invalid_handle))
+                return invalid_handle;
+
+            // chunks stay around after `freeLastAllocatedBytes`, so only allocate when we really go past the end
+            const uint32_t chunkIx = addr>>CHUNK_SIZE_LOG2;
+            while (chunks.size() <= chunkIx)
+                chunks.push_back(reinterpret_cast<uint8_t*>(_NBL_ALIGNED_MALLOC(CHUNK_SIZE, ALIGNMENT)));
+
+            cursor = addr+static_cast<uint32_t>(bytes);
+            return addr;
+        }
 
-            return mem+addr;
+        inline uint8_t* getPtr(handle_t _handle) const
+        {
+            return chunks[_handle>>CHUNK_SIZE_LOG2]+(_handle&(CHUNK_SIZE-1u));
         }
 
         uint32_t getAllocatedSize() const
         {
-            return addrAlctr.get_allocated_size();
+            return cursor;
         }
 
         void freeLastAllocatedBytes(uint32_t _bytes)
         {
-            assert(addrAlctr.get_allocated_size() >= _bytes);
-            const uint32_t newCursor = addrAlctr.get_allocated_size() - _bytes;
-            addrAlctr.reset(newCursor);
+            assert(cursor >= _bytes);
+            cursor -= _bytes;
         }
     };
 
 protected:
     ~IR()
     {
-        //call destructors on all nodes
-        for (auto* root : roots)
+        //call destructors on all nodes, `nodes` is in allocation order so this walks the chunks front to back
+        for (auto handle : nodes)
         {
-            core::stack<decltype(root)> s;
-            s.push(root);
-            while (!s.empty())
-            {
-                auto* n = s.top();
-                s.pop();
-                for (auto* c : n->children)
-                    s.push(c);
-
-                if (!n->deinited) {
-                    n->~INode();
-                    n->deinited = true;
-                }
-            }
+            auto* n = getNode(handle);
+            if (!n->deinited)
+                n->~INode();
         }
     }
 
     template <typename NodeType, typename ...Args>
     NodeType* allocNode_impl(Args&& ...args)
     {
-        uint8_t* ptr = memMgr.alloc(sizeof(NodeType));
-        return new (ptr) NodeType(std::forward<Args>(args)...);
+        const auto handle = memMgr.alloc(sizeof(NodeType));
+        if (handle == SBackingMemManager::invalid_handle)
+            return nullptr;
+        nodes.push_back(handle);
+        return new (memMgr.getPtr(handle)) NodeType(std::forward<Args>(args)...);
     }
 
 public:
+    using node_handle_t = SBackingMemManager::handle_t;
+
     IR() : memMgr() {}
 
     struct INode;
@@ -112,12 +108,23 @@ public:
     void deinitTmpNodes()
     {
         for (INode* n : tmp)
+        {
             n->~INode();
+            n->deinited = true;
+        }
         tmp.clear();
         memMgr.freeLastAllocatedBytes(tmpSize);
+        // forget nodes whose memory got given back
+        while (!nodes.empty() && nodes.back() >= memMgr.getAllocatedSize())
+            nodes.pop_back();
         tmpSize = 0u;
     }
 
+    inline INode* getNode(node_handle_t _handle) { return reinterpret_cast<INode*>(memMgr.getPtr(_handle)); }
+    inline const INode* getNode(node_handle_t _handle) const { return reinterpret_cast<const INode*>(memMgr.getPtr(_handle)); }
+    //! Every node allocated from this IR and not given back yet, in allocation order
+    inline const core::vector<node_handle_t>& getNodeHandles() const { return nodes; }
+
     void addRootNode(INode* node)
     {
         roots.push_back(node);
@@ -613,6 +620,7 @@ public:
     };
 
     SBackingMemManager memMgr;
+    core::vector<node_handle_t> nodes;
     core::vector<INode*> roots;
 
     core::vector<INode*> tmp;
@@ -0,0 +1,126 @@
+// Copyright (C) 2018-2021 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_ASSET_C_ASSET_DEDUPLICATOR_H_INCLUDED__
+#define __NBL_ASSET_C_ASSET_DEDUPLICATOR_H_INCLUDED__
+
+#include "nbl/core/core.h"
+
+#include "nbl/asset/ICPUMesh.h"
+#include "nbl/asset/ICPUImageView.h"
+
+namespace nbl
+{
+namespace asset
+{
+
+//! Makes assets with identical contents share one instance, regardless of the path they were loaded from
+/**
+	Buffers are compared by their bytes, images by their creation parameters, regions and buffer contents,
+	image views and mesh buffers by their parameters and the (already deduplicated) assets they reference.
+	Pipelines, descriptor sets and skeletons are compared by pointer, they're not deduplicated themselves.
+
+	Every asset which survives deduplication is kept alive by the deduplicator so later duplicates can be matched
+	against it, call `clear()` to let go of them. Assets which are not mutable are never modified, but may still be
+	replaced by their canonical instance wherever they're referenced from a mutable asset.
+
+	Not thread-safe, IAssetManager serializes the access to the one it owns.
+*/
+class CAssetDeduplicator : public core::IReferenceCounted
+{
+	public:
+		using hash_t = std::array<uint64_t,4u>;
+
+		struct SStatistics
+		{
+			uint64_t buffersDeduplicated = 0ull;
+			uint64_t imagesDeduplicated = 0ull;
+			uint64_t imageViewsDeduplicated = 0ull;
+			uint64_t meshBuffersDeduplicated = 0ull;
+			//! Bytes of buffer data which turned out to be a copy of another buffer, freed once nothing references the copies anymore
+			uint64_t bytesSaved = 0ull;
+
+			inline SStatistics& operator+=(const SStatistics& other)
+			{
+				buffersDeduplicated += other.buffersDeduplicated;
+				imagesDeduplicated += other.imagesDeduplicated;
+				imageViewsDeduplicated += other.imageViewsDeduplicated;
+				meshBuffersDeduplicated += other.meshBuffersDeduplicated;
+				bytesSaved += other.bytesSaved;
+				return *this;
+			}
+		};
+
+		CAssetDeduplicator() = default;
+
+		//! Content hashes, equal assets always hash the same no matter which instances of other assets they reference
+		static hash_t hash(const ICPUBuffer* buffer);
+		static hash_t hash(const ICPUImage* image);
+		static hash_t hash(const ICPUMeshBuffer* meshbuffer);
+
+		//! @returns the canonical instance of an asset with the same contents, `_asset` itself if it's the first of its kind
+		/** Only buffers, images, image views and mesh buffers can be replaced, other types only get their contents deduplicated.
+		Dummy assets (converted to empty cache handles) are returned as-is. */
+		core::smart_refctd_ptr<IAsset> deduplicate(core::smart_refctd_ptr<IAsset>&& _asset);
+
+		//! Replaces the assets referenced by `_asset` with their canonical instances, but never `_asset` itself
+		/** Use this when `_asset` must keep its identity, for example because metadata is attached to it. */
+		void deduplicateContents(IAsset* _asset);
+
+		//! Counts of everything deduplicated since construction or the last `clear()`
+		inline const SStatistics& getStatistics() const { return m_stats; }
+
+		//! Forgets all canonical assets and resets the statistics
+		void clear();
+
+	protected:
+		virtual ~CAssetDeduplicator() = default;
+
+	private:
+		template<class AssetType>
+		struct SKeyedEntry
+		{
+			core::vector<uint8_t> key;
+			core::smart_refctd_ptr<AssetType> asset;
+		};
+		template<class AssetType>
+		using keyed_storage_t = core::unordered_multimap<uint64_t,SKeyedEntry<AssetType>>;
+
+		core::smart_refctd_ptr<IAsset> deduplicate_impl(IAsset* _asset);
+		void deduplicateContents_impl(IAsset* _asset);
+
+		core::smart_refctd_ptr<ICPUBuffer> deduplicate_impl(ICPUBuffer* _buffer);
+		core::smart_refctd_ptr<ICPUImage> deduplicate_impl(ICPUImage* _image);
+		core::smart_refctd_ptr<ICPUImageView> deduplicate_impl(ICPUImageView* _view);
+		core::smart_refctd_ptr<ICPUMeshBuffer> deduplicate_impl(ICPUMeshBuffer* _meshbuffer);
+
+		void deduplicateContents_impl(ICPUImage* _image);
+		void deduplicateContents_impl(ICPUDescriptorSet* _ds);
+		void deduplicateContents_impl(ICPUMeshBuffer* _meshbuffer);
+		void deduplicateContents_impl(ICPUMesh* _mesh);
+
+		template<class AssetType>
+		core::smart_refctd_ptr<AssetType> findOrInsert(keyed_storage_t<AssetType>& storage, core::vector<uint8_t>&& key, AssetType* _asset);
+
+		//! Canonical assets, kept alive so later duplicates can be matched against them
+		core::unordered_multimap<uint64_t,core::smart_refctd_ptr<ICPUBuffer>> m_buffers;
+		keyed_storage_t<ICPUImage> m_images;
+		keyed_storage_t<ICPUImageView> m_imageViews;
+		keyed_storage_t<ICPUMeshBuffer> m_meshBuffers;
+		core::unordered_set<const IAsset*> m_canonical;
+		//! Duplicates already resolved during the current call, they're held so their addresses can't get reused before the call ends
+		struct SResolved
+		{
+			core::smart_refctd_ptr<IAsset> duplicate;
+			core::smart_refctd_ptr<IAsset> canonical;
+		};
+		core::unordered_map<const IAsset*,SResolved> m_resolved;
+
+		SStatistics m_stats;
+};
+
+}
+}
+
+#endif
@@ -403,13 +403,13 @@ IMeshPackerBase::PackedMeshBufferData CCPUMeshPackerV1<MDIStructType>::commit(co
 	size_t batchFirstIdx = ramb.indexAllocationOffset;
 	size_t batchBaseVtx = ramb.vertexAllocationOffset;
 
+	core::vector<TriangleBatches> allTriangleBatches = constructTriangleBatches(mbBegin, mbEnd);
+	auto triangleBatchesIt = allTriangleBatches.begin();
 	for (auto it = mbBegin; it != mbEnd; it++)
 	{
 		const auto mbPrimitiveType = (*it)->getPipeline()->getPrimitiveAssemblyParams().primitiveType;
 
-		IdxBufferParams idxBufferParams = retriveOrCreateNewIdxBufferParams(*it);
-
-		TriangleBatches triangleBatches = constructTriangleBatches(*it, idxBufferParams);
+		TriangleBatches& triangleBatches = *(triangleBatchesIt++);
 		const auto& mbVtxInputParams = (*it)->getPipeline()->getVertexInputParams();
 
 		const uint32_t batchCnt = triangleBatches.ranges.size() - 1u;
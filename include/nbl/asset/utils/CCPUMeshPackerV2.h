@@ -77,6 +77,8 @@ uint32_t CCPUMeshPackerV2<MDIStructType>::commit(IMeshPackerBase::PackedMeshBuff
 {
     MDIStructType* mdiBuffPtr = static_cast<MDIStructType*>(m_packerDataStore.MDIDataBuffer->getPointer()) + rambIn->mdiAllocationOffset;
 
+    core::vector<TriangleBatches> allTriangleBatches = constructTriangleBatches(mbBegin, mbEnd);
+
     size_t i = 0ull;
     uint32_t batchCntTotal = 0u;
     for (auto it = mbBegin; it != mbEnd; it++)
@@ -93,9 +95,7 @@ uint32_t CCPUMeshPackerV2<MDIStructType>::commit(IMeshPackerBase::PackedMeshBuff
         const auto& mbVtxInputParams = (*it)->getPipeline()->getVertexInputParams();
         const uint32_t insCnt = (*it)->getInstanceCount();
 
-        IdxBufferParams idxBufferParams = retriveOrCreateNewIdxBufferParams(*it);
-
-        TriangleBatches triangleBatches = constructTriangleBatches(*it, idxBufferParams);
+        TriangleBatches& triangleBatches = allTriangleBatches[i];
 
         size_t batchFirstIdx = ramb.indexAllocationOffset;
         size_t verticesAddedCnt = 0u;
@@ -367,8 +367,12 @@ class IMeshManipulator : public virtual core::IReferenceCounted
 			const bool computeJointAABBs = outJointAABBs&&meshbuffer->isSkinned();
 			const auto* skeleton = meshbuffer->getSkeleton();
 			if (computeJointAABBs)
-			for (auto i=0u; i<meshbuffer->getSkeleton()->getJointCount(); i++)
-				outJointAABBs[i] = aabb;
+			{
+				for (auto i=0u; i<meshbuffer->getSkeleton()->getJointCount(); i++)
+					outJointAABBs[i] = aabb;
+			}
+			else if (calculatePositionBoundingBox(meshbuffer,aabb))
+				return aabb;
 
 			auto impl = [meshbuffer,&aabb,skeleton](const auto* indexPtr, auto* jointAABBs) -> void
 			{
@@ -441,6 +445,60 @@ class IMeshManipulator : public virtual core::IReferenceCounted
 			return aabb;
 		}
 
+		//! Bounding box of the positions alone, ignoring skinning. Decodes positions in batches instead of one by one
+		/** Indexed meshbuffers only take referenced vertices into account. Returns false without touching `aabb` if not all positions could be decoded.*/
+		static inline bool calculatePositionBoundingBox(const ICPUMeshBuffer* meshbuffer, core::aabbox3df& aabb)
+		{
+			const uint32_t vertexCount = upperBoundVertexID(meshbuffer);
+			const auto posAttrId = meshbuffer->getPositionAttributeIx();
+
+			core::vector<uint8_t> referenced;
+			auto markReferenced = [meshbuffer,&referenced,vertexCount](const auto* indexPtr) -> void
+			{
+				referenced.resize(vertexCount,0u);
+				for (uint32_t j=0u; j<meshbuffer->getIndexCount(); j++)
+					referenced[indexPtr[j]] = 1u;
+			};
+			switch (meshbuffer->getIndexType())
+			{
+				case EIT_32BIT:
+					markReferenced(reinterpret_cast<const uint32_t*>(meshbuffer->getIndices()));
+					break;
+				case EIT_16BIT:
+					markReferenced(reinterpret_cast<const uint16_t*>(meshbuffer->getIndices()));
+					break;
+				default:
+					break;
+			}
+
+			constexpr uint32_t BatchSize = 1024u;
+			float positions[3][BatchSize];
+			float* const output[4] = {positions[0],positions[1],positions[2],nullptr};
+			core::vectorSIMDf minEdge(FLT_MAX), maxEdge(-FLT_MAX);
+			for (uint32_t first=0u; first<vertexCount; first+=BatchSize)
+			{
+				const uint32_t count = core::min(vertexCount-first,BatchSize);
+				if (meshbuffer->getAttributeRange(output,posAttrId,first,count)!=count)
+					return false;
+
+				for (uint32_t i=0u; i<count; i++)
+				{
+					if (!referenced.empty() && !referenced[first+i])
+						continue;
+					const core::vectorSIMDf pos(positions[0][i],positions[1][i],positions[2][i]);
+					minEdge = core::min(minEdge,pos);
+					maxEdge = core::max(maxEdge,pos);
+				}
+			}
+
+			if (vertexCount)
+			{
+				aabb.MinEdge = minEdge.getAsVector3df();
+				aabb.MaxEdge = maxEdge.getAsVector3df();
+			}
+			return true;
+		}
+
 		//! Recalculates the cached bounding box of the meshbuffer
 		static inline void recalculateBoundingBox(ICPUMeshBuffer* meshbuffer)
 		{
@@ -469,7 +527,9 @@ class IMeshManipulator : public virtual core::IReferenceCounted
 				});
 
 		//! Creates a copy of a mesh with vertices welded
-		/** \param mesh Input mesh
+		/** Every vertex gets redirected to the lowest-indexed vertex equal to it within `errMetrics`,
+		candidates are found with a spatial hash grid over the positions so this runs in O(n) on average.
+		\param mesh Input mesh
         \param errMetrics Array of size EVAI_COUNT. Describes error metric for each vertex attribute (used if attribute is of floating point or normalized type).
 		\param tolerance The threshold for vertex comparisons.
 		\return Mesh without redundant vertices. */
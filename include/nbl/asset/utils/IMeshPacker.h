@@ -5,6 +5,9 @@
 #ifndef __NBL_ASSET_I_MESH_PACKER_H_INCLUDED__
 #define __NBL_ASSET_I_MESH_PACKER_H_INCLUDED__
 
+#include <execution>
+
+#include "nbl/core/math/morton.h"
 #include "nbl/asset/utils/IMeshManipulator.h"
 
 namespace nbl
@@ -203,6 +206,22 @@ protected:
     //TODO: functions: constructTriangleBatches, convertIdxBufferToTriangles, deinterleaveAndCopyAttribute and deinterleaveAndCopyPerInstanceAttribute
     //will not work with IGPUMeshBuffer as MeshBufferType, move it to new `ICPUMeshPacker`
 
+    //! Every mesh buffer gets its batches built independently, so they're built in parallel
+    template <typename MeshBufferIterator>
+    core::vector<TriangleBatches> constructTriangleBatches(const MeshBufferIterator mbBegin, const MeshBufferIterator mbEnd)
+    {
+        core::vector<MeshBufferType*> meshBuffers;
+        for (auto it = mbBegin; it != mbEnd; it++)
+            meshBuffers.push_back(*it);
+
+        core::vector<TriangleBatches> triangleBatches(meshBuffers.size(), TriangleBatches(0u));
+        std::transform(std::execution::par, meshBuffers.begin(), meshBuffers.end(), triangleBatches.begin(), [this](MeshBufferType* meshBuffer) -> TriangleBatches
+        {
+            return constructTriangleBatches(meshBuffer, retriveOrCreateNewIdxBufferParams(meshBuffer));
+        });
+        return triangleBatches;
+    }
+
     TriangleBatches constructTriangleBatches(const MeshBufferType* meshBuffer, IdxBufferParams idxBufferParams) const
     {
         uint32_t triCnt;
@@ -212,49 +231,10 @@ protected:
         const uint32_t batchCnt = calcBatchCountBound(triCnt);
         assert(batchCnt != 0u);
 
-        struct MortonTriangle
-        {
-            MortonTriangle() = default;
-
-            MortonTriangle(uint16_t fixedPointPos[3], float area)
-            {
-                auto tmp = reinterpret_cast<uint16_t*>(key);
-                std::copy_n(fixedPointPos,3u,tmp);
-                tmp[3] = core::Float16Compressor::compress(area);
-            }
-
-            void complete(float maxArea)
-            {
-                auto tmp = reinterpret_cast<const uint16_t*>(key);
-                const float area = core::Float16Compressor::decompress(tmp[3]);
-                const float scale = 0.5f; // square root
-                uint16_t logRelArea = uint16_t(65535.5f+core::clamp(scale*std::log2f(area/maxArea),-65535.5f,0.f));
-                key = core::morton4d_encode(tmp[0],tmp[1],tmp[2],logRelArea);
-            }
-
-            uint64_t key;
-        };
-        
-
-        //TODO: use SoA instead (with core::radix_sort):
-        //core::vector<Triangle> triangles;
-        //core::vector<MortonTriangle> triangleMortonCodes;
-        //where `triangles` is member of `TriangleBatch` struct
-        struct TriangleMortonCodePair
-        {
-            Triangle triangle;
-            MortonTriangle mortonCode;
-
-            inline bool operator<(const TriangleMortonCodePair& other)
-            {
-                return this->mortonCode.key < other.mortonCode.key;
-            }
-        };
-
         TriangleBatches triangleBatches(triCnt);
-        core::vector<TriangleMortonCodePair> triangles(triCnt); //#1
 
-        //triangle reordering
+        //triangle reordering, nothing to reorder (or take the max area of) for meshbuffers without triangles
+        if (triCnt != 0u)
         {
             //this is needed for mesh buffers with no index buffer (triangle strips and triagnle fans)
             //TODO: fix
@@ -267,49 +247,53 @@ protected:
             //}
 
             const core::aabbox3df aabb = IMeshManipulator::calculateBoundingBox(meshBuffer);
-
-            uint32_t ix = 0u;
-            float maxTriangleArea = 0.0f;
-            for (auto it = triangles.begin(); it != triangles.end(); it++)
+            const core::vectorSIMDf aabbMin(aabb.MinEdge.X, aabb.MinEdge.Y, aabb.MinEdge.Z);
+            const auto extent = aabb.getExtent();
+            // flat meshes have a zero extent along some axis
+            auto fixedPointScale = [](float extent) -> float { return extent > 0.f ? 65535.5f / extent : 0.f; };
+            const core::vectorSIMDf toFixedPoint(fixedPointScale(extent.X), fixedPointScale(extent.Y), fixedPointScale(extent.Z));
+
+            // SoA so that the keys get sorted together with the triangles, instead of triangles being interleaved with their keys
+            core::vector<Triangle> unsortedTriangles(triCnt);
+            core::vector<uint64_t> mortonKeys(triCnt*2u);
+            core::vector<float> areas(triCnt);
+
+            std::for_each(std::execution::par, unsortedTriangles.begin(), unsortedTriangles.end(), [&](Triangle& triangle) -> void
             {
-                auto triangleIndices = IMeshManipulator::getTriangleIndices(meshBuffer, ix++);
-                //have to copy there
-                std::copy(triangleIndices.begin(), triangleIndices.end(), it->triangle.oldIndices);
+                const uint32_t ix = &triangle - unsortedTriangles.data();
+                auto triangleIndices = IMeshManipulator::getTriangleIndices(meshBuffer, ix);
+                std::copy(triangleIndices.begin(), triangleIndices.end(), triangle.oldIndices);
 
                 core::vectorSIMDf trianglePos[3];
-                trianglePos[0] = meshBuffer->getPosition(it->triangle.oldIndices[0]);
-                trianglePos[1] = meshBuffer->getPosition(it->triangle.oldIndices[1]);
-                trianglePos[2] = meshBuffer->getPosition(it->triangle.oldIndices[2]);
+                trianglePos[0] = meshBuffer->getPosition(triangle.oldIndices[0]);
+                trianglePos[1] = meshBuffer->getPosition(triangle.oldIndices[1]);
+                trianglePos[2] = meshBuffer->getPosition(triangle.oldIndices[2]);
 
-                const core::vectorSIMDf centroid = ((trianglePos[0] + trianglePos[1] + trianglePos[2]) / 3.0f) - core::vectorSIMDf(aabb.MinEdge.X, aabb.MinEdge.Y, aabb.MinEdge.Z);
-                uint16_t fixedPointPos[3];
-                fixedPointPos[0] = uint16_t(centroid.x * 65535.5f / aabb.getExtent().X);
-                fixedPointPos[1] = uint16_t(centroid.y * 65535.5f / aabb.getExtent().Y);
-                fixedPointPos[2] = uint16_t(centroid.z * 65535.5f / aabb.getExtent().Z);
+                const core::vectorSIMDf centroid = (trianglePos[0] + trianglePos[1] + trianglePos[2]) / 3.0f;
+                const core::vectorSIMDf fixedPointPos = core::min(core::max((centroid - aabbMin) * toFixedPoint, core::vectorSIMDf(0.f)), core::vectorSIMDf(65535.f));
+                // the fixed point position waits in the key until the max area is known
+                mortonKeys[ix] = uint64_t(fixedPointPos.x) | (uint64_t(fixedPointPos.y) << 16ull) | (uint64_t(fixedPointPos.z) << 32ull);
+                areas[ix] = core::length(core::cross(trianglePos[1] - trianglePos[0], trianglePos[2] - trianglePos[0]))[0];
+            });
 
-                float area = core::cross(trianglePos[1] - trianglePos[0], trianglePos[2] - trianglePos[0]).x;
-                it->mortonCode = MortonTriangle(fixedPointPos, area);
-
-                if (area > maxTriangleArea)
-                    maxTriangleArea = area;
-            }
+            //complete morton code
+            const float maxTriangleArea = *std::max_element(std::execution::par_unseq, areas.begin(), areas.end());
+            std::transform(std::execution::par_unseq, mortonKeys.begin(), mortonKeys.begin()+triCnt, areas.begin(), mortonKeys.begin(), [maxTriangleArea](const uint64_t fixedPointPos, const float area) -> uint64_t
+            {
+                const float scale = 0.5f; // square root
+                const uint16_t logRelArea = maxTriangleArea > 0.f ? uint16_t(65535.5f + core::clamp(scale * std::log2f(area / maxTriangleArea), -65535.5f, 0.f)) : 0u;
+                return core::morton4d_encode<uint64_t>(fixedPointPos & 0xffffull, (fixedPointPos >> 16ull) & 0xffffull, fixedPointPos >> 32ull, logRelArea);
+            });
 
             /*if (wasTmpIdxBufferSet)
                 meshBuffer->setIndexBufferBinding(nullptr);*/
 
-            //complete morton code
-            for (auto it = triangles.begin(); it != triangles.end(); it++)
-                it->mortonCode.complete(maxTriangleArea);
-
-            std::sort(triangles.begin(), triangles.end());
+            // the output triangle array doubles as the scratch for the triangles being sorted
+            const Triangle* sortedTriangles = core::radix_sort(mortonKeys.data(), mortonKeys.data()+triCnt, unsortedTriangles.data(), triangleBatches.triangles.data(), triCnt).second;
+            if (sortedTriangles != triangleBatches.triangles.data())
+                triangleBatches.triangles = std::move(unsortedTriangles);
         }
 
-        //copying, after radix_sort this will be removed
-        //TODO durning radix_sort integration:
-        //since there will be distinct arrays for triangles and their morton code use `triangleBatches.triangles` instead of #1
-        for (uint32_t i = 0u; i < triCnt; i++)
-            triangleBatches.triangles[i] = triangles[i].triangle;
-
         //set ranges
         Triangle* triangleArrayBegin = triangleBatches.triangles.data();
         Triangle* triangleArrayEnd = triangleArrayBegin + triangleBatches.triangles.size();
@@ -7,8 +7,14 @@
 
 #include <algorithm>
 #include <bitset>
+#include <cassert>
 #include <cstdint>
+#include <execution>
+#include <iterator>
 #include <numeric>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "nbl/macros.h"
 
@@ -45,10 +51,13 @@ constexpr int8_t find_msb(const T& a_variable)
     {
         if (variable_bitset[msb] == 1)
             return msb;
-    }        
+    }
     return -1;
 }
 
+//! Stands in for the value iterator when only keys get sorted
+struct NoValues {};
+
 template<size_t key_bit_count, typename histogram_t>
 struct RadixSorter
 {
@@ -57,63 +66,171 @@ struct RadixSorter
 		_NBL_STATIC_INLINE_CONSTEXPR uint8_t radix_bits = find_msb(histogram_size);
 		_NBL_STATIC_INLINE_CONSTEXPR size_t last_pass = (key_bit_count-1ull)/size_t(radix_bits);
 		_NBL_STATIC_INLINE_CONSTEXPR uint16_t radix_mask = (1u<<radix_bits)-1u;
+		//! Below this many elements per thread, spinning up the threads costs more than it saves
+		_NBL_STATIC_INLINE_CONSTEXPR size_t min_block_size = 0x1ull<<15ull;
 
-		template<class RandomIt, class KeyAccessor>
-		inline RandomIt operator()(RandomIt input, RandomIt output, const histogram_t rangeSize, const KeyAccessor& comp)
+		//! @returns where the sorted keys (and values) ended up, the inputs or the outputs
+		template<class KeyIt, class ValueIt, class KeyAccessor>
+		inline std::pair<KeyIt,ValueIt> operator()(KeyIt input, KeyIt output, ValueIt valuesIn, ValueIt valuesOut, const histogram_t rangeSize, const KeyAccessor& comp)
 		{
-			return pass<RandomIt,KeyAccessor,0ull>(input,output,rangeSize,comp);
+			const size_t threadCount = std::max(std::thread::hardware_concurrency(),1u);
+			blockCount = std::min<size_t>(rangeSize/min_block_size,threadCount);
+			if (blockCount>1u)
+			{
+				blockSize = (size_t(rangeSize)-1ull)/blockCount+1ull;
+				blockHistograms.resize(blockCount*histogram_size);
+				blockIndices.resize(blockCount);
+				std::iota(blockIndices.begin(),blockIndices.end(),0u);
+			}
+
+			passes(input,output,valuesIn,valuesOut,rangeSize,comp,std::make_index_sequence<last_pass+1ull>());
+			return {input,valuesIn};
 		}
 	private:
-		template<class RandomIt, class KeyAccessor, size_t pass_ix>
-		inline RandomIt pass(RandomIt input, RandomIt output, const histogram_t rangeSize, const KeyAccessor& comp)
+		template<class KeyIt, class ValueIt, class KeyAccessor, size_t... pass_ixs>
+		inline void passes(KeyIt& input, KeyIt& output, ValueIt& valuesIn, ValueIt& valuesOut, const histogram_t rangeSize, const KeyAccessor& comp, std::index_sequence<pass_ixs...>)
+		{
+			auto doPass = [&](auto pass_ix) -> void
+			{
+				const bool scattered = blockCount>1u ?
+					parallelPass<decltype(pass_ix)::value>(input,output,valuesIn,valuesOut,rangeSize,comp):
+					pass<decltype(pass_ix)::value>(input,output,valuesIn,valuesOut,rangeSize,comp);
+				if (!scattered)
+					return;
+				std::swap(input,output);
+				std::swap(valuesIn,valuesOut);
+			};
+			(doPass(std::integral_constant<size_t,pass_ixs>()),...);
+		}
+
+		template<class KeyIt, class ValueIt>
+		static inline void move(KeyIt input, KeyIt output, ValueIt valuesIn, ValueIt valuesOut, const size_t inIx, const size_t outIx)
+		{
+			output[outIx] = std::move(input[inIx]);
+			if constexpr (!std::is_same_v<ValueIt,NoValues>)
+				valuesOut[outIx] = std::move(valuesIn[inIx]);
+		}
+
+		//! @returns false if every key had the same digit, in which case nothing got moved
+		template<size_t pass_ix, class KeyIt, class ValueIt, class KeyAccessor>
+		inline bool pass(KeyIt input, KeyIt output, ValueIt valuesIn, ValueIt valuesOut, const histogram_t rangeSize, const KeyAccessor& comp)
 		{
 			// clear
 			std::fill_n(histogram,histogram_size,static_cast<histogram_t>(0u));
 			// count
 			constexpr histogram_t shift = static_cast<histogram_t>(radix_bits*pass_ix);
 			for (histogram_t i=0u; i<rangeSize; i++)
-				++histogram[comp.operator()<shift,radix_mask>(input[i])];
+				++histogram[comp.template operator()<shift,radix_mask>(input[i])];
+			if (histogram[comp.template operator()<shift,radix_mask>(input[0])]==rangeSize)
+				return false;
 			// prefix sum
 			std::inclusive_scan(histogram,histogram+histogram_size,histogram);
 			// scatter
 			for (histogram_t i=rangeSize; i!=0u;)
 			{
 				i--;
-				output[--histogram[comp.operator()<shift,radix_mask>(input[i])]] = input[i];
+				move(input,output,valuesIn,valuesOut,i,--histogram[comp.template operator()<shift,radix_mask>(input[i])]);
+			}
+			return true;
+		}
+
+		//! Every block counts and then scatters its own slice, the offsets of a digit's bucket go block after block so the sort stays stable
+		template<size_t pass_ix, class KeyIt, class ValueIt, class KeyAccessor>
+		inline bool parallelPass(KeyIt input, KeyIt output, ValueIt valuesIn, ValueIt valuesOut, const histogram_t rangeSize, const KeyAccessor& comp)
+		{
+			constexpr histogram_t shift = static_cast<histogram_t>(radix_bits*pass_ix);
+			std::for_each(std::execution::par,blockIndices.begin(),blockIndices.end(),[&](const uint32_t block) -> void
+			{
+				histogram_t* blockHistogram = blockHistograms.data()+block*histogram_size;
+				std::fill_n(blockHistogram,histogram_size,static_cast<histogram_t>(0u));
+				const size_t end = std::min<size_t>((block+1ull)*blockSize,rangeSize);
+				for (size_t i=block*blockSize; i<end; i++)
+					++blockHistogram[comp.template operator()<shift,radix_mask>(input[i])];
+			});
+
+			const auto firstDigit = comp.template operator()<shift,radix_mask>(input[0]);
+			histogram_t firstDigitCount = 0u;
+			for (size_t block=0u; block<blockCount; block++)
+				firstDigitCount += blockHistograms[block*histogram_size+firstDigit];
+			if (firstDigitCount==rangeSize)
+				return false;
+			// exclusive prefix sum over (digit,block) pairs
+			histogram_t offset = 0u;
+			for (size_t digit=0u; digit<histogram_size; digit++)
+			for (size_t block=0u; block<blockCount; block++)
+			{
+				histogram_t& count = blockHistograms[block*histogram_size+digit];
+				const histogram_t blockOffset = offset;
+				offset += count;
+				count = blockOffset;
 			}
 
-			if constexpr (pass_ix != last_pass)
-				return pass<RandomIt,KeyAccessor,pass_ix+1ull>(output,input,rangeSize,comp);
-			else
-				return output;
+			std::for_each(std::execution::par,blockIndices.begin(),blockIndices.end(),[&](const uint32_t block) -> void
+			{
+				histogram_t* blockOffsets = blockHistograms.data()+block*histogram_size;
+				const size_t end = std::min<size_t>((block+1ull)*blockSize,rangeSize);
+				for (size_t i=block*blockSize; i<end; i++)
+					move(input,output,valuesIn,valuesOut,i,blockOffsets[comp.template operator()<shift,radix_mask>(input[i])]++);
+			});
+			return true;
 		}
-	
+
 		alignas(sizeof(histogram_t)) histogram_t histogram[histogram_size];
+		size_t blockCount = 1u;
+		size_t blockSize = 0u;
+		std::vector<histogram_t> blockHistograms;
+		std::vector<uint32_t> blockIndices;
 };
 
-}
-
-template<class RandomIt, class KeyAccessor>
-inline RandomIt radix_sort(RandomIt input, RandomIt scratch, const size_t rangeSize, const KeyAccessor& comp)
+template<class KeyIt, class ValueIt, class KeyAccessor>
+inline std::pair<KeyIt,ValueIt> dispatch_radix_sort(KeyIt input, KeyIt scratch, ValueIt values, ValueIt valuesScratch, const size_t rangeSize, const KeyAccessor& comp)
 {
 	assert(std::abs(std::distance(input,scratch))>=rangeSize);
+	if (rangeSize==0ull)
+		return {input,values};
 
 	if (rangeSize<static_cast<decltype(rangeSize)>(0x1ull<<16ull))
-		return impl::RadixSorter<KeyAccessor::key_bit_count,uint16_t>()(input,scratch,static_cast<uint16_t>(rangeSize),comp);
+		return impl::RadixSorter<KeyAccessor::key_bit_count,uint16_t>()(input,scratch,values,valuesScratch,static_cast<uint16_t>(rangeSize),comp);
 	if (rangeSize<static_cast<decltype(rangeSize)>(0x1ull<<32ull))
-		return impl::RadixSorter<KeyAccessor::key_bit_count,uint32_t>()(input,scratch,static_cast<uint32_t>(rangeSize),comp);
+		return impl::RadixSorter<KeyAccessor::key_bit_count,uint32_t>()(input,scratch,values,valuesScratch,static_cast<uint32_t>(rangeSize),comp);
 	else
-		return impl::RadixSorter<KeyAccessor::key_bit_count,size_t>()(input,scratch,rangeSize,comp);
+		return impl::RadixSorter<KeyAccessor::key_bit_count,size_t>()(input,scratch,values,valuesScratch,rangeSize,comp);
+}
+
+template<class RandomIt>
+using key_adaptor_t = KeyAdaptor<typename std::iterator_traits<RandomIt>::value_type>;
+
+}
+
+template<class RandomIt, class KeyAccessor>
+inline RandomIt radix_sort(RandomIt input, RandomIt scratch, const size_t rangeSize, const KeyAccessor& comp)
+{
+	return impl::dispatch_radix_sort(input,scratch,impl::NoValues(),impl::NoValues(),rangeSize,comp).first;
 }
 
 //! Because Radix Sort needs O(2n) space and a number of passes dependant on the key length, the final sorted range can be either in `input` or `scratch`
+/** Passes in which all keys have the same digit get skipped, big ranges get sorted in parallel, the sort is stable. */
 template<class RandomIt>
 inline RandomIt radix_sort(RandomIt input, RandomIt scratch, const size_t rangeSize)
 {
-	return radix_sort<RandomIt>(input,scratch,rangeSize,impl::KeyAdaptor<decltype(*input)>());
+	return radix_sort<RandomIt>(input,scratch,rangeSize,impl::key_adaptor_t<RandomIt>());
+}
+
+//! Sorts `values` by `keys`, the keys and values get moved in lockstep so there's no need for a struct of both
+/** Same as the keys-only sort, the sorted keys and values can end up either in their input or scratch arrays, but always both in the same. */
+template<class KeyIt, class ValueIt, class KeyAccessor>
+inline std::pair<KeyIt,ValueIt> radix_sort(KeyIt keys, KeyIt keysScratch, ValueIt values, ValueIt valuesScratch, const size_t rangeSize, const KeyAccessor& comp)
+{
+	return impl::dispatch_radix_sort(keys,keysScratch,values,valuesScratch,rangeSize,comp);
+}
+
+template<class KeyIt, class ValueIt>
+inline std::pair<KeyIt,ValueIt> radix_sort(KeyIt keys, KeyIt keysScratch, ValueIt values, ValueIt valuesScratch, const size_t rangeSize)
+{
+	return radix_sort(keys,keysScratch,values,valuesScratch,rangeSize,impl::key_adaptor_t<KeyIt>());
 }
 
 }
 }
 
-#endif
\ No newline at end of file
+#endif
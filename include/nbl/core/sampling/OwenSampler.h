@@ -5,7 +5,9 @@
 #ifndef __NBL_CORE_CORE_OWEN_SAMPLER_H_
 #define __NBL_CORE_CORE_OWEN_SAMPLER_H_
 
-#include "nbl/core/sampling/RandomSampler.h"
+#include <execution>
+#include <numeric>
+
 #include "nbl/core/sampling/SobolSampler.h"
 
 namespace nbl
@@ -13,29 +15,25 @@ namespace nbl
 namespace core
 {
 
-	//! TODO: make the tree sampler/generator configurable and let RandomSampler be default
+	//! Owen scrambled `SequenceSampler`, the scrambling is a hash of the sample's bits so any (dimension,sample) pair can be evaluated in any order
+	/** The nested uniform scramble is the Laine-Karras permutation applied to the bit-reversed sample, with the hash constants from
+	Burley's "Practical Hash-based Owen Scrambling" (JCGT 2020). Every dimension gets its own seed hashed from the sampler's seed.
+
+	`sample` is const and stateless, so one sampler can be shared between threads. */
 	template<class SequenceSampler=SobolSampler>
 	class OwenSampler : protected SequenceSampler
 	{
 	public:
-		OwenSampler(uint32_t _dimensions, uint32_t _seed) : SequenceSampler(_dimensions)
+		OwenSampler(uint32_t _dimensions, uint32_t _seed) : SequenceSampler(_dimensions), seed(_seed)
 		{
-			mersenneTwister.seed(_seed);
-			cachedFlip.resize(MAX_SAMPLES-1u);
-			resetDimensionCounter(0u);
 		}
 		~OwenSampler()
 		{
 		}
 
-		// 
-		inline uint32_t sample(uint32_t dim, uint32_t sampleNum)
+		//
+		inline uint32_t sample(uint32_t dim, uint32_t sampleNum) const
 		{
-			if (dim>lastDim)
-				resetDimensionCounter(dim);
-			else if (dim<lastDim)
-				assert(false);
-
 			uint32_t oldsample = SequenceSampler::sample(dim,sampleNum);
 			#ifdef _NBL_DEBUG
 				assert(sampleNum<MAX_SAMPLES);
@@ -44,46 +42,38 @@ namespace core
 				else
 					assert(oldsample == 0u);
 			#endif
-			constexpr uint32_t lastLevelStart = MAX_SAMPLES/2u-1u;
-			uint32_t index = oldsample>>(OUT_BITS+1u - MAX_SAMPLES_LOG2);
-			index += lastLevelStart;
-
-			return oldsample^cachedFlip[index];
+			return scramble(oldsample,getDimensionSeed(dim));
 		}
 
-		//!
-		inline void resetDimensionCounter(uint32_t dimension)
+		//! Fills `out[i*dimensionCount+d]` with `sample(firstDimension+d,i)` for all `i<sampleCount` and `d<dimensionCount`
+		/** The same layout as a sample-major table filled from `SobolSampler::sample`, blocks of samples get generated in parallel 4 at a time. */
+		inline void generateTable(uint32_t* out, uint32_t dimensionCount, uint32_t sampleCount, uint32_t firstDimension=0u) const
 		{
-			/** NOTES:
-			- For 64k samples, we can store their positions in uint16_t
-			- The last leves of Owen Tree can be collapsed to a single node (because trailing bits are always 00000.....)
-			- The above can be stored in 1x array of sample count uint16_t/uint32_t per Dimension
-			- We should store samples as uint32_t always because the total amount of memory to fetch is always the same
-			**/
-			for (uint32_t i=0u; i<MAX_SAMPLES-1u; i++) 
+			assert(sampleCount<=MAX_SAMPLES);
+			const uint32_t blockCount = (sampleCount+SAMPLES_PER_BLOCK-1u)/SAMPLES_PER_BLOCK;
+			core::vector<uint32_t> blocks(blockCount);
+			std::iota(blocks.begin(),blocks.end(),0u);
+			std::for_each(std::execution::par,blocks.begin(),blocks.end(),[&](const uint32_t block) -> void
 			{
-				uint32_t randMask = (i<(MAX_SAMPLES/2u-1u)) ? 0x80000000u:0xffffffffu;
-				cachedFlip[i] = mersenneTwister()&(randMask>>getTreeDepth(i));
-			}
-			for (uint32_t i=1u; i<MAX_SAMPLES_LOG2; i++)
-			{
-				uint32_t previousLevelStart = (0x1u<<(i-1u))-1u;
-				uint32_t currentLevelStart = (0x1u<<i)-1u;
-				uint32_t currentLevelSize = 0x1u<<i;
-				for (uint32_t j=0u; j<currentLevelSize; j++)
-					cachedFlip[currentLevelStart+j] |= cachedFlip[previousLevelStart+(j>>1u)];
-				#ifdef _NBL_DEBUG
-					for (uint32_t j=0u; j<currentLevelSize; j+=2)
+				const uint32_t sampleBegin = block*SAMPLES_PER_BLOCK;
+				const uint32_t sampleEnd = core::min(sampleBegin+SAMPLES_PER_BLOCK,sampleCount);
+				const uint32_t sampleNumBits = core::findMSB(sampleEnd-1u)+1u;
+				for (uint32_t d=0u; d<dimensionCount; d++)
+				{
+					const uint32_t dim = firstDimension+d;
+					const vectorSIMDu32 dimSeed(getDimensionSeed(dim));
+					uint32_t* const outDim = out+d;
+					for (uint32_t i=sampleBegin; i<sampleEnd; i+=4u)
 					{
-						const uint32_t highBitMask = 0xffffffffu<<(OUT_BITS-i);
-						uint32_t left = cachedFlip[currentLevelStart+j];
-						uint32_t right = cachedFlip[currentLevelStart+j+1];
-						assert(((left^right)&highBitMask)==0u);
-						assert((left&right&highBitMask)==cachedFlip[previousLevelStart+(j>>1u)]);
+						const vectorSIMDu32 sampleNums = vectorSIMDu32(0u,1u,2u,3u)+vectorSIMDu32(i);
+						alignas(16) uint32_t scrambled[4];
+						_mm_store_si128(reinterpret_cast<__m128i*>(scrambled),scramble(SequenceSampler::sampleSIMD(dim,sampleNums,sampleNumBits),dimSeed).getAsRegister());
+						const uint32_t laneCount = core::min(sampleEnd-i,4u);
+						for (uint32_t j=0u; j<laneCount; j++)
+							outDim[size_t(i+j)*dimensionCount] = scrambled[j];
 					}
-				#endif
-			}
-			lastDim = dimension;
+				}
+			});
 		}
 
 	protected:
@@ -91,19 +81,64 @@ namespace core
 		_NBL_STATIC_INLINE_CONSTEXPR uint32_t OUT_BITS = sizeof(uint32_t)*8u;
 		_NBL_STATIC_INLINE_CONSTEXPR uint32_t MAX_SAMPLES_LOG2 = 24u;
 		_NBL_STATIC_INLINE_CONSTEXPR uint32_t MAX_SAMPLES = 0x1u<<MAX_SAMPLES_LOG2;
+		// big enough to amortize the threading, small enough for the output rows to stay in cache
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t SAMPLES_PER_BLOCK = 0x1u<<12u;
+
+		// Chris Wellons' lowbias32
+		static inline uint32_t hash(uint32_t x)
+		{
+			x ^= x>>16u;
+			x *= 0x7feb352du;
+			x ^= x>>15u;
+			x *= 0x846ca68bu;
+			x ^= x>>16u;
+			return x;
+		}
+		inline uint32_t getDimensionSeed(uint32_t dim) const
+		{
+			return hash(seed^hash(dim));
+		}
+
+		static inline uint32_t reverseBits(uint32_t x)
+		{
+			x = ((x>>1u)&0x55555555u)|((x&0x55555555u)<<1u);
+			x = ((x>>2u)&0x33333333u)|((x&0x33333333u)<<2u);
+			x = ((x>>4u)&0x0f0f0f0fu)|((x&0x0f0f0f0fu)<<4u);
+			x = ((x>>8u)&0x00ff00ffu)|((x&0x00ff00ffu)<<8u);
+			return (x>>16u)|(x<<16u);
+		}
+		static inline vectorSIMDu32 reverseBits(const vectorSIMDu32& x)
+		{
+			auto swap = [](__m128i x, const int shift, const uint32_t mask) -> __m128i
+			{
+				const __m128i m = _mm_set1_epi32(mask);
+				return _mm_or_si128(_mm_and_si128(_mm_srl_epi32(x,_mm_cvtsi32_si128(shift)),m),_mm_sll_epi32(_mm_and_si128(x,m),_mm_cvtsi32_si128(shift)));
+			};
+			__m128i retval = swap(x.getAsRegister(),1,0x55555555u);
+			retval = swap(retval,2,0x33333333u);
+			retval = swap(retval,4,0x0f0f0f0fu);
+			retval = swap(retval,8,0x00ff00ffu);
+			return _mm_or_si128(_mm_srli_epi32(retval,16),_mm_slli_epi32(retval,16));
+		}
 
-		inline uint32_t getTreeDepth(uint32_t sampleNum)
+		//! Flips of any bit only ever depend on the bits above it, which makes it a nested uniform scramble
+		template<typename T>
+		static inline T scramble(T x, const T& dimSeed)
 		{
-			return core::findMSB(sampleNum+1u);
+			x = reverseBits(x);
+			x += dimSeed;
+			x = x^(x*T(0x6c50b47cu));
+			x = x^(x*T(0xb82f1e52u));
+			x = x^(x*T(0xc7afe638u));
+			x = x^(x*T(0x8d22f6e6u));
+			return reverseBits(x);
 		}
 
-		std::mt19937 mersenneTwister;
-		uint32_t lastDim;
-		core::vector<uint32_t> cachedFlip;
+		uint32_t seed;
 	};
 
 
 }
 }
 
-#endif
\ No newline at end of file
+#endif
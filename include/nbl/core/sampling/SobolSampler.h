@@ -6,6 +6,7 @@
 #define __NBL_CORE_SOBOL_SAMPLER_H_
 
 #include "nbl/core/Types.h"
+#include "vectorSIMD.h"
 
 namespace nbl
 {
@@ -79,7 +80,7 @@ class SobolSampler
 		}
 		
 		// Idea for optimization, do PoT samples per pass, then can precompute most of the `retval`
-		inline uint32_t sample(uint32_t dim, uint32_t sampleNum)
+		inline uint32_t sample(uint32_t dim, uint32_t sampleNum) const
 		{
 			#ifdef _DEBUG
 				assert(dim<dimensions);
@@ -93,6 +94,26 @@ class SobolSampler
 			return retval;
 		}
 
+		//! Same as `sample` but for 4 sample numbers at once, `sampleNumBits` is how many low bits of the sample numbers can be set
+		inline vectorSIMDu32 sampleSIMD(uint32_t dim, const vectorSIMDu32& sampleNums, uint32_t sampleNumBits=SOBOL_BITS) const
+		{
+			#ifdef _DEBUG
+				assert(dim<dimensions);
+				assert(sampleNumBits<=SOBOL_BITS);
+			#endif
+			auto vectors = *reinterpret_cast<uint32_t(*)[][SOBOL_BITS]>(directions);
+
+			const __m128i samples = sampleNums.getAsRegister();
+			__m128i retval = _mm_setzero_si128();
+			for (uint32_t i=0u; i<sampleNumBits; i++)
+			{
+				const __m128i bit = _mm_set1_epi32(0x1u<<i);
+				const __m128i isSet = _mm_cmpeq_epi32(_mm_and_si128(samples,bit),bit);
+				retval = _mm_xor_si128(retval,_mm_and_si128(isSet,_mm_set1_epi32(vectors[dim][i])));
+			}
+			return retval;
+		}
+
 	protected:
 		typedef struct SobolDirectionNumbers {
 			uint32_t d, s, a;
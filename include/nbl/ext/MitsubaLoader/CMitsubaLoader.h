@@ -47,8 +47,16 @@ class CMitsubaLoader : public asset::IRenderpassIndependentPipelineLoader
 		core::vector<SContext::shape_ass_type>	getMesh(SContext& ctx, uint32_t hierarchyLevel, CElementShape* shape);
 		core::vector<SContext::shape_ass_type>	loadShapeGroup(SContext& ctx, uint32_t hierarchyLevel, const CElementShape::ShapeGroup* shapegroup, const core::matrix3x4SIMD& relTform);
 		SContext::shape_ass_type				loadBasicShape(SContext& ctx, uint32_t hierarchyLevel, CElementShape* shape, const core::matrix3x4SIMD& relTform);
-		
+		//! Doesn't touch any of the `ctx` caches, so can be called for different shapes in parallel
+		SContext::shape_ass_type				createShapeMesh(const SContext& ctx, uint32_t hierarchyLevel, CElementShape* shape);
+
 		SContext::tex_ass_type					cacheTexture(SContext& ctx, uint32_t hierarchyLevel, const CElementTexture* texture, bool _restore = false);
+		//! Thread-safe as long as no two threads ask for the same view (see `SContext::bitmapViewCacheKey`)
+		core::smart_refctd_ptr<asset::ICPUImageView>	cacheImageView(const SContext& ctx, uint32_t hierarchyLevel, const CElementTexture* bitmap, bool _restore = false);
+		//! Derivative map or blend weight image made from a bitmap used as a bumpmap or blend weight
+		void									cacheDerivedImage(const SContext& ctx, const CElementTexture* bitmap, bool derivativeMap);
+		//! Loads and converts all images the BSDFs will need in parallel, so that building the material IR doesn't wait on them
+		void									prefetchTextures(const SContext& ctx, const core::vector<const CElementBSDF*>& bsdfs);
 
 		SContext::bsdf_type getBSDFtreeTraversal(SContext& ctx, const CElementBSDF* bsdf);
 		SContext::bsdf_type genBSDFtreeTraversal(SContext& ctx, const CElementBSDF* bsdf);
@@ -23,7 +23,10 @@ class CSerializedLoader final : public asset::IRenderpassIndependentPipelineLoad
 
 	public:
 		//! Constructor
-		CSerializedLoader(asset::IAssetManager* _manager) : IRenderpassIndependentPipelineLoader(_manager) {}
+		/** @param _quantizeAttributes makes the loader store normals as `EF_A2B10G10R10_SNORM_PACK32`, UVs as `EF_R16G16_SFLOAT`,
+		vertex colors as `EF_E5B9G9R9_UFLOAT_PACK32` and double precision positions as floats, instead of the full precision
+		the file was written with. Positions and indices are never quantized otherwise. */
+		CSerializedLoader(asset::IAssetManager* _manager, bool _quantizeAttributes=false) : IRenderpassIndependentPipelineLoader(_manager), m_quantizeAttributes(_quantizeAttributes) {}
 
 		inline bool isALoadableFileFormat(io::IReadFile* _file) const override
 		{
@@ -68,6 +71,8 @@ class CSerializedLoader final : public asset::IRenderpassIndependentPipelineLoad
 			uint32_t meshCount;
 			core::smart_refctd_dynamic_array<uint64_t> meshOffsets;
 		};
+
+		const bool m_quantizeAttributes;
 };
 
 
@@ -61,6 +61,29 @@ namespace MitsubaLoader
 			return imageCacheKey + "?view";
 		}
 
+		static std::string bitmapViewCacheKey(const CElementTexture* bitmap)
+		{
+			std::string key = imageViewCacheKey(bitmap->bitmap.filename.svalue);
+			switch (bitmap->bitmap.channel)
+			{
+				case CElementTexture::Bitmap::CHANNEL::R:
+					key += "?r";
+					break;
+				case CElementTexture::Bitmap::CHANNEL::G:
+					key += "?g";
+					break;
+				case CElementTexture::Bitmap::CHANNEL::B:
+					key += "?b";
+					break;
+				case CElementTexture::Bitmap::CHANNEL::A:
+					key += "?a";
+					break;
+				default:
+					break;
+			}
+			return key;
+		}
+
 		static std::string derivMapCacheKey(const CElementTexture* bitmap)
 		{
 			using namespace std::string_literals;
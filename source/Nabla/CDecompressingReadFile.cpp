@@ -0,0 +1,349 @@
+// Copyright (C) 2019 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "CDecompressingReadFile.h"
+
+#ifdef __NBL_COMPILE_WITH_ZIP_ARCHIVE_LOADER_
+
+#include "os.h"
+
+#ifdef _NBL_COMPILE_WITH_ZLIB_
+	#include "zlib/zlib.h"
+
+	#ifdef _NBL_COMPILE_WITH_BZIP2_
+	#include "bzip2/bzlib.h"
+	#endif
+	#ifdef _NBL_COMPILE_WITH_LZMA_
+	#include "lzma/LzmaDec.h"
+	#endif
+#endif
+
+namespace nbl
+{
+namespace io
+{
+
+#ifdef _NBL_COMPILE_WITH_LZMA_
+//! The lzma lib has no default memory management
+namespace
+{
+	void* lzmaStreamAlloc(ISzAllocPtr, size_t size) { return _NBL_ALIGNED_MALLOC(size,_NBL_SIMD_ALIGNMENT); }
+	void lzmaStreamFree(ISzAllocPtr, void* address) { _NBL_ALIGNED_FREE(address); }
+	const ISzAlloc lzmaStreamAllocator = { lzmaStreamAlloc, lzmaStreamFree };
+}
+#endif
+
+
+CDecompressingReadFile::CDecompressingReadFile(IReadFile* parent, size_t compressedOffset, size_t compressedSize, size_t uncompressedSize, E_CODEC codec, const io::path& fileName)
+: Parent(parent), CompressedOffset(compressedOffset), CompressedSize(compressedSize), UncompressedSize(uncompressedSize), Codec(codec), Filename(fileName), Pos(0),
+	DecoderState(nullptr), StreamEnded(false), InputConsumed(0), Input(InputChunkSize), InputPtr(nullptr), InputAvailable(0), Window(WindowSize), WindowBegin(0), WindowFill(0)
+{
+	#ifdef _NBL_DEBUG
+	setDebugName("CDecompressingReadFile");
+	#endif
+
+	if (Parent)
+		Parent->grab();
+
+	if (!Parent || !initDecoder())
+		os::Printer::log("Could not start decompressing", Filename.c_str(), ELL_ERROR);
+}
+
+
+CDecompressingReadFile::~CDecompressingReadFile()
+{
+	destroyDecoder();
+	if (Parent)
+		Parent->drop();
+}
+
+
+bool CDecompressingReadFile::initDecoder()
+{
+	destroyDecoder();
+	StreamEnded = false;
+	InputConsumed = 0u;
+	InputPtr = Input.data();
+	InputAvailable = 0u;
+	WindowBegin = 0u;
+	WindowFill = 0u;
+
+	switch (Codec)
+	{
+		#ifdef _NBL_COMPILE_WITH_ZLIB_
+		case EC_DEFLATE:
+		{
+			auto* stream = new z_stream;
+			memset(stream,0,sizeof(z_stream));
+			// wbits < 0 indicates no zlib header inside the data
+			if (inflateInit2(stream,-MAX_WBITS)!=Z_OK)
+			{
+				delete stream;
+				return false;
+			}
+			DecoderState = stream;
+			return true;
+		}
+		#endif
+		#ifdef _NBL_COMPILE_WITH_BZIP2_
+		case EC_BZIP2:
+		{
+			auto* stream = new bz_stream;
+			memset(stream,0,sizeof(bz_stream));
+			if (BZ2_bzDecompressInit(stream,0,0)!=BZ_OK)
+			{
+				delete stream;
+				return false;
+			}
+			DecoderState = stream;
+			return true;
+		}
+		#endif
+		#ifdef _NBL_COMPILE_WITH_LZMA_
+		case EC_LZMA:
+		{
+			// zip stores a 2 byte version and a 2 byte properties size before the properties themselves
+			uint8_t header[4];
+			if (CompressedSize<sizeof(header) || Parent->readAt(CompressedOffset,header,sizeof(header))!=sizeof(header))
+				return false;
+			const size_t propSize = (size_t(header[3])<<8u)+header[2];
+			if (CompressedSize<sizeof(header)+propSize)
+				return false;
+			core::vector<uint8_t> props(propSize);
+			if (Parent->readAt(CompressedOffset+sizeof(header),props.data(),propSize)!=propSize)
+				return false;
+
+			auto* decoder = new CLzmaDec;
+			LzmaDec_Construct(decoder);
+			if (LzmaDec_Allocate(decoder,props.data(),propSize,&lzmaStreamAllocator)!=SZ_OK)
+			{
+				delete decoder;
+				return false;
+			}
+			LzmaDec_Init(decoder);
+			DecoderState = decoder;
+			InputConsumed = sizeof(header)+propSize;
+			return true;
+		}
+		#endif
+		default:
+			os::Printer::log("Decompression method not compiled in, file cannot be read.", Filename.c_str(), ELL_ERROR);
+			return false;
+	}
+}
+
+
+void CDecompressingReadFile::destroyDecoder()
+{
+	if (!DecoderState)
+		return;
+
+	switch (Codec)
+	{
+		#ifdef _NBL_COMPILE_WITH_ZLIB_
+		case EC_DEFLATE:
+		{
+			auto* stream = reinterpret_cast<z_stream*>(DecoderState);
+			inflateEnd(stream);
+			delete stream;
+			break;
+		}
+		#endif
+		#ifdef _NBL_COMPILE_WITH_BZIP2_
+		case EC_BZIP2:
+		{
+			auto* stream = reinterpret_cast<bz_stream*>(DecoderState);
+			BZ2_bzDecompressEnd(stream);
+			delete stream;
+			break;
+		}
+		#endif
+		#ifdef _NBL_COMPILE_WITH_LZMA_
+		case EC_LZMA:
+		{
+			auto* decoder = reinterpret_cast<CLzmaDec*>(DecoderState);
+			LzmaDec_Free(decoder,&lzmaStreamAllocator);
+			delete decoder;
+			break;
+		}
+		#endif
+		default:
+			break;
+	}
+	DecoderState = nullptr;
+}
+
+
+void CDecompressingReadFile::refillInput()
+{
+	const size_t toRead = core::min(Input.size(),CompressedSize-InputConsumed);
+	InputAvailable = Parent->readAt(CompressedOffset+InputConsumed,Input.data(),toRead);
+	InputPtr = Input.data();
+	// a short read means the parent is truncated, don't try to read past it again
+	InputConsumed = InputAvailable!=toRead ? CompressedSize:(InputConsumed+InputAvailable);
+}
+
+
+size_t CDecompressingReadFile::decode(uint8_t* dst, size_t size)
+{
+	size_t produced = 0u;
+	while (produced<size && !StreamEnded)
+	{
+		if (!InputAvailable && InputConsumed<CompressedSize)
+			refillInput();
+
+		const size_t inputBefore = InputAvailable;
+		size_t output = 0u;
+		switch (Codec)
+		{
+			#ifdef _NBL_COMPILE_WITH_ZLIB_
+			case EC_DEFLATE:
+			{
+				auto* stream = reinterpret_cast<z_stream*>(DecoderState);
+				const uInt outputSize = static_cast<uInt>(core::min<size_t>(size-produced,0x40000000ull));
+				stream->next_in = const_cast<Bytef*>(InputPtr);
+				stream->avail_in = static_cast<uInt>(InputAvailable);
+				stream->next_out = dst+produced;
+				stream->avail_out = outputSize;
+				const int err = inflate(stream,Z_NO_FLUSH);
+				output = outputSize-stream->avail_out;
+				InputPtr = stream->next_in;
+				InputAvailable = stream->avail_in;
+				if (err!=Z_OK && err!=Z_BUF_ERROR)
+					StreamEnded = true;
+				break;
+			}
+			#endif
+			#ifdef _NBL_COMPILE_WITH_BZIP2_
+			case EC_BZIP2:
+			{
+				auto* stream = reinterpret_cast<bz_stream*>(DecoderState);
+				const unsigned int outputSize = static_cast<unsigned int>(core::min<size_t>(size-produced,0x40000000ull));
+				stream->next_in = reinterpret_cast<char*>(const_cast<uint8_t*>(InputPtr));
+				stream->avail_in = static_cast<unsigned int>(InputAvailable);
+				stream->next_out = reinterpret_cast<char*>(dst+produced);
+				stream->avail_out = outputSize;
+				const int err = BZ2_bzDecompress(stream);
+				output = outputSize-stream->avail_out;
+				InputPtr = reinterpret_cast<const uint8_t*>(stream->next_in);
+				InputAvailable = stream->avail_in;
+				if (err!=BZ_OK)
+					StreamEnded = true;
+				break;
+			}
+			#endif
+			#ifdef _NBL_COMPILE_WITH_LZMA_
+			case EC_LZMA:
+			{
+				SizeT outputSize = size-produced;
+				SizeT inputSize = InputAvailable;
+				ELzmaStatus status;
+				const SRes err = LzmaDec_DecodeToBuf(reinterpret_cast<CLzmaDec*>(DecoderState),dst+produced,&outputSize,InputPtr,&inputSize,LZMA_FINISH_ANY,&status);
+				output = outputSize;
+				InputPtr += inputSize;
+				InputAvailable -= inputSize;
+				if (err!=SZ_OK || status==LZMA_STATUS_FINISHED_WITH_MARK)
+					StreamEnded = true;
+				break;
+			}
+			#endif
+			default:
+				StreamEnded = true;
+				break;
+		}
+		produced += output;
+
+		// no progress means the compressed data ran out or is corrupt
+		if (!output && InputAvailable==inputBefore)
+			StreamEnded = true;
+	}
+
+	if (StreamEnded && produced<size)
+		os::Printer::log("Compressed data ended prematurely or is corrupt", Filename.c_str(), ELL_ERROR);
+	return produced;
+}
+
+
+size_t CDecompressingReadFile::readAt(size_t offset, void* buffer, size_t sizeToRead)
+{
+	if (offset>=UncompressedSize)
+		return 0u;
+	sizeToRead = core::min(sizeToRead,UncompressedSize-offset);
+
+	std::lock_guard<std::mutex> lock(DecoderMutex);
+	if (!DecoderState)
+		return 0u;
+
+	// no way to decompress backwards, start over
+	if (offset<WindowBegin && !initDecoder())
+		return 0u;
+
+	uint8_t* const dst = reinterpret_cast<uint8_t*>(buffer);
+	size_t done = 0u;
+	while (done<sizeToRead)
+	{
+		const size_t pos = offset+done;
+		const size_t windowEnd = WindowBegin+WindowFill;
+		if (pos<windowEnd)
+		{
+			const size_t amount = core::min(windowEnd-pos,sizeToRead-done);
+			memcpy(dst+done,Window.data()+(pos-WindowBegin),amount);
+			done += amount;
+			continue;
+		}
+
+		if (StreamEnded)
+			break;
+
+		// big reads continuing where decompression left off go straight to the caller's memory, only the tail gets kept for history
+		const size_t remaining = sizeToRead-done;
+		if (pos==windowEnd && remaining>=WindowSize)
+		{
+			const size_t decoded = decode(dst+done,remaining);
+			done += decoded;
+			const size_t history = core::min(done,WindowHistory);
+			memcpy(Window.data(),dst+done-history,history);
+			WindowBegin = offset+done-history;
+			WindowFill = history;
+			continue;
+		}
+
+		// slide the window once it's full, anything before `pos` which we skip over only ever passes through it
+		if (WindowFill==WindowSize)
+		{
+			const size_t dropped = WindowFill-WindowHistory;
+			memmove(Window.data(),Window.data()+dropped,WindowHistory);
+			WindowBegin += dropped;
+			WindowFill = WindowHistory;
+		}
+		WindowFill += decode(Window.data()+WindowFill,core::min(WindowSize-WindowFill,UncompressedSize-windowEnd));
+	}
+	return done;
+}
+
+
+int32_t CDecompressingReadFile::read(void* buffer, uint32_t sizeToRead)
+{
+	const size_t amount = readAt(Pos,buffer,sizeToRead);
+	Pos += amount;
+	return static_cast<int32_t>(amount);
+}
+
+
+bool CDecompressingReadFile::seek(const size_t& finalPos, bool relativeMovement)
+{
+	const int64_t target = static_cast<int64_t>(finalPos)+(relativeMovement ? static_cast<int64_t>(Pos):0ll);
+	if (target<0ll || static_cast<size_t>(target)>UncompressedSize)
+		return false;
+
+	Pos = static_cast<size_t>(target);
+	return true;
+}
+
+
+} // end namespace io
+} // end namespace nbl
+
+#endif // __NBL_COMPILE_WITH_ZIP_ARCHIVE_LOADER_
+
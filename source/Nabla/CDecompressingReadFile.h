@@ -0,0 +1,111 @@
+// Copyright (C) 2019 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_C_DECOMPRESSING_READ_FILE_H_INCLUDED__
+#define __NBL_C_DECOMPRESSING_READ_FILE_H_INCLUDED__
+
+#include "nbl/asset/compile_config.h"
+
+#ifdef __NBL_COMPILE_WITH_ZIP_ARCHIVE_LOADER_
+
+#include <mutex>
+
+#include "nbl/core/core.h"
+#include "IReadFile.h"
+
+namespace nbl
+{
+namespace io
+{
+
+	/*!
+		Read file which decompresses a range of another file on demand, instead of inflating all of it up front.
+		Only a small window of decompressed data around the last read is kept. Forward seeks decompress and discard
+		whatever lies in between, seeking back past the window restarts decompression from the beginning.
+		Opening or probing a big archive entry costs next to nothing, reading it front to back a single decompression.
+	*/
+	class CDecompressingReadFile : public IReadFile
+	{
+        public:
+            enum E_CODEC
+            {
+                EC_DEFLATE,
+                EC_BZIP2,
+                EC_LZMA
+            };
+
+            //! `compressedOffset` and `compressedSize` delimit the compressed stream within `parent`
+            CDecompressingReadFile(IReadFile* parent, size_t compressedOffset, size_t compressedSize, size_t uncompressedSize, E_CODEC codec, const io::path& fileName);
+
+            //! returns false if the codec isn't compiled in or the stream couldn't be set up
+            inline bool isOpen() const
+            {
+                return DecoderState != nullptr;
+            }
+
+            //! returns how much was read
+            virtual int32_t read(void* buffer, uint32_t sizeToRead) override;
+
+            //! reads from an absolute position, calls are serialized because they share the decompression state
+            virtual size_t readAt(size_t offset, void* buffer, size_t sizeToRead) override;
+
+            //! changes position in file, nothing gets decompressed until the next read
+            virtual bool seek(const size_t& finalPos, bool relativeMovement = false) override;
+
+            //! returns the uncompressed size
+            virtual size_t getSize() const override { return UncompressedSize; }
+
+            //! returns where in the file we are.
+            virtual size_t getPos() const override { return Pos; }
+
+            //! returns name of file
+            virtual const io::path& getFileName() const override { return Filename; }
+
+        protected:
+            virtual ~CDecompressingReadFile();
+
+        private:
+            _NBL_STATIC_INLINE_CONSTEXPR size_t InputChunkSize = 0x1ull<<16ull;
+            _NBL_STATIC_INLINE_CONSTEXPR size_t WindowSize = 0x1ull<<18ull;
+            // amount of already read data which survives sliding the window, so short backward seeks stay cheap
+            _NBL_STATIC_INLINE_CONSTEXPR size_t WindowHistory = WindowSize/4ull;
+
+            //! (re)starts decompression from the beginning of the stream
+            bool initDecoder();
+            void destroyDecoder();
+            //! fetches the next chunk of compressed data from the parent
+            void refillInput();
+            //! decompresses up to `size` bytes following the ones decompressed so far, returns how many were produced
+            size_t decode(uint8_t* dst, size_t size);
+
+            IReadFile* Parent;
+            const size_t CompressedOffset;
+            const size_t CompressedSize;
+            const size_t UncompressedSize;
+            const E_CODEC Codec;
+            io::path Filename;
+            size_t Pos;
+
+            std::mutex DecoderMutex;
+            // z_stream, bz_stream or CLzmaDec depending on `Codec`, opaque so that users don't need the codec headers
+            void* DecoderState;
+            bool StreamEnded;
+            // position of the next compressed chunk, relative to `CompressedOffset`
+            size_t InputConsumed;
+            core::vector<uint8_t> Input;
+            const uint8_t* InputPtr;
+            size_t InputAvailable;
+            // holds the decompressed bytes [WindowBegin,WindowBegin+WindowFill), decompression always continues right after them
+            core::vector<uint8_t> Window;
+            size_t WindowBegin;
+            size_t WindowFill;
+	};
+
+} // end namespace io
+} // end namespace nbl
+
+#endif // __NBL_COMPILE_WITH_ZIP_ARCHIVE_LOADER_
+
+#endif
+
@@ -6,6 +6,7 @@
 #include <list>
 #include "CFileSystem.h"
 #include "CReadFile.h"
+#include "CMappedReadFile.h"
 #include "IWriteFile.h"
 #include "CZipReader.h"
 #include "CMountPointReader.h"
@@ -104,7 +105,14 @@ IReadFile* CFileSystem::createAndOpenFile(const io::path& filename)
 
 	// Create the file using an absolute path so that it matches
 	// the scheme used by CNullDriver::getTexture().
-    file = new CReadFile(getAbsolutePath(filename));
+	const io::path absolutePath = getAbsolutePath(filename);
+	// prefer a memory mapping so loaders can parse without copying the file, not every file can be mapped (empty files, pipes)
+	file = new CMappedReadFile(absolutePath);
+	if (static_cast<CMappedReadFile*>(file)->isOpen())
+		return file;
+	file->drop();
+
+    file = new CReadFile(absolutePath);
     if (static_cast<CReadFile*>(file)->isOpen())
         return file;
 
@@ -42,55 +42,34 @@ CLimitReadFile::~CLimitReadFile()
 //! returns how much was read
 int32_t CLimitReadFile::read(void* buffer, uint32_t sizeToRead)
 {
-#if 1
-	if (0 == File)
-		return 0;
-
-	int32_t r = AreaStart + Pos;
-	int32_t toRead = core::min<int32_t>(AreaEnd, r + sizeToRead) - core::max<int32_t>(AreaStart, r);
-	if (toRead < 0)
-		return 0;
-	File->seek(r);
-	r = File->read(buffer, toRead);
+	// positional reads keep the parent's position out of it, so entries of one archive can be read from different threads
+	const size_t r = readAt(Pos, buffer, sizeToRead);
 	Pos += r;
-	return r;
-#else
-	const size_t pos = File->getPos();
+	return static_cast<int32_t>(r);
+}
 
-	if (pos >= AreaEnd)
+
+//! reads from an absolute position within the area
+size_t CLimitReadFile::readAt(size_t offset, void* buffer, size_t sizeToRead)
+{
+	if (0 == File)
 		return 0;
 
-	if (pos + (size_t)sizeToRead >= AreaEnd)
-		sizeToRead = AreaEnd - pos;
+	const size_t areaSize = AreaEnd - AreaStart;
+	if (offset >= areaSize)
+		return 0;
 
-	return File->read(buffer, sizeToRead);
-#endif
+	return File->readAt(AreaStart + offset, buffer, core::min(sizeToRead, areaSize - offset));
 }
 
 
 //! changes position in file, returns true if successful
 bool CLimitReadFile::seek(const size_t& finalPos, bool relativeMovement)
 {
-#if 1
-	Pos = core::clamp<int32_t,int32_t>(finalPos + (relativeMovement ? Pos : 0 ), 0, AreaEnd - AreaStart);
+	// relative movement can be negative, the size_t just wraps around
+	const int64_t newPos = static_cast<int64_t>(finalPos) + (relativeMovement ? static_cast<int64_t>(Pos) : 0ll);
+	Pos = static_cast<size_t>(core::clamp<int64_t,int64_t>(newPos, 0ll, static_cast<int64_t>(AreaEnd - AreaStart)));
 	return true;
-#else
-	const size_t pos = File->getPos();
-
-	if (relativeMovement)
-	{
-		if (pos + finalPos > AreaEnd)
-			finalPos = AreaEnd - pos;
-	}
-	else
-	{
-		finalPos += AreaStart;
-		if (finalPos > AreaEnd)
-			return false;
-	}
-
-	return File->seek(finalPos, relativeMovement);
-#endif
 }
 
 
@@ -104,11 +83,7 @@ size_t CLimitReadFile::getSize() const
 //! returns where in the file we are.
 size_t CLimitReadFile::getPos() const
 {
-#if 1
 	return Pos;
-#else
-	return File->getPos() - AreaStart;
-#endif
 }
 
 
@@ -119,6 +94,17 @@ const io::path& CLimitReadFile::getFileName() const
 }
 
 
+//! returns the area of the underlying file's mapping, if it has one
+const void* CLimitReadFile::getMappedPointer() const
+{
+	if (!File)
+		return nullptr;
+
+	const auto* mapped = reinterpret_cast<const uint8_t*>(File->getMappedPointer());
+	return mapped ? (mapped+AreaStart):nullptr;
+}
+
+
 } // end namespace io
 } // end namespace nbl
 
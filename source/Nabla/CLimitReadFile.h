@@ -32,6 +32,9 @@ namespace io
             //! returns how much was read
             virtual int32_t read(void* buffer, uint32_t sizeToRead);
 
+            //! reads from an absolute position within the area, forwarded to the parent file's `readAt`
+            virtual size_t readAt(size_t offset, void* buffer, size_t sizeToRead);
+
             //! changes position in file, returns true if successful
             //! if relativeMovement==true, the pos is changed relative to current pos,
             //! otherwise from begin of file
@@ -46,6 +49,9 @@ namespace io
             //! returns name of file
             virtual const io::path& getFileName() const;
 
+            //! returns the area of the underlying file's mapping, if it has one
+            virtual const void* getMappedPointer() const;
+
         private:
 
             io::path Filename;
@@ -0,0 +1,144 @@
+// Copyright (C) 2019 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "CMappedReadFile.h"
+
+#if defined(_NBL_WINDOWS_API_)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#elif defined(_NBL_POSIX_API_)
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace nbl
+{
+namespace io
+{
+
+
+CMappedReadFile::CMappedReadFile(const io::path& fileName)
+: Mapping(nullptr), FileSize(0), Pos(0), Filename(fileName)
+{
+	#ifdef _NBL_DEBUG
+	setDebugName("CMappedReadFile");
+	#endif
+
+	mapFile();
+}
+
+
+CMappedReadFile::~CMappedReadFile()
+{
+	if (!Mapping)
+		return;
+
+#if defined(_NBL_WINDOWS_API_)
+	UnmapViewOfFile(Mapping);
+#elif defined(_NBL_POSIX_API_)
+	munmap(const_cast<uint8_t*>(Mapping), FileSize);
+#endif
+}
+
+
+//! returns how much was read
+int32_t CMappedReadFile::read(void* buffer, uint32_t sizeToRead)
+{
+	if (!isOpen())
+		return 0;
+
+	const size_t amount = core::min<size_t>(sizeToRead, FileSize-Pos);
+	memcpy(buffer, Mapping+Pos, amount);
+	Pos += amount;
+	return static_cast<int32_t>(amount);
+}
+
+
+//! reads from an absolute position without touching the current one
+size_t CMappedReadFile::readAt(size_t offset, void* buffer, size_t sizeToRead)
+{
+	if (!isOpen() || offset >= FileSize)
+		return 0;
+
+	const size_t amount = core::min(sizeToRead, FileSize-offset);
+	memcpy(buffer, Mapping+offset, amount);
+	return amount;
+}
+
+
+//! changes position in file, returns true if successful
+//! if relativeMovement==true, the pos is changed relative to current pos,
+//! otherwise from begin of file
+bool CMappedReadFile::seek(const size_t& finalPos, bool relativeMovement)
+{
+	if (!isOpen())
+		return false;
+
+	const size_t newPos = relativeMovement ? (Pos+finalPos):finalPos;
+	if (newPos > FileSize)
+		return false;
+
+	Pos = newPos;
+	return true;
+}
+
+
+//! maps the file
+void CMappedReadFile::mapFile()
+{
+	if (Filename.size() == 0)
+		return;
+
+#if defined(_NBL_WINDOWS_API_)
+	#if defined(_NBL_WCHAR_FILESYSTEM)
+	HANDLE file = CreateFileW(Filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	#else
+	HANDLE file = CreateFileA(Filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	#endif
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+	{
+		// the view keeps the mapping object (and the file) alive, both handles can be closed right away
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping)
+		{
+			Mapping = reinterpret_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			if (Mapping)
+				FileSize = static_cast<size_t>(size.QuadPart);
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+#elif defined(_NBL_POSIX_API_)
+	const int fd = open(Filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return;
+
+	struct stat info;
+	// only regular files can be mapped, and mapping zero bytes is an error
+	if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+	{
+		void* ptr = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (ptr != MAP_FAILED)
+		{
+			// loaders overwhelmingly parse front to back
+			madvise(ptr, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+			Mapping = reinterpret_cast<const uint8_t*>(ptr);
+			FileSize = static_cast<size_t>(info.st_size);
+		}
+	}
+	// the mapping stays valid after the descriptor is closed
+	close(fd);
+#endif
+}
+
+
+} // end namespace io
+} // end namespace nbl
+
@@ -0,0 +1,73 @@
+// Copyright (C) 2019 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_C_MAPPED_READ_FILE_H_INCLUDED__
+#define __NBL_C_MAPPED_READ_FILE_H_INCLUDED__
+
+#include "IReadFile.h"
+
+#include "nbl/core/core.h"
+
+namespace nbl
+{
+
+namespace io
+{
+
+	/*!
+		Class for reading a real file from disk through a read-only memory mapping.
+		The whole file is available via getMappedPointer() so loaders can parse it in place,
+		read() is just a memcpy out of the mapping.
+	*/
+	class CMappedReadFile : public IReadFile
+	{
+        protected:
+            virtual ~CMappedReadFile();
+
+        public:
+            CMappedReadFile(const io::path& fileName);
+
+            //! returns how much was read
+            virtual int32_t read(void* buffer, uint32_t sizeToRead) override;
+
+            //! reads from an absolute position without touching the current one, can be called from multiple threads
+            virtual size_t readAt(size_t offset, void* buffer, size_t sizeToRead) override;
+
+            //! changes position in file, returns true if successful
+            virtual bool seek(const size_t& finalPos, bool relativeMovement = false) override;
+
+            //! returns size of file
+            virtual size_t getSize() const override { return FileSize; }
+
+            //! returns if file is open, empty files and anything that can't be mapped never are
+            inline bool isOpen() const
+            {
+                return Mapping != nullptr;
+            }
+
+            //! returns where in the file we are.
+            virtual size_t getPos() const override { return Pos; }
+
+            //! returns name of file
+            virtual const io::path& getFileName() const override { return Filename; }
+
+            //! returns the beginning of the mapping
+            virtual const void* getMappedPointer() const override { return Mapping; }
+
+        private:
+
+            //! maps the file
+            void mapFile();
+
+            const uint8_t* Mapping;
+            size_t FileSize;
+            size_t Pos;
+            io::path Filename;
+	};
+
+} // end namespace io
+} // end namespace nbl
+
+#endif
+
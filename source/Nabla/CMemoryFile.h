@@ -139,6 +139,8 @@ namespace io
 
         virtual const io::path& getFileName() const override { return m_filename; }
 
+        virtual const void* getMappedPointer() const override { return m_storage; }
+
         virtual int32_t read(void* buffer, uint32_t sizeToRead) override
         {
             int64_t amount = static_cast<int64_t>(sizeToRead);
@@ -155,6 +157,16 @@ namespace io
             return static_cast<int32_t>(amount);
         }
 
+        virtual size_t readAt(size_t offset, void* buffer, size_t sizeToRead) override
+        {
+            if (offset >= m_length)
+                return 0u;
+
+            const size_t amount = core::min(sizeToRead, m_length-offset);
+            memcpy(buffer, reinterpret_cast<uint8_t*>(m_storage)+offset, amount);
+            return amount;
+        }
+
         const void* getData() const {return m_storage;}
 
     protected:
@@ -5,6 +5,17 @@
 
 #include "CReadFile.h"
 
+#if defined(_NBL_WINDOWS_API_)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+	#define NBL_FSEEK _fseeki64
+	#define NBL_FTELL _ftelli64
+#else
+	#include <unistd.h>
+	#define NBL_FSEEK fseeko
+	#define NBL_FTELL ftello
+#endif
+
 namespace nbl
 {
 namespace io
@@ -12,7 +23,11 @@ namespace io
 
 
 CReadFile::CReadFile(const io::path& fileName)
-: File(0), FileSize(0), Filename(fileName)
+: File(0),
+#ifdef _NBL_WINDOWS_API_
+	PositionalHandle(INVALID_HANDLE_VALUE),
+#endif
+	FileSize(0), Filename(fileName)
 {
 	#ifdef _NBL_DEBUG
 	setDebugName("CReadFile");
@@ -26,6 +41,10 @@ CReadFile::~CReadFile()
 {
 	if (File)
 		fclose(File);
+#ifdef _NBL_WINDOWS_API_
+	if (PositionalHandle != INVALID_HANDLE_VALUE)
+		CloseHandle(PositionalHandle);
+#endif
 }
 
 
@@ -39,6 +58,39 @@ int32_t CReadFile::read(void* buffer, uint32_t sizeToRead)
 }
 
 
+//! reads from an absolute position without touching the current one
+size_t CReadFile::readAt(size_t offset, void* buffer, size_t sizeToRead)
+{
+	if (!isOpen() || offset >= FileSize)
+		return 0;
+	sizeToRead = core::min(sizeToRead, FileSize-offset);
+
+	size_t totalRead = 0;
+	while (totalRead < sizeToRead)
+	{
+		uint8_t* const dst = reinterpret_cast<uint8_t*>(buffer)+totalRead;
+		const size_t remaining = sizeToRead-totalRead;
+#if defined(_NBL_WINDOWS_API_)
+		if (PositionalHandle == INVALID_HANDLE_VALUE)
+			break;
+		OVERLAPPED overlapped = {};
+		const uint64_t position = offset+totalRead;
+		overlapped.Offset = static_cast<DWORD>(position);
+		overlapped.OffsetHigh = static_cast<DWORD>(position>>32ull);
+		DWORD count = 0;
+		if (!ReadFile(PositionalHandle, dst, static_cast<DWORD>(core::min<size_t>(remaining, 0x40000000ull)), &count, &overlapped) || count == 0)
+			break;
+#else
+		const ssize_t count = pread(fileno(File), dst, remaining, static_cast<off_t>(offset+totalRead));
+		if (count <= 0)
+			break;
+#endif
+		totalRead += static_cast<size_t>(count);
+	}
+	return totalRead;
+}
+
+
 //! changes position in file, returns true if successful
 //! if relativeMovement==true, the pos is changed relative to current pos,
 //! otherwise from begin of file
@@ -47,7 +99,8 @@ bool CReadFile::seek(const size_t& finalPos, bool relativeMovement)
 	if (!isOpen())
 		return false;
 
-	return fseek(File, finalPos, relativeMovement ? SEEK_CUR : SEEK_SET) == 0;
+	// relative movement can be negative, the size_t just wraps around
+	return NBL_FSEEK(File, static_cast<int64_t>(finalPos), relativeMovement ? SEEK_CUR : SEEK_SET) == 0;
 }
 
 
@@ -61,7 +114,7 @@ size_t CReadFile::getSize() const
 //! returns where in the file we are.
 size_t CReadFile::getPos() const
 {
-	return ftell(File);
+	return static_cast<size_t>(NBL_FTELL(File));
 }
 
 
@@ -84,9 +137,17 @@ void CReadFile::openFile()
 	{
 		// get FileSize
 
-		fseek(File, 0, SEEK_END);
+		NBL_FSEEK(File, 0, SEEK_END);
 		FileSize = getPos();
-		fseek(File, 0, SEEK_SET);
+		NBL_FSEEK(File, 0, SEEK_SET);
+
+#ifdef _NBL_WINDOWS_API_
+	#if defined(_NBL_WCHAR_FILESYSTEM)
+		PositionalHandle = CreateFileW(Filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	#else
+		PositionalHandle = CreateFileA(Filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	#endif
+#endif
 	}
 }
 
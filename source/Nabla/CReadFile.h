@@ -31,6 +31,9 @@ namespace io
             //! returns how much was read
             virtual int32_t read(void* buffer, uint32_t sizeToRead);
 
+            //! reads from an absolute position without touching the current one, can be called from multiple threads
+            virtual size_t readAt(size_t offset, void* buffer, size_t sizeToRead);
+
             //! changes position in file, returns true if successful
             virtual bool seek(const size_t& finalPos, bool relativeMovement = false);
 
@@ -55,6 +58,10 @@ namespace io
             void openFile();
 
             FILE* File;
+#ifdef _NBL_WINDOWS_API_
+            // a separate handle for `readAt` because positional `ReadFile` still moves the file pointer which `File` relies on
+            void* PositionalHandle;
+#endif
             size_t FileSize;
             io::path Filename;
 	};
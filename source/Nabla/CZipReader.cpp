@@ -6,6 +6,7 @@
 #include "CZipReader.h"
 #include "CMemoryFile.h"
 #include "CLimitReadFile.h"
+#include "CDecompressingReadFile.h"
 
 #include "os.h"
 #include <sstream>
@@ -439,11 +440,11 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
 		os::Printer::log("Reading encrypted file.");
 		uint8_t salt[16]={0};
 		const uint16_t saltSize = (((e.header.Sig & 0x00ff0000) >>16)+1)*4;
-		File->seek(e.Offset);
-		File->read(salt, saltSize);
+		size_t readOffset = e.Offset;
+		readOffset += File->readAt(readOffset, salt, saltSize);
 		char pwVerification[2];
 		char pwVerificationFile[2];
-		File->read(pwVerification, 2);
+		readOffset += File->readAt(readOffset, pwVerification, 2);
 		fcrypt_ctx zctx; // the encryption context
 		int rc = fcrypt_init(
 			(e.header.Sig & 0x00ff0000) >>16,
@@ -462,14 +463,14 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
 		uint32_t c = 0;
 		while ((c+32768)<=decryptedSize)
 		{
-			File->read(decryptedBuf+c, 32768);
+			readOffset += File->readAt(readOffset, decryptedBuf+c, 32768);
 			fcrypt_decrypt(
 				decryptedBuf+c, // pointer to the data to decrypt
 				32768,   // how many bytes to decrypt
 				&zctx); // decryption context
 			c+=32768;
 		}
-		File->read(decryptedBuf+c, decryptedSize-c);
+		readOffset += File->readAt(readOffset, decryptedBuf+c, decryptedSize-c);
 		fcrypt_decrypt(
 			decryptedBuf+c, // pointer to the data to decrypt
 			decryptedSize-c,   // how many bytes to decrypt
@@ -486,7 +487,7 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
 			delete [] decryptedBuf;
 			return 0;
 		}
-		File->read(fileMAC, 10);
+		File->readAt(readOffset, fileMAC, 10);
 		if (strncmp(fileMAC, resMAC, 10))
 		{
 			os::Printer::log("Error on encryption check");
@@ -510,6 +511,23 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
 #endif
 	}
 #endif
+	// compressed entries get decompressed lazily while being read, encrypted ones from their decrypted copy
+	auto createDecompressingFile = [&](CDecompressingReadFile::E_CODEC codec) -> IReadFile*
+	{
+		auto ret = new CDecompressingReadFile(decrypted ? decrypted:File, decrypted ? 0u:e.Offset, decryptedSize, e.header.DataDescriptor.UncompressedSize, codec, found->FullName);
+		delete[] decryptedBuf;
+		if (decrypted)
+			decrypted->drop();
+		if (!ret->isOpen())
+		{
+			swprintf ( buf, 64, L"Error decompressing %s", found->FullName.c_str() );
+			os::Printer::log( buf, ELL_ERROR);
+			ret->drop();
+			return 0;
+		}
+		return ret;
+	};
+
 	switch(actualCompressionMethod)
 	{
 	case 0: // no compression
@@ -523,161 +541,22 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
 	case 8:
 		{
   			#ifdef _NBL_COMPILE_WITH_ZLIB_
-
-			const uint32_t uncompressedSize = e.header.DataDescriptor.UncompressedSize;
-			char* pBuf = new char[ uncompressedSize ];
-			if (!pBuf)
-			{
-				swprintf ( buf, 64, L"Not enough memory for decompressing %s", found->FullName.c_str() );
-				os::Printer::log( buf, ELL_ERROR);
-                delete[] decryptedBuf;
-				if (decrypted)
-					decrypted->drop();
-				return 0;
-			}
-
-			uint8_t *pcData = decryptedBuf;
-			if (!pcData)
-			{
-				pcData = new uint8_t[decryptedSize];
-				if (!pcData)
-				{
-					swprintf ( buf, 64, L"Not enough memory for decompressing %s", found->FullName.c_str() );
-					os::Printer::log( buf, ELL_ERROR);
-                    delete[] decryptedBuf;
-					delete [] pBuf;
-					return 0;
-				}
-
-				//memset(pcData, 0, decryptedSize);
-				File->seek(e.Offset);
-				File->read(pcData, decryptedSize);
-			}
-
-			// Setup the inflate stream.
-			z_stream stream;
-			int32_t err;
-
-			stream.next_in = (Bytef*)pcData;
-			stream.avail_in = (uInt)decryptedSize;
-			stream.next_out = (Bytef*)pBuf;
-			stream.avail_out = uncompressedSize;
-			stream.zalloc = (alloc_func)0;
-			stream.zfree = (free_func)0;
-
-			// Perform inflation. wbits < 0 indicates no zlib header inside the data.
-			err = inflateInit2(&stream, -MAX_WBITS);
-			if (err == Z_OK)
-			{
-				err = inflate(&stream, Z_FINISH);
-				inflateEnd(&stream);
-				if (err == Z_STREAM_END)
-					err = Z_OK;
-				err = Z_OK;
-				inflateEnd(&stream);
-			}
-
+			return createDecompressingFile(CDecompressingReadFile::EC_DEFLATE);
+			#else
+            delete[] decryptedBuf;
 			if (decrypted)
 				decrypted->drop();
-			else
-				delete[] pcData;
-
-            delete[] decryptedBuf;
-			if (err != Z_OK)
-			{
-				swprintf ( buf, 64, L"Error decompressing %s", found->FullName.c_str() );
-				os::Printer::log( buf, ELL_ERROR);
-				delete [] pBuf;
-				return 0;
-			}
-            else
-            {
-                auto ret = new io::CMemoryReadFile(pBuf, uncompressedSize, found->FullName);
-                delete[] pBuf;
-                return ret;
-            }
-
-			#else
 			return 0; // zlib not compiled, we cannot decompress the data.
 			#endif
 		}
 	case 12:
 		{
   			#ifdef _NBL_COMPILE_WITH_BZIP2_
-
-			const uint32_t uncompressedSize = e.header.DataDescriptor.UncompressedSize;
-			char* pBuf = new char[ uncompressedSize ];
-			if (!pBuf)
-			{
-				swprintf ( buf, 64, L"Not enough memory for decompressing %s", found->FullName.c_str() );
-				os::Printer::log( buf, ELL_ERROR);
-                delete[] decryptedBuf;
-				if (decrypted)
-					decrypted->drop();
-				return 0;
-			}
-
-			uint8_t *pcData = decryptedBuf;
-			if (!pcData)
-			{
-				pcData = new uint8_t[decryptedSize];
-				if (!pcData)
-				{
-					swprintf ( buf, 64, L"Not enough memory for decompressing %s", found->FullName.c_str() );
-					os::Printer::log( buf, ELL_ERROR);
-					delete [] pBuf;
-                    delete[] decryptedBuf;
-					return 0;
-				}
-
-				//memset(pcData, 0, decryptedSize);
-				File->seek(e.Offset);
-				File->read(pcData, decryptedSize);
-			}
-
-			bz_stream bz_ctx={0};
-			/* use BZIP2's default memory allocation
-			bz_ctx->bzalloc = NULL;
-			bz_ctx->bzfree  = NULL;
-			bz_ctx->opaque  = NULL;
-			*/
-			int err = BZ2_bzDecompressInit(&bz_ctx, 0, 0); /* decompression */
-			if(err != BZ_OK)
-			{
-				os::Printer::log("bzip2 decompression failed. File cannot be read.", ELL_ERROR);
-                delete[] decryptedBuf;
-				return 0;
-			}
-			bz_ctx.next_in = (char*)pcData;
-			bz_ctx.avail_in = decryptedSize;
-			/* pass all input to decompressor */
-			bz_ctx.next_out = pBuf;
-			bz_ctx.avail_out = uncompressedSize;
-			err = BZ2_bzDecompress(&bz_ctx);
-			err = BZ2_bzDecompressEnd(&bz_ctx);
-
-			if (decrypted)
-				decrypted->drop();
-			else
-				delete[] pcData;
-
-			if (err != BZ_OK)
-			{
-				swprintf ( buf, 64, L"Error decompressing %s", found->FullName.c_str() );
-				os::Printer::log( buf, ELL_ERROR);
-				delete [] pBuf;
-                delete[] decryptedBuf;
-				return 0;
-			}
-            else
-            {
-                auto ret = new io::CMemoryReadFile(pBuf, uncompressedSize, found->FullName);
-                delete[] pBuf;
-                return ret;
-            }
-
+			return createDecompressingFile(CDecompressingReadFile::EC_BZIP2);
 			#else
             delete[] decryptedBuf;
+			if (decrypted)
+				decrypted->drop();
 			os::Printer::log("bzip2 decompression not supported. File cannot be read.", ELL_ERROR);
 			return 0;
 			#endif
@@ -685,65 +564,11 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
 	case 14:
 		{
   			#ifdef _NBL_COMPILE_WITH_LZMA_
-
-			uint32_t uncompressedSize = e.header.DataDescriptor.UncompressedSize;
-			char* pBuf = new char[ uncompressedSize ];
-			if (!pBuf)
-			{
-				swprintf ( buf, 64, L"Not enough memory for decompressing %s", found->FullName.c_str() );
-				os::Printer::log( buf, ELL_ERROR);
-                delete[] decryptedBuf;
-				if (decrypted)
-					decrypted->drop();
-				return 0;
-			}
-
-			uint8_t *pcData = decryptedBuf;
-			if (!pcData)
-			{
-				pcData = new uint8_t[decryptedSize];
-				if (!pcData)
-				{
-					swprintf ( buf, 64, L"Not enough memory for decompressing %s", found->FullName.c_str() );
-					os::Printer::log( buf, ELL_ERROR);
-					delete [] pBuf;
-					return 0;
-				}
-
-				//memset(pcData, 0, decryptedSize);
-				File->seek(e.Offset);
-				File->read(pcData, decryptedSize);
-			}
-
-			ELzmaStatus status;
-			SizeT tmpDstSize = uncompressedSize;
-			SizeT tmpSrcSize = decryptedSize;
-
-			unsigned int propSize = (pcData[3]<<8)+pcData[2];
-			int err = LzmaDecode((Byte*)pBuf, &tmpDstSize,
-					pcData+4+propSize, &tmpSrcSize,
-					pcData+4, propSize,
-					e.header.GeneralBitFlag&0x1?LZMA_FINISH_END:LZMA_FINISH_ANY, &status,
-					&lzmaAlloc);
-			uncompressedSize = tmpDstSize; // may be different to expected value
-
-			if (decrypted)
-				decrypted->drop();
-			else
-				delete[] pcData;
-
-            delete[] decryptedBuf;
-			if (err != SZ_OK)
-			{
-				os::Printer::log( "Error decompressing", found->FullName, ELL_ERROR);
-				delete [] pBuf;
-				return 0;
-			}
-			else
-				return io::createMemoryReadFile(pBuf, uncompressedSize, found->FullName, true);
-
+			return createDecompressingFile(CDecompressingReadFile::EC_LZMA);
 			#else
             delete[] decryptedBuf;
+			if (decrypted)
+				decrypted->drop();
 			os::Printer::log("lzma decompression not supported. File cannot be read.", ELL_ERROR);
 			return 0;
 			#endif
@@ -761,16 +586,6 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
 	};
 }
 
-#ifdef _NBL_COMPILE_WITH_LZMA_
-//! Used for LZMA decompression. The lib has no default memory management
-namespace
-{
-	void *SzAlloc(void *p, size_t size) { p = p; return _NBL_ALIGNED_MALLOC(size,_NBL_SIMD_ALIGNMENT); }
-	void SzFree(void *p, void *address) { p = p; _NBL_ALIGNED_FREE(address); }
-	ISzAlloc lzmaAlloc = { SzAlloc, SzFree };
-}
-#endif
-
 } // end namespace io
 } // end namespace nbl
 
@@ -419,3 +419,55 @@ void IAssetManager::insertBuiltinAssets()
             addBuiltInToCaches(pipelineLayout, path);
     }
 }
+
+
+void IAssetManager::deduplicateLoadedBundle(SAssetBundle& _bundle)
+{
+	// metadata is looked up by asset pointer, so the top-level assets of bundles with metadata can't be swapped out
+	const bool keepIdentity = _bundle.getMetadata();
+
+	std::lock_guard<std::mutex> lock(m_deduplicatorMutex);
+	const auto contents = _bundle.getContents();
+	for (uint32_t i=0u; i<contents.size(); i++)
+	{
+		IAsset* asset = contents.begin()[i].get();
+		if (keepIdentity)
+			m_deduplicator->deduplicateContents(asset);
+		else
+		{
+			auto canonical = m_deduplicator->deduplicate(core::smart_refctd_ptr<IAsset>(asset));
+			if (canonical.get()!=asset)
+				_bundle.setAsset(i,std::move(canonical));
+		}
+	}
+}
+
+CAssetDeduplicator::SStatistics IAssetManager::deduplicateCachedAssets(const uint64_t& _assetTypeBitFlags)
+{
+	core::vector<typename AssetCacheType::MutablePairType> cached;
+
+	std::lock_guard<std::mutex> lock(m_deduplicatorMutex);
+	const auto before = m_deduplicator->getStatistics();
+	for (size_t i=0u; i<IAsset::ET_STANDARD_TYPES_COUNT; i++)
+	{
+		if (!((_assetTypeBitFlags>>i)&1ull))
+			continue;
+
+		size_t count = m_assetCache[i]->getSize();
+		cached.resize(count);
+		m_assetCache[i]->outputAll(count,cached.data());
+		cached.resize(count);
+		for (const auto& entry : cached)
+		for (const auto& asset : entry.second.getContents())
+			m_deduplicator->deduplicateContents(asset.get());
+	}
+
+	const auto& after = m_deduplicator->getStatistics();
+	CAssetDeduplicator::SStatistics retval;
+	retval.buffersDeduplicated = after.buffersDeduplicated-before.buffersDeduplicated;
+	retval.imagesDeduplicated = after.imagesDeduplicated-before.imagesDeduplicated;
+	retval.imageViewsDeduplicated = after.imageViewsDeduplicated-before.imageViewsDeduplicated;
+	retval.meshBuffersDeduplicated = after.meshBuffersDeduplicated-before.meshBuffersDeduplicated;
+	retval.bytesSaved = after.bytesSaved-before.bytesSaved;
+	return retval;
+}
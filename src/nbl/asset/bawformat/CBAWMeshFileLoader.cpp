@@ -5,6 +5,8 @@
 #include "CBAWMeshFileLoader.h"
 
 #include <stack>
+#include <algorithm>
+#include <execution>
 
 #include "os.h"
 #include "CMemoryFile.h"
@@ -93,6 +95,21 @@ SAssetBundle CBAWMeshFileLoader::loadAsset(io::IReadFile* _file, const asset::IA
 	}
 	_NBL_ALIGNED_FREE(offsets);
 
+	// reading, hash validation and decompression of a blob don't depend on any other blob, so dependencies get fetched in parallel as soon as the walk discovers them
+	// encrypted blobs are left for the walk itself because their keys come from the override, one blob at a time
+	core::vector<SBlobData*> discovered;
+	auto prefetch = [&]() -> void
+	{
+		auto end = std::remove_if(discovered.begin(), discovered.end(), [](const SBlobData* data) {
+			return data->heapBlob || (data->header->compressionType & asset::Blob::EBCT_AES128_GCM);
+		});
+		std::for_each(std::execution::par, discovered.begin(), end, [&](SBlobData* data)
+		{
+			data->heapBlob = tryReadBlobOnStack(*data, ctx, nullptr);
+		});
+		discovered.clear();
+	};
+
     const std::string rootCacheKey = ctx.inner.mainFile->getFileName().c_str();
 
 	asset::BlobLoadingParams params{
@@ -125,7 +142,9 @@ SAssetBundle CBAWMeshFileLoader::loadAsset(io::IReadFile* _file, const asset::IA
         // todo: supposedFilename arg is missing (empty string) - what is it?
         while (_override->getDecryptionKey(decrKey, decrKeyLen, attempt, ctx.inner.mainFile, "", thisCacheKey, ctx.inner, hierLvl))
         {
-            if (!((data->header->compressionType & asset::Blob::EBCT_AES128_GCM) && decrKeyLen != 16u))
+            if (data->heapBlob) // prefetched, the override still gets asked so it can observe or veto every blob
+                blob = data->heapBlob;
+            else if (!((data->header->compressionType & asset::Blob::EBCT_AES128_GCM) && decrKeyLen != 16u))
                 blob = data->heapBlob = tryReadBlobOnStack(*data, ctx, decrKey);
             if (blob)
                 break;
@@ -144,13 +163,17 @@ SAssetBundle CBAWMeshFileLoader::loadAsset(io::IReadFile* _file, const asset::IA
             {
                 toLoad.push(&ctx.blobs[*it]);
                 toLoad.top()->hierarchyLvl = hierLvl+1u;
+                discovered.push_back(toLoad.top());
             }
         }
+        prefetch();
 
         auto foundBundle = _override->findCachedAsset(thisCacheKey, nullptr, ctx.inner, hierLvl).getContents();
         if (foundBundle.first!=foundBundle.second)
         {
             ctx.createdObjs[handle] = toAddrUsedByBlobsLoadingMgr(foundBundle.first->get(), blobType);
+            _NBL_ALIGNED_FREE(data->heapBlob);
+            data->heapBlob = nullptr;
             continue;
         }
 
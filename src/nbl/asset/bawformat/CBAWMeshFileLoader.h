@@ -161,7 +161,8 @@ private:
 		bool safeRead(io::IReadFile* _file, void* _buf, size_t _size) const;
 
 		//! Reads blob to memory on stack or allocates sufficient amount on heap if provided stack storage was not big enough.
-		/** @returns `_stackPtr` if blob was read to it or pointer to malloc'd memory otherwise.*/
+		/** Safe to call concurrently for different blobs of the same file.
+		@returns `_stackPtr` if blob was read to it or pointer to malloc'd memory otherwise.*/
 		template<typename HeaderT>
 		void* tryReadBlobOnStack(const SBlobData_t<HeaderT>& _data, SContext& _ctx, const unsigned char pwd[16], void* _stackPtr=NULL, size_t _stackSize=0) const;
 
@@ -406,14 +407,14 @@ void* CBAWMeshFileLoader::tryReadBlobOnStack(const SBlobData_t<HeaderT> & _data,
         dst = _NBL_ALIGNED_MALLOC(BlobHeaderVn<_NBL_FORMAT_VERSION>::calcEncSize(_data.header->blobSizeDecompr), _NBL_SIMD_ALIGNMENT);
 
     const bool encrypted = (_data.header->compressionType & asset::Blob::EBCT_AES128_GCM);
-    const bool compressed = (_data.header->compressionType & asset::Blob::EBCT_LZ4) || (_data.header->compressionType & asset::Blob::EBCT_LZMA);
+    const bool compressed = (_data.header->compressionType & (asset::Blob::EBCT_LZ4 | asset::Blob::EBCT_LZ4HC | asset::Blob::EBCT_LZMA));
 
     void* dstCompressed = dst; // ptr to mem to load possibly compressed data
     if (compressed)
         dstCompressed = _NBL_ALIGNED_MALLOC(_data.header->effectiveSize(), _NBL_SIMD_ALIGNMENT);
 
-    _ctx.inner.mainFile->seek(_data.absOffset);
-    _ctx.inner.mainFile->read(dstCompressed, _data.header->effectiveSize());
+    // positional read so that blobs can be fetched from multiple threads at once
+    _ctx.inner.mainFile->readAt(_data.absOffset, dstCompressed, _data.header->effectiveSize());
 
     if (!_data.header->validate(dstCompressed))
     {
@@ -470,7 +471,7 @@ void* CBAWMeshFileLoader::tryReadBlobOnStack(const SBlobData_t<HeaderT> & _data,
         const uint8_t comprType = _data.header->compressionType;
         bool res = false;
 
-        if (comprType & asset::Blob::EBCT_LZ4)
+        if (comprType & (asset::Blob::EBCT_LZ4 | asset::Blob::EBCT_LZ4HC)) // HC only differs while compressing
             res = decompressLz4(dst, _data.header->blobSizeDecompr, dstCompressed, _data.header->blobSize);
         else if (comprType & asset::Blob::EBCT_LZMA)
             res = decompressLzma(dst, _data.header->blobSizeDecompr, dstCompressed, _data.header->blobSize);
@@ -11,8 +11,12 @@
 #include "IFileSystem.h"
 #include "IWriteFile.h"
 
+#include <algorithm>
+#include <execution>
+#include <numeric>
 
 #include "lz4/lib/lz4.h"
+#include "lz4/lib/lz4hc.h"
 #undef Bool
 #include "lzma/C/LzmaEnc.h"
 
@@ -39,7 +43,7 @@ struct LzmaMemMngmnt
 	}
 
 	template<>
-	void CBAWMeshWriter::exportAsBlob<ICPUMesh>(ICPUMesh* _obj, uint32_t _headerIdx, io::IWriteFile* _file, SContext& _ctx)
+	void CBAWMeshWriter::exportAsBlob<ICPUMesh>(ICPUMesh* _obj, uint32_t _headerIdx, SContext& _ctx)
 	{
 		uint8_t stackData[1u<<14];
         auto data = MeshBlobV3::createAndTryOnStack(_obj, stackData, sizeof(stackData));
@@ -51,13 +55,13 @@ struct LzmaMemMngmnt
         const uint8_t* encrPwd = nullptr;
         _ctx.writerOverride->getEncryptionKey(encrPwd, _ctx.inner, _obj, 0u);
         const float comprLvl = _ctx.writerOverride->getAssetCompressionLevel(_ctx.inner, _obj, 0u);
-		tryWrite(data, _file, _ctx, MeshBlobV3::calcBlobSizeForObj(_obj), _headerIdx, flags, encrPwd, comprLvl);
+		queueBlob(data, _ctx, MeshBlobV3::calcBlobSizeForObj(_obj), _headerIdx, flags, encrPwd, comprLvl);
 
 		if ((uint8_t*)data != stackData)
 			_NBL_ALIGNED_FREE(data);
 	}
 	template<>
-	void CBAWMeshWriter::exportAsBlob<ICPUMeshBuffer>(ICPUMeshBuffer* _obj, uint32_t _headerIdx, io::IWriteFile* _file, SContext& _ctx)
+	void CBAWMeshWriter::exportAsBlob<ICPUMeshBuffer>(ICPUMeshBuffer* _obj, uint32_t _headerIdx, SContext& _ctx)
 	{
         MeshBufferBlobV3 data(_obj);
 
@@ -65,16 +69,16 @@ struct LzmaMemMngmnt
         const uint8_t* encrPwd = nullptr;
         _ctx.writerOverride->getEncryptionKey(encrPwd, _ctx.inner, _obj, 1u);
         const float comprLvl = _ctx.writerOverride->getAssetCompressionLevel(_ctx.inner, _obj, 1u);
-		tryWrite(&data, _file, _ctx, sizeof(data), _headerIdx, flags, encrPwd, comprLvl);
+		queueBlob(&data, _ctx, sizeof(data), _headerIdx, flags, encrPwd, comprLvl);
 	}
 	template<>
-	void CBAWMeshWriter::exportAsBlob<ICPUBuffer>(ICPUBuffer* _obj, uint32_t _headerIdx, io::IWriteFile* _file, SContext& _ctx)
+	void CBAWMeshWriter::exportAsBlob<ICPUBuffer>(ICPUBuffer* _obj, uint32_t _headerIdx, SContext& _ctx)
 	{
         const E_WRITER_FLAGS flags = _ctx.writerOverride->getAssetWritingFlags(_ctx.inner, _obj, 3u);
         const uint8_t* encrPwd = nullptr;
         _ctx.writerOverride->getEncryptionKey(encrPwd, _ctx.inner, _obj, 3u);
         const float comprLvl = _ctx.writerOverride->getAssetCompressionLevel(_ctx.inner, _obj, 3u);
-		tryWrite(_obj->getPointer(), _file, _ctx, _obj->getSize(), _headerIdx, flags, encrPwd, comprLvl);
+		queueBlob(_obj->getPointer(), _ctx, _obj->getSize(), _headerIdx, flags, encrPwd, comprLvl, true);
 	}
 
 	bool CBAWMeshWriter::writeAsset(io::IWriteFile* _file, const SAssetWriteParams& _params, IAssetWriterOverride* _override)
@@ -120,37 +124,65 @@ struct LzmaMemMngmnt
 		_file->write(ctx.headers.data(), ctx.headers.size() * sizeof(BlobHeaderLatest));
 
 		ctx.offsets.resize(0); // set `used` to 0, to allow push starting from 0 index
+		ctx.blobs.resize(ctx.headers.size());
 		for (int i = 0; i < ctx.headers.size(); ++i)
 		{
 			switch (ctx.headers[i].blobType)
 			{
 			case Blob::EBT_MESH:
-				exportAsBlob(reinterpret_cast<ICPUMesh*>(ctx.headers[i].handle), i, _file, ctx);
+				exportAsBlob(reinterpret_cast<ICPUMesh*>(ctx.headers[i].handle), i, ctx);
 				break;
 			case Blob::EBT_SKINNED_MESH:
-				exportAsBlob(reinterpret_cast<ICPUSkinnedMesh*>(ctx.headers[i].handle), i, _file, ctx);
+				exportAsBlob(reinterpret_cast<ICPUSkinnedMesh*>(ctx.headers[i].handle), i, ctx);
 				break;
 			case Blob::EBT_MESH_BUFFER:
-				exportAsBlob(reinterpret_cast<ICPUMeshBuffer*>(ctx.headers[i].handle), i, _file, ctx);
+				exportAsBlob(reinterpret_cast<ICPUMeshBuffer*>(ctx.headers[i].handle), i, ctx);
 				break;
 			case Blob::EBT_SKINNED_MESH_BUFFER:
-				exportAsBlob(reinterpret_cast<ICPUSkinnedMeshBuffer*>(ctx.headers[i].handle), i, _file, ctx);
+				exportAsBlob(reinterpret_cast<ICPUSkinnedMeshBuffer*>(ctx.headers[i].handle), i, ctx);
 				break;
 			case Blob::EBT_RAW_DATA_BUFFER:
-				exportAsBlob(reinterpret_cast<ICPUBuffer*>(ctx.headers[i].handle), i, _file, ctx);
+				exportAsBlob(reinterpret_cast<ICPUBuffer*>(ctx.headers[i].handle), i, ctx);
 				break;
 			case Blob::EBT_DATA_FORMAT_DESC:
-				exportAsBlob(reinterpret_cast<IMeshDataFormatDesc<ICPUBuffer>*>(ctx.headers[i].handle), i, _file, ctx);
+				exportAsBlob(reinterpret_cast<IMeshDataFormatDesc<ICPUBuffer>*>(ctx.headers[i].handle), i, ctx);
 				break;
 			case Blob::EBT_FINAL_BONE_HIERARCHY:
-				exportAsBlob(reinterpret_cast<CFinalBoneHierarchy*>(ctx.headers[i].handle), i, _file, ctx);
+				exportAsBlob(reinterpret_cast<CFinalBoneHierarchy*>(ctx.headers[i].handle), i, ctx);
 				break;
 			case Blob::EBT_TEXTURE_PATH:
-				exportAsBlob(reinterpret_cast<ICPUTexture*>(ctx.headers[i].handle), i, _file, ctx);
+				exportAsBlob(reinterpret_cast<ICPUTexture*>(ctx.headers[i].handle), i, ctx);
 				break;
 			}
 		}
 
+		// blobs compress and encrypt independently of each other, only writing them out has to happen in header order
+		core::vector<uint32_t> blobIndices(ctx.blobs.size());
+		std::iota(blobIndices.begin(), blobIndices.end(), 0u);
+		std::for_each(std::execution::par, blobIndices.begin(), blobIndices.end(), [&](uint32_t i)
+		{
+			if (ctx.blobs[i].data)
+				encodeBlob(ctx.blobs[i], i, ctx);
+		});
+
+		for (uint32_t i = 0u; i < ctx.blobs.size(); ++i)
+		{
+			SBlobJob& blob = ctx.blobs[i];
+			if (!blob.data)
+			{
+				pushCorruptedOffset(ctx);
+				continue;
+			}
+
+			_file->write(blob.encoded, blob.encodedSize);
+			calcAndPushNextOffset(!i ? 0 : ctx.headers[i - 1].effectiveSize(), ctx);
+
+			if (blob.encoded != blob.data)
+				_NBL_ALIGNED_FREE(const_cast<void*>(blob.encoded)); // safe const_cast since it's _NBL_ALIGNED_MALLOC'd by the compressing/encrypting functions
+			if (blob.ownedData)
+				_NBL_ALIGNED_FREE(blob.ownedData);
+		}
+
 		const size_t prevPos = _file->getPos();
 
 		// overwrite offsets
@@ -289,38 +321,57 @@ struct LzmaMemMngmnt
 		_ctx.offsets.push_back(!_ctx.offsets.size() ? 0 : _ctx.offsets.back() + _blobSize);
 	}
 
-	void CBAWMeshWriter::tryWrite(void* _data, io::IWriteFile * _file, SContext & _ctx, size_t _size, uint32_t _headerIdx, E_WRITER_FLAGS _flags, const uint8_t* _encrPwd, float _comprLvl) const
+	void CBAWMeshWriter::queueBlob(const void* _data, SContext& _ctx, size_t _size, uint32_t _headerIdx, E_WRITER_FLAGS _flags, const uint8_t* _encrPwd, float _comprLvl, bool _persistentData) const
 	{
+		SBlobJob& blob = _ctx.blobs[_headerIdx];
 		if (!_data)
-			return pushCorruptedOffset(_ctx);
+			return;
+
+		blob.data = _data;
+		if (!_persistentData)
+		{
+			blob.ownedData = _NBL_ALIGNED_MALLOC(_size, _NBL_SIMD_ALIGNMENT);
+			memcpy(blob.ownedData, _data, _size);
+			blob.data = blob.ownedData;
+		}
+		blob.size = _size;
+		blob.flags = _flags;
+		blob.encrPwd = _encrPwd;
+		blob.comprLvl = _comprLvl;
+	}
 
+	void CBAWMeshWriter::encodeBlob(SBlobJob& _blob, uint32_t _headerIdx, SContext& _ctx) const
+	{
+		E_WRITER_FLAGS flags = _blob.flags;
 #ifndef _NBL_COMPILE_WITH_OPENSSL_
-		_encrypt = false;
+		flags = static_cast<E_WRITER_FLAGS>(flags & ~EWF_ENCRYPTED);
 #endif // _NBL_COMPILE_WITH_OPENSSL_
 
-		uint8_t stack[1u<<14];
-
-		size_t compressedSize = _size;
-		void* data = _data;
+		const size_t size = _blob.size;
+		void* const input = const_cast<void*>(_blob.data);
+		size_t compressedSize = size;
+		void* data = input;
 		uint8_t comprType = Blob::EBCT_RAW;
 
-        if (_flags & EWF_COMPRESSED)
+        if (flags & EWF_COMPRESSED)
         {
-            if (_comprLvl > 0.3f)
+            const bool highCompression = _blob.comprLvl > 0.3f;
+            if (highCompression && !(flags & EWF_FAST_DECOMPRESSION))
             {
-                data = compressWithLzma(data, _size, compressedSize);
-                if (data != _data)
+                data = compressWithLzma(data, size, compressedSize);
+                if (data != input)
                     comprType |= Blob::EBCT_LZMA;
             }
-            else if (_comprLvl == 0.3f && _size<=0xffffffffull)
+            else if (_blob.comprLvl >= 0.3f && size<=0xffffffffull)
             {
-                data = compressWithLz4AndTryOnStack(data, static_cast<uint32_t>(_size), stack, static_cast<uint32_t>(sizeof(stack)), compressedSize);
-                if (data != _data)
-                    comprType |= Blob::EBCT_LZ4;
+                // no stack to try, the result has to outlive this call
+                data = compressWithLz4AndTryOnStack(data, static_cast<uint32_t>(size), nullptr, 0u, compressedSize, highCompression);
+                if (data != input)
+                    comprType |= highCompression ? Blob::EBCT_LZ4HC:Blob::EBCT_LZ4;
             }
         }
 
-		if (_flags & EWF_ENCRYPTED)
+		if (flags & EWF_ENCRYPTED)
 		{
 			const size_t encrSize = BlobHeaderLatest::calcEncSize(compressedSize);
 			void* in = _NBL_ALIGNED_MALLOC(encrSize,_NBL_SIMD_ALIGNMENT);
@@ -330,9 +381,9 @@ struct LzmaMemMngmnt
 			void* out = _NBL_ALIGNED_MALLOC(encrSize, _NBL_SIMD_ALIGNMENT);
 
             const WriteProperties* props = reinterpret_cast<const WriteProperties*>(_ctx.inner.params.userData);
-			if (encAes128gcm(data, encrSize, out, encrSize, _encrPwd, props->initializationVector, _ctx.headers[_headerIdx].gcmTag))
+			if (encAes128gcm(data, encrSize, out, encrSize, _blob.encrPwd, props->initializationVector, _ctx.headers[_headerIdx].gcmTag))
 			{
-				if (data != _data && data != stack) // allocated in compressing functions?
+				if (data != input) // allocated in compressing functions?
 					_NBL_ALIGNED_FREE(data);
 				data = out;
 				_NBL_ALIGNED_FREE(in);
@@ -348,16 +399,12 @@ struct LzmaMemMngmnt
 			}
 		}
 
-		_ctx.headers[_headerIdx].finalize(data, _size, compressedSize, comprType);
-		const size_t writeSize = (comprType & Blob::EBCT_AES128_GCM) ? BlobHeaderLatest::calcEncSize(compressedSize) : compressedSize;
-		_file->write(data, writeSize);
-		calcAndPushNextOffset(!_headerIdx ? 0 : _ctx.headers[_headerIdx - 1].effectiveSize(), _ctx);
-
-		if (data != stack && data != _data)
-			_NBL_ALIGNED_FREE(const_cast<void*>(data)); // safe const_cast since the only case when this executes is when `data` points to _NBL_ALIGNED_MALLOC'd memory
+		_ctx.headers[_headerIdx].finalize(data, size, compressedSize, comprType);
+		_blob.encoded = data;
+		_blob.encodedSize = (comprType & Blob::EBCT_AES128_GCM) ? BlobHeaderLatest::calcEncSize(compressedSize) : compressedSize;
 	}
 
-	void* CBAWMeshWriter::compressWithLz4AndTryOnStack(const void* _input, uint32_t _inputSize, void* _stack, uint32_t _stackSize, size_t& _outComprSize) const
+	void* CBAWMeshWriter::compressWithLz4AndTryOnStack(const void* _input, uint32_t _inputSize, void* _stack, uint32_t _stackSize, size_t& _outComprSize, bool _highCompression) const
 	{
 		void* data = _stack;
 		size_t dstSize = _stackSize;
@@ -371,7 +418,10 @@ struct LzmaMemMngmnt
 				dstSize = BlobHeaderLatest::calcEncSize(lz4CompressBound);
 				data = _NBL_ALIGNED_MALLOC(dstSize,_NBL_SIMD_ALIGNMENT);
 			}
-			compressedSize = LZ4_compress_default((const char*)_input, (char*)data, _inputSize, dstSize);
+			if (_highCompression) // same format, just a slower and more thorough match search
+				compressedSize = LZ4_compress_HC((const char*)_input, (char*)data, _inputSize, dstSize, LZ4HC_CLEVEL_DEFAULT);
+			else
+				compressedSize = LZ4_compress_default((const char*)_input, (char*)data, _inputSize, dstSize);
 		}
 		if (!compressedSize) // if compression did not succeed
 		{
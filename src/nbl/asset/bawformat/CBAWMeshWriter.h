@@ -51,12 +51,27 @@ namespace asset
 		};
 
 	private:
+		//! Blob gathered from an exported object, waiting to be compressed/encrypted and written
+		struct SBlobJob
+		{
+			const void* data = nullptr;
+			void* ownedData = nullptr; // copy of `data` made when the exporter's storage doesn't live until the write
+			size_t size = 0ull;
+			asset::E_WRITER_FLAGS flags = asset::EWF_NONE;
+			const uint8_t* encrPwd = nullptr;
+			float comprLvl = 0.f;
+			// filled by `encodeBlob`, points to `data` if it got neither compressed nor encrypted
+			const void* encoded = nullptr;
+			size_t encodedSize = 0ull;
+		};
+
 		struct SContext
 		{
 			asset::IAssetWriter::SAssetWriteContext inner;
             asset::IAssetWriter::IAssetWriterOverride* writerOverride;
 			core::vector<asset::BlobHeaderLatest> headers;
 			core::vector<uint32_t> offsets;
+			core::vector<SBlobJob> blobs; // one per header
 		};
 
         class CBAWOverride : public IAssetWriterOverride
@@ -92,7 +107,7 @@ namespace asset
         virtual uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_MESH; }
 
         //! Returns which flags are supported for writing modes
-        virtual uint32_t getSupportedFlags() override { return asset::EWF_COMPRESSED | asset::EWF_ENCRYPTED; }
+        virtual uint32_t getSupportedFlags() override { return asset::EWF_COMPRESSED | asset::EWF_ENCRYPTED | asset::EWF_FAST_DECOMPRESSION; }
 
         //! Returns which flags are forced for writing modes, i.e. a writer can only support binary
         virtual uint32_t getForcedFlags() override { return asset::EWF_BINARY; }
@@ -100,12 +115,11 @@ namespace asset
         virtual bool writeAsset(io::IWriteFile* _file, const SAssetWriteParams& _params, IAssetWriterOverride* _override = nullptr) override;
 
 	private:
-		//! Takes object and exports (writes to file) its data as another blob.
+		//! Takes object and queues its data as another blob.
 		/** @param _obj Pointer to object which is to be exported.
-		@param _headersIdx Corresponding index of headers array.
-		@param _file Target file.*/
+		@param _headersIdx Corresponding index of headers array.*/
 		template<typename T>
-		void exportAsBlob(T* _obj, uint32_t _headerIdx, io::IWriteFile* _file, SContext& _ctx);
+		void exportAsBlob(T* _obj, uint32_t _headerIdx, SContext& _ctx);
 
 		//! Generates header of blobs from mesh object and pushes them to `SContext::headers`.
 		/** After calling this method headers are NOT ready yet. Hashes (and also size in case of texture path blob) are calculated while writing blob data.
@@ -121,11 +135,17 @@ namespace asset
 		//! Pushes corrupted offset so that, while loading resulting .baw file, it will be easy to find out something went wrong.
 		void pushCorruptedOffset(SContext& _ctx) const { _ctx.offsets.push_back(0xffffffff); }
 
-		//! Tries to write given data to file. If not possible (i.e. _data is NULL) - pushes "corrupted offset" and does not call .finalize() on blob-header.
-		void tryWrite(void* _data, io::IWriteFile* _file, SContext& _ctx, size_t _size, uint32_t _headerIdx, asset::E_WRITER_FLAGS _flags, const uint8_t* _encrPwd = nullptr, float _comprLvl = 0.f) const;
-		
+		//! Records given data as the blob for `_headerIdx`, it gets compressed, encrypted and written once all blobs are gathered.
+		/** Unless `_persistentData` is set the data gets copied, because exporters often assemble blobs in temporaries.
+		If `_data` is NULL a "corrupted offset" gets pushed while writing and .finalize() doesn't get called on the blob-header.*/
+		void queueBlob(const void* _data, SContext& _ctx, size_t _size, uint32_t _headerIdx, asset::E_WRITER_FLAGS _flags, const uint8_t* _encrPwd = nullptr, float _comprLvl = 0.f, bool _persistentData = false) const;
+
+		//! Compresses and encrypts the blob according to its flags and finalizes its header, safe to call for different blobs concurrently.
+		/** Compression level 0.3 picks LZ4 and levels above it pick LZMA, unless `asset::EWF_FAST_DECOMPRESSION` is set in which case they pick LZ4HC.*/
+		void encodeBlob(SBlobJob& _blob, uint32_t _headerIdx, SContext& _ctx) const;
+
 		//! Uint32_t because lzma doesn't support compressing more than 4GB
-		void* compressWithLz4AndTryOnStack(const void* _input, uint32_t _inputSize, void* _stack, uint32_t _stackSize, size_t& _outComprSize) const;
+		void* compressWithLz4AndTryOnStack(const void* _input, uint32_t _inputSize, void* _stack, uint32_t _stackSize, size_t& _outComprSize, bool _highCompression = false) const;
 		void* compressWithLzma(const void* _input, size_t _inputSize, size_t& _outComprSize) const;
 
 	private:
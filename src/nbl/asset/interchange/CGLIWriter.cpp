@@ -369,7 +369,7 @@ inline std::pair<gli::texture::format_type, std::array<gli::gl::swizzle, 4>> get
 		case EF_BC1_RGBA_SRGB_BLOCK: return getTranslatedFinalFormat(FORMAT_RGBA_DXT1_SRGB_BLOCK8);				//GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
 		case EF_BC2_SRGB_BLOCK: return getTranslatedFinalFormat(FORMAT_RGBA_DXT3_SRGB_BLOCK16);				//GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT
 		case EF_BC3_SRGB_BLOCK: return getTranslatedFinalFormat(FORMAT_RGBA_DXT5_SRGB_BLOCK16);				//GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
-		case EF_BC7_SRGB_BLOCK: return getTranslatedFinalFormat(FORMAT_RGB_BP_UFLOAT_BLOCK16 /*there should be BP_UNORM, but no provided for RGB*/);	//GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+		case EF_BC7_SRGB_BLOCK: return getTranslatedFinalFormat(FORMAT_RGBA_BP_SRGB_BLOCK16);	//GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
 		case EF_ETC2_R8G8B8_SRGB_BLOCK: return getTranslatedFinalFormat(FORMAT_RGB_ETC2_SRGB_BLOCK8);						//GL_COMPRESSED_SRGB8_ETC2
 		case EF_ETC2_R8G8B8A1_SRGB_BLOCK: return getTranslatedFinalFormat(FORMAT_RGBA_ETC2_SRGB_BLOCK8);	//GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2
 		case EF_ETC2_R8G8B8A8_SRGB_BLOCK: return getTranslatedFinalFormat(FORMAT_RGBA_ETC2_SRGB_BLOCK8);			//GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC
@@ -425,7 +425,7 @@ inline std::pair<gli::texture::format_type, std::array<gli::gl::swizzle, 4>> get
 		case EF_BC5_SNORM_BLOCK: return getTranslatedFinalFormat(FORMAT_RG_ATI2N_SNORM_BLOCK16);				//GL_COMPRESSED_SIGNED_RG_RGTC2
 		case EF_BC6H_UFLOAT_BLOCK: return getTranslatedFinalFormat(FORMAT_RGB_BP_UFLOAT_BLOCK16);		//GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT
 		case EF_BC6H_SFLOAT_BLOCK: return getTranslatedFinalFormat(FORMAT_RGB_BP_SFLOAT_BLOCK16);			//GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT
-		case EF_BC7_UNORM_BLOCK: return getTranslatedFinalFormat(FORMAT_RGB_BP_UFLOAT_BLOCK16 /*there should be BP_UNORM, but no provided for RGB*/);					//GL_COMPRESSED_RGBA_BPTC_UNORM
+		case EF_BC7_UNORM_BLOCK: return getTranslatedFinalFormat(FORMAT_RGBA_BP_UNORM_BLOCK16);					//GL_COMPRESSED_RGBA_BPTC_UNORM
 
 		case EF_ASTC_4x4_UNORM_BLOCK: return getTranslatedFinalFormat(FORMAT_RGBA_ASTC_4X4_UNORM_BLOCK16);				//GL_COMPRESSED_RGBA_ASTC_4x4_KHR
 		case EF_ASTC_5x4_UNORM_BLOCK: return getTranslatedFinalFormat(FORMAT_RGBA_ASTC_5X4_UNORM_BLOCK16);				//GL_COMPRESSED_RGBA_ASTC_5x4_KHR
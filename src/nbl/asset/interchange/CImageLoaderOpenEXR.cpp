@@ -20,6 +20,7 @@ SOFTWARE.
 #include <algorithm>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
 #include "nbl/asset/IAssetManager.h"
@@ -27,7 +28,6 @@ SOFTWARE.
 
 #ifdef _NBL_COMPILE_WITH_OPENEXR_LOADER_
 
-#include "nbl/asset/filters/CRegionBlockFunctorFilter.h"
 #include "nbl/asset/metadata/COpenEXRMetadata.h"
 
 #include "CImageLoaderOpenEXR.h"
@@ -35,13 +35,16 @@ SOFTWARE.
 #include "os.h"
 
 #include "openexr/IlmBase/Imath/ImathBox.h"
+#include "openexr/IlmBase/IlmThread/IlmThread.h"
 #include "openexr/OpenEXR/IlmImf/ImfRgbaFile.h"
 #include "openexr/OpenEXR/IlmImf/ImfInputFile.h"
+#include "openexr/OpenEXR/IlmImf/ImfTiledInputFile.h"
+#include "openexr/OpenEXR/IlmImf/ImfFrameBuffer.h"
+#include "openexr/OpenEXR/IlmImf/ImfThreading.h"
 #include "openexr/OpenEXR/IlmImf/ImfChannelList.h"
 #include "openexr/OpenEXR/IlmImf/ImfChannelListAttribute.h"
 #include "openexr/OpenEXR/IlmImf/ImfStringAttribute.h"
 #include "openexr/OpenEXR/IlmImf/ImfMatrixAttribute.h"
-#include "openexr/OpenEXR/IlmImf/ImfArray.h"
 
 #include "openexr/OpenEXR/IlmImf/ImfNamespace.h"
 namespace IMF = Imf;
@@ -59,10 +62,9 @@ namespace nbl
 		using mapOfChannels = std::unordered_map<channelName, Channel>;				// suffix.channel, where channel are "R", "G", "B", "A"
 
 		class SContext;
-		bool readVersionField(io::IReadFile* _file, SContext& ctx);
-		bool readHeader(const char fileName[], SContext& ctx);
-		template<typename rgbaFormat>
-		void readRgba(InputFile& file, std::array<Array2D<rgbaFormat>, 4>& pixelRgbaMapArray, int& width, int& height, E_FORMAT& format, const suffixOfChannelBundle suffixOfChannels);
+		bool readVersionField(const InputFile& file, SContext& ctx);
+		bool readHeader(const InputFile& file, SContext& ctx);
+		void insertChannelSlices(FrameBuffer& frameBuffer, ICPUImage* image, const suffixOfChannelBundle& suffixOfChannels, const Box2i& dataWindow);
 		E_FORMAT specifyIrrlichtEndFormat(const mapOfChannels& mapOfChannels, const suffixOfChannelBundle suffixName, const std::string fileName);
 
 		//! A helpful struct for handling OpenEXR layout
@@ -147,40 +149,6 @@ namespace nbl
 		};
 
 		constexpr uint8_t availableChannels = 4;
-		struct PerImageData
-		{
-			ICPUImage::SCreationParams params;
-			std::array<Array2D<half>, availableChannels> halfPixelMapArray;
-			std::array<Array2D<float>, availableChannels> fullFloatPixelMapArray;
-			std::array<Array2D<uint32_t>, availableChannels> uint32_tPixelMapArray;
-		};
-		template<typename IlmType>
-		struct ReadTexels
-		{
-				ReadTexels(ICPUImage* image, const std::array<Array2D<IlmType>, availableChannels>& _pixelMapArray) :
-					data(reinterpret_cast<uint8_t*>(image->getBuffer()->getPointer())), pixelMapArray(_pixelMapArray)
-				{
-					using StreamFromEXR = CRegionBlockFunctorFilter<ReadTexels<IlmType>,false>;
-					StreamFromEXR::state_type state(*this,image,image->getRegions().begin());
-					StreamFromEXR::execute(std::execution::par_unseq,&state);
-				}
-
-				inline void operator()(uint32_t ptrOffset, const core::vectorSIMDu32& texelCoord)
-				{
-					assert(texelCoord.w==0u && texelCoord.z==0u);
-
-					uint8_t* texelPtr = data+ptrOffset;
-					for (auto channelIndex=0; channelIndex<availableChannels; channelIndex++)
-					{
-						const auto& element = pixelMapArray[channelIndex][texelCoord.y][texelCoord.x];
-						reinterpret_cast<std::decay<decltype(element)>::type*>(texelPtr)[channelIndex] = element;
-					}
-				}
-
-			private:
-				uint8_t* const data;
-				const std::array<Array2D<IlmType>, availableChannels>& pixelMapArray;
-		};
 
 		auto getChannels(const InputFile& file)
 		{
@@ -218,41 +186,54 @@ namespace nbl
 		}
 
 
+		CImageLoaderOpenEXR::CImageLoaderOpenEXR(IAssetManager* _manager, uint32_t _decodeThreadCount) :
+			m_manager(_manager), m_decodeThreadCount(_decodeThreadCount ? _decodeThreadCount:core::max(std::thread::hardware_concurrency(),1u))
+		{
+			// a file's thread count only decides how many line blocks or tiles are in flight, the decoding itself is queued onto the global IlmThread pool
+			if (m_decodeThreadCount>1u && IlmThread::supportsThreads() && globalThreadCount()<static_cast<int>(m_decodeThreadCount))
+				setGlobalThreadCount(m_decodeThreadCount);
+		}
+
 		SAssetBundle CImageLoaderOpenEXR::loadAsset(io::IReadFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
 		{
 			if (!_file)
 				return {};
 
 			const auto& fileName = _file->getFileName().c_str();
+			const int fileThreadCount = m_decodeThreadCount>1u ? static_cast<int>(m_decodeThreadCount):0;
 
 			SContext ctx;
-			InputFile file = fileName;
+			InputFile file(fileName,fileThreadCount);
 
-			if (!readVersionField(_file, ctx))
+			if (!readVersionField(file, ctx))
 				return {};
 
-			if (!readHeader(fileName, ctx))
+			if (!readHeader(file, ctx))
 				return {};
 
+			const Box2i dataWindow = file.header().dataWindow();
+			const uint32_t width = dataWindow.max.x - dataWindow.min.x + 1;
+			const uint32_t height = dataWindow.max.y - dataWindow.min.y + 1;
+
 			core::vector<core::smart_refctd_ptr<ICPUImage>> images;
 			const auto channelsData = getChannels(file);
 			auto meta = core::make_smart_refctd_ptr<COpenEXRMetadata>(channelsData.size());
+			// slices of all layers point straight into the images' buffers, so every line block or tile gets decompressed only once, whatever the layer count
+			FrameBuffer frameBuffer;
 			{
 				uint32_t metaOffset = 0u;
 				for (const auto& data : channelsData)
 				{
 					const auto suffixOfChannels = data.first;
 					const auto mapOfChannels = data.second;
-					PerImageData perImageData;
 
-					int width;
-					int height;
-
-					auto params = perImageData.params;
+					ICPUImage::SCreationParams params;
 					params.format = specifyIrrlichtEndFormat(mapOfChannels, suffixOfChannels, file.fileName());
 					params.type = ICPUImage::ET_2D;;
 					params.flags = static_cast<ICPUImage::E_CREATE_FLAGS>(0u);
 					params.samples = ICPUImage::ESCF_1_BIT;
+					params.extent.width = width;
+					params.extent.height = height;
 					params.extent.depth = 1u;
 					params.mipLevels = 1u;
 					params.arrayLayers = 1u;
@@ -263,16 +244,6 @@ namespace nbl
 						continue;
 					}
 
-					if (params.format == EF_R16G16B16A16_SFLOAT)
-						readRgba(file, perImageData.halfPixelMapArray, width, height, params.format, suffixOfChannels);
-					else if (params.format == EF_R32G32B32A32_SFLOAT)
-						readRgba(file, perImageData.fullFloatPixelMapArray, width, height, params.format, suffixOfChannels);
-					else if (params.format == EF_R32G32B32A32_UINT)
-						readRgba(file, perImageData.uint32_tPixelMapArray, width, height, params.format, suffixOfChannels);
-
-					params.extent.width = width;
-					params.extent.height = height;
-
 					auto image = ICPUImage::create(std::move(params));
 					{ // create image and buffer that backs it
 						const uint32_t texelFormatByteSize = getTexelOrBlockBytesize(image->getCreationParameters().format);
@@ -292,18 +263,30 @@ namespace nbl
 						image->setBufferAndRegions(std::move(texelBuffer), regions);
 					}
 
-					if (params.format == EF_R16G16B16A16_SFLOAT)
-						ReadTexels(image.get(),perImageData.halfPixelMapArray);
-					else if (params.format == EF_R32G32B32A32_SFLOAT)
-						ReadTexels(image.get(), perImageData.fullFloatPixelMapArray);
-					else if (params.format == EF_R32G32B32A32_UINT)
-						ReadTexels(image.get(), perImageData.uint32_tPixelMapArray);
+					insertChannelSlices(frameBuffer, image.get(), suffixOfChannels, dataWindow);
 
 					meta->placeMeta(metaOffset++,image.get(),std::string(suffixOfChannels),IImageMetadata::ColorSemantic{ ECP_SRGB,EOTF_IDENTITY });
 
 					images.push_back(std::move(image));
 				}
-			}	
+			}
+
+			if (!images.empty())
+			{
+				if (ctx.versionField.Compoment.singlePartFileCompomentSubTypes == SContext::VersionField::Compoment::TILES)
+				{
+					// InputFile would read tiled files a row of tiles at a time through its own cache, reading the tiles directly avoids that copy
+					TiledInputFile tiledFile(fileName,fileThreadCount);
+					tiledFile.setFrameBuffer(frameBuffer);
+					// only the full resolution level, mip and rip levels aren't loaded
+					tiledFile.readTiles(0, tiledFile.numXTiles(0)-1, 0, tiledFile.numYTiles(0)-1, 0);
+				}
+				else
+				{
+					file.setFrameBuffer(frameBuffer);
+					file.readPixels(dataWindow.min.y, dataWindow.max.y);
+				}
+			}
 
 			return SAssetBundle(std::move(meta),std::move(images));
 		}
@@ -320,27 +303,23 @@ namespace nbl
 			return isImfMagic(magicNumberBuffer);
 		}
 
-		template<typename rgbaFormat>
-		void readRgba(InputFile& file, std::array<Array2D<rgbaFormat>, 4>& pixelRgbaMapArray, int& width, int& height, E_FORMAT& format, const suffixOfChannelBundle suffixOfChannels)
+		void insertChannelSlices(FrameBuffer& frameBuffer, ICPUImage* image, const suffixOfChannelBundle& suffixOfChannels, const Box2i& dataWindow)
 		{
-			Box2i dw = file.header().dataWindow();
-			width = dw.max.x - dw.min.x + 1;
-			height = dw.max.y - dw.min.y + 1;
-
-			constexpr const char* rgbaSignatureAsText[] = {"R", "G", "B", "A"};
-			for (auto& pixelChannelBuffer : pixelRgbaMapArray)
-				pixelChannelBuffer.resizeErase(height, width);
-
-			FrameBuffer frameBuffer;
+			const auto format = image->getCreationParameters().format;
 			PixelType pixelType;
-
 			if (format == EF_R16G16B16A16_SFLOAT)
 				pixelType = PixelType::HALF;
 			else if (format == EF_R32G32B32A32_SFLOAT)
 				pixelType = PixelType::FLOAT;
-			else if (format == EF_R32G32B32A32_UINT)
+			else
 				pixelType = PixelType::UINT;
 
+			const ptrdiff_t texelByteSize = getTexelOrBlockBytesize(format);
+			const ptrdiff_t rowByteSize = image->getRegions().begin()->bufferRowLength*texelByteSize;
+			// OpenEXR addresses the slices with absolute data window coordinates
+			char* const origin = reinterpret_cast<char*>(image->getBuffer()->getPointer())-dataWindow.min.x*texelByteSize-dataWindow.min.y*rowByteSize;
+
+			constexpr const char* rgbaSignatureAsText[] = {"R", "G", "B", "A"};
 			for (uint8_t rgbaChannelIndex = 0; rgbaChannelIndex < availableChannels; ++rgbaChannelIndex)
 			{
 				std::string name = suffixOfChannels.empty() ? rgbaSignatureAsText[rgbaChannelIndex] : suffixOfChannels + "." + rgbaSignatureAsText[rgbaChannelIndex];
@@ -348,16 +327,13 @@ namespace nbl
 				(
 					name.c_str(),																					// name
 					Slice(pixelType,																				// type
-					(char*)(&(pixelRgbaMapArray[rgbaChannelIndex])[0][0] - dw.min.x - dw.min.y * width),			// base
-						sizeof((pixelRgbaMapArray[rgbaChannelIndex])[0][0]) * 1,                                    // xStride
-						sizeof((pixelRgbaMapArray[rgbaChannelIndex])[0][0]) * width,                                // yStride
+						origin + rgbaChannelIndex*texelByteSize/availableChannels,									// base
+						texelByteSize,																				// xStride
+						rowByteSize,																				// yStride
 						1, 1,                                                                                       // x/y sampling
 						rgbaChannelIndex == 3 ? 1 : 0                                                               // default fillValue for channels that aren't present in file - 1 for alpha, otherwise 0
 					));
 			}
-
-			file.setFrameBuffer(frameBuffer);
-			file.readPixels(dw.min.y, dw.max.y);
 		}
 
 		E_FORMAT specifyIrrlichtEndFormat(const mapOfChannels& mapOfChannels, const suffixOfChannelBundle suffixName, const std::string fileName)
@@ -400,30 +376,25 @@ namespace nbl
 			return retVal;
 		}
 
-		bool readVersionField(io::IReadFile* _file, SContext& ctx)
+		bool readVersionField(const InputFile& file, SContext& ctx)
 		{
-			RgbaInputFile file(_file->getFileName().c_str());
 			auto& versionField = ctx.versionField;
 			
 			versionField.mainDataRegisterField = file.version();
 
 			auto isTheBitActive = [&](uint16_t bitToCheck)
 			{
-				return (versionField.mainDataRegisterField & (1 << (bitToCheck - 1)));
+				return (versionField.mainDataRegisterField & (1u << bitToCheck));
 			};
 
-			versionField.fileFormatVersionNumber |= isTheBitActive(1) | isTheBitActive(2) | isTheBitActive(3) | isTheBitActive(4) | isTheBitActive(5) | isTheBitActive(6) | isTheBitActive(7) | isTheBitActive(8);
+			versionField.fileFormatVersionNumber = versionField.mainDataRegisterField & 0xffu;
 
 			if (!isTheBitActive(11) && !isTheBitActive(12))
 			{
 				versionField.Compoment.type = SContext::VersionField::Compoment::SINGLE_PART_FILE;
 
 				if (isTheBitActive(9))
-				{
 					versionField.Compoment.singlePartFileCompomentSubTypes = SContext::VersionField::Compoment::TILES;
-					os::Printer::log("LOAD EXR: the file consist of not supported tiles", file.fileName(), ELL_ERROR);
-					return false;
-				}
 				else
 					versionField.Compoment.singlePartFileCompomentSubTypes = SContext::VersionField::Compoment::SCAN_LINES;
 			}
@@ -435,7 +406,7 @@ namespace nbl
 				return false;
 			}
 
-			if (!isTheBitActive(9) && isTheBitActive(11) && isTheBitActive(12))
+			if (!isTheBitActive(9) && isTheBitActive(11))
 			{
 				versionField.doesItSupportDeepData = true;
 				os::Printer::log("LOAD EXR: the file consist of not supported deep data", file.fileName(), ELL_ERROR);
@@ -452,9 +423,8 @@ namespace nbl
 			return true;
 		}
 
-		bool readHeader(const char fileName[], SContext& ctx)
+		bool readHeader(const InputFile& file, SContext& ctx)
 		{
-			RgbaInputFile file(fileName);
 			auto& attribs = ctx.attributes;
 			auto& versionField = ctx.versionField;
 
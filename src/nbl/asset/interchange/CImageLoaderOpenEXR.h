@@ -23,7 +23,9 @@ class CImageLoaderOpenEXR final : public IImageLoader
 		~CImageLoaderOpenEXR(){}
 
 	public:
-		CImageLoaderOpenEXR(IAssetManager* _manager) : m_manager(_manager) {}
+		//! @param _decodeThreadCount how many IlmThread pool threads decode line blocks or tiles of a file in parallel, 1 (default) decodes on the loading thread and 0 uses all hardware threads.
+		/** More than one thread grows OpenEXR's process-wide thread pool to that size. */
+		CImageLoaderOpenEXR(IAssetManager* _manager, uint32_t _decodeThreadCount=1u);
 
 		bool isALoadableFileFormat(io::IReadFile* _file) const override;
 
@@ -40,6 +42,7 @@ class CImageLoaderOpenEXR final : public IImageLoader
 	private:
 
 		IAssetManager* m_manager;
+		const uint32_t m_decodeThreadCount;
 };
 
 }
@@ -17,7 +17,9 @@
 #include "nbl/asset/utils/CQuantNormalCache.h"
 #include "COBJMeshFileLoader.h"
 
+#include <execution>
 #include <filesystem>
+#include <thread>
 
 
 namespace nbl
@@ -70,9 +72,6 @@ asset::SAssetBundle COBJMeshFileLoader::loadAsset(io::IReadFile* _file, const as
 	if (!filesize)
         return {};
 
-	const uint32_t WORD_BUFFER_LENGTH = 512u;
-    char tmpbuf[WORD_BUFFER_LENGTH]{};
-
 	uint32_t smoothingGroup=0;
 
 	const std::string fullName = _file->getFileName().c_str();
@@ -102,140 +101,176 @@ asset::SAssetBundle COBJMeshFileLoader::loadAsset(io::IReadFile* _file, const as
 	};
     core::unordered_multiset<pipeline_meta_pair_t,hash_t,key_equal_t> pipelines;
 
+	// parse straight out of the file's memory when possible, otherwise read a copy
     std::string fileContents;
-    fileContents.resize(filesize);
-	char* const buf = fileContents.data();
-	_file->read(buf, filesize);
+	const char* buf = reinterpret_cast<const char*>(_file->getMappedPointer());
+	if (!buf)
+	{
+		fileContents.resize(filesize);
+		_file->read(fileContents.data(), filesize);
+		buf = fileContents.data();
+	}
 	const char* const bufEnd = buf+filesize;
 
-	// Process obj information
-	const char* bufPtr = buf;
-	std::string grpName, mtlName;
+	const bool rightHanded = _params.loaderFlags&E_LOADER_PARAMETER_FLAGS::ELPF_RIGHT_HANDED_MESHES;
 
-	auto performActionBasedOnOrientationSystem = [&](auto performOnRightHanded, auto performOnLeftHanded)
+	// Parse line-aligned chunks of the file in parallel, only the statements which depend on the state
+	// built up by the previous lines (materials, groups, vertex deduplication) get replayed serially afterwards.
+	core::vector<SParsedChunk> chunks;
 	{
-		if (_params.loaderFlags & E_LOADER_PARAMETER_FLAGS::ELPF_RIGHT_HANDED_MESHES)
-			performOnRightHanded();
-		else
-			performOnLeftHanded();
-	};
+		constexpr size_t MinChunkSize = 0x1ull<<18u;
+		const size_t chunkCount = core::max<size_t>(core::min<size_t>(size_t(filesize)/MinChunkSize,size_t(core::max(std::thread::hardware_concurrency(),1u))*4ull),1ull);
+		core::vector<const char*> chunkBegins(chunkCount+1ull);
+		chunkBegins[0] = buf;
+		for (size_t i=1ull; i<chunkCount; i++)
+		{
+			const char* ptr = core::max(buf+size_t(filesize)*i/chunkCount,chunkBegins[i-1ull]);
+			while (ptr!=bufEnd && *ptr!='\n' && *ptr!='\r')
+				ptr++;
+			chunkBegins[i] = goFirstWord(ptr,bufEnd);
+		}
+		chunkBegins[chunkCount] = bufEnd;
 
+		chunks.resize(chunkCount);
+		std::for_each(std::execution::par,chunks.begin(),chunks.end(),[&](SParsedChunk& chunk)
+		{
+			const size_t i = &chunk-chunks.data();
+			parseChunk(chunkBegins[i],chunkBegins[i+1ull],rightHanded,chunk);
+		});
+	}
 
-    struct vec3 {
-        float data[3];
-    };
-    struct vec2 {
-        float data[2];
-    };
-    core::vector<vec3> vertexBuffer;
-    core::vector<vec3> normalsBuffer;
-    core::vector<vec2> textureCoordBuffer;
+	size_t totalPositions = 0ull, totalUVs = 0ull, totalNormals = 0ull;
+	for (const auto& chunk : chunks)
+	{
+		totalPositions += chunk.positions.size();
+		totalUVs += chunk.uvs.size();
+		totalNormals += chunk.normals.size();
+	}
+	core::vector<std::array<float,3>> vertexBuffer;
+	core::vector<std::array<float,2>> textureCoordBuffer;
+	core::vector<std::array<float,3>> normalsBuffer;
+	vertexBuffer.reserve(totalPositions);
+	textureCoordBuffer.reserve(totalUVs);
+	normalsBuffer.reserve(totalNormals);
+	// every normal gets quantized once, on first use so the quantization cache sees the same sequence of lookups as before
+	core::vector<CQuantNormalCache::value_type_t<EF_A2B10G10R10_SNORM_PACK32>> quantizedNormals(totalNormals);
+	core::vector<bool> normalWasQuantized(totalNormals,false);
+
+	//! Same equivalence as `SObjVertex::operator<` gives, except that missing (NaN) texture coordinates compare equal
+	//! instead of making all vertices at one position equivalent regardless of their normals
+	struct vertex_hash_t
+	{
+		static inline uint32_t canonicalBits(float f)
+		{
+			f = core::isnan(f) ? core::nan<float>():(f+0.f); // collapse -0 onto +0 and all NaNs onto one
+			return core::floatBitsToUint(f);
+		}
+		inline size_t operator()(const SObjVertex& v) const
+		{
+			const auto normal = v.normal32bit.getValue();
+			size_t h = normal.x^(normal.y<<10u)^(normal.z<<20u);
+			for (auto f : {v.pos[0],v.pos[1],v.pos[2],v.uv[0],v.uv[1]})
+				h = (h^canonicalBits(f))*0x100000001b3ull;
+			return h;
+		}
+	};
+	struct vertex_equal_t
+	{
+		static inline bool equal(const float a, const float b)
+		{
+			return a==b || (core::isnan(a) && core::isnan(b));
+		}
+		inline bool operator()(const SObjVertex& lhs, const SObjVertex& rhs) const
+		{
+			return equal(lhs.pos[0],rhs.pos[0]) && equal(lhs.pos[1],rhs.pos[1]) && equal(lhs.pos[2],rhs.pos[2]) &&
+				equal(lhs.uv[0],rhs.uv[0]) && equal(lhs.uv[1],rhs.uv[1]) && lhs.normal32bit==rhs.normal32bit;
+		}
+	};
 
     core::vector<core::smart_refctd_ptr<ICPUMeshBuffer>> submeshes;
     core::vector<core::vector<uint32_t>> indices;
     core::vector<SObjVertex> vertices;
-    core::map<SObjVertex, uint32_t> map_vtx2ix;
+    core::unordered_map<SObjVertex,uint32_t,vertex_hash_t,vertex_equal_t> map_vtx2ix;
     core::vector<bool> recalcNormals;
     core::vector<bool> submeshWasLoadedFromCache;
     core::vector<std::string> submeshCacheKeys;
     core::vector<std::string> submeshMaterialNames;
     core::vector<uint32_t> vtxSmoothGrp;
+	vertices.reserve(totalPositions);
+	vtxSmoothGrp.reserve(totalPositions);
+	map_vtx2ix.reserve(totalPositions);
 
+	std::string grpName, mtlName;
 	constexpr const char* NO_MATERIAL_MTL_NAME = "#";
 	bool noMaterial = true;
 	bool dummyMaterialCreated = false;
-	while(bufPtr != bufEnd)
+	core::vector<uint32_t> faceCorners;
+	faceCorners.reserve(32ull);
+	for (auto& chunk : chunks)
 	{
-		switch(bufPtr[0])
-		{
-		case 'm':	// mtllib (material)
+		const uint32_t positionBase = vertexBuffer.size();
+		const uint32_t uvBase = textureCoordBuffer.size();
+		const uint32_t normalBase = normalsBuffer.size();
+		vertexBuffer.insert(vertexBuffer.end(),chunk.positions.begin(),chunk.positions.end());
+		textureCoordBuffer.insert(textureCoordBuffer.end(),chunk.uvs.begin(),chunk.uvs.end());
+		normalsBuffer.insert(normalsBuffer.end(),chunk.normals.begin(),chunk.normals.end());
+
+		for (const auto& statement : chunk.statements)
+		switch (statement.type)
 		{
-			if (ctx.useMaterials)
-			{
-				bufPtr = goAndCopyNextWord(tmpbuf, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-				#ifdef _NBL_DEBUG_OBJ_LOADER_
-					os::Printer::log("Reading material _file",tmpbuf);
-				#endif
-
-                std::string mtllib = relPath+tmpbuf;
-                std::replace(mtllib.begin(), mtllib.end(), '\\', '/');
-                SAssetLoadParams loadParams;
-                auto bundle = interm_getAssetInHierarchy(AssetManager, mtllib, loadParams, _hierarchyLevel+ICPUMesh::PIPELINE_HIERARCHYLEVELS_BELOW, _override);
-				auto meta = bundle.getMetadata()->selfCast<const CMTLMetadata>();
-				if (bundle.getAssetType()==IAsset::ET_RENDERPASS_INDEPENDENT_PIPELINE)
-				for (auto ass : bundle.getContents())
-                {
-                    auto ppln = core::smart_refctd_ptr_static_cast<ICPURenderpassIndependentPipeline>(ass);
-					const auto pplnMeta = meta->getAssetSpecificMetadata(ppln.get());
-					if (!pplnMeta)
-						continue;
-
-                    pipelines.emplace(std::move(ppln),pplnMeta);
-                }
-			}
-		}
-			break;
-
-		case 'v':               // v, vn, vt
-			//reset flags
-			noMaterial = true;
-			dummyMaterialCreated = false;
-			switch(bufPtr[1])
+			case SStatement::ET_VERTEX_DATA:
+				//reset flags
+				noMaterial = true;
+				dummyMaterialCreated = false;
+				break;
+			case SStatement::ET_MTLLIB:
 			{
-			case ' ':          // vertex
+				if (ctx.useMaterials)
 				{
-					vec3 vec;
-					bufPtr = readVec3(bufPtr, vec.data, bufEnd);
-					performActionBasedOnOrientationSystem([&]() {vec.data[0] = -vec.data[0];}, [&]() {});
-					vertexBuffer.push_back(vec);
-				}
-				break;
+					#ifdef _NBL_DEBUG_OBJ_LOADER_
+						os::Printer::log("Reading material _file",chunk.words[statement.first]);
+					#endif
+
+					std::string mtllib = relPath+chunk.words[statement.first];
+					std::replace(mtllib.begin(), mtllib.end(), '\\', '/');
+					SAssetLoadParams loadParams;
+					auto bundle = interm_getAssetInHierarchy(AssetManager, mtllib, loadParams, _hierarchyLevel+ICPUMesh::PIPELINE_HIERARCHYLEVELS_BELOW, _override);
+					auto meta = bundle.getMetadata()->selfCast<const CMTLMetadata>();
+					if (bundle.getAssetType()==IAsset::ET_RENDERPASS_INDEPENDENT_PIPELINE)
+					for (auto ass : bundle.getContents())
+					{
+						auto ppln = core::smart_refctd_ptr_static_cast<ICPURenderpassIndependentPipeline>(ass);
+						const auto pplnMeta = meta->getAssetSpecificMetadata(ppln.get());
+						if (!pplnMeta)
+							continue;
 
-			case 'n':       // normal
-				{
-					vec3 vec;
-					bufPtr = readVec3(bufPtr, vec.data, bufEnd);
-					performActionBasedOnOrientationSystem([&]() {vec.data[0] = -vec.data[0]; }, [&]() {});
-					normalsBuffer.push_back(vec);
+						pipelines.emplace(std::move(ppln),pplnMeta);
+					}
 				}
+			}
 				break;
-
-			case 't':       // texcoord
-				{
-					vec2 vec;
-					bufPtr = readUV(bufPtr, vec.data, bufEnd);
-					textureCoordBuffer.push_back(vec);
-				}
+			case SStatement::ET_GROUP:
+				grpName = chunk.words[statement.first];
 				break;
-			}
-			break;
-
-		case 'g': // group name
-            bufPtr = goAndCopyNextWord(tmpbuf, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-            grpName = tmpbuf;
-			break;
-		case 's': // smoothing can be a group or off (equiv. to 0)
+			case SStatement::ET_SMOOTHING_GROUP: // smoothing can be a group or off (equiv. to 0)
 			{
-				bufPtr = goAndCopyNextWord(tmpbuf, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+				const char* word = chunk.words[statement.first].c_str();
 #ifdef _NBL_DEBUG_OBJ_LOADER_
-	os::Printer::log("Loaded smoothing group start",tmpbuf, ELL_DEBUG);
+	os::Printer::log("Loaded smoothing group start",word, ELL_DEBUG);
 #endif
-				if (strcmp("off", tmpbuf)==0)
+				if (strcmp("off", word)==0)
 					smoothingGroup=0u;
 				else
-                    sscanf(tmpbuf,"%u",&smoothingGroup);
+					sscanf(word,"%u",&smoothingGroup);
 			}
-			break;
-
-		case 'u': // usemtl
-			// get name of material
+				break;
+			case SStatement::ET_USEMTL:
 			{
 				noMaterial = false;
-				bufPtr = goAndCopyNextWord(tmpbuf, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+				mtlName = chunk.words[statement.first];
 #ifdef _NBL_DEBUG_OBJ_LOADER_
-	os::Printer::log("Loaded material start",tmpbuf, ELL_DEBUG);
+	os::Printer::log("Loaded material start",mtlName, ELL_DEBUG);
 #endif
-				mtlName=tmpbuf;
 
                 if (ctx.useMaterials && !ctx.useGroups)
                 {
@@ -255,121 +290,108 @@ asset::SAssetBundle COBJMeshFileLoader::loadAsset(io::IReadFile* _file, const as
                     submeshMaterialNames.push_back(mtlName);
                 }
 			}
-			break;
-		case 'f':               // face
-		{
-			if (noMaterial && !dummyMaterialCreated)
+				break;
+			case SStatement::ET_FACE:
 			{
-				dummyMaterialCreated = true;
-
-				submeshes.push_back(core::make_smart_refctd_ptr<ICPUMeshBuffer>());
-				indices.emplace_back();
-				recalcNormals.push_back(false);
-				submeshWasLoadedFromCache.push_back(false);
-				submeshCacheKeys.push_back(genKeyForMeshBuf(ctx, _file->getFileName().c_str(), NO_MATERIAL_MTL_NAME, grpName));
-				submeshMaterialNames.push_back(NO_MATERIAL_MTL_NAME);
-			}
+				if (noMaterial && !dummyMaterialCreated)
+				{
+					dummyMaterialCreated = true;
+
+					submeshes.push_back(core::make_smart_refctd_ptr<ICPUMeshBuffer>());
+					indices.emplace_back();
+					recalcNormals.push_back(false);
+					submeshWasLoadedFromCache.push_back(false);
+					submeshCacheKeys.push_back(genKeyForMeshBuf(ctx, _file->getFileName().c_str(), NO_MATERIAL_MTL_NAME, grpName));
+					submeshMaterialNames.push_back(NO_MATERIAL_MTL_NAME);
+				}
 
-			SObjVertex v;
+				// obj indices are 1-based, negative ones count back from the last element defined so far
+				auto resolveIndex = [](const int32_t ix, const uint32_t countSoFar) -> int64_t
+				{
+					if (ix>0)
+						return int64_t(ix)-1ll;
+					if (ix<0)
+						return int64_t(countSoFar)+ix;
+					return -1ll;
+				};
+				const uint32_t positionsSoFar = positionBase+statement.positionCount;
+				const uint32_t uvsSoFar = uvBase+statement.uvCount;
+				const uint32_t normalsSoFar = normalBase+statement.normalCount;
 
-			// get all vertices data in this face (current line of obj _file)
-			const core::stringc wordBuffer = copyLine(bufPtr, bufEnd);
-			const char* linePtr = wordBuffer.c_str();
-			const char* const endPtr = linePtr+wordBuffer.size();
+				faceCorners.clear();
+				for (uint32_t c=0u; c<statement.count; c++)
+				{
+					const auto& corner = chunk.faceCorners[statement.first+c];
+					const int64_t posIx = resolveIndex(corner[0],positionsSoFar);
+					if (posIx<0ll || posIx>=positionsSoFar)
+						continue;
+					const int64_t uvIx = resolveIndex(corner[1],uvsSoFar);
+					const int64_t normalIx = resolveIndex(corner[2],normalsSoFar);
+
+					SObjVertex v;
+					std::copy(vertexBuffer[posIx].begin(),vertexBuffer[posIx].end(),v.pos);
+					//set texcoord
+					if (uvIx>=0ll && uvIx<uvsSoFar)
+						std::copy(textureCoordBuffer[uvIx].begin(),textureCoordBuffer[uvIx].end(),v.uv);
+					else
+						v.uv[0] = v.uv[1] = core::nan<float>();
+					//set normal
+					if (normalIx>=0ll && normalIx<normalsSoFar)
+					{
+						if (!normalWasQuantized[normalIx])
+						{
+							core::vectorSIMDf simdNormal;
+							simdNormal.set(normalsBuffer[normalIx].data());
+							simdNormal.makeSafe3D();
+							quantizedNormals[normalIx] = quantNormalCache->quantize<EF_A2B10G10R10_SNORM_PACK32>(simdNormal);
+							normalWasQuantized[normalIx] = true;
+						}
+						v.normal32bit = quantizedNormals[normalIx];
+					}
+					else
+					{
+						v.normal32bit = core::vectorSIMDu32(0u);
+						recalcNormals.back() = true;
+					}
 
-			core::vector<uint32_t> faceCorners;
-			faceCorners.reserve(32ull);
+					uint32_t ix;
+					auto vtx_ix = map_vtx2ix.find(v);
+					if (vtx_ix != map_vtx2ix.end() && smoothingGroup==vtxSmoothGrp[vtx_ix->second])
+						ix = vtx_ix->second;
+					else
+					{
+						ix = vertices.size();
+						vertices.push_back(v);
+						vtxSmoothGrp.push_back(smoothingGroup);
+						map_vtx2ix.insert({v, ix});
+					}
 
-			// read in all vertices
-			linePtr = goNextWord(linePtr, endPtr);
-			while (0 != linePtr[0])
-			{
-				// Array to communicate with retrieveVertexIndices()
-				// sends the buffer sizes and gets the actual indices
-				// if index not set returns -1
-				int32_t Idx[3];
-				Idx[1] = Idx[2] = -1;
-
-				// read in next vertex's data
-				uint32_t wlength = copyWord(tmpbuf, linePtr, WORD_BUFFER_LENGTH, endPtr);
-				// this function will also convert obj's 1-based index to c++'s 0-based index
-				retrieveVertexIndices(tmpbuf, Idx, tmpbuf+wlength+1, vertexBuffer.size(), textureCoordBuffer.size(), normalsBuffer.size());
-				v.pos[0] = vertexBuffer[Idx[0]].data[0];
-				v.pos[1] = vertexBuffer[Idx[0]].data[1];
-				v.pos[2] = vertexBuffer[Idx[0]].data[2];
-				//set texcoord
-				if ( -1 != Idx[1] )
-                {
-					v.uv[0] = textureCoordBuffer[Idx[1]].data[0];
-					v.uv[1] = textureCoordBuffer[Idx[1]].data[1];
-                }
-				else
-                {
-					v.uv[0] = core::nan<float>();
-					v.uv[1] = core::nan<float>();
-                }
-                //set normal
-				if ( -1 != Idx[2] )
-                {
-					core::vectorSIMDf simdNormal;
-					simdNormal.set(normalsBuffer[Idx[2]].data);
-                    simdNormal.makeSafe3D();
-					v.normal32bit = quantNormalCache->quantize<EF_A2B10G10R10_SNORM_PACK32>(simdNormal);
-                }
-				else
-				{
-					v.normal32bit = core::vectorSIMDu32(0u);
-                    recalcNormals.back() = true;
+					faceCorners.push_back(ix);
 				}
 
-				uint32_t ix;
-				auto vtx_ix = map_vtx2ix.find(v);
-				if (vtx_ix != map_vtx2ix.end() && smoothingGroup==vtxSmoothGrp[vtx_ix->second])
-					ix = vtx_ix->second;
-				else
+				// triangulate the face
+				auto& submeshIndices = indices.back();
+				for (uint32_t i = 1u; i+1u < faceCorners.size(); ++i)
 				{
-					ix = vertices.size();
-					vertices.push_back(v);
-                    vtxSmoothGrp.push_back(smoothingGroup);
-					map_vtx2ix.insert({v, ix});
+					if (rightHanded)
+					{
+						submeshIndices.push_back(faceCorners[0]);
+						submeshIndices.push_back(faceCorners[i]);
+						submeshIndices.push_back(faceCorners[i + 1]);
+					}
+					else
+					{
+						submeshIndices.push_back(faceCorners[i + 1]);
+						submeshIndices.push_back(faceCorners[i]);
+						submeshIndices.push_back(faceCorners[0]);
+					}
 				}
-
-				faceCorners.push_back(ix);
-
-				// go to next vertex
-				linePtr = goNextWord(linePtr, endPtr);
 			}
-
-            // triangulate the face
-            for (uint32_t i = 1u; i < faceCorners.size()-1u; ++i)
-            {
-                // Add a triangle
-                performActionBasedOnOrientationSystem
-                (
-                [&]()
-                {
-                    indices.back().push_back(faceCorners[0]);
-                    indices.back().push_back(faceCorners[i]);
-                    indices.back().push_back(faceCorners[i + 1]);
-                },
-                [&]()
-                {
-                    indices.back().push_back(faceCorners[i + 1]);
-                    indices.back().push_back(faceCorners[i]);
-                    indices.back().push_back(faceCorners[0]);
-                }
-                );
-            }
+				break;
 		}
-		break;
-
-		case '#': // comment
-		default:
-			break;
-		}	// end switch(bufPtr[0])
-		// eat up rest of line
-		bufPtr = goNextLine(bufPtr, bufEnd);
-	}	// end while(bufPtr && (bufPtr-buf<filesize))
+		// release the chunk's memory as soon as it has been merged
+		chunk = SParsedChunk();
+	}
 	
     core::unordered_set<pipeline_meta_pair_t,hash_t,key_equal_t> usedPipelines;
     {
@@ -506,37 +528,130 @@ asset::SAssetBundle COBJMeshFileLoader::loadAsset(io::IReadFile* _file, const as
 }
 
 
-//! Read 3d vector of floats
-const char* COBJMeshFileLoader::readVec3(const char* bufPtr, float vec[3], const char* const bufEnd)
+void COBJMeshFileLoader::parseChunk(const char* bufPtr, const char* const bufEnd, const bool rightHanded, SParsedChunk& out)
 {
-	const uint32_t WORD_BUFFER_LENGTH = 256;
-	char wordBuffer[WORD_BUFFER_LENGTH];
-
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	sscanf(wordBuffer,"%f",vec);
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	sscanf(wordBuffer,"%f",vec+1);
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	sscanf(wordBuffer,"%f",vec+2);
-
-    vec[0] = -vec[0]; // change handedness
-	return bufPtr;
-}
-
-
-//! Read 2d vector of floats
-const char* COBJMeshFileLoader::readUV(const char* bufPtr, float vec[2], const char* const bufEnd)
-{
-	const uint32_t WORD_BUFFER_LENGTH = 256;
 	char wordBuffer[WORD_BUFFER_LENGTH];
+	// same result as the `sscanf("%f")` this replaced, without the format string parsing
+	auto readFloats = [&wordBuffer](const char* ptr, const char* const lineEnd, float* outFloats, const uint32_t count) -> void
+	{
+		for (uint32_t i=0u; i<count; i++)
+		{
+			while (ptr!=lineEnd && core::isspace(*ptr))
+				ptr++;
+			const char* const wordBegin = ptr;
+			while (ptr!=lineEnd && !core::isspace(*ptr))
+				ptr++;
+			const size_t length = core::min<size_t>(ptr-wordBegin,WORD_BUFFER_LENGTH-1u);
+			memcpy(wordBuffer,wordBegin,length);
+			wordBuffer[length] = 0;
+			outFloats[i] = strtof(wordBuffer,nullptr);
+		}
+	};
+	auto pushStatement = [&out](const SStatement::E_TYPE type, const uint32_t first, const uint32_t count) -> void
+	{
+		out.statements.push_back({type,first,count,uint32_t(out.positions.size()),uint32_t(out.uvs.size()),uint32_t(out.normals.size())});
+	};
+	auto pushNamedStatement = [&](const SStatement::E_TYPE type, const char* ptr, const char* const lineEnd) -> void
+	{
+		goAndCopyNextWord(wordBuffer,ptr,WORD_BUFFER_LENGTH,lineEnd);
+		pushStatement(type,out.words.size(),1u);
+		out.words.emplace_back(wordBuffer);
+	};
 
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	sscanf(wordBuffer,"%f",vec);
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	sscanf(wordBuffer,"%f",vec+1);
+	while (bufPtr != bufEnd)
+	{
+		const char* lineEnd = bufPtr;
+		while (lineEnd!=bufEnd && *lineEnd!='\n' && *lineEnd!='\r')
+			lineEnd++;
 
-	vec[1] = 1.f-vec[1]; // change handedness
-	return bufPtr;
+		switch (bufPtr[0])
+		{
+			case 'm':	// mtllib (material)
+				pushNamedStatement(SStatement::ET_MTLLIB,bufPtr,lineEnd);
+				break;
+			case 'v':	// v, vn, vt
+				if (out.statements.empty() || out.statements.back().type!=SStatement::ET_VERTEX_DATA)
+					pushStatement(SStatement::ET_VERTEX_DATA,0u,0u);
+				if (bufPtr+1!=lineEnd)
+				switch (bufPtr[1])
+				{
+					case ' ':	// vertex
+					{
+						std::array<float,3> vec;
+						readFloats(bufPtr+1,lineEnd,vec.data(),3u);
+						if (!rightHanded)
+							vec[0] = -vec[0];
+						out.positions.push_back(vec);
+					}
+						break;
+					case 'n':	// normal
+					{
+						std::array<float,3> vec;
+						readFloats(bufPtr+2,lineEnd,vec.data(),3u);
+						if (!rightHanded)
+							vec[0] = -vec[0];
+						out.normals.push_back(vec);
+					}
+						break;
+					case 't':	// texcoord
+					{
+						std::array<float,2> vec;
+						readFloats(bufPtr+2,lineEnd,vec.data(),2u);
+						vec[1] = 1.f-vec[1]; // change handedness
+						out.uvs.push_back(vec);
+					}
+						break;
+				}
+				break;
+			case 'g':	// group name
+				pushNamedStatement(SStatement::ET_GROUP,bufPtr,lineEnd);
+				break;
+			case 's':	// smoothing group
+				pushNamedStatement(SStatement::ET_SMOOTHING_GROUP,bufPtr,lineEnd);
+				break;
+			case 'u':	// usemtl
+				pushNamedStatement(SStatement::ET_USEMTL,bufPtr,lineEnd);
+				break;
+			case 'f':	// face
+			{
+				const uint32_t firstCorner = out.faceCorners.size();
+				// every word after the `f` is a `pos/uv/normal` triplet where the last two are optional
+				for (const char* ptr=goNextWord(bufPtr,lineEnd,false); ptr!=lineEnd; ptr=goFirstWord(ptr,lineEnd,false))
+				{
+					std::array<int32_t,3> corner = {0,0,0};
+					uint32_t idxType = 0u;
+					while (ptr!=lineEnd && !core::isspace(*ptr))
+					{
+						if (*ptr=='/')
+						{
+							idxType = core::min(idxType+1u,2u);
+							ptr++;
+						}
+						else if (*ptr=='-' || core::isdigit(*ptr))
+						{
+							const bool negative = *ptr=='-';
+							if (negative)
+								ptr++;
+							int32_t value = 0;
+							for (; ptr!=lineEnd && core::isdigit(*ptr); ptr++)
+								value = value*10+(*ptr-'0');
+							corner[idxType] = negative ? -value:value;
+						}
+						else // stray characters get skipped
+							ptr++;
+					}
+					out.faceCorners.push_back(corner);
+				}
+				pushStatement(SStatement::ET_FACE,firstCorner,out.faceCorners.size()-firstCorner);
+			}
+				break;
+			case '#':	// comment
+			default:
+				break;
+		}
+		// eat up rest of line
+		bufPtr = goFirstWord(lineEnd,bufEnd);
+	}
 }
 
 
@@ -603,9 +718,9 @@ uint32_t COBJMeshFileLoader::copyWord(char* outBuf, const char* const inBuf, uin
 	}
 
 	uint32_t i = 0;
-	while(inBuf[i])
+	while (&(inBuf[i]) != bufEnd && inBuf[i])
 	{
-		if (core::isspace(inBuf[i]) || &(inBuf[i]) == bufEnd)
+		if (core::isspace(inBuf[i]))
 			break;
 		++i;
 	}
@@ -619,23 +734,6 @@ uint32_t COBJMeshFileLoader::copyWord(char* outBuf, const char* const inBuf, uin
 }
 
 
-core::stringc COBJMeshFileLoader::copyLine(const char* inBuf, const char* bufEnd)
-{
-	if (!inBuf)
-		return core::stringc();
-
-	const char* ptr = inBuf;
-	while (ptr<bufEnd)
-	{
-		if (*ptr=='\n' || *ptr=='\r')
-			break;
-		++ptr;
-	}
-	// we must avoid the +1 in case the array is used up
-	return core::stringc(inBuf, (uint32_t)(ptr-inBuf+((ptr < bufEnd) ? 1 : 0)));
-}
-
-
 const char* COBJMeshFileLoader::goAndCopyNextWord(char* outBuf, const char* inBuf, uint32_t outBufLength, const char* bufEnd)
 {
 	inBuf = goNextWord(inBuf, bufEnd, false);
@@ -644,74 +742,6 @@ const char* COBJMeshFileLoader::goAndCopyNextWord(char* outBuf, const char* inBu
 }
 
 
-bool COBJMeshFileLoader::retrieveVertexIndices(char* vertexData, int32_t* idx, const char* bufEnd, uint32_t vbsize, uint32_t vtsize, uint32_t vnsize)
-{
-	char word[16] = "";
-	const char* p = goFirstWord(vertexData, bufEnd);
-	uint32_t idxType = 0;	// 0 = posIdx, 1 = texcoordIdx, 2 = normalIdx
-
-	uint32_t i = 0;
-	while ( p != bufEnd )
-	{
-		if ( ( core::isdigit(*p)) || (*p == '-') )
-		{
-			// build up the number
-			word[i++] = *p;
-		}
-		else if ( *p == '/' || *p == ' ' || *p == '\0' )
-		{
-			// number is completed. Convert and store it
-			word[i] = '\0';
-			// if no number was found index will become 0 and later on -1 by decrement
-			sscanf(word,"%d",idx+idxType);
-			if (idx[idxType]<0)
-			{
-				switch (idxType)
-				{
-					case 0:
-						idx[idxType] += vbsize;
-						break;
-					case 1:
-						idx[idxType] += vtsize;
-						break;
-					case 2:
-						idx[idxType] += vnsize;
-						break;
-				}
-			}
-			else
-				idx[idxType]-=1;
-
-			// reset the word
-			word[0] = '\0';
-			i = 0;
-
-			// go to the next kind of index type
-			if (*p == '/')
-			{
-				if ( ++idxType > 2 )
-				{
-					// error checking, shouldn't reach here unless file is wrong
-					idxType = 0;
-				}
-			}
-			else
-			{
-				// set all missing values to disable (=-1)
-				while (++idxType < 3)
-					idx[idxType]=-1;
-				++p;
-				break; // while
-			}
-		}
-
-		// go to the next char
-		++p;
-	}
-
-	return true;
-}
-
 std::string COBJMeshFileLoader::genKeyForMeshBuf(const SContext& _ctx, const std::string& _baseKey, const std::string& _mtlName, const std::string& _grpName) const
 {
     return _baseKey + "?" + _grpName + "?" + _mtlName;
@@ -6,6 +6,8 @@
 #ifndef __NBL_ASSET_C_OBJ_MESH_FILE_LOADER_H_INCLUDED__
 #define __NBL_ASSET_C_OBJ_MESH_FILE_LOADER_H_INCLUDED__
 
+#include <array>
+
 #include "nbl/core/core.h"
 #include "nbl/asset/ICPUMeshBuffer.h"
 #include "nbl/asset/interchange/IAssetLoader.h"
@@ -105,6 +107,42 @@ public:
     virtual asset::SAssetBundle loadAsset(io::IReadFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
 
 private:
+	//! A statement of the obj file which has to be replayed in order after the parallel parse
+	struct SStatement
+	{
+		enum E_TYPE : uint8_t
+		{
+			ET_VERTEX_DATA, // any run of `v*` lines, only matters because it resets the current material
+			ET_MTLLIB,
+			ET_GROUP,
+			ET_SMOOTHING_GROUP,
+			ET_USEMTL,
+			ET_FACE
+		};
+
+		E_TYPE type;
+		// for `ET_FACE` the range in `SParsedChunk::faceCorners`, for the named statements an index into `SParsedChunk::words`
+		uint32_t first;
+		uint32_t count;
+		// amount of `v`,`vt` and `vn` parsed so far in the chunk, needed to resolve relative indices of a face
+		uint32_t positionCount;
+		uint32_t uvCount;
+		uint32_t normalCount;
+	};
+	//! Everything parsed out of a line-aligned range of the file, chunks don't depend on each other
+	struct SParsedChunk
+	{
+		core::vector<std::array<float,3>> positions;
+		core::vector<std::array<float,3>> normals;
+		core::vector<std::array<float,2>> uvs;
+		// position, uv and normal index of every face corner as written in the file, 0 if absent
+		core::vector<std::array<int32_t,3>> faceCorners;
+		core::vector<std::string> words;
+		core::vector<SStatement> statements;
+	};
+	//! Parses the lines in `[bufPtr,bufEnd)`, `bufPtr` needs to be at the start of a line
+	void parseChunk(const char* bufPtr, const char* const bufEnd, const bool rightHanded, SParsedChunk& out);
+
 	// returns a pointer to the first printable character available in the buffer
 	const char* goFirstWord(const char* buf, const char* const bufEnd, bool acrossNewlines=true);
 	// returns a pointer to the first printable character after the first non-printable
@@ -113,24 +151,13 @@ private:
 	const char* goNextLine(const char* buf, const char* const bufEnd);
 	// copies the current word from the inBuf to the outBuf
 	uint32_t copyWord(char* outBuf, const char* inBuf, uint32_t outBufLength, const char* const pBufEnd);
-	// copies the current line from the inBuf to the outBuf
-	core::stringc copyLine(const char* inBuf, const char* const bufEnd);
 
 	// combination of goNextWord followed by copyWord
 	const char* goAndCopyNextWord(char* outBuf, const char* inBuf, uint32_t outBufLength, const char* const pBufEnd);
 
-	//! Read 3d vector of floats
-	const char* readVec3(const char* bufPtr, float vec[3], const char* const pBufEnd);
-	//! Read 2d vector of floats
-	const char* readUV(const char* bufPtr, float vec[2], const char* const pBufEnd);
 	//! Read boolean value represented as 'on' or 'off'
 	const char* readBool(const char* bufPtr, bool& tf, const char* const bufEnd);
 
-	// reads and convert to integer the vertex indices in a line of obj file's face statement
-	// -1 for the index if it doesn't exist
-	// indices are changed to 0-based index instead of 1-based from the obj file
-	bool retrieveVertexIndices(char* vertexData, int32_t* idx, const char* bufEnd, uint32_t vbsize, uint32_t vtsize, uint32_t vnsize);
-
     std::string genKeyForMeshBuf(const SContext& _ctx, const std::string& _baseKey, const std::string& _mtlName, const std::string& _grpName) const;
 
 	IAssetManager* AssetManager;
@@ -4,6 +4,7 @@
 // See the original file in irrlicht source for authors
 
 
+#include <execution>
 #include <numeric>
 
 #include "BuildConfigOptions.h"
@@ -22,6 +23,148 @@ namespace nbl
 namespace asset
 {
 
+namespace
+{
+
+//! Gives the same (correctly rounded) result as `atof`, but plain decimals which are exactly representable
+//! as a double mantissa and a power of ten take a single multiplication or division instead of the generic conversion
+double parseDouble(const char* word)
+{
+	const char* ptr = word;
+	const bool negative = *ptr=='-';
+	if (*ptr=='-' || *ptr=='+')
+		ptr++;
+
+	constexpr int32_t MaxDigits = 19; // can't overflow 64bit
+	uint64_t mantissa = 0ull;
+	int32_t digits = 0, exponent = 0;
+	bool anyDigits = false;
+	for (; core::isdigit(*ptr); ptr++, anyDigits = true)
+	{
+		if (digits==MaxDigits)
+			return atof(word);
+		mantissa = mantissa*10ull+uint64_t(*ptr-'0');
+		if (mantissa)
+			digits++;
+	}
+	if (*ptr=='.')
+	for (ptr++; core::isdigit(*ptr); ptr++, anyDigits = true)
+	{
+		if (digits==MaxDigits)
+			return atof(word);
+		mantissa = mantissa*10ull+uint64_t(*ptr-'0');
+		if (mantissa)
+			digits++;
+		exponent--;
+	}
+	if (!anyDigits)
+		return atof(word);
+	if (*ptr=='e' || *ptr=='E')
+	{
+		ptr++;
+		const bool negativeExponent = *ptr=='-';
+		if (*ptr=='-' || *ptr=='+')
+			ptr++;
+		if (!core::isdigit(*ptr))
+			return atof(word);
+		int32_t explicitExponent = 0;
+		for (; core::isdigit(*ptr) && explicitExponent<10000; ptr++)
+			explicitExponent = explicitExponent*10+(*ptr-'0');
+		exponent += negativeExponent ? -explicitExponent:explicitExponent;
+	}
+	// inexact mantissa, power of ten or anything we didn't understand goes the slow route
+	constexpr int32_t MaxExactPowerOf10 = 22;
+	if (*ptr || mantissa>(0x1ull<<53ull) || exponent<-MaxExactPowerOf10 || exponent>MaxExactPowerOf10)
+		return atof(word);
+
+	constexpr double PowersOf10[MaxExactPowerOf10+1] = {
+		1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,
+		1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22
+	};
+	double value = double(mantissa);
+	value = exponent<0 ? (value/PowersOf10[-exponent]):(value*PowersOf10[exponent]);
+	return negative ? -value:value;
+}
+
+//! Same as `atoi` for everything which fits into 32 bits
+int32_t parseInt(const char* word)
+{
+	const char* ptr = word;
+	while (core::isspace(*ptr))
+		ptr++;
+	const bool negative = *ptr=='-';
+	if (*ptr=='-' || *ptr=='+')
+		ptr++;
+	uint32_t value = 0u;
+	for (; core::isdigit(*ptr); ptr++)
+		value = value*10u+uint32_t(*ptr-'0');
+	return int32_t(negative ? (0u-value):value);
+}
+
+template<typename T>
+inline T loadUnaligned(const uint8_t* ptr)
+{
+	T retval;
+	memcpy(&retval,ptr,sizeof(T));
+	return retval;
+}
+
+//! Binary value as `CPLYMeshFileLoader::getFloat` would read it, endianness already taken care of
+inline float loadBinaryFloat(const uint8_t* ptr, const E_PLY_PROPERTY_TYPE type)
+{
+	switch (type)
+	{
+		case EPLYPT_INT8:
+			return loadUnaligned<int8_t>(ptr);
+		case EPLYPT_INT16:
+			return loadUnaligned<int16_t>(ptr);
+		case EPLYPT_INT32:
+			return float(loadUnaligned<int32_t>(ptr));
+		case EPLYPT_FLOAT32:
+			return loadUnaligned<float>(ptr);
+		case EPLYPT_FLOAT64:
+			return float(loadUnaligned<double>(ptr));
+		default:
+			return 0.f;
+	}
+}
+
+//! Binary value as `CPLYMeshFileLoader::getInt` would read it, endianness already taken care of
+inline uint32_t loadBinaryInt(const uint8_t* ptr, const E_PLY_PROPERTY_TYPE type)
+{
+	switch (type)
+	{
+		case EPLYPT_INT8:
+			return loadUnaligned<uint8_t>(ptr);
+		case EPLYPT_INT16:
+			return loadUnaligned<uint16_t>(ptr);
+		case EPLYPT_INT32:
+			return loadUnaligned<uint32_t>(ptr);
+		case EPLYPT_FLOAT32:
+			return uint32_t(loadUnaligned<float>(ptr));
+		case EPLYPT_FLOAT64:
+			return uint32_t(loadUnaligned<double>(ptr));
+		default:
+			return 0u;
+	}
+}
+
+//! Reverses the bytes of every `itemSize` sized value in `[data,data+bytes)`
+void byteswapInPlace(uint8_t* data, const size_t bytes, const uint32_t itemSize)
+{
+	uint8_t* const end = data+bytes;
+	if (itemSize==4u)
+	{
+		const __m128i mask = _mm_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+		for (; data+16<=end; data+=16)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(data),_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)),mask));
+	}
+	for (; data+itemSize<=end; data+=itemSize)
+		std::reverse(data,data+itemSize);
+}
+
+}
+
 CPLYMeshFileLoader::CPLYMeshFileLoader(IAssetManager* _am) 
 	: IRenderpassIndependentPipelineLoader(_am)
 {
@@ -404,7 +547,16 @@ asset::SAssetBundle CPLYMeshFileLoader::loadAsset(io::IReadFile* _file, const as
 						}			
 					}
 
-					// loop through vertex properties
+					// binary vertices without lists are just a strided array, convert them all at once
+					if (ctx.IsBinaryFile && plyVertexElement.IsFixedWidth)
+					{
+						if (!readVertexBlock(ctx, plyVertexElement, attributes, _params))
+						{
+							os::Printer::log("PLY file is too short for its vertex element", ctx.inner.mainFile->getFileName().c_str(), ELL_ERROR);
+							return {};
+						}
+					}
+					else // loop through vertex properties
 					for (uint32_t j=0; j<ctx.ElementList[i]->Count; ++j)
 						hasNormals &= readVertex(ctx, plyVertexElement, attributes, j, _params);
 				}
@@ -629,6 +781,153 @@ bool CPLYMeshFileLoader::readVertex(SContext& _ctx, const SPLYElement& Element,
 }
 
 
+bool CPLYMeshFileLoader::readVertexBlock(SContext& _ctx, const SPLYElement& Element, asset::SBufferBinding<asset::ICPUBuffer> outAttributes[4], const asset::IAssetLoader::SAssetLoadParams& _params)
+{
+	// same property to attribute mapping as `readVertex`
+	struct SPropertyTarget
+	{
+		uint32_t srcOffset;
+		E_PLY_PROPERTY_TYPE type;
+		bool normalizedInt;
+		float scale;
+		float* dst;
+		uint32_t dstStride;
+	};
+	core::vector<SPropertyTarget> targets;
+	{
+		const bool rightHanded = _params.loaderFlags & E_LOADER_PARAMETER_FLAGS::ELPF_RIGHT_HANDED_MESHES;
+		auto getAttribute = [&](const E_TYPE attr, const uint32_t component, const uint32_t componentCount) -> std::pair<float*,uint32_t>
+		{
+			return {reinterpret_cast<float*>(outAttributes[attr].buffer->getPointer())+component,componentCount};
+		};
+
+		uint32_t srcOffset = 0u;
+		for (const auto& property : Element.Properties)
+		{
+			SPropertyTarget target = {srcOffset,property.Type,false,1.f,nullptr,0u};
+			srcOffset += property.size();
+
+			const auto& name = property.Name;
+			std::pair<float*,uint32_t> dst = {nullptr,0u};
+			if (name == "x" || name == "y" || name == "z")
+			{
+				dst = getAttribute(ET_POS,name[0]-'x',3u);
+				if (name == "x" && rightHanded)
+					target.scale = -1.f;
+			}
+			else if (name == "nx" || name == "ny" || name == "nz")
+			{
+				dst = getAttribute(ET_NORM,name[1]-'x',3u);
+				if (name == "nx" && rightHanded)
+					target.scale = -1.f;
+			}
+			else if (name == "u" || name == "s")
+				dst = getAttribute(ET_UV,0u,2u);
+			else if (name == "v" || name == "t")
+				dst = getAttribute(ET_UV,1u,2u);
+			else if (name == "red" || name == "green" || name == "blue" || name == "alpha")
+			{
+				const uint32_t component = name == "red" ? 0u:(name == "green" ? 1u:(name == "blue" ? 2u:3u));
+				dst = getAttribute(ET_COL,component,4u);
+				if (!property.isFloat())
+				{
+					target.normalizedInt = true;
+					target.scale = 1.f/255.f;
+				}
+			}
+			else
+				continue;
+
+			std::tie(target.dst,target.dstStride) = dst;
+			targets.push_back(target);
+		}
+	}
+
+	const size_t stride = Element.KnownSize;
+	const size_t bytes = stride*Element.Count;
+	core::vector<uint8_t> scratch;
+	const uint8_t* data = readBinaryBlock(_ctx, bytes, scratch);
+	if (!data)
+		return false;
+
+	if (_ctx.IsWrongEndian)
+	{
+		// mappings are read-only, swap in a copy
+		if (data != scratch.data())
+		{
+			scratch.assign(data, data+bytes);
+			data = scratch.data();
+		}
+		const bool uniformSize = std::all_of(Element.Properties.begin(),Element.Properties.end(),[&](const SPLYProperty& prop){return prop.size()==Element.Properties.front().size();});
+		if (uniformSize)
+			byteswapInPlace(scratch.data(), bytes, Element.Properties.front().size());
+		else
+		for (uint32_t i=0u; i<Element.Count; i++)
+		{
+			uint8_t* vertex = scratch.data()+stride*i;
+			for (const auto& property : Element.Properties)
+			{
+				byteswapInPlace(vertex, property.size(), property.size());
+				vertex += property.size();
+			}
+		}
+	}
+
+	constexpr uint32_t BatchSize = 0x1u<<12u;
+	core::vector<uint32_t> batches((Element.Count+BatchSize-1u)/BatchSize);
+	std::iota(batches.begin(), batches.end(), 0u);
+	std::for_each(std::execution::par_unseq, batches.begin(), batches.end(), [&](const uint32_t batch)
+	{
+		const uint32_t begin = batch*BatchSize;
+		const uint32_t end = core::min(begin+BatchSize, Element.Count);
+		for (const auto& target : targets)
+		for (uint32_t i=begin; i<end; i++)
+		{
+			const uint8_t* src = data+stride*i+target.srcOffset;
+			const float value = target.normalizedInt ? float(loadBinaryInt(src,target.type)):loadBinaryFloat(src,target.type);
+			target.dst[size_t(i)*target.dstStride] = value*target.scale;
+		}
+	});
+	return true;
+}
+
+const uint8_t* CPLYMeshFileLoader::readBinaryBlock(SContext& _ctx, const size_t bytes, core::vector<uint8_t>& _scratch)
+{
+	const size_t buffered = _ctx.EndPointer-_ctx.StartPointer;
+	if (bytes <= buffered)
+	{
+		const auto* retval = reinterpret_cast<const uint8_t*>(_ctx.StartPointer);
+		_ctx.StartPointer += bytes;
+		return retval;
+	}
+
+	// the buffered bytes are the ones right before the file's current position
+	io::IReadFile* file = _ctx.inner.mainFile;
+	const size_t remaining = bytes-buffered;
+	if (file->getPos()+remaining > file->getSize())
+		return nullptr;
+
+	const uint8_t* retval;
+	if (const auto* mapped = reinterpret_cast<const uint8_t*>(file->getMappedPointer()))
+	{
+		retval = mapped+file->getPos()-buffered;
+		file->seek(remaining, true);
+	}
+	else
+	{
+		_scratch.resize(bytes);
+		memcpy(_scratch.data(), _ctx.StartPointer, buffered);
+		constexpr size_t MaxReadSize = 0x1ull<<30ull;
+		for (size_t offset=buffered; offset<bytes; offset+=MaxReadSize)
+			file->read(_scratch.data()+offset, core::min(bytes-offset,MaxReadSize));
+		retval = _scratch.data();
+	}
+	// buffer is empty now, next `fillBuffer` continues right after the block
+	_ctx.StartPointer = _ctx.EndPointer = _ctx.Buffer;
+	return retval;
+}
+
+
 bool CPLYMeshFileLoader::readFace(SContext& _ctx, const SPLYElement& Element, core::vector<uint32_t>& _outIndices)
 {
 	if (!_ctx.IsBinaryFile)
@@ -642,6 +941,39 @@ bool CPLYMeshFileLoader::readFace(SContext& _ctx, const SPLYElement& Element, co
 			int32_t count = getInt(_ctx, Element.Properties[i].Data.List.CountType);
 			//_NBL_DEBUG_BREAK_IF(count != 3)
 
+			// grab all the indices of a binary face at once instead of going through `getInt` for each
+			const auto itemType = Element.Properties[i].Data.List.ItemType;
+			const uint32_t itemSize = SPLYProperty::size(itemType);
+			const size_t listBytes = size_t(core::max(count,0))*itemSize;
+			if (_ctx.IsBinaryFile && count>=3 && listBytes<=PLY_INPUT_BUFFER_SIZE)
+			{
+				if (size_t(_ctx.EndPointer-_ctx.StartPointer)<listBytes)
+					fillBuffer(_ctx);
+				if (size_t(_ctx.EndPointer-_ctx.StartPointer)>=listBytes)
+				{
+					uint8_t* items = reinterpret_cast<uint8_t*>(_ctx.StartPointer);
+					_ctx.StartPointer += listBytes;
+					if (_ctx.IsWrongEndian)
+						byteswapInPlace(items,listBytes,itemSize);
+					auto getItem = [&](const int32_t j) -> uint32_t {return loadBinaryInt(items+size_t(j)*itemSize,itemType);};
+
+					const uint32_t a = getItem(0);
+					uint32_t b = getItem(1), c = getItem(2);
+					_outIndices.push_back(a);
+					_outIndices.push_back(b);
+					_outIndices.push_back(c);
+					for (int32_t j=3; j<count; ++j)
+					{
+						b = c;
+						c = getItem(j);
+						_outIndices.push_back(a);
+						_outIndices.push_back(c);
+						_outIndices.push_back(b);
+					}
+					continue;
+				}
+			}
+
 			uint32_t a = getInt(_ctx, Element.Properties[i].Data.List.ItemType),
 				b = getInt(_ctx, Element.Properties[i].Data.List.ItemType),
 				c = getInt(_ctx, Element.Properties[i].Data.List.ItemType);
@@ -1063,11 +1395,11 @@ float CPLYMeshFileLoader::getFloat(SContext& _ctx, E_PLY_PROPERTY_TYPE t)
 		case EPLYPT_INT8:
 		case EPLYPT_INT16:
 		case EPLYPT_INT32:
-			retVal = float(atoi(word));
+			retVal = float(parseInt(word));
 			break;
 		case EPLYPT_FLOAT32:
 		case EPLYPT_FLOAT64:
-			retVal = float(atof(word));
+			retVal = float(parseDouble(word));
 			break;
 		case EPLYPT_LIST:
 		case EPLYPT_UNKNOWN:
@@ -1095,7 +1427,7 @@ uint32_t CPLYMeshFileLoader::getInt(SContext& _ctx, E_PLY_PROPERTY_TYPE t)
 			switch (t)
 			{
 			case EPLYPT_INT8:
-				retVal = *_ctx.StartPointer;
+				retVal = *reinterpret_cast<uint8_t*>(_ctx.StartPointer);
 				_ctx.StartPointer++;
 				break;
 			case EPLYPT_INT16:
@@ -1142,11 +1474,11 @@ uint32_t CPLYMeshFileLoader::getInt(SContext& _ctx, E_PLY_PROPERTY_TYPE t)
 		case EPLYPT_INT8:
 		case EPLYPT_INT16:
 		case EPLYPT_INT32:
-			retVal = atoi(word);
+			retVal = parseInt(word);
 			break;
 		case EPLYPT_FLOAT32:
 		case EPLYPT_FLOAT64:
-			retVal = uint32_t(atof(word));
+			retVal = uint32_t(parseDouble(word));
 			break;
 		case EPLYPT_LIST:
 		case EPLYPT_UNKNOWN:
@@ -108,9 +108,9 @@ private:
 		} Data PACK_STRUCT;
 		#include "nbl/nblunpack.h"
 
-		inline uint32_t size() const
+		static inline uint32_t size(const E_PLY_PROPERTY_TYPE type)
 		{
-			switch(Type)
+			switch(type)
 			{
 			case EPLYPT_INT8:
 				return 1;
@@ -127,6 +127,10 @@ private:
 				return 0;
 			}
 		}
+		inline uint32_t size() const
+		{
+			return size(Type);
+		}
 
 		inline bool isFloat() const
 		{
@@ -194,6 +198,11 @@ private:
  	bool readVertex(SContext& _ctx, const SPLYElement &Element, asset::SBufferBinding<asset::ICPUBuffer> outAttributes[4], const uint32_t& currentVertexIndex, const IAssetLoader::SAssetLoadParams& _params);
 	bool readFace(SContext& _ctx, const SPLYElement &Element, core::vector<uint32_t>& _outIndices);
 
+	//! Reads a whole fixed width binary vertex element at once
+	bool readVertexBlock(SContext& _ctx, const SPLYElement &Element, asset::SBufferBinding<asset::ICPUBuffer> outAttributes[4], const IAssetLoader::SAssetLoadParams& _params);
+	//! Returns `bytes` contiguous bytes of the binary body and moves past them, straight out of the file's mapping if it has one
+	const uint8_t* readBinaryBlock(SContext& _ctx, const size_t bytes, core::vector<uint8_t>& _scratch);
+
 	void skipElement(SContext& _ctx, const SPLYElement &Element);
 	void skipProperty(SContext& _ctx, const SPLYProperty &Property);
 	float getFloat(SContext& _ctx, E_PLY_PROPERTY_TYPE t);
@@ -82,6 +82,146 @@ namespace material_compiler
 		core::unordered_map<const IR::INode*, id_t> m_cache;
 	};
 
+	//! Hash-consing of IR subtrees: maps every node to the first node seen which has the same type, parameters (textures included) and structurally identical children
+	class CSubtreeDeduplicator
+	{
+	public:
+		using stats_t = CMaterialCompilerGLSLBackendCommon::result_t::SDeduplicationStatistics;
+
+		CSubtreeDeduplicator(stats_t* _stats) : m_stats(_stats) {}
+
+		const IR::INode* canonicalize(const IR::INode* _node)
+		{
+			if (auto found = m_canonical.find(_node); found != m_canonical.end())
+				return found->second;
+
+			std::string key;
+			serializeLocal(key, _node);
+			put(key, _node->children.count);
+			for (const IR::INode* child : _node->children)
+				put(key, canonicalize(child));
+
+			const IR::INode* canonical = m_nodes.insert({std::move(key),_node}).first->second;
+			if (canonical != _node)
+				m_stats->nodes++;
+			m_canonical.insert({_node,canonical});
+
+			return canonical;
+		}
+
+		stats_t& getStatistics() { return *m_stats; }
+
+	private:
+		template <typename T>
+		static void put(std::string& _out, const T& _val)
+		{
+			_out.append(reinterpret_cast<const char*>(&_val), sizeof(T));
+		}
+		static void put(std::string& _out, const IR::INode::color_t& _col)
+		{
+			// w is not part of the colour and can hold anything
+			put(_out, _col.x);
+			put(_out, _col.y);
+			put(_out, _col.z);
+		}
+		static void put(std::string& _out, const IR::INode::STextureSource& _tex)
+		{
+			put(_out, _tex.image.get());
+			put(_out, _tex.sampler.get());
+			put(_out, _tex.scale);
+		}
+		template <typename type_of_const>
+		static void put(std::string& _out, const IR::INode::SParameter<type_of_const>& _param)
+		{
+			put(_out, _param.source);
+			if (_param.source == IR::INode::EPS_TEXTURE)
+				put(_out, _param.value.texture);
+			else
+				put(_out, _param.value.constant);
+		}
+
+		static void serializeLocal(std::string& _out, const IR::INode* _node)
+		{
+			put(_out, _node->symbol);
+			switch (_node->symbol)
+			{
+			case IR::INode::ES_GEOM_MODIFIER:
+			{
+				auto* node = static_cast<const IR::CGeomModifierNode*>(_node);
+				put(_out, node->type);
+				put(_out, node->texture);
+			}
+			break;
+			case IR::INode::ES_EMISSION:
+				put(_out, static_cast<const IR::CEmissionNode*>(_node)->intensity);
+				break;
+			case IR::INode::ES_OPACITY:
+				put(_out, static_cast<const IR::COpacityNode*>(_node)->opacity);
+				break;
+			case IR::INode::ES_BSDF_COMBINER:
+			{
+				auto* node = static_cast<const IR::CBSDFCombinerNode*>(_node);
+				put(_out, node->type);
+				if (node->type == IR::CBSDFCombinerNode::ET_WEIGHT_BLEND)
+					put(_out, static_cast<const IR::CBSDFBlendNode*>(node)->weight);
+				else if (node->type == IR::CBSDFCombinerNode::ET_MIX)
+				{
+					auto* mix = static_cast<const IR::CBSDFMixNode*>(node);
+					_out.append(reinterpret_cast<const char*>(mix->weights), mix->children.count*sizeof(float));
+				}
+			}
+			break;
+			case IR::INode::ES_BSDF:
+			{
+				auto* node = static_cast<const IR::CBSDFNode*>(_node);
+				put(_out, node->type);
+				put(_out, node->eta);
+				put(_out, node->etaK);
+				switch (node->type)
+				{
+				case IR::CBSDFNode::ET_MICROFACET_DIFFTRANS:
+				{
+					auto* difftrans = static_cast<const IR::CMicrofacetDifftransBSDFNode*>(node);
+					put(_out, difftrans->alpha_u);
+					put(_out, difftrans->alpha_v);
+					put(_out, difftrans->transmittance);
+				}
+				break;
+				case IR::CBSDFNode::ET_MICROFACET_DIFFUSE:
+				{
+					auto* diffuse = static_cast<const IR::CMicrofacetDiffuseBSDFNode*>(node);
+					put(_out, diffuse->alpha_u);
+					put(_out, diffuse->alpha_v);
+					put(_out, diffuse->reflectance);
+				}
+				break;
+				case IR::CBSDFNode::ET_MICROFACET_SPECULAR: [[fallthrough]];
+				case IR::CBSDFNode::ET_MICROFACET_COATING: [[fallthrough]];
+				case IR::CBSDFNode::ET_MICROFACET_DIELECTRIC:
+				{
+					auto* specular = static_cast<const IR::CMicrofacetSpecularBSDFNode*>(node);
+					put(_out, specular->ndf);
+					put(_out, specular->shadowing);
+					put(_out, specular->alpha_u);
+					put(_out, specular->alpha_v);
+					if (node->type == IR::CBSDFNode::ET_MICROFACET_COATING)
+						put(_out, static_cast<const IR::CMicrofacetCoatingBSDFNode*>(node)->thicknessSigmaA);
+					else if (node->type == IR::CBSDFNode::ET_MICROFACET_DIELECTRIC)
+						put(_out, static_cast<const IR::CMicrofacetDielectricBSDFNode*>(node)->thin);
+				}
+				break;
+				default: break;
+				}
+			}
+			break;
+			}
+		}
+
+		stats_t* m_stats;
+		core::unordered_map<const IR::INode*, const IR::INode*> m_canonical;
+		core::unordered_map<std::string, const IR::INode*> m_nodes;
+	};
+
 	template <typename stack_el_t>
 	class ITraversalGenerator
 	{
@@ -92,6 +232,7 @@ namespace material_compiler
 		IR* m_ir;
 		CIdGenerator* m_id_gen;
 		tmp_bxdf_translation_cache_t* m_translationCache;
+		CSubtreeDeduplicator* m_dedup;
 
 		core::stack<stack_el_t> m_stack;
 
@@ -135,8 +276,8 @@ namespace material_compiler
 
 		std::pair<instr_t, const IR::INode*> processSubtree(const IR::INode* tree, IR::INode::children_array_t& next)
 		{
-			//TODO deduplication
-			return CInterpreter::processSubtree(m_ir, tree, next, m_translationCache);
+			// identical subtrees get interpreted the same way and share IDs, translated nodes and BSDF data
+			return CInterpreter::processSubtree(m_ir, m_dedup->canonicalize(tree), next, m_translationCache);
 		}
 
 		void setBSDFData(instr_stream::intermediate::SBSDFUnion& _dst, instr_stream::E_OPCODE _op, const IR::INode* _node)
@@ -263,11 +404,24 @@ namespace material_compiler
 			auto found = m_ctx->bsdfDataIndexMap.find(_node);
 			if (found != m_ctx->bsdfDataIndexMap.end())
 				return found->second;
+			// temporary nodes made by the interpreter (like blends out of mixes) are new objects every time, so need canonicalizing too
+			const IR::INode* canonical = m_dedup->canonicalize(_node);
+			if (canonical != _node)
+			{
+				found = m_ctx->bsdfDataIndexMap.find(canonical);
+				if (found != m_ctx->bsdfDataIndexMap.end())
+				{
+					m_ctx->bsdfDataIndexMap.insert({_node,found->second});
+					m_dedup->getStatistics().bsdfDataEntries++;
+					return found->second;
+				}
+			}
 
 			instr_stream::intermediate::SBSDFUnion data;
 			setBSDFData(data, _op, _node);
 			size_t ix = m_ctx->bsdfData.size();
 			m_ctx->bsdfDataIndexMap.insert({_node,ix});
+			m_ctx->bsdfDataIndexMap.insert({canonical,ix});
 			m_ctx->bsdfData.push_back(data);
 
 			return ix;
@@ -417,8 +571,8 @@ namespace material_compiler
 		}
 
 	public:
-		ITraversalGenerator(SContext* _ctx, IR* _ir, CIdGenerator* _id_gen, tmp_bxdf_translation_cache_t* _cache, uint32_t _regCount) : 
-			m_ctx(_ctx), m_ir(_ir), m_id_gen(_id_gen), m_translationCache(_cache), m_registerPool(_regCount) {}
+		ITraversalGenerator(SContext* _ctx, IR* _ir, CIdGenerator* _id_gen, tmp_bxdf_translation_cache_t* _cache, CSubtreeDeduplicator* _dedup, uint32_t _regCount) : 
+			m_ctx(_ctx), m_ir(_ir), m_id_gen(_id_gen), m_translationCache(_cache), m_dedup(_dedup), m_registerPool(_regCount) {}
 
 		virtual traversal_t genTraversal(const IR::INode* _root, uint32_t& _out_usedRegs) = 0;
 	};
@@ -539,8 +693,8 @@ namespace remainder_and_pdf
 		CTraversalManipulator::id2pos_map_t m_id2pos;
 
 	public:
-		CTraversalGenerator(SContext* _ctx, IR* _ir, CIdGenerator* _id_gen, tmp_bxdf_translation_cache_t* _cache, uint32_t _regCount, uint32_t _regsPerResult) :
-			base_t(_ctx, _ir, _id_gen, _cache, _regCount), m_regsPerRes(_regsPerResult)
+		CTraversalGenerator(SContext* _ctx, IR* _ir, CIdGenerator* _id_gen, tmp_bxdf_translation_cache_t* _cache, CSubtreeDeduplicator* _dedup, uint32_t _regCount, uint32_t _regsPerResult) :
+			base_t(_ctx, _ir, _id_gen, _cache, _dedup, _regCount), m_regsPerRes(_regsPerResult)
 		{}
 
 		const auto& getId2PosMapping() const { return m_id2pos; }
@@ -1153,10 +1307,33 @@ auto CMaterialCompilerGLSLBackendCommon::compile(SContext* _ctx, IR* _ir, bool _
 	res.usedRegisterCount = 0u;
 	res.globalPrefetchRegCountFlags = 0u;
 
+	CSubtreeDeduplicator dedup(&res.deduplicated);
+	//final BSDF data is deduplicated by contents, since different intermediate entries can end up identical once textures become prefetch registers
+	core::unordered_map<std::string, uint32_t> bsdfDataContents;
 	for (const IR::INode* root : _ir->roots)
 	{
+		if (res.streams.find(root) != res.streams.end())
+			continue;
+		//structurally identical root compiled before, its streams can be used as they are
+		if (const IR::INode* canonicalRoot = dedup.canonicalize(root); canonicalRoot != root)
+		{
+			auto found = res.streams.find(canonicalRoot);
+			if (found != res.streams.end())
+			{
+				const result_t::instr_streams_t streams = found->second;
+				res.streams.insert({root,streams});
+
+				res.deduplicated.roots++;
+				res.deduplicated.instructions += streams.rem_and_pdf_count+streams.gen_choice_count+streams.norm_precomp_count;
+				res.deduplicated.prefetchInstructions += streams.tex_prefetch_count;
+				continue;
+			}
+		}
+
 		uint32_t registerPool = instr_stream::MAX_REGISTER_COUNT;
 
+		//prefetch registers are assigned per root, so intermediate BSDF data can't be shared with other roots
+		_ctx->bsdfDataIndexMap.clear();
 		const size_t interm_bsdf_data_begin_ix = _ctx->bsdfData.size();
 
 		CIdGenerator id_gen;
@@ -1173,7 +1350,7 @@ auto CMaterialCompilerGLSLBackendCommon::compile(SContext* _ctx, IR* _ir, bool _
 			//In raytracing backend _computeGenChoiceStream is always true
 			const uint32_t regsPerRes = _computeGenChoiceStream ? 4u : 3u;
 
-			remainder_and_pdf::CTraversalGenerator gen(_ctx, _ir, &id_gen, &translationCache, registerPool, regsPerRes);
+			remainder_and_pdf::CTraversalGenerator gen(_ctx, _ir, &id_gen, &translationCache, &dedup, registerPool, regsPerRes);
 			rem_pdf_stream = gen.genTraversal(root, usedRegs);
 			assert(usedRegs <= registerPool);
 			registerPool -= usedRegs;
@@ -1182,7 +1359,7 @@ auto CMaterialCompilerGLSLBackendCommon::compile(SContext* _ctx, IR* _ir, bool _
 		traversal_t gen_choice_stream;
 		if (_computeGenChoiceStream)
 		{
-			gen_choice::CTraversalGenerator gen(_ctx, _ir, &id_gen, &translationCache, registerPool);
+			gen_choice::CTraversalGenerator gen(_ctx, _ir, &id_gen, &translationCache, &dedup, registerPool);
 			gen_choice_stream = gen.genTraversal(root, usedRegs);
 			assert(usedRegs <= registerPool);
 			registerPool -= usedRegs;
@@ -1229,11 +1406,15 @@ auto CMaterialCompilerGLSLBackendCommon::compile(SContext* _ctx, IR* _ir, bool _
 		setSourceRegForBumpmaps(rem_pdf_stream, regNum);
 		setSourceRegForBumpmaps(gen_choice_stream, regNum);
 
+		core::vector<uint32_t> bsdfDataRemap;
+		bsdfDataRemap.reserve(_ctx->bsdfData.size()-interm_bsdf_data_begin_ix);
 		for (auto it = _ctx->bsdfData.begin()+interm_bsdf_data_begin_ix; it != _ctx->bsdfData.end(); ++it)
 		{
 			const auto& interm_bsdf_data = *it;
 
 			instr_stream::SBSDFUnion bsdf_data;
+			//unused bytes must not make otherwise equal entries differ
+			memset(&bsdf_data, 0, sizeof(bsdf_data));
 			for (uint32_t i = 0u; i < instr_stream::SBSDFUnion::MAX_TEXTURES; ++i)
 			{
 				auto found = tex2reg.find(interm_bsdf_data.common.param[i].tex);
@@ -1245,8 +1426,30 @@ auto CMaterialCompilerGLSLBackendCommon::compile(SContext* _ctx, IR* _ir, bool _
 			bsdf_data.common.extras[0] = interm_bsdf_data.common.extras[0];
 			bsdf_data.common.extras[1] = interm_bsdf_data.common.extras[1];
 
-			res.bsdfData.push_back(bsdf_data);
+			auto inserted = bsdfDataContents.insert({std::string(reinterpret_cast<const char*>(&bsdf_data),sizeof(bsdf_data)),static_cast<uint32_t>(res.bsdfData.size())});
+			if (inserted.second)
+				res.bsdfData.push_back(bsdf_data);
+			else
+				res.deduplicated.bsdfDataEntries++;
+			bsdfDataRemap.push_back(inserted.first->second);
 		}
+		auto remapBSDFDataIndices = [&bsdfDataRemap,interm_bsdf_data_begin_ix](traversal_t& _stream)
+		{
+			for (instr_t& instr : _stream)
+			{
+				const instr_stream::E_OPCODE op = instr_stream::getOpcode(instr);
+				//same as in prefetch stream generation, these have no BSDF data
+				if (op==instr_stream::OP_NOOP || op==instr_stream::OP_INVALID || op==instr_stream::OP_SET_GEOM_NORMAL)
+					continue;
+
+				const uint32_t ix = instr_stream::getBSDFDataIx(instr);
+				assert(ix >= interm_bsdf_data_begin_ix && ix-interm_bsdf_data_begin_ix < bsdfDataRemap.size());
+				instr_stream::setBSDFDataIx(instr, bsdfDataRemap[ix-interm_bsdf_data_begin_ix]);
+			}
+		};
+		remapBSDFDataIndices(rem_pdf_stream);
+		remapBSDFDataIndices(gen_choice_stream);
+		remapBSDFDataIndices(normal_precomp_stream);
 
 		result_t::instr_streams_t streams;
 		{
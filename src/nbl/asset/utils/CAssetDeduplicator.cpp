@@ -0,0 +1,444 @@
+// Copyright (C) 2018-2021 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/asset/utils/CAssetDeduplicator.h"
+
+#include "nbl/core/xxHash256.h"
+
+#include <functional>
+
+using namespace nbl;
+using namespace asset;
+
+
+namespace
+{
+
+//! Flattens the fields which make two assets equal into a byte string, padding never gets in
+class CKeyWriter
+{
+	public:
+		template<typename T>
+		inline void write(const T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Only plain data can go into a key");
+			const auto* ptr = reinterpret_cast<const uint8_t*>(&value);
+			m_data.insert(m_data.end(),ptr,ptr+sizeof(T));
+		}
+		inline void write(const void* data, size_t size)
+		{
+			const auto* ptr = reinterpret_cast<const uint8_t*>(data);
+			m_data.insert(m_data.end(),ptr,ptr+size);
+		}
+
+		inline CAssetDeduplicator::hash_t hash() const
+		{
+			CAssetDeduplicator::hash_t retval;
+			core::XXHash_256(m_data.data(),m_data.size(),retval.data());
+			return retval;
+		}
+
+		inline core::vector<uint8_t>& getData() { return m_data; }
+
+	private:
+		core::vector<uint8_t> m_data;
+};
+
+template<class BufferType>
+inline void writeBinding(CKeyWriter& writer, const SBufferBinding<BufferType>& binding, const std::function<void(CKeyWriter&,const ICPUBuffer*)>& writeBuffer)
+{
+	writer.write(binding.buffer ? binding.offset:0ull);
+	writeBuffer(writer,binding.buffer.get());
+}
+
+//! `writeBuffer` decides whether buffers are identified by their contents or by their canonical instance
+void writeImageKey(CKeyWriter& writer, const ICPUImage* image, const std::function<void(CKeyWriter&,const ICPUBuffer*)>& writeBuffer)
+{
+	const auto& params = image->getCreationParameters();
+	writer.write(params.flags);
+	writer.write(params.type);
+	writer.write(params.format);
+	writer.write(params.extent.width);
+	writer.write(params.extent.height);
+	writer.write(params.extent.depth);
+	writer.write(params.mipLevels);
+	writer.write(params.arrayLayers);
+	writer.write(params.samples);
+
+	const auto regions = image->getRegions();
+	writer.write(regions.size());
+	for (const auto& region : regions)
+	{
+		writer.write(region.bufferOffset);
+		writer.write(region.bufferRowLength);
+		writer.write(region.bufferImageHeight);
+		writer.write(region.imageSubresource.aspectMask);
+		writer.write(region.imageSubresource.mipLevel);
+		writer.write(region.imageSubresource.baseArrayLayer);
+		writer.write(region.imageSubresource.layerCount);
+		writer.write(region.imageOffset.x);
+		writer.write(region.imageOffset.y);
+		writer.write(region.imageOffset.z);
+		writer.write(region.imageExtent.width);
+		writer.write(region.imageExtent.height);
+		writer.write(region.imageExtent.depth);
+	}
+	writeBuffer(writer,image->getBuffer());
+}
+
+void writeMeshBufferKey(CKeyWriter& writer, const ICPUMeshBuffer* meshbuffer, const std::function<void(CKeyWriter&,const ICPUBuffer*)>& writeBuffer)
+{
+	const auto& bbox = meshbuffer->getBoundingBox();
+	writer.write(bbox.MinEdge.X);
+	writer.write(bbox.MinEdge.Y);
+	writer.write(bbox.MinEdge.Z);
+	writer.write(bbox.MaxEdge.X);
+	writer.write(bbox.MaxEdge.Y);
+	writer.write(bbox.MaxEdge.Z);
+
+	for (uint32_t i=0u; i<ICPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT; i++)
+		writeBinding(writer,meshbuffer->getVertexBufferBindings()[i],writeBuffer);
+	writeBinding(writer,meshbuffer->getIndexBufferBinding(),writeBuffer);
+	writeBinding(writer,meshbuffer->getInverseBindPoseBufferBinding(),writeBuffer);
+	writeBinding(writer,meshbuffer->getJointAABBBufferBinding(),writeBuffer);
+
+	writer.write(reinterpret_cast<uintptr_t>(meshbuffer->getSkeleton()));
+	writer.write(reinterpret_cast<uintptr_t>(meshbuffer->getAttachedDescriptorSet()));
+	writer.write(reinterpret_cast<uintptr_t>(meshbuffer->getPipeline()));
+	writer.write(meshbuffer->getPushConstantsDataPtr(),ICPUMeshBuffer::MAX_PUSH_CONSTANT_BYTESIZE);
+
+	writer.write(meshbuffer->getIndexCount());
+	writer.write(meshbuffer->getInstanceCount());
+	writer.write(meshbuffer->getBaseVertex());
+	writer.write(meshbuffer->getBaseInstance());
+	writer.write(static_cast<uint32_t>(meshbuffer->getMaxJointsPerVertex()));
+	writer.write(meshbuffer->getIndexType());
+
+	writer.write(meshbuffer->getPositionAttributeIx());
+	writer.write(meshbuffer->getNormalAttributeIx());
+	writer.write(meshbuffer->getJointIDAttributeIx());
+	writer.write(meshbuffer->getJointWeightAttributeIx());
+}
+
+void writeBufferContentHash(CKeyWriter& writer, const ICPUBuffer* buffer)
+{
+	writer.write(buffer ? CAssetDeduplicator::hash(buffer):CAssetDeduplicator::hash_t{});
+}
+
+inline bool canBeModified(const IAsset* _asset)
+{
+	return _asset->getMutability()!=IAsset::EM_IMMUTABLE && !_asset->isADummyObjectForCache();
+}
+
+}
+
+
+CAssetDeduplicator::hash_t CAssetDeduplicator::hash(const ICPUBuffer* buffer)
+{
+	hash_t retval;
+	const size_t size = buffer->getPointer() ? buffer->getSize():0ull;
+	core::XXHash_256(buffer->getPointer(),size,retval.data());
+	return retval;
+}
+
+CAssetDeduplicator::hash_t CAssetDeduplicator::hash(const ICPUImage* image)
+{
+	CKeyWriter writer;
+	writeImageKey(writer,image,writeBufferContentHash);
+	return writer.hash();
+}
+
+CAssetDeduplicator::hash_t CAssetDeduplicator::hash(const ICPUMeshBuffer* meshbuffer)
+{
+	CKeyWriter writer;
+	writeMeshBufferKey(writer,meshbuffer,writeBufferContentHash);
+	return writer.hash();
+}
+
+
+core::smart_refctd_ptr<IAsset> CAssetDeduplicator::deduplicate(core::smart_refctd_ptr<IAsset>&& _asset)
+{
+	if (!_asset)
+		return nullptr;
+
+	auto retval = deduplicate_impl(_asset.get());
+	m_resolved.clear();
+	return retval;
+}
+
+void CAssetDeduplicator::deduplicateContents(IAsset* _asset)
+{
+	if (!_asset)
+		return;
+
+	deduplicateContents_impl(_asset);
+	m_resolved.clear();
+}
+
+void CAssetDeduplicator::clear()
+{
+	m_buffers.clear();
+	m_images.clear();
+	m_imageViews.clear();
+	m_meshBuffers.clear();
+	m_canonical.clear();
+	m_resolved.clear();
+	m_stats = {};
+}
+
+
+core::smart_refctd_ptr<IAsset> CAssetDeduplicator::deduplicate_impl(IAsset* _asset)
+{
+	switch (_asset->getAssetType())
+	{
+		case IAsset::ET_BUFFER:
+			return deduplicate_impl(static_cast<ICPUBuffer*>(_asset));
+		case IAsset::ET_IMAGE:
+			return deduplicate_impl(static_cast<ICPUImage*>(_asset));
+		case IAsset::ET_IMAGE_VIEW:
+			return deduplicate_impl(static_cast<ICPUImageView*>(_asset));
+		case IAsset::ET_SUB_MESH:
+			return deduplicate_impl(static_cast<ICPUMeshBuffer*>(_asset));
+		default:
+			deduplicateContents_impl(_asset);
+			return core::smart_refctd_ptr<IAsset>(_asset);
+	}
+}
+
+void CAssetDeduplicator::deduplicateContents_impl(IAsset* _asset)
+{
+	switch (_asset->getAssetType())
+	{
+		case IAsset::ET_IMAGE:
+			deduplicateContents_impl(static_cast<ICPUImage*>(_asset));
+			break;
+		case IAsset::ET_DESCRIPTOR_SET:
+			deduplicateContents_impl(static_cast<ICPUDescriptorSet*>(_asset));
+			break;
+		case IAsset::ET_SUB_MESH:
+			deduplicateContents_impl(static_cast<ICPUMeshBuffer*>(_asset));
+			break;
+		case IAsset::ET_MESH:
+			deduplicateContents_impl(static_cast<ICPUMesh*>(_asset));
+			break;
+		default: // image views can't be repointed at another image, everything else doesn't reference data we deduplicate
+			break;
+	}
+}
+
+
+core::smart_refctd_ptr<ICPUBuffer> CAssetDeduplicator::deduplicate_impl(ICPUBuffer* _buffer)
+{
+	if (!_buffer || _buffer->isADummyObjectForCache() || !_buffer->getPointer() || m_canonical.find(_buffer)!=m_canonical.end())
+		return core::smart_refctd_ptr<ICPUBuffer>(_buffer);
+	if (auto found=m_resolved.find(_buffer); found!=m_resolved.end())
+		return core::smart_refctd_ptr_static_cast<ICPUBuffer>(found->second.canonical);
+
+	const auto size = _buffer->getSize();
+	const uint64_t bucket = hash(_buffer)[0];
+	const auto range = m_buffers.equal_range(bucket);
+	for (auto it=range.first; it!=range.second; it++)
+	{
+		const auto* other = it->second.get();
+		if (other->getSize()==size && memcmp(other->getPointer(),_buffer->getPointer(),size)==0)
+		{
+			m_stats.buffersDeduplicated++;
+			m_stats.bytesSaved += size;
+			m_resolved.emplace(_buffer,SResolved{core::smart_refctd_ptr<IAsset>(_buffer),it->second});
+			return it->second;
+		}
+	}
+
+	auto retval = core::smart_refctd_ptr<ICPUBuffer>(_buffer);
+	m_buffers.emplace(bucket,retval);
+	m_canonical.insert(_buffer);
+	return retval;
+}
+
+core::smart_refctd_ptr<ICPUImage> CAssetDeduplicator::deduplicate_impl(ICPUImage* _image)
+{
+	if (_image->isADummyObjectForCache() || m_canonical.find(_image)!=m_canonical.end())
+		return core::smart_refctd_ptr<ICPUImage>(_image);
+	if (auto found=m_resolved.find(_image); found!=m_resolved.end())
+		return core::smart_refctd_ptr_static_cast<ICPUImage>(found->second.canonical);
+
+	deduplicateContents_impl(_image);
+	CKeyWriter writer;
+	writeImageKey(writer,_image,[this](CKeyWriter& _writer, const ICPUBuffer* buffer) -> void
+	{
+		_writer.write(reinterpret_cast<uintptr_t>(buffer ? deduplicate_impl(const_cast<ICPUBuffer*>(buffer)).get():nullptr));
+	});
+
+	auto retval = findOrInsert(m_images,std::move(writer.getData()),_image);
+	if (retval.get()!=_image)
+		m_stats.imagesDeduplicated++;
+	return retval;
+}
+
+core::smart_refctd_ptr<ICPUImageView> CAssetDeduplicator::deduplicate_impl(ICPUImageView* _view)
+{
+	if (_view->isADummyObjectForCache() || m_canonical.find(_view)!=m_canonical.end())
+		return core::smart_refctd_ptr<ICPUImageView>(_view);
+	if (auto found=m_resolved.find(_view); found!=m_resolved.end())
+		return core::smart_refctd_ptr_static_cast<ICPUImageView>(found->second.canonical);
+
+	auto params = _view->getCreationParameters();
+	if (params.image)
+		params.image = deduplicate_impl(params.image.get());
+
+	CKeyWriter writer;
+	writer.write(params.flags);
+	writer.write(reinterpret_cast<uintptr_t>(params.image.get()));
+	writer.write(params.viewType);
+	writer.write(params.format);
+	writer.write(params.components.r);
+	writer.write(params.components.g);
+	writer.write(params.components.b);
+	writer.write(params.components.a);
+	writer.write(params.subresourceRange.aspectMask);
+	writer.write(params.subresourceRange.baseMipLevel);
+	writer.write(params.subresourceRange.levelCount);
+	writer.write(params.subresourceRange.baseArrayLayer);
+	writer.write(params.subresourceRange.layerCount);
+
+	// a view can't be repointed at the canonical image, so if it's the first of its kind a new view takes its place
+	core::smart_refctd_ptr<ICPUImageView> replacement;
+	if (params.image.get()!=_view->getCreationParameters().image.get())
+		replacement = ICPUImageView::create(std::move(params));
+	auto retval = findOrInsert(m_imageViews,std::move(writer.getData()),replacement ? replacement.get():_view);
+	if (retval.get()!=_view)
+	{
+		if (retval!=replacement)
+			m_stats.imageViewsDeduplicated++;
+		m_resolved.emplace(_view,SResolved{core::smart_refctd_ptr<IAsset>(_view),retval});
+	}
+	return retval;
+}
+
+core::smart_refctd_ptr<ICPUMeshBuffer> CAssetDeduplicator::deduplicate_impl(ICPUMeshBuffer* _meshbuffer)
+{
+	if (_meshbuffer->isADummyObjectForCache() || m_canonical.find(_meshbuffer)!=m_canonical.end())
+		return core::smart_refctd_ptr<ICPUMeshBuffer>(_meshbuffer);
+	if (auto found=m_resolved.find(_meshbuffer); found!=m_resolved.end())
+		return core::smart_refctd_ptr_static_cast<ICPUMeshBuffer>(found->second.canonical);
+
+	deduplicateContents_impl(_meshbuffer);
+	CKeyWriter writer;
+	writeMeshBufferKey(writer,_meshbuffer,[this](CKeyWriter& _writer, const ICPUBuffer* buffer) -> void
+	{
+		_writer.write(reinterpret_cast<uintptr_t>(buffer ? deduplicate_impl(const_cast<ICPUBuffer*>(buffer)).get():nullptr));
+	});
+
+	auto retval = findOrInsert(m_meshBuffers,std::move(writer.getData()),_meshbuffer);
+	if (retval.get()!=_meshbuffer)
+		m_stats.meshBuffersDeduplicated++;
+	return retval;
+}
+
+
+void CAssetDeduplicator::deduplicateContents_impl(ICPUImage* _image)
+{
+	if (!canBeModified(_image))
+		return;
+
+	auto* buffer = _image->getBuffer();
+	if (!buffer)
+		return;
+	auto canonical = deduplicate_impl(buffer);
+	if (canonical.get()==buffer)
+		return;
+
+	const auto regions = _image->getRegions();
+	auto regionsCopy = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<IImage::SBufferCopy>>(regions.size());
+	std::copy(regions.begin(),regions.end(),regionsCopy->begin());
+	_image->setBufferAndRegions(std::move(canonical),regionsCopy);
+}
+
+void CAssetDeduplicator::deduplicateContents_impl(ICPUDescriptorSet* _ds)
+{
+	if (!canBeModified(_ds))
+		return;
+
+	for (uint32_t i=0u; i<=_ds->getMaxDescriptorBindingIndex(); i++)
+	for (auto& info : _ds->getDescriptors(i))
+	{
+		auto* descriptor = info.desc.get();
+		if (!descriptor)
+			continue;
+		// uniform and storage buffers usually get written to per-object after loading, so only images are shared
+		if (descriptor->getTypeCategory()!=IDescriptor::EC_IMAGE)
+			continue;
+		auto canonical = deduplicate_impl(static_cast<ICPUImageView*>(descriptor));
+		if (canonical.get()!=descriptor)
+			info.desc = std::move(canonical);
+	}
+}
+
+void CAssetDeduplicator::deduplicateContents_impl(ICPUMeshBuffer* _meshbuffer)
+{
+	if (!canBeModified(_meshbuffer))
+		return;
+
+	auto dedupBinding = [this](const SBufferBinding<ICPUBuffer>& binding) -> SBufferBinding<ICPUBuffer>
+	{
+		if (!binding.buffer)
+			return binding;
+		return {binding.offset,deduplicate_impl(binding.buffer.get())};
+	};
+
+	for (uint32_t i=0u; i<ICPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT; i++)
+	{
+		auto binding = dedupBinding(_meshbuffer->getVertexBufferBindings()[i]);
+		if (binding!=_meshbuffer->getVertexBufferBindings()[i])
+			_meshbuffer->setVertexBufferBinding(std::move(binding),i);
+	}
+	{
+		auto binding = dedupBinding(_meshbuffer->getIndexBufferBinding());
+		if (binding!=_meshbuffer->getIndexBufferBinding())
+			_meshbuffer->setIndexBufferBinding(std::move(binding));
+	}
+	{
+		auto inverseBindPoses = dedupBinding(_meshbuffer->getInverseBindPoseBufferBinding());
+		auto jointAABBs = dedupBinding(_meshbuffer->getJointAABBBufferBinding());
+		if (inverseBindPoses!=_meshbuffer->getInverseBindPoseBufferBinding() || jointAABBs!=_meshbuffer->getJointAABBBufferBinding())
+		{
+			auto skeleton = core::smart_refctd_ptr<ICPUSkeleton>(_meshbuffer->getSkeleton());
+			_meshbuffer->setSkin(std::move(inverseBindPoses),std::move(jointAABBs),std::move(skeleton),_meshbuffer->getMaxJointsPerVertex());
+		}
+	}
+
+	if (auto* ds=_meshbuffer->getAttachedDescriptorSet())
+		deduplicateContents_impl(ds);
+}
+
+void CAssetDeduplicator::deduplicateContents_impl(ICPUMesh* _mesh)
+{
+	if (!canBeModified(_mesh))
+		return;
+
+	for (auto& meshbuffer : _mesh->getMeshBufferVector())
+	if (meshbuffer)
+		meshbuffer = deduplicate_impl(meshbuffer.get());
+}
+
+
+template<class AssetType>
+core::smart_refctd_ptr<AssetType> CAssetDeduplicator::findOrInsert(keyed_storage_t<AssetType>& storage, core::vector<uint8_t>&& key, AssetType* _asset)
+{
+	uint64_t keyHash[4];
+	core::XXHash_256(key.data(),key.size(),keyHash);
+
+	const auto range = storage.equal_range(keyHash[0]);
+	for (auto it=range.first; it!=range.second; it++)
+	if (it->second.key==key)
+	{
+		m_resolved.emplace(_asset,SResolved{core::smart_refctd_ptr<IAsset>(_asset),it->second.asset});
+		return it->second.asset;
+	}
+
+	auto retval = core::smart_refctd_ptr<AssetType>(_asset);
+	storage.emplace(keyHash[0],SKeyedEntry<AssetType>{std::move(key),retval});
+	m_canonical.insert(_asset);
+	return retval;
+}
@@ -21,6 +21,7 @@
 //-----------------------------------------------------------------------------
 
 
+#include <algorithm>
 #include <cmath>
 
 
@@ -119,28 +120,50 @@ namespace asset
 			_CHECK_NEXT_NEXT_BEST(curTri.score, tri);
 		}
 
+		// Every time a triangle gets (re)scored it's pushed onto this heap, so finding the best triangle left
+		// when the cache runs dry doesn't need a scan over all triangles. Entries for triangles which got emitted
+		// or rescored since are stale and get skipped, ties go to the lowest triangle index same as a linear scan.
+		struct ScoredTri
+		{
+			float score;
+			int32_t tri;
+
+			inline bool operator<(const ScoredTri& other) const
+			{
+				return score<other.score || (score==other.score && tri>other.tri);
+			}
+		};
+		core::vector<ScoredTri> scoreHeap(NumPrimitives);
+		for (int32_t tri = 0; tri < NumPrimitives; tri++)
+			scoreHeap[tri] = {triangleData[tri].score,tri};
+		std::make_heap(scoreHeap.begin(), scoreHeap.end());
+
 		//
 		// Step 2: Start emitting triangles...this is the emit loop
 		//
 		LRUCacheModel lruCache;
+		core::vector<uint32_t> trisToUpdate;
 		for (int32_t outIdx = 0; outIdx < _numIndices; /* this space intentionally left blank */)
 		{
 			// If there is no next best triangle, than search for the next highest
 			// scored triangle that isn't in the list already
 			if (nextBestTriIdx < 0)
 			{
-				// TODO: Something better than linear performance here...
 				nextBestTriScore = nextNextBestTriScore = -1.0f;
 				nextBestTriIdx = nextNextBestTriIdx = -1;
 
-				for (int32_t tri = 0; tri < NumPrimitives; tri++)
+				while (!scoreHeap.empty())
 				{
-					TriData &curTri = triangleData[tri];
+					std::pop_heap(scoreHeap.begin(), scoreHeap.end());
+					const ScoredTri top = scoreHeap.back();
+					scoreHeap.pop_back();
 
-					if (!curTri.isInList)
+					const TriData &curTri = triangleData[top.tri];
+					if (!curTri.isInList && curTri.score == top.score)
 					{
-						_CHECK_NEXT_BEST(curTri.score, tri);
-						_CHECK_NEXT_NEXT_BEST(curTri.score, tri);
+						nextBestTriIdx = top.tri;
+						nextBestTriScore = top.score;
+						break;
 					}
 				}
 			}
@@ -174,7 +197,6 @@ namespace asset
 			// Enforce cache size, this will update the cache position of all verts
 			// still in the cache. It will also update the score of the verts in the
 			// cache, and give back a list of triangle indicies that need updating.
-			core::vector<uint32_t> trisToUpdate;
 			lruCache.enforceSize(maxSIZE_VERTEX_CACHE, trisToUpdate);
 
 			// Now update scores for triangles that need updates, and find the new best
@@ -192,6 +214,8 @@ namespace asset
 
 					for (int32_t i = 0; i < 3; i++)
 						tri.score += vertexData[tri.vertIdx[i]].score;
+					scoreHeap.push_back({tri.score, int32_t(*itr)});
+					std::push_heap(scoreHeap.begin(), scoreHeap.end());
 
 					_CHECK_NEXT_BEST(tri.score, *itr);
 					_CHECK_NEXT_NEXT_BEST(tri.score, *itr);
@@ -14,6 +14,7 @@
 #include "nbl/asset/asset.h"
 #include "nbl/asset/utils/CMeshManipulator.h"
 #include "nbl/asset/utils/CSmoothNormalGenerator.h"
+#include "nbl/asset/utils/CVertexWelder.h"
 #include "nbl/asset/utils/CForsythVertexCacheOptimizer.h"
 #include "nbl/asset/utils/COverdrawMeshOptimizer.h"
 
@@ -436,77 +437,12 @@ core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::calculateSmoothNormals(
 	return outbuffer;
 }
 
-// Used by createMeshBufferWelded only
-static bool cmpVertices(ICPUMeshBuffer* _inbuf, const void* _va, const void* _vb, size_t _vsize, const IMeshManipulator::SErrorMetric* _errMetrics)
-{
-    auto cmpInteger = [](uint32_t* _a, uint32_t* _b, size_t _n) -> bool {
-        return !memcmp(_a, _b, _n*4);
-    };
-
-    constexpr uint32_t MAX_ATTRIBS = ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT;
-
-    const uint8_t* va = (uint8_t*)_va, *vb = (uint8_t*)_vb;
-    for (size_t i = 0u; i < MAX_ATTRIBS; ++i)
-    {
-        if (!_inbuf->isAttributeEnabled(i))
-            continue;
-
-        const auto atype = _inbuf->getAttribFormat(i);
-        const auto cpa = getFormatChannelCount(atype);
-
-        if (isIntegerFormat(atype) || isScaledFormat(atype))
-        {
-            uint32_t attr[8];
-            ICPUMeshBuffer::getAttribute(attr, va, atype);
-            ICPUMeshBuffer::getAttribute(attr+4, vb, atype);
-            if (!cmpInteger(attr, attr+4, cpa))
-                return false;
-        }
-        else
-        {
-            core::vectorSIMDf attr[2];
-            ICPUMeshBuffer::getAttribute(attr[0], va, atype);
-            ICPUMeshBuffer::getAttribute(attr[1], vb, atype);
-            if (!IMeshManipulator::compareFloatingPointAttribute(attr[0], attr[1], cpa, _errMetrics[i]))
-                return false;
-        }
-
-        const uint32_t sz = getTexelOrBlockBytesize(atype);
-        va += sz;
-        vb += sz;
-    }
-
-    return true;
-}
-
 //! Creates a copy of a mesh, which will have identical vertices welded together
 core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createMeshBufferWelded(ICPUMeshBuffer *inbuffer, const SErrorMetric* _errMetrics, const bool& optimIndexType, const bool& makeNewMesh)
 {
     if (!inbuffer || !inbuffer->getPipeline())
         return nullptr;
 
-    constexpr uint32_t MAX_ATTRIBS = ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT;
-
-    bool bufferPresent[MAX_ATTRIBS];
-
-    size_t vertexAttrSize[MAX_ATTRIBS];
-    size_t vertexSize = 0;
-    for (size_t i=0; i<MAX_ATTRIBS; i++)
-    {
-        const auto& buf = inbuffer->getAttribBoundBuffer(i).buffer;
-        bufferPresent[i] = inbuffer->isAttributeEnabled(i);
-        if (bufferPresent[i] && buf)
-        {
-            const E_FORMAT componentType = inbuffer->getAttribFormat(i);
-            vertexAttrSize[i] = getTexelOrBlockBytesize(componentType);
-            vertexSize += vertexAttrSize[i];
-        }
-    }
-
-    auto cmpfunc = [&, inbuffer, vertexSize, _errMetrics](const void* _va, const void* _vb) {
-        return cmpVertices(inbuffer, _va, _vb, vertexSize, _errMetrics);
-    };
-
     const uint32_t vertexCount = IMeshManipulator::upperBoundVertexID(inbuffer);
     const E_INDEX_TYPE oldIndexType = inbuffer->getIndexType();
 
@@ -516,43 +452,7 @@ core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createMeshBufferWelded(
     // reset redirect list
     uint32_t* redirects = new uint32_t[vertexCount];
 
-    uint32_t maxRedirect = 0;
-
-    uint8_t* epicData = (uint8_t*)_NBL_ALIGNED_MALLOC(vertexSize*vertexCount,_NBL_SIMD_ALIGNMENT);
-    for (auto i=0u; i<vertexCount; i++)
-    {
-        uint8_t* currentVertexPtr = epicData+i*vertexSize;
-        for (size_t k=0; k<MAX_ATTRIBS; k++)
-        {
-            if (!bufferPresent[k])
-                continue;
-
-            size_t stride = inbuffer->getAttribStride(k);
-            uint8_t* sourcePtr = inbuffer->getAttribPointer(k) + i*stride;
-            memcpy(currentVertexPtr,sourcePtr,vertexAttrSize[k]);
-            currentVertexPtr += vertexAttrSize[k];
-        }
-    }
-
-    for (auto i=0u; i<vertexCount; i++)
-    {
-        uint32_t redir = i;
-        for (auto j=0u; j<vertexCount; ++j) // TODO: Use spatial hash for this like in the smooth normal computation @Przemog
-        {
-            if (i == j)
-                continue;
-            if (cmpfunc(epicData+vertexSize*i, epicData+vertexSize*j))
-            {
-                redir = j;
-                break;
-            }
-        }
-
-        redirects[i] = redir;
-        if (redir>maxRedirect)
-            maxRedirect = redir;
-    }
-    _NBL_ALIGNED_FREE(epicData);
+    const uint32_t maxRedirect = CVertexWelder::computeRedirects(inbuffer,_errMetrics,redirects);
 
     void* oldIndices = inbuffer->getIndices();
     core::smart_refctd_ptr<ICPUMeshBuffer> clone;
@@ -652,6 +552,8 @@ core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createOptimizedMeshBuff
     // STEP: filter invalid triangles
     if (!_inbuffer->isSkinned())
         filterInvalidTriangles(outbuffer.get());
+    if (!outbuffer->getIndexCount())
+        return nullptr;
 
 	// STEP: overdraw optimization
 	COverdrawMeshOptimizer::createOptimized(outbuffer.get(),outbuffer.get());
@@ -672,40 +574,31 @@ core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createOptimizedMeshBuff
 
 	// STEP: reduce index buffer to 16bit or completely get rid of it
 	{
-		const void* const indices = outbuffer->getIndices();
-		uint32_t* indicesCopy = (uint32_t*)_NBL_ALIGNED_MALLOC(outbuffer->getIndexCount()*4,_NBL_SIMD_ALIGNMENT);
-		memcpy(indicesCopy, indices, outbuffer->getIndexCount()*4);
-		std::sort(indicesCopy, indicesCopy + outbuffer->getIndexCount());
+		const uint32_t indexCount = outbuffer->getIndexCount();
+		// the indices are still 32bit at this point, and need to outlive the index buffer getting swapped out
+		const auto oldIndexBuffer = outbuffer->getIndexBufferBinding().buffer;
+		const uint32_t* const indices = reinterpret_cast<const uint32_t*>(outbuffer->getIndices());
+		core::vector<uint32_t> indicesCopy(indices,indices+indexCount);
+		std::sort(indicesCopy.begin(),indicesCopy.end());
 
 		bool continuous = true; // indices are i.e. 0,1,2,3,4,5,... (also implies indices being unique)
 		bool unique = true; // indices are unique (but not necessarily continuos)
 
-		for (size_t i = 0; i < outbuffer->getIndexCount(); ++i)
+		for (size_t i = 1; i < indexCount; ++i)
 		{
-			uint32_t idx = indicesCopy[i], prevIdx = 0xffffffffu;
-			if (i)
+			const uint32_t idx = indicesCopy[i], prevIdx = indicesCopy[i-1];
+			if (idx == prevIdx)
 			{
-				prevIdx = indicesCopy[i-1];
-
-				if (idx == prevIdx)
-				{
-					unique = false;
-					continuous = false;
-					break;
-				}
-				if (idx != prevIdx + 1)
-					continuous = false;
+				unique = false;
+				continuous = false;
+				break;
 			}
+			if (idx != prevIdx + 1)
+				continuous = false;
 		}
 
-		const uint32_t minIdx = indicesCopy[0];
-		const uint32_t maxIdx = indicesCopy[outbuffer->getIndexCount() - 1];
-
-		_NBL_ALIGNED_FREE(indicesCopy);
-
-		core::smart_refctd_ptr<ICPUBuffer> newIdxBuffer;
-		bool verticesMustBeReordered = false;
-        E_INDEX_TYPE newIdxType = EIT_UNKNOWN;
+		const uint32_t minIdx = indicesCopy.front();
+		const uint32_t maxIdx = indicesCopy.back();
 
 		if (!continuous)
 		{
@@ -713,58 +606,44 @@ core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createOptimizedMeshBuff
 			{
 				// no index buffer
 				// vertices have to be reordered
-				verticesMustBeReordered = true;
-			}
-			else
-			{
-				if (maxIdx - minIdx <= USHRT_MAX)
-					newIdxType = EIT_16BIT;
-				else
-					newIdxType = EIT_32BIT;
+				auto* pipeline = outbuffer->getPipeline();
 
-				outbuffer->setBaseVertex(outbuffer->getBaseVertex() + minIdx);
+				const uint32_t posId = outbuffer->getPositionAttributeIx();
+				const size_t bufsz = outbuffer->getAttribBoundBuffer(posId).buffer->getSize();
 
-				if (newIdxType == EIT_16BIT)
+				const size_t vertexSize = pipeline->getVertexInputParams().bindings[0].stride;
+				uint8_t* const v = (uint8_t*)(outbuffer->getAttribBoundBuffer(posId).buffer->getPointer()); // after prefetch optim. we have guarantee of single vertex buffer so we can do like this
+				const core::vector<uint8_t> vCopy(v,v+bufsz);
+
+				const size_t baseVtx = outbuffer->getBaseVertex();
+				for (size_t i = 0; i < indexCount; ++i)
 				{
-					newIdxBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(sizeof(uint16_t)*outbuffer->getIndexCount());
-					// no need to change index buffer offset because it's always 0 (after duplicating original mesh)
-					for (size_t i = 0; i < outbuffer->getIndexCount(); ++i)
-						reinterpret_cast<uint16_t*>(newIdxBuffer->getPointer())[i] = reinterpret_cast<const uint32_t*>(indices)[i] - minIdx;
+					const size_t idx = indices[i]+baseVtx;
+					if (idx != i+baseVtx)
+						memcpy(v + (vertexSize*(i + baseVtx)), vCopy.data() + (vertexSize*idx), vertexSize);
 				}
+
+				outbuffer->setIndexType(EIT_UNKNOWN);
+				outbuffer->setIndexBufferBinding({ 0u, nullptr });
 			}
+			else if (maxIdx - minIdx <= USHRT_MAX)
+			{
+				outbuffer->setBaseVertex(outbuffer->getBaseVertex() + minIdx);
+
+				auto newIdxBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(sizeof(uint16_t)*indexCount);
+				// no need to change index buffer offset because it's always 0 (after duplicating original mesh)
+				for (size_t i = 0; i < indexCount; ++i)
+					reinterpret_cast<uint16_t*>(newIdxBuffer->getPointer())[i] = indices[i] - minIdx;
+				outbuffer->setIndexType(EIT_16BIT);
+				outbuffer->setIndexBufferBinding({ 0u, std::move(newIdxBuffer) });
+			}
+			// otherwise the 32bit index buffer stays as it is
 		}
 		else
 		{
 			outbuffer->setBaseVertex(outbuffer->getBaseVertex()+minIdx);
-		}
-
-		outbuffer->setIndexType(newIdxType);
-        outbuffer->setIndexBufferBinding({ 0u, std::move(newIdxBuffer) });
-
-		if (verticesMustBeReordered)
-		{
-            auto* pipeline = outbuffer->getPipeline();
-
-			// reorder vertices according to index buffer
-#define _ACCESS_IDX(n) ((newIdxType == EIT_32BIT) ? *(reinterpret_cast<const uint32_t*>(indices)+(n)) : *(reinterpret_cast<const uint16_t*>(indices)+(n)))
-
-            const uint32_t posId = outbuffer->getPositionAttributeIx();
-            const size_t bufsz = outbuffer->getAttribBoundBuffer(posId).buffer->getSize();
-
-			const size_t vertexSize = pipeline->getVertexInputParams().bindings[0].stride;
-			uint8_t* const v = (uint8_t*)(outbuffer->getAttribBoundBuffer(posId).buffer->getPointer()); // after prefetch optim. we have guarantee of single vertex buffer so we can do like this
-			uint8_t* const vCopy = (uint8_t*)_NBL_ALIGNED_MALLOC(bufsz, _NBL_SIMD_ALIGNMENT);
-			memcpy(vCopy, v, bufsz);
-
-			size_t baseVtx = outbuffer->getBaseVertex();
-			for (size_t i = 0; i < outbuffer->getIndexCount(); ++i)
-			{
-				const uint32_t idx = _ACCESS_IDX(i+baseVtx);
-				if (idx != i+baseVtx)
-					memcpy(v + (vertexSize*(i + baseVtx)), vCopy + (vertexSize*idx), vertexSize);
-			}
-#undef _ACCESS_IDX
-			_NBL_ALIGNED_FREE(vCopy);
+			outbuffer->setIndexType(EIT_UNKNOWN);
+			outbuffer->setIndexBufferBinding({ 0u, nullptr });
 		}
 	}
 
@@ -860,9 +739,16 @@ void IMeshManipulator::requantizeMeshBuffer(ICPUMeshBuffer* _meshbuffer, const S
 		if (itf != attribsF.end())
 		{
 			const core::vector<core::vectorSIMDf>& attrVec = itf->second;
-			for (size_t ai = 0u; ai < attrVec.size(); ++ai)
+			constexpr size_t BatchSize = 1024u;
+			float soa[4][BatchSize];
+			const float* const input[4] = { soa[0], soa[1], soa[2], soa[3] };
+			for (size_t first = 0u; first < attrVec.size(); first += BatchSize)
 			{
-				const bool check = _meshbuffer->setAttribute(attrVec[ai], newAttribs[i].vaid, ai);
+				const size_t batch = core::min(attrVec.size() - first, BatchSize);
+				for (size_t ai = 0u; ai < batch; ++ai)
+				for (uint32_t c = 0u; c < 4u; ++c)
+					soa[c][ai] = attrVec[first + ai].pointer[c];
+				const bool check = _meshbuffer->setAttributeRange(input, newAttribs[i].vaid, first, batch) == batch;
 				_NBL_DEBUG_BREAK_IF(!check)
 			}
 		}
@@ -942,9 +828,9 @@ core::vector<core::vectorSIMDf> CMeshManipulator::findBetterFormatF(E_FORMAT* _o
 
 	core::vectorSIMDf attr;
     const uint32_t cnt = IMeshManipulator::upperBoundVertexID(_meshbuffer);
-    for (uint32_t idx = 0u; idx < cnt; ++idx)
+    attribs.reserve(cnt);
+	auto addAttrib = [&]() -> void
 	{
-        _meshbuffer->getAttribute(attr, _attrId, idx);
 		attribs.push_back(attr);
 		for (uint32_t i = 0; i < cpa ; ++i)
 		{
@@ -953,6 +839,30 @@ core::vector<core::vectorSIMDf> CMeshManipulator::findBetterFormatF(E_FORMAT* _o
 			if (attr.pointer[i] > max[i])
 				max[i] = attr.pointer[i];
 		}
+	};
+
+	// decode in batches, whatever the batched path can't reach (past the end of the buffer) goes through getAttribute like before
+	constexpr uint32_t BatchSize = 1024u;
+	float decoded[4][BatchSize];
+	float* const output[4] = { decoded[0], decoded[1], decoded[2], decoded[3] };
+	uint32_t idx = 0u;
+	while (idx < cnt)
+	{
+		const uint32_t batch = core::min(cnt - idx, BatchSize);
+		const size_t batchDecoded = _meshbuffer->getAttributeRange(output, _attrId, idx, batch);
+		if (!batchDecoded)
+			break;
+		for (uint32_t j = 0u; j < batchDecoded; ++j)
+		{
+			attr.set(decoded[0][j], decoded[1][j], decoded[2][j], decoded[3][j]);
+			addAttrib();
+		}
+		idx += batchDecoded;
+	}
+    for (; idx < cnt; ++idx)
+	{
+        _meshbuffer->getAttribute(attr, _attrId, idx);
+		addAttrib();
 	}
 
 	core::vector<SAttribTypeChoice> possibleTypes = findTypesOfProperRangeF(thisType, getTexelOrBlockBytesize(thisType), min, max, _errMetric);
@@ -0,0 +1,236 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/core/core.h"
+
+#include "CVertexWelder.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <execution>
+#include <numeric>
+
+namespace nbl
+{
+namespace asset
+{
+
+CVertexWelder::SPackedVertices::SPackedVertices(const ICPUMeshBuffer* _inbuffer, const uint32_t _vertexCount) : data(nullptr), vertexSize(0ull), attrCount(0u), positionAttr(MAX_ATTRIBS)
+{
+	const uint32_t posAttrID = _inbuffer->getPositionAttributeIx();
+	for (uint32_t i=0u; i<MAX_ATTRIBS; i++)
+	{
+		if (!_inbuffer->isAttributeEnabled(i) || !_inbuffer->getAttribBoundBuffer(i).buffer)
+			continue;
+
+		if (i==posAttrID)
+			positionAttr = attrCount;
+		attrFormat[attrCount] = _inbuffer->getAttribFormat(i);
+		attrOffset[attrCount] = vertexSize;
+		attrMetric[attrCount] = i;
+		vertexSize += getTexelOrBlockBytesize(attrFormat[attrCount]);
+		attrCount++;
+	}
+
+	data = reinterpret_cast<uint8_t*>(_NBL_ALIGNED_MALLOC(vertexSize*_vertexCount,_NBL_SIMD_ALIGNMENT));
+	for (uint32_t k=0u; k<attrCount; k++)
+	{
+		const uint32_t attrID = attrMetric[k];
+		const size_t attrSize = getTexelOrBlockBytesize(attrFormat[k]);
+		const size_t stride = _inbuffer->getAttribStride(attrID);
+		const uint8_t* sourcePtr = _inbuffer->getAttribPointer(attrID);
+		uint8_t* destPtr = data+attrOffset[k];
+		for (uint32_t i=0u; i<_vertexCount; i++,sourcePtr+=stride,destPtr+=vertexSize)
+			memcpy(destPtr,sourcePtr,attrSize);
+	}
+}
+
+CVertexWelder::SPackedVertices::~SPackedVertices()
+{
+	_NBL_ALIGNED_FREE(data);
+}
+
+bool CVertexWelder::SPackedVertices::compare(const uint8_t* _va, const uint8_t* _vb, const IMeshManipulator::SErrorMetric* _errMetrics) const
+{
+	for (uint32_t k=0u; k<attrCount; k++)
+	{
+		const auto atype = attrFormat[k];
+		const auto cpa = getFormatChannelCount(atype);
+		const uint8_t* va = _va+attrOffset[k];
+		const uint8_t* vb = _vb+attrOffset[k];
+
+		if (isIntegerFormat(atype) || isScaledFormat(atype))
+		{
+			uint32_t attr[8];
+			ICPUMeshBuffer::getAttribute(attr,va,atype);
+			ICPUMeshBuffer::getAttribute(attr+4,vb,atype);
+			if (memcmp(attr,attr+4,cpa*sizeof(uint32_t)))
+				return false;
+		}
+		else
+		{
+			core::vectorSIMDf attr[2];
+			ICPUMeshBuffer::getAttribute(attr[0],va,atype);
+			ICPUMeshBuffer::getAttribute(attr[1],vb,atype);
+			if (!IMeshManipulator::compareFloatingPointAttribute(attr[0],attr[1],cpa,_errMetrics[attrMetric[k]]))
+				return false;
+		}
+	}
+	return true;
+}
+
+
+CVertexWelder::VertexHashGrid::VertexHashGrid(const SPackedVertices& _vertices, const uint32_t _vertexCount, const IMeshManipulator::SErrorMetric& _posMetric) : hashTableMask(0u), invCellSize(0.f)
+{
+	bucketContents.resize(_vertexCount);
+
+	const uint32_t posAttr = _vertices.positionAttr;
+	const bool canPartition = posAttr!=MAX_ATTRIBS && _posMetric.method==IMeshManipulator::EEM_POSITIONS &&
+		(isNormalizedFormat(_vertices.attrFormat[posAttr]) || isFloatingPointFormat(_vertices.attrFormat[posAttr]) || isScaledFormat(_vertices.attrFormat[posAttr]));
+	core::vector<uint32_t> hashes;
+	if (canPartition)
+	{
+		const E_FORMAT posFormat = _vertices.attrFormat[posAttr];
+		const uint32_t posOffset = _vertices.attrOffset[posAttr];
+		auto getPosition = [&](uint32_t ix) -> core::vectorSIMDf
+		{
+			core::vectorSIMDf pos(0.f);
+			ICPUMeshBuffer::getAttribute(pos,_vertices.getVertex(ix)+posOffset,posFormat);
+			return pos;
+		};
+
+		float maxEpsilon = 0.f;
+		if (!isIntegerFormat(posFormat) && !isScaledFormat(posFormat))
+		for (uint32_t i=0u; i<core::min(getFormatChannelCount(posFormat),3u); i++)
+			maxEpsilon = core::max(_posMetric.epsilon.pointer[i],maxEpsilon);
+
+		float maxCoord = 0.f;
+		for (uint32_t i=0u; i<_vertexCount; i++)
+		{
+			const auto pos = core::abs(getPosition(i));
+			for (uint32_t j=0u; j<3u; j++)
+			if (std::isfinite(pos.pointer[j]))
+				maxCoord = core::max(pos.pointer[j],maxCoord);
+		}
+
+		// cells need to be at least twice as large as epsilon for the 8-cell neighbourhood to suffice,
+		// but we also keep the cell coordinates within 2^20 so they don't overflow
+		const float cellSize = core::max(core::max(maxEpsilon*2.00001f,maxCoord*float(0x1p-20)),FLT_MIN);
+		invCellSize = 1.f/cellSize;
+
+		hashTableMask = core::roundUpToPoT<uint32_t>(core::clamp(_vertexCount,1u,0x1u<<24u))-1u;
+		hashes.resize(_vertexCount);
+		std::for_each(std::execution::par_unseq,hashes.begin(),hashes.end(),[&](uint32_t& outHash)
+		{
+			const uint32_t i = &outHash-hashes.data();
+			const core::vectorSIMDf pos = getPosition(i)*invCellSize;
+			core::vectorSIMDi32 cell(0);
+			for (uint32_t j=0u; j<3u; j++)
+			if (std::isfinite(pos.pointer[j]))
+				cell.pointer[j] = static_cast<int32_t>(std::floor(pos.pointer[j]));
+			outHash = hash(cell);
+		});
+	}
+
+	// counting sort by hash, stable so every bucket lists its vertices in ascending order
+	bucketOffsets.resize(hashTableMask+2u,0u);
+	if (canPartition)
+	{
+		for (uint32_t i=0u; i<_vertexCount; i++)
+			bucketOffsets[hashes[i]+1u]++;
+		std::inclusive_scan(bucketOffsets.begin(),bucketOffsets.end(),bucketOffsets.begin());
+		core::vector<uint32_t> cursors(bucketOffsets.begin(),bucketOffsets.end()-1u);
+		for (uint32_t i=0u; i<_vertexCount; i++)
+			bucketContents[cursors[hashes[i]]++] = i;
+	}
+	else
+	{
+		bucketOffsets[1] = _vertexCount;
+		std::iota(bucketContents.begin(),bucketContents.end(),0u);
+	}
+}
+
+uint32_t CVertexWelder::VertexHashGrid::hash(const core::vectorSIMDi32& cell) const
+{
+	static constexpr uint32_t primeNumber1 = 73856093;
+	static constexpr uint32_t primeNumber2 = 19349663;
+	static constexpr uint32_t primeNumber3 = 83492791;
+
+	return	((static_cast<uint32_t>(cell.x) * primeNumber1) ^
+		(static_cast<uint32_t>(cell.y) * primeNumber2) ^
+		(static_cast<uint32_t>(cell.z) * primeNumber3)) & hashTableMask;
+}
+
+std::array<uint32_t,8> CVertexWelder::VertexHashGrid::getNeighboringCellHashes(const core::vectorSIMDf& position) const
+{
+	std::array<uint32_t,8> neighbourhood;
+	if (!isSpatial())
+	{
+		std::fill(neighbourhood.begin(),neighbourhood.end(),0u);
+		return neighbourhood;
+	}
+
+	// offset by half a cell so the floor lands on the lower corner of the 2x2x2 neighbourhood
+	const core::vectorSIMDf cellFloatCoord = position*invCellSize-core::vectorSIMDf(0.5f);
+	core::vectorSIMDi32 base(0);
+	for (uint32_t j=0u; j<3u; j++)
+	if (std::isfinite(cellFloatCoord.pointer[j]))
+		base.pointer[j] = static_cast<int32_t>(std::floor(cellFloatCoord.pointer[j]));
+
+	for (uint32_t i=0u; i<8u; i++)
+		neighbourhood[i] = hash(base+core::vectorSIMDi32(int32_t(i&0x1u),int32_t((i>>1u)&0x1u),int32_t((i>>2u)&0x1u)));
+	return neighbourhood;
+}
+
+
+uint32_t CVertexWelder::computeRedirects(const ICPUMeshBuffer* _inbuffer, const IMeshManipulator::SErrorMetric* _errMetrics, uint32_t* _outRedirects)
+{
+	const uint32_t vertexCount = IMeshManipulator::upperBoundVertexID(_inbuffer);
+	if (!vertexCount)
+		return 0u;
+
+	const SPackedVertices vertices(_inbuffer,vertexCount);
+	const uint32_t posAttrID = _inbuffer->getPositionAttributeIx();
+	const IMeshManipulator::SErrorMetric posMetric = posAttrID<MAX_ATTRIBS ? _errMetrics[posAttrID]:IMeshManipulator::SErrorMetric();
+	const VertexHashGrid grid(vertices,vertexCount,posMetric);
+
+	std::atomic_uint32_t maxRedirect(0u);
+	std::for_each(std::execution::par,_outRedirects,_outRedirects+vertexCount,[&](uint32_t& redir)
+	{
+		const uint32_t i = &redir-_outRedirects;
+		const uint8_t* vertex = vertices.getVertex(i);
+
+		core::vectorSIMDf position(0.f);
+		if (grid.isSpatial())
+			ICPUMeshBuffer::getAttribute(position,vertex+vertices.attrOffset[vertices.positionAttr],vertices.attrFormat[vertices.positionAttr]);
+
+		auto neighbourhood = grid.getNeighboringCellHashes(position);
+		std::sort(neighbourhood.begin(),neighbourhood.end());
+		const auto uniqueEnd = std::unique(neighbourhood.begin(),neighbourhood.end());
+
+		redir = i;
+		for (auto it=neighbourhood.begin(); it!=uniqueEnd; it++)
+		for (const uint32_t candidate : grid.getBucket(*it))
+		{
+			// buckets are sorted, nothing past this point can lower the redirect
+			if (candidate>=redir)
+				break;
+			if (vertices.compare(vertex,vertices.getVertex(candidate),_errMetrics))
+			{
+				redir = candidate;
+				break;
+			}
+		}
+
+		uint32_t prevMax = maxRedirect.load(std::memory_order_relaxed);
+		while (prevMax<redir && !maxRedirect.compare_exchange_weak(prevMax,redir,std::memory_order_relaxed)) {}
+	});
+
+	return maxRedirect.load();
+}
+
+}
+}
@@ -0,0 +1,94 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_ASSET_C_VERTEX_WELDER_H_INCLUDED__
+#define __NBL_ASSET_C_VERTEX_WELDER_H_INCLUDED__
+
+
+#include <array>
+
+#include "nbl/asset/ICPUMeshBuffer.h"
+#include "nbl/asset/utils/IMeshManipulator.h"
+
+
+namespace nbl
+{
+namespace asset
+{
+
+//! Finds vertices which are equal within the given per-attribute error metrics
+/**
+Positions are quantized into a uniform grid with a cell size of at least twice the position epsilon,
+so every candidate for a vertex lies in one of the 8 cells surrounding the corner closest to it.
+Only those candidates get compared attribute by attribute, which makes welding O(n) on average.
+If the position attribute cannot be used for spatial partitioning (missing, or compared with an angular metric),
+all vertices fall into a single cell and welding degrades to the old brute-force O(n^2).
+*/
+class CVertexWelder
+{
+	public:
+		//! Fills `_outRedirects[i]` with the lowest vertex ID `j<=i` whose every enabled attribute matches vertex `i`'s
+		/**
+		@param _inbuffer Mesh buffer to weld, only the vertex attributes are read.
+		@param _errMetrics Array of `ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT` error metrics, one per attribute.
+		@param _outRedirects Array of at least `IMeshManipulator::upperBoundVertexID(_inbuffer)` entries.
+		@returns The largest redirect written.
+		*/
+		static uint32_t computeRedirects(const ICPUMeshBuffer* _inbuffer, const IMeshManipulator::SErrorMetric* _errMetrics, uint32_t* _outRedirects);
+
+		CVertexWelder() = delete;
+		~CVertexWelder() = delete;
+
+	private:
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t MAX_ATTRIBS = ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT;
+
+		//! All enabled attributes of a vertex packed tightly one after the other, so comparisons stay in cache
+		struct SPackedVertices
+		{
+			SPackedVertices(const ICPUMeshBuffer* _inbuffer, const uint32_t _vertexCount);
+			~SPackedVertices();
+
+			inline const uint8_t* getVertex(uint32_t ix) const { return data+size_t(ix)*vertexSize; }
+
+			bool compare(const uint8_t* _va, const uint8_t* _vb, const IMeshManipulator::SErrorMetric* _errMetrics) const;
+
+			uint8_t* data;
+			size_t vertexSize;
+			uint32_t attrCount;
+			E_FORMAT attrFormat[MAX_ATTRIBS];
+			uint32_t attrOffset[MAX_ATTRIBS];
+			uint32_t attrMetric[MAX_ATTRIBS];
+			uint32_t positionAttr; // index into `attrFormat`, or `MAX_ATTRIBS` if missing
+		};
+
+		class VertexHashGrid
+		{
+			public:
+				VertexHashGrid(const SPackedVertices& _vertices, const uint32_t _vertexCount, const IMeshManipulator::SErrorMetric& _posMetric);
+
+				//! Hashes of the 8 cells around the cell corner closest to the vertex, any vertex within epsilon has to lie in one of them
+				std::array<uint32_t,8> getNeighboringCellHashes(const core::vectorSIMDf& position) const;
+
+				inline core::SRange<const uint32_t> getBucket(uint32_t hash) const
+				{
+					return {bucketContents.data()+bucketOffsets[hash],bucketContents.data()+bucketOffsets[hash+1u]};
+				}
+
+				inline bool isSpatial() const { return invCellSize!=0.f; }
+
+			private:
+				uint32_t hash(const core::vectorSIMDi32& cell) const;
+
+				//! vertex IDs sorted by cell hash, within a bucket they stay in ascending order
+				core::vector<uint32_t> bucketContents;
+				core::vector<uint32_t> bucketOffsets;
+				uint32_t hashTableMask;
+				float invCellSize;
+		};
+};
+
+}
+}
+
+#endif
@@ -6,6 +6,7 @@
 #include "os.h"
 
 #include <cwchar>
+#include <execution>
 
 #include "nbl/ext/MitsubaLoader/CMitsubaLoader.h"
 #include "nbl/ext/MitsubaLoader/ParserUtil.h"
@@ -20,6 +21,9 @@
 #	define DEBUG_MITSUBA_LOADER
 #endif
 
+// weld, reorder for vertex cache and overdraw, and requantize every shape's meshbuffers (comment out for faster imports)
+#define OPTIMIZE_MESHES
+
 namespace nbl
 {
 using namespace asset;
@@ -267,10 +271,8 @@ static core::smart_refctd_ptr<asset::ICPUImageView> createImageView(core::smart_
 
 	return asset::ICPUImageView::create(std::move(params));
 }
-static core::smart_refctd_ptr<asset::ICPUImage> createDerivMap(asset::ICPUImage* _heightMap, asset::ICPUSampler* _smplr)
+static core::smart_refctd_ptr<asset::ICPUImage> createDerivMap(asset::ICPUImage* _heightMap, const asset::ICPUSampler::SParams& sp)
 {
-	const auto& sp = _smplr->getParams();
-
 	return asset::CDerivativeMapCreator::createDerivativeMapFromHeightMap(
 			_heightMap,
 			static_cast<asset::ICPUSampler::E_TEXTURE_CLAMP>(sp.TextureWrapU),
@@ -342,6 +344,170 @@ static core::smart_refctd_ptr<asset::ICPUImage> createBlendWeightImage(const ass
 	return outImg;
 }
 
+static asset::ICPUSampler::SParams getSamplerParams(const CElementTexture* bitmap)
+{
+	ICPUSampler::SParams samplerParams;
+	samplerParams.AnisotropicFilter = core::max(core::findMSB(uint32_t(bitmap->bitmap.maxAnisotropy)),1);
+	samplerParams.LodBias = 0.f;
+	samplerParams.TextureWrapW = ISampler::ETC_REPEAT;
+	samplerParams.BorderColor = ISampler::ETBC_FLOAT_OPAQUE_BLACK;
+	samplerParams.CompareEnable = false;
+	samplerParams.CompareFunc = ISampler::ECO_NEVER;
+	samplerParams.MaxLod = 10000.f;
+	samplerParams.MinLod = 0.f;
+	switch (bitmap->bitmap.filterType)
+	{
+		case CElementTexture::Bitmap::FILTER_TYPE::EWA:
+			[[fallthrough]]; // we dont support this fancy stuff
+		case CElementTexture::Bitmap::FILTER_TYPE::TRILINEAR:
+			samplerParams.MinFilter = ISampler::ETF_LINEAR;
+			samplerParams.MaxFilter = ISampler::ETF_LINEAR;
+			samplerParams.MipmapMode = ISampler::ESMM_LINEAR;
+			break;
+		default:
+			samplerParams.MinFilter = ISampler::ETF_NEAREST;
+			samplerParams.MaxFilter = ISampler::ETF_NEAREST;
+			samplerParams.MipmapMode = ISampler::ESMM_NEAREST;
+			break;
+	}
+	auto getWrapMode = [](CElementTexture::Bitmap::WRAP_MODE mode)
+	{
+		switch (mode)
+		{
+			case CElementTexture::Bitmap::WRAP_MODE::CLAMP:
+				return ISampler::ETC_CLAMP_TO_EDGE;
+				break;
+			case CElementTexture::Bitmap::WRAP_MODE::MIRROR:
+				return ISampler::ETC_MIRROR;
+				break;
+			case CElementTexture::Bitmap::WRAP_MODE::ONE:
+				_NBL_DEBUG_BREAK_IF(true); // TODO : replace whole texture?
+				break;
+			case CElementTexture::Bitmap::WRAP_MODE::ZERO:
+				_NBL_DEBUG_BREAK_IF(true); // TODO : replace whole texture?
+				break;
+			default:
+				break;
+		}
+		return ISampler::ETC_REPEAT;
+	};
+	samplerParams.TextureWrapU = getWrapMode(bitmap->bitmap.wrapModeU);
+	samplerParams.TextureWrapV = getWrapMode(bitmap->bitmap.wrapModeV);
+	return samplerParams;
+}
+
+static const CElementTexture* unrollScales(const CElementTexture* tex)
+{
+	while (tex->type == CElementTexture::SCALE)
+		tex = tex->scale.texture;
+	return tex;
+}
+
+//! Calls `f(shape)` for every shape `CMitsubaLoader::getMesh` would load for a top level shape, shapes in nested groups included
+template<typename F>
+static void forEachBasicShape(CElementShape* shape, F& f)
+{
+	if (shape->type!=CElementShape::Type::INSTANCE && shape->type!=CElementShape::Type::SHAPEGROUP)
+	{
+		f(shape);
+		return;
+	}
+
+	const CElementShape::ShapeGroup* shapegroup = nullptr;
+	if (shape->type==CElementShape::Type::INSTANCE)
+	{
+		if (!shape->instance.parent)
+			return;
+		shapegroup = &shape->instance.parent->shapegroup;
+	}
+	else
+		shapegroup = &shape->shapegroup;
+	for (auto i=0u; i<shapegroup->childCount; i++)
+	if (auto child=shapegroup->children[i])
+		forEachBasicShape(child,f);
+}
+
+//! Calls `f(texture,usage)` for every texture in a BSDF tree, in the same order `CMitsubaLoader::genBSDFtreeTraversal` caches them
+enum E_BSDF_TEXTURE_USAGE
+{
+	EBTU_PLAIN,
+	EBTU_BUMPMAP,
+	EBTU_BLEND_WEIGHT
+};
+template<typename F>
+static void forEachBSDFTexture(const CElementBSDF* _bsdf, F&& f)
+{
+	auto propertyTexture = [&](const auto& const_or_tex) -> void
+	{
+		if (const_or_tex.value.type == SPropertyElementData::INVALID)
+			f(const_or_tex.texture,EBTU_PLAIN);
+	};
+
+	core::stack<const CElementBSDF*> stack;
+	stack.push(_bsdf);
+
+	while (!stack.empty())
+	{
+		auto* bsdf = stack.top();
+		stack.pop();
+		switch (bsdf->type)
+		{
+		case CElementBSDF::COATING:
+		case CElementBSDF::ROUGHCOATING:
+		case CElementBSDF::BUMPMAP:
+		case CElementBSDF::BLEND_BSDF:
+		case CElementBSDF::MIXTURE_BSDF:
+		case CElementBSDF::MASK:
+		case CElementBSDF::TWO_SIDED:
+			for (uint32_t i = 0u; i < bsdf->meta_common.childCount; ++i)
+				stack.push(bsdf->meta_common.bsdf[i]);
+		default: break;
+		}
+
+		switch (bsdf->type)
+		{
+		case CElementBSDF::DIFFUSE:
+		case CElementBSDF::ROUGHDIFFUSE:
+			propertyTexture(bsdf->diffuse.reflectance);
+			propertyTexture(bsdf->diffuse.alpha);
+			break;
+		case CElementBSDF::DIFFUSE_TRANSMITTER:
+			propertyTexture(bsdf->difftrans.transmittance);
+			break;
+		case CElementBSDF::DIELECTRIC:
+		case CElementBSDF::THINDIELECTRIC:
+		case CElementBSDF::ROUGHDIELECTRIC:
+			propertyTexture(bsdf->dielectric.alphaU);
+			if (bsdf->dielectric.distribution == CElementBSDF::RoughSpecularBase::ASHIKHMIN_SHIRLEY)
+				propertyTexture(bsdf->dielectric.alphaV);
+			break;
+		case CElementBSDF::CONDUCTOR:
+			propertyTexture(bsdf->conductor.alphaU);
+			if (bsdf->conductor.distribution == CElementBSDF::RoughSpecularBase::ASHIKHMIN_SHIRLEY)
+				propertyTexture(bsdf->conductor.alphaV);
+			break;
+		case CElementBSDF::PLASTIC:
+		case CElementBSDF::ROUGHPLASTIC:
+			propertyTexture(bsdf->plastic.diffuseReflectance);
+			propertyTexture(bsdf->plastic.alphaU);
+			if (bsdf->plastic.distribution == CElementBSDF::RoughSpecularBase::ASHIKHMIN_SHIRLEY)
+				propertyTexture(bsdf->plastic.alphaV);
+			break;
+		case CElementBSDF::BUMPMAP:
+			f(bsdf->bumpmap.texture,EBTU_BUMPMAP);
+			break;
+		case CElementBSDF::BLEND_BSDF:
+			if (bsdf->blendbsdf.weight.value.type == SPropertyElementData::INVALID)
+				f(bsdf->blendbsdf.weight.texture,EBTU_BLEND_WEIGHT);
+			break;
+		case CElementBSDF::MASK:
+			propertyTexture(bsdf->mask.opacity);
+			break;
+		default: break;
+		}
+	}
+}
+
 core::smart_refctd_ptr<asset::ICPUPipelineLayout> CMitsubaLoader::createPipelineLayout(asset::IAssetManager* _manager, asset::ICPUVirtualTexture* _vt)
 {
 	core::smart_refctd_ptr<ICPUDescriptorSetLayout> ds0layout;
@@ -488,22 +654,56 @@ asset::SAssetBundle CMitsubaLoader::loadAsset(io::IReadFile* _file, const asset:
 			createAndCacheVertexShader(m_assetMgr, DUMMY_VERTEX_SHADER);
 		}
 
-		core::map<core::smart_refctd_ptr<asset::ICPUMesh>,std::pair<std::string,CElementShape::Type>> meshes;
-		for (auto& shapepair : parserManager.shapegroups)
+		// Shapes and the textures of their BSDFs don't depend on each other, so load and process them all in parallel up-front.
+		// Everything gets gathered and stored in parse order, so the output doesn't depend on scheduling.
 		{
-			auto* shapedef = shapepair.first;
-			if (shapedef->type == CElementShape::Type::SHAPEGROUP)
-				continue;
+			core::vector<CElementShape*> basicShapes;
+			core::vector<const CElementBSDF*> bsdfs;
+			{
+				core::unordered_set<const CElementShape*> uniqueShapes;
+				core::unordered_set<const CElementBSDF*> uniqueBSDFs;
+				auto gather = [&](CElementShape* shape) -> void
+				{
+					if (!uniqueShapes.insert(shape).second)
+						return;
+					basicShapes.push_back(shape);
+					if (shape->bsdf && uniqueBSDFs.insert(shape->bsdf).second)
+						bsdfs.push_back(shape->bsdf);
+				};
+				for (auto& shapepair : parserManager.shapegroups)
+				if (shapepair.first->type!=CElementShape::Type::SHAPEGROUP)
+					forEachBasicShape(shapepair.first,gather);
+			}
 
-			auto lowermeshes = getMesh(ctx, _hierarchyLevel, shapedef);
-			for (auto& mesh : lowermeshes)
+			prefetchTextures(ctx,bsdfs);
+
+			core::vector<SContext::shape_ass_type> shapeMeshes(basicShapes.size());
+			std::transform(std::execution::par,basicShapes.begin(),basicShapes.end(),shapeMeshes.begin(),[&](CElementShape* shape) -> SContext::shape_ass_type
+			{
+				return createShapeMesh(ctx,_hierarchyLevel,shape);
+			});
+			for (size_t i=0ull; i<basicShapes.size(); i++)
+				ctx.shapeCache.emplace(basicShapes[i],std::move(shapeMeshes[i]));
+		}
+
+		core::vector<std::pair<core::smart_refctd_ptr<asset::ICPUMesh>,std::pair<std::string,CElementShape::Type>>> meshes;
+		{
+			core::unordered_set<const asset::ICPUMesh*> uniqueMeshes;
+			for (auto& shapepair : parserManager.shapegroups)
 			{
-				if (!mesh)
+				auto* shapedef = shapepair.first;
+				if (shapedef->type == CElementShape::Type::SHAPEGROUP)
 					continue;
 
-				auto found = meshes.find(mesh);
-				if (found == meshes.end())
-					meshes.emplace(std::move(mesh),std::pair<std::string,CElementShape::Type>(std::move(shapepair.second),shapedef->type));
+				auto lowermeshes = getMesh(ctx, _hierarchyLevel, shapedef);
+				for (auto& mesh : lowermeshes)
+				{
+					if (!mesh)
+						continue;
+
+					if (uniqueMeshes.insert(mesh.get()).second)
+						meshes.emplace_back(std::move(mesh),std::pair<std::string,CElementShape::Type>(shapepair.second,shapedef->type));
+				}
 			}
 		}
 
@@ -519,6 +719,12 @@ asset::SAssetBundle CMitsubaLoader::loadAsset(io::IReadFile* _file, const asset:
 		}
 
 		auto compResult = ctx.backend.compile(&ctx.backend_ctx, ctx.ir.get());
+#ifdef DEBUG_MITSUBA_LOADER
+		{
+			const auto& dedup = compResult.deduplicated;
+			os::Printer::log("Mitsuba XML Loader: material compiler deduplicated "+std::to_string(dedup.nodes)+" IR nodes, "+std::to_string(dedup.roots)+" roots, "+std::to_string(dedup.getByteSize())+" bytes of instructions and BSDF data", ELL_INFORMATION);
+		}
+#endif
 		ctx.backend_ctx.vt.commitAll();
 		auto pipelineLayout = createPipelineLayout(m_assetMgr, ctx.backend_ctx.vt.vt.get());
 		auto fragShader = createFragmentShader(compResult, ctx.backend_ctx.vt.vt->getFloatViews().size());
@@ -652,30 +858,32 @@ static core::smart_refctd_ptr<ICPUMesh> createMeshFromGeomCreatorReturnType(IGeo
 
 SContext::shape_ass_type CMitsubaLoader::loadBasicShape(SContext& ctx, uint32_t hierarchyLevel, CElementShape* shape, const core::matrix3x4SIMD& relTform)
 {
-	constexpr uint32_t UV_ATTRIB_ID = 2U;
+	auto found = ctx.shapeCache.find(shape);
+	if (found == ctx.shapeCache.end())
+		found = ctx.shapeCache.emplace(shape,createShapeMesh(ctx,hierarchyLevel,shape)).first;
+	const auto& mesh = found->second;
+	if (!mesh)
+		return nullptr;
 
-	auto addInstance = [shape,&ctx,&relTform,this](SContext::shape_ass_type& mesh)
-	{
-		auto bsdf = getBSDFtreeTraversal(ctx, shape->bsdf);
-		core::matrix3x4SIMD tform = core::concatenateBFollowedByA(relTform, shape->getAbsoluteTransform());
-		SContext::SInstanceData instance(
-			tform,
-			bsdf,
+	auto bsdf = getBSDFtreeTraversal(ctx, shape->bsdf);
+	core::matrix3x4SIMD tform = core::concatenateBFollowedByA(relTform, shape->getAbsoluteTransform());
+	SContext::SInstanceData instance(
+		tform,
+		bsdf,
 #if defined(_NBL_DEBUG) || defined(_NBL_RELWITHDEBINFO)
-			shape->bsdf ? shape->bsdf->id:"",
+		shape->bsdf ? shape->bsdf->id:"",
 #endif
-			shape->obtainEmitter(),
-			CElementEmitter{} // TODO: does enabling a twosided BRDF make the emitter twosided?
-		);
-		ctx.mapMesh2instanceData.insert({ mesh.get(), instance });
-	};
+		shape->obtainEmitter(),
+		CElementEmitter{} // TODO: does enabling a twosided BRDF make the emitter twosided?
+	);
+	ctx.mapMesh2instanceData.insert({ mesh.get(), instance });
 
-	auto found = ctx.shapeCache.find(shape);
-	if (found != ctx.shapeCache.end()) {
-		addInstance(found->second);
+	return mesh;
+}
 
-		return found->second;
-	}
+SContext::shape_ass_type CMitsubaLoader::createShapeMesh(const SContext& ctx, uint32_t hierarchyLevel, CElementShape* shape)
+{
+	constexpr uint32_t UV_ATTRIB_ID = 2U;
 
 	auto loadModel = [&](const ext::MitsubaLoader::SPropertyElementData& filename, int64_t index=-1) -> core::smart_refctd_ptr<asset::ICPUMesh>
 	{
@@ -717,6 +925,7 @@ SContext::shape_ass_type CMitsubaLoader::loadBasicShape(SContext& ctx, uint32_t
 
 	core::smart_refctd_ptr<asset::ICPUMesh> mesh;
 	bool flipNormals = false;
+	bool flipTexCoords = false;
 	bool faceNormals = false;
 	float maxSmoothAngle = NAN;
 	switch (shape->type)
@@ -775,18 +984,7 @@ SContext::shape_ass_type CMitsubaLoader::loadBasicShape(SContext& ctx, uint32_t
 			flipNormals = flipNormals!=shape->obj.flipNormals;
 			faceNormals = shape->obj.faceNormals;
 			maxSmoothAngle = shape->obj.maxSmoothAngle;
-			if (mesh && shape->obj.flipTexCoords)
-			{
-				for (auto meshbuffer : mesh->getMeshBuffers())
-				{
-					core::vectorSIMDf uv;
-					for (uint32_t i=0u; meshbuffer->getAttribute(uv, UV_ATTRIB_ID, i); i++)
-					{
-						uv.y = -uv.y;
-						meshbuffer->setAttribute(uv, UV_ATTRIB_ID, i);
-					}
-				}
-			}
+			flipTexCoords = shape->obj.flipTexCoords;
 			// collapse parameter gets ignored
 			break;
 		case CElementShape::Type::PLY:
@@ -848,30 +1046,31 @@ SContext::shape_ass_type CMitsubaLoader::loadBasicShape(SContext& ctx, uint32_t
 	if (!mesh)
 		return nullptr;
 
-	// flip normals if necessary
-	if (flipNormals)
-	for (auto meshbuffer : mesh->getMeshBuffers())
-		ctx.manipulator->flipSurfaces(meshbuffer);
-
-	//turned off by default, it's too slow (works though)
-//#define OPTIMIZE_MESHES
-
+	// Meshbuffers of loaded models are shared with the asset cache (and with other shapes referencing the same file),
+	// so whatever we modify has to be done on a copy.
 	auto newMesh = core::make_smart_refctd_ptr<asset::ICPUMesh>();
 	for (auto meshbuffer : mesh->getMeshBuffers())
 	{
-#ifdef OPTIMIZE_MESHES // TODO
-		asset::IMeshManipulator::SErrorMetric metrics[asset::ICPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT];
-		metrics[3].method = asset::IMeshManipulator::EEM_ANGLES;
-		auto newMeshBuffer = ctx.manipulator->createOptimizedMeshBuffer(meshbuffer, metrics);
-#else
-		auto newMeshBuffer = core::smart_refctd_ptr<asset::ICPUMeshBuffer>(meshbuffer);
-#endif
+		auto newMeshBuffer = core::smart_refctd_ptr_static_cast<asset::ICPUMeshBuffer>(meshbuffer->clone(flipNormals||flipTexCoords ? 1u:0u));
+		// flip normals if necessary
+		if (flipNormals)
+			ctx.manipulator->flipSurfaces(newMeshBuffer.get());
+		if (flipTexCoords)
+		{
+			core::vectorSIMDf uv;
+			for (uint32_t i=0u; newMeshBuffer->getAttribute(uv, UV_ATTRIB_ID, i); i++)
+			{
+				uv.y = -uv.y;
+				newMeshBuffer->setAttribute(uv, UV_ATTRIB_ID, i);
+			}
+		}
+
 		if (faceNormals || !std::isnan(maxSmoothAngle))
 		{
 			const float smoothAngleCos = cos(core::radians(maxSmoothAngle));
 
-			ctx.manipulator->filterInvalidTriangles(meshbuffer);
-			newMeshBuffer = ctx.manipulator->createMeshBufferUniquePrimitives(meshbuffer);
+			ctx.manipulator->filterInvalidTriangles(newMeshBuffer.get());
+			newMeshBuffer = ctx.manipulator->createMeshBufferUniquePrimitives(newMeshBuffer.get());
 			ctx.manipulator->calculateSmoothNormals(newMeshBuffer.get(), false, 0.f, newMeshBuffer->getNormalAttributeIx(),
 				[&](const asset::IMeshManipulator::SSNGVertexData& a, const asset::IMeshManipulator::SSNGVertexData& b, asset::ICPUMeshBuffer* buffer)
 				{
@@ -881,22 +1080,21 @@ SContext::shape_ass_type CMitsubaLoader::loadBasicShape(SContext& ctx, uint32_t
 						return core::dot(a.parentTriangleFaceNormal, b.parentTriangleFaceNormal).x >= smoothAngleCos;
 				});
 		}
+#ifdef OPTIMIZE_MESHES
+		// done after normal generation so that welding can re-index the vertices `createMeshBufferUniquePrimitives` made unique
+		asset::IMeshManipulator::SErrorMetric metrics[asset::ICPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT];
+		metrics[3].method = asset::IMeshManipulator::EEM_ANGLES;
+		if (auto optimizedMeshBuffer = ctx.manipulator->createOptimizedMeshBuffer(newMeshBuffer.get(), metrics))
+			newMeshBuffer = std::move(optimizedMeshBuffer);
+#endif
 		newMesh->getMeshBufferVector().push_back(std::move(newMeshBuffer));
 	}
 	IMeshManipulator::recalculateBoundingBox(newMesh.get());
-	mesh = std::move(newMesh);
-
-	addInstance(mesh);
-	// cache and return
-	ctx.shapeCache.insert({ shape,mesh });
-	return mesh;
+	return newMesh;
 }
 
-SContext::tex_ass_type CMitsubaLoader::cacheTexture(SContext& ctx, uint32_t hierarchyLevel, const CElementTexture* tex, bool _restore)
+core::smart_refctd_ptr<asset::ICPUImageView> CMitsubaLoader::cacheImageView(const SContext& ctx, uint32_t hierarchyLevel, const CElementTexture* tex, bool _restore)
 {
-	if (!tex)
-		return {};
-
 	ICPUImageView::SCreationParams viewParams;
 	viewParams.flags = static_cast<ICPUImageView::E_CREATE_FLAGS>(0);
 	viewParams.subresourceRange.aspectMask = static_cast<IImage::E_ASPECT_FLAGS>(0);
@@ -904,238 +1102,182 @@ SContext::tex_ass_type CMitsubaLoader::cacheTexture(SContext& ctx, uint32_t hier
 	viewParams.subresourceRange.layerCount = 1u;
 	viewParams.subresourceRange.baseMipLevel = 0u;
 	viewParams.viewType = IImageView<ICPUImage>::ET_2D;
-	ICPUSampler::SParams samplerParams;
-	samplerParams.AnisotropicFilter = core::max(core::findMSB(uint32_t(tex->bitmap.maxAnisotropy)),1);
-	samplerParams.LodBias = 0.f;
-	samplerParams.TextureWrapW = ISampler::ETC_REPEAT;
-	samplerParams.BorderColor = ISampler::ETBC_FLOAT_OPAQUE_BLACK;
-	samplerParams.CompareEnable = false;
-	samplerParams.CompareFunc = ISampler::ECO_NEVER;
-	samplerParams.MaxLod = 10000.f;
-	samplerParams.MinLod = 0.f;
 
-	switch (tex->type)
+	const std::string cacheKey = ctx.bitmapViewCacheKey(tex);
+	core::smart_refctd_ptr<asset::ICPUImageView> view;
 	{
-		case CElementTexture::Type::BITMAP:
+		asset::SAssetBundle viewBundle;
+		const asset::IAsset::E_TYPE types[]{ asset::IAsset::ET_IMAGE_VIEW, static_cast<asset::IAsset::E_TYPE>(0) };
+		viewBundle = ctx.override_->findCachedAsset(cacheKey, types, ctx.inner, 0u);
+
+		auto contents = viewBundle.getContents();
+		if (!contents.empty())
+			view = core::smart_refctd_ptr_static_cast<asset::ICPUImageView>(contents.begin()[0]);
+		if (view)
 		{
-				std::string cacheKey = ctx.imageViewCacheKey(tex->bitmap.filename.svalue);
-				switch (tex->bitmap.channel)
+			auto& image = view->getCreationParameters().image;
+			if (_restore && image->isADummyObjectForCache())
+			{
+				auto loadParams = ctx.inner.params;
+				loadParams.restoreLevels = std::max(loadParams.restoreLevels, hierarchyLevel + 2u);
+				// this will restore the image being kept by found `view`
+				auto bundle = interm_getAssetInHierarchy(m_assetMgr, tex->bitmap.filename.svalue, loadParams, hierarchyLevel, ctx.override_);
+				if (bundle.getContents().empty() || image->isADummyObjectForCache())
 				{
-				case CElementTexture::Bitmap::CHANNEL::R:
-					cacheKey += "?r";
-					break;
-				case CElementTexture::Bitmap::CHANNEL::G:
-					cacheKey += "?g";
-					break;
-				case CElementTexture::Bitmap::CHANNEL::B:
-					cacheKey += "?b";
-					break;
-				case CElementTexture::Bitmap::CHANNEL::A:
-					cacheKey += "?a";
-					break;
-				default:
-					break;
+					// if for some reason restore failed, force recreating whole view
+					auto removeBundle = asset::SAssetBundle(nullptr, { view });
+					m_assetMgr->removeAssetFromCache(removeBundle);
+					view = nullptr;
 				}
+			}
+		}
+	}
 
-				core::smart_refctd_ptr<asset::ICPUImageView> view;
-				{
-					asset::SAssetBundle viewBundle;
-					const asset::IAsset::E_TYPE types[]{ asset::IAsset::ET_IMAGE_VIEW, static_cast<asset::IAsset::E_TYPE>(0) };
-					viewBundle = ctx.override_->findCachedAsset(cacheKey, types, ctx.inner, 0u);
+	core::smart_refctd_ptr<asset::ICPUImage> img;
+	if (!view)
+	{
+		const uint32_t restoreLevels = _restore ? 2u : 0u;
+		auto loadParams = ctx.inner.params;
+		loadParams.restoreLevels = std::max(loadParams.restoreLevels, hierarchyLevel + restoreLevels);
+		asset::SAssetBundle imgBundle = interm_getAssetInHierarchy(m_assetMgr,tex->bitmap.filename.svalue,loadParams,hierarchyLevel,ctx.override_);
+		auto contentRange = imgBundle.getContents();
+		if (contentRange.begin() < contentRange.end())
+		{
+			auto asset = contentRange.begin()[0];
+			if (asset && asset->getAssetType() == asset::IAsset::ET_IMAGE)
+			{
+				img = core::smart_refctd_ptr_static_cast<asset::ICPUImage>(asset);
 
-					auto contents = viewBundle.getContents();
-					if (!contents.empty())
-						view = core::smart_refctd_ptr_static_cast<asset::ICPUImageView>(contents.begin()[0]);
-					if (view)
-					{
-						auto& image = view->getCreationParameters().image;
-						if (_restore && image->isADummyObjectForCache())
+				switch (tex->bitmap.channel)
+				{
+					// no GL_R8_SRGB support yet
+					case CElementTexture::Bitmap::CHANNEL::R:
 						{
-							auto loadParams = ctx.inner.params;
-							loadParams.restoreLevels = std::max(loadParams.restoreLevels, hierarchyLevel + 2u);
-							// this will restore the image being kept by found `view`
-							auto bundle = interm_getAssetInHierarchy(m_assetMgr, tex->bitmap.filename.svalue, loadParams, hierarchyLevel, ctx.override_);
-							if (bundle.getContents().empty() || image->isADummyObjectForCache())
-							{
-								// if for some reason restore failed, force recreating whole view
-								auto removeBundle = asset::SAssetBundle(nullptr, { view });
-								m_assetMgr->removeAssetFromCache(removeBundle);
-								view = nullptr;
-							}
+						constexpr auto RED = ICPUImageView::SComponentMapping::ES_R;
+						viewParams.components = {RED,RED,RED,RED};
 						}
-					}
-				}
-
-				core::smart_refctd_ptr<asset::ICPUImage> img;
-				if (!view)
-				{
-					const uint32_t restoreLevels = _restore ? 2u : 0u;
-					auto loadParams = ctx.inner.params;
-					loadParams.restoreLevels = std::max(loadParams.restoreLevels, hierarchyLevel + restoreLevels);
-					asset::SAssetBundle imgBundle = interm_getAssetInHierarchy(m_assetMgr,tex->bitmap.filename.svalue,loadParams,hierarchyLevel,ctx.override_);
-					auto contentRange = imgBundle.getContents();
-					if (contentRange.begin() < contentRange.end())
-					{
-						auto asset = contentRange.begin()[0];
-						if (asset && asset->getAssetType() == asset::IAsset::ET_IMAGE)
+						break;
+					case CElementTexture::Bitmap::CHANNEL::G:
 						{
-							img = core::smart_refctd_ptr_static_cast<asset::ICPUImage>(asset);
-
-							switch (tex->bitmap.channel)
-							{
-								// no GL_R8_SRGB support yet
-								case CElementTexture::Bitmap::CHANNEL::R:
-									{
-									constexpr auto RED = ICPUImageView::SComponentMapping::ES_R;
-									viewParams.components = {RED,RED,RED,RED};
-									}
-									break;
-								case CElementTexture::Bitmap::CHANNEL::G:
-									{
-									constexpr auto GREEN = ICPUImageView::SComponentMapping::ES_G;
-									viewParams.components = {GREEN,GREEN,GREEN,GREEN};
-									}
-									break;
-								case CElementTexture::Bitmap::CHANNEL::B:
-									{
-									constexpr auto BLUE = ICPUImageView::SComponentMapping::ES_B;
-									viewParams.components = {BLUE,BLUE,BLUE,BLUE};
-									}
-									break;
-								case CElementTexture::Bitmap::CHANNEL::A:
-									{
-									constexpr auto ALPHA = ICPUImageView::SComponentMapping::ES_A;
-									viewParams.components = {ALPHA,ALPHA,ALPHA,ALPHA};
-									}
-									break;
-								/* special conversions needed to CIE space
-								case CElementTexture::Bitmap::CHANNEL::X:
-								case CElementTexture::Bitmap::CHANNEL::Y:
-								case CElementTexture::Bitmap::CHANNEL::Z:*/
-								case CElementTexture::Bitmap::CHANNEL::INVALID:
-									[[fallthrough]];
-								default:
-									break;
-							}
-							viewParams.subresourceRange.levelCount = img->getCreationParameters().mipLevels;
-							viewParams.format = img->getCreationParameters().format;
-							viewParams.image = std::move(img);
-							//! TODO: this stuff (custom shader sampling code?)
-							_NBL_DEBUG_BREAK_IF(tex->bitmap.uoffset != 0.f);
-							_NBL_DEBUG_BREAK_IF(tex->bitmap.voffset != 0.f);
-							_NBL_DEBUG_BREAK_IF(tex->bitmap.uscale != 1.f);
-							_NBL_DEBUG_BREAK_IF(tex->bitmap.vscale != 1.f);
+						constexpr auto GREEN = ICPUImageView::SComponentMapping::ES_G;
+						viewParams.components = {GREEN,GREEN,GREEN,GREEN};
 						}
-
-						//in case of <channel>, extract one channel
-						if (viewParams.components.g != asset::ICPUImageView::SComponentMapping::ES_G)
+						break;
+					case CElementTexture::Bitmap::CHANNEL::B:
 						{
-							auto get1ChannelFormat = [](uint32_t bytesPerChannel) -> asset::E_FORMAT {
-								switch (bytesPerChannel)
-								{
-								case 1u:
-									return asset::EF_R8_UNORM;
-								case 2u:
-									return asset::EF_R16_SFLOAT;
-								case 4u:
-									return asset::EF_R32_SFLOAT;
-								case 8u:
-									return asset::EF_R64_SFLOAT;
-								default:
-									return asset::EF_UNKNOWN;
-								}
-							};
-
-							auto outParams = viewParams.image->getCreationParameters();
-							asset::ICPUImage::SBufferCopy region;
-							const uint32_t bytesPerChannel = (getBytesPerPixel(outParams.format) * core::rational(1, getFormatChannelCount(outParams.format))).getIntegerApprox();
-							outParams.format = get1ChannelFormat(bytesPerChannel);
-							const size_t texelBytesz = asset::getTexelOrBlockBytesize(outParams.format);
-							region.bufferRowLength = asset::IImageAssetHandlerBase::calcPitchInBlocks(outParams.extent.width, texelBytesz);
-							auto buffer = core::make_smart_refctd_ptr<asset::ICPUBuffer>(texelBytesz * region.bufferRowLength * outParams.extent.height);
-							region.imageOffset = { 0,0,0 };
-							region.imageExtent = outParams.extent;
-							region.imageSubresource.baseArrayLayer = 0u;
-							region.imageSubresource.layerCount = 1u;
-							region.imageSubresource.mipLevel = 0u;
-							region.bufferImageHeight = 0u;
-							region.bufferOffset = 0u;
-							auto outImg = asset::ICPUImage::create(std::move(outParams));
-							outImg->setBufferAndRegions(std::move(buffer), core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<IImage::SBufferCopy>>(1ull, region));
-
-							using convert_filter_t = asset::CSwizzleAndConvertImageFilter<asset::EF_UNKNOWN, asset::EF_UNKNOWN>;
-							convert_filter_t::state_type conv;
-							conv.swizzle = viewParams.components;
-							conv.extent = viewParams.image->getCreationParameters().extent;
-							conv.layerCount = 1u;
-							conv.inMipLevel = 0u;
-							conv.outMipLevel = 0u;
-							conv.inBaseLayer = 0u;
-							conv.outBaseLayer = 0u;
-							conv.inOffset = { 0u,0u,0u };
-							conv.outOffset = { 0u,0u,0u };
-							conv.inImage = viewParams.image.get();
-							conv.outImage = outImg.get();
-
-							viewParams.components = asset::ICPUImageView::SComponentMapping{};
-							if (!convert_filter_t::execute(std::execution::par_unseq,&conv))
-								_NBL_DEBUG_BREAK_IF(true);
-							viewParams.format = outImg->getCreationParameters().format;
-							viewParams.image = std::move(outImg);
+						constexpr auto BLUE = ICPUImageView::SComponentMapping::ES_B;
+						viewParams.components = {BLUE,BLUE,BLUE,BLUE};
 						}
-
-						view = ICPUImageView::create(std::move(viewParams));
-						asset::SAssetBundle viewBundle(nullptr,{ view });
-						ctx.override_->insertAssetIntoCache(std::move(viewBundle), cacheKey, ctx.inner, hierarchyLevel);
-					}
-
-					// adjust gamma on pixels (painful and long process)
-					if (!std::isnan(tex->bitmap.gamma))
-					{
-						_NBL_DEBUG_BREAK_IF(true); // TODO : use an image filter!
-					}
-				}
-
-				const std::string samplerCacheKey = ctx.samplerCacheKey(tex);
-				switch (tex->bitmap.filterType)
-				{
-					case CElementTexture::Bitmap::FILTER_TYPE::EWA:
-						[[fallthrough]]; // we dont support this fancy stuff
-					case CElementTexture::Bitmap::FILTER_TYPE::TRILINEAR:
-						samplerParams.MinFilter = ISampler::ETF_LINEAR;
-						samplerParams.MaxFilter = ISampler::ETF_LINEAR;
-						samplerParams.MipmapMode = ISampler::ESMM_LINEAR;
 						break;
+					case CElementTexture::Bitmap::CHANNEL::A:
+						{
+						constexpr auto ALPHA = ICPUImageView::SComponentMapping::ES_A;
+						viewParams.components = {ALPHA,ALPHA,ALPHA,ALPHA};
+						}
+						break;
+					/* special conversions needed to CIE space
+					case CElementTexture::Bitmap::CHANNEL::X:
+					case CElementTexture::Bitmap::CHANNEL::Y:
+					case CElementTexture::Bitmap::CHANNEL::Z:*/
+					case CElementTexture::Bitmap::CHANNEL::INVALID:
+						[[fallthrough]];
 					default:
-						samplerParams.MinFilter = ISampler::ETF_NEAREST;
-						samplerParams.MaxFilter = ISampler::ETF_NEAREST;
-						samplerParams.MipmapMode = ISampler::ESMM_NEAREST;
 						break;
 				}
-				auto getWrapMode = [&samplerCacheKey](CElementTexture::Bitmap::WRAP_MODE mode)
-				{
-					switch (mode)
+				viewParams.subresourceRange.levelCount = img->getCreationParameters().mipLevels;
+				viewParams.format = img->getCreationParameters().format;
+				viewParams.image = std::move(img);
+				//! TODO: this stuff (custom shader sampling code?)
+				_NBL_DEBUG_BREAK_IF(tex->bitmap.uoffset != 0.f);
+				_NBL_DEBUG_BREAK_IF(tex->bitmap.voffset != 0.f);
+				_NBL_DEBUG_BREAK_IF(tex->bitmap.uscale != 1.f);
+				_NBL_DEBUG_BREAK_IF(tex->bitmap.vscale != 1.f);
+			}
+
+			//in case of <channel>, extract one channel
+			if (viewParams.components.g != asset::ICPUImageView::SComponentMapping::ES_G)
+			{
+				auto get1ChannelFormat = [](uint32_t bytesPerChannel) -> asset::E_FORMAT {
+					switch (bytesPerChannel)
 					{
-						case CElementTexture::Bitmap::WRAP_MODE::CLAMP:
-							return ISampler::ETC_CLAMP_TO_EDGE;
-							break;
-						case CElementTexture::Bitmap::WRAP_MODE::MIRROR:
-							return ISampler::ETC_MIRROR;
-							break;
-						case CElementTexture::Bitmap::WRAP_MODE::ONE:
-							_NBL_DEBUG_BREAK_IF(true); // TODO : replace whole texture?
-							break;
-						case CElementTexture::Bitmap::WRAP_MODE::ZERO:
-							_NBL_DEBUG_BREAK_IF(true); // TODO : replace whole texture?
-							break;
-						default:
-							break;
+					case 1u:
+						return asset::EF_R8_UNORM;
+					case 2u:
+						return asset::EF_R16_SFLOAT;
+					case 4u:
+						return asset::EF_R32_SFLOAT;
+					case 8u:
+						return asset::EF_R64_SFLOAT;
+					default:
+						return asset::EF_UNKNOWN;
 					}
-					return ISampler::ETC_REPEAT;
 				};
-				samplerParams.TextureWrapU = getWrapMode(tex->bitmap.wrapModeU);
-				samplerParams.TextureWrapV = getWrapMode(tex->bitmap.wrapModeV);
 
+				auto outParams = viewParams.image->getCreationParameters();
+				asset::ICPUImage::SBufferCopy region;
+				const uint32_t bytesPerChannel = (getBytesPerPixel(outParams.format) * core::rational(1, getFormatChannelCount(outParams.format))).getIntegerApprox();
+				outParams.format = get1ChannelFormat(bytesPerChannel);
+				const size_t texelBytesz = asset::getTexelOrBlockBytesize(outParams.format);
+				region.bufferRowLength = asset::IImageAssetHandlerBase::calcPitchInBlocks(outParams.extent.width, texelBytesz);
+				auto buffer = core::make_smart_refctd_ptr<asset::ICPUBuffer>(texelBytesz * region.bufferRowLength * outParams.extent.height);
+				region.imageOffset = { 0,0,0 };
+				region.imageExtent = outParams.extent;
+				region.imageSubresource.baseArrayLayer = 0u;
+				region.imageSubresource.layerCount = 1u;
+				region.imageSubresource.mipLevel = 0u;
+				region.bufferImageHeight = 0u;
+				region.bufferOffset = 0u;
+				auto outImg = asset::ICPUImage::create(std::move(outParams));
+				outImg->setBufferAndRegions(std::move(buffer), core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<IImage::SBufferCopy>>(1ull, region));
+
+				using convert_filter_t = asset::CSwizzleAndConvertImageFilter<asset::EF_UNKNOWN, asset::EF_UNKNOWN>;
+				convert_filter_t::state_type conv;
+				conv.swizzle = viewParams.components;
+				conv.extent = viewParams.image->getCreationParameters().extent;
+				conv.layerCount = 1u;
+				conv.inMipLevel = 0u;
+				conv.outMipLevel = 0u;
+				conv.inBaseLayer = 0u;
+				conv.outBaseLayer = 0u;
+				conv.inOffset = { 0u,0u,0u };
+				conv.outOffset = { 0u,0u,0u };
+				conv.inImage = viewParams.image.get();
+				conv.outImage = outImg.get();
+
+				viewParams.components = asset::ICPUImageView::SComponentMapping{};
+				if (!convert_filter_t::execute(std::execution::par_unseq,&conv))
+					_NBL_DEBUG_BREAK_IF(true);
+				viewParams.format = outImg->getCreationParameters().format;
+				viewParams.image = std::move(outImg);
+			}
+
+			view = ICPUImageView::create(std::move(viewParams));
+			asset::SAssetBundle viewBundle(nullptr,{ view });
+			ctx.override_->insertAssetIntoCache(std::move(viewBundle), cacheKey, ctx.inner, hierarchyLevel);
+		}
+
+		// adjust gamma on pixels (painful and long process)
+		if (!std::isnan(tex->bitmap.gamma))
+		{
+			_NBL_DEBUG_BREAK_IF(true); // TODO : use an image filter!
+		}
+	}
+
+	return view;
+}
+
+SContext::tex_ass_type CMitsubaLoader::cacheTexture(SContext& ctx, uint32_t hierarchyLevel, const CElementTexture* tex, bool _restore)
+{
+	if (!tex)
+		return {};
+
+	switch (tex->type)
+	{
+		case CElementTexture::Type::BITMAP:
+		{
+				auto view = cacheImageView(ctx,hierarchyLevel,tex,_restore);
+
+				const std::string samplerCacheKey = ctx.samplerCacheKey(tex);
 				core::smart_refctd_ptr<ICPUSampler> sampler;
 				{
 					const asset::IAsset::E_TYPE types[]{ asset::IAsset::ET_SAMPLER, static_cast<asset::IAsset::E_TYPE>(0) };
@@ -1149,7 +1291,7 @@ SContext::tex_ass_type CMitsubaLoader::cacheTexture(SContext& ctx, uint32_t hier
 					sampler = nullptr;
 				else if (!sampler)
 				{
-					sampler = core::make_smart_refctd_ptr<ICPUSampler>(samplerParams);
+					sampler = core::make_smart_refctd_ptr<ICPUSampler>(getSamplerParams(tex));
 					SAssetBundle samplerBundle(nullptr,{ sampler });
 					ctx.override_->insertAssetIntoCache(std::move(samplerBundle), samplerCacheKey, ctx.inner, hierarchyLevel);
 				}
@@ -1171,6 +1313,62 @@ SContext::tex_ass_type CMitsubaLoader::cacheTexture(SContext& ctx, uint32_t hier
 	}
 }
 
+void CMitsubaLoader::cacheDerivedImage(const SContext& ctx, const CElementTexture* bitmap, bool derivativeMap)
+{
+	const std::string key = derivativeMap ? ctx.derivMapCacheKey(bitmap):ctx.blendWeightImageCacheKey(bitmap);
+	if (getBuiltinAsset<asset::ICPUImage, asset::IAsset::ET_IMAGE>(key.c_str(), m_assetMgr))
+		return;
+
+	// TODO check and restore if dummy (image and sampler)
+	auto view = cacheImageView(ctx,0u,bitmap);
+	if (!view)
+		return;
+	auto* image = view->getCreationParameters().image.get();
+
+	auto derived = derivativeMap ? createDerivMap(image,getSamplerParams(bitmap)):createBlendWeightImage(image);
+	asset::SAssetBundle imgBundle(nullptr,{ derived });
+	ctx.override_->insertAssetIntoCache(imgBundle, key, ctx.inner, 0u);
+	auto derivedView = createImageView(std::move(derived));
+	asset::SAssetBundle viewBundle(nullptr,{ derivedView });
+	ctx.override_->insertAssetIntoCache(viewBundle, ctx.imageViewCacheKey(key), ctx.inner, 0u);
+}
+
+void CMitsubaLoader::prefetchTextures(const SContext& ctx, const core::vector<const CElementBSDF*>& bsdfs)
+{
+	// gather unique work items in BSDF order, so that the same view is never produced by two threads at once
+	core::vector<const CElementTexture*> bitmaps;
+	core::vector<std::pair<const CElementTexture*,bool>> derivedImages;
+	{
+		core::unordered_set<std::string> viewKeys, derivedKeys;
+		for (auto* bsdf : bsdfs)
+		forEachBSDFTexture(bsdf,[&](const CElementTexture* tex, E_BSDF_TEXTURE_USAGE usage) -> void
+		{
+			if (!tex)
+				return;
+			tex = unrollScales(tex);
+			if (tex->type!=CElementTexture::Type::BITMAP)
+				return;
+			if (viewKeys.insert(ctx.bitmapViewCacheKey(tex)).second)
+				bitmaps.push_back(tex);
+			if (usage==EBTU_PLAIN)
+				return;
+			const bool derivativeMap = usage==EBTU_BUMPMAP;
+			if (derivedKeys.insert(derivativeMap ? ctx.derivMapCacheKey(tex):ctx.blendWeightImageCacheKey(tex)).second)
+				derivedImages.emplace_back(tex,derivativeMap);
+		});
+	}
+
+	std::for_each(std::execution::par,bitmaps.begin(),bitmaps.end(),[&](const CElementTexture* bitmap) -> void
+	{
+		cacheImageView(ctx,0u,bitmap);
+	});
+	// derivative maps need the views to be present already
+	std::for_each(std::execution::par,derivedImages.begin(),derivedImages.end(),[&](const std::pair<const CElementTexture*,bool>& item) -> void
+	{
+		cacheDerivedImage(ctx,item.first,item.second);
+	});
+}
+
 auto CMitsubaLoader::getBSDFtreeTraversal(SContext& ctx, const CElementBSDF* bsdf) -> SContext::bsdf_type
 {
 	if (!bsdf)
@@ -1186,120 +1384,15 @@ auto CMitsubaLoader::getBSDFtreeTraversal(SContext& ctx, const CElementBSDF* bsd
 
 auto CMitsubaLoader::genBSDFtreeTraversal(SContext& ctx, const CElementBSDF* _bsdf) -> SContext::bsdf_type
 {
+	// all hits if `prefetchTextures` ran for this BSDF already
+	forEachBSDFTexture(_bsdf,[&](const CElementTexture* tex, E_BSDF_TEXTURE_USAGE usage) -> void
 	{
-		auto cachePropertyTexture = [&](const auto& const_or_tex, SContext::tex_ass_type& out_img) {
-			bool is_tex = (const_or_tex.value.type == SPropertyElementData::INVALID);
-			if (const_or_tex.value.type == SPropertyElementData::INVALID)
-				out_img = cacheTexture(ctx, 0u, const_or_tex.texture);
-
-			return is_tex;
-		};
-		auto unrollScales = [](CElementTexture* tex)
-		{
-			while (tex->type == CElementTexture::SCALE)
-				tex = tex->scale.texture;
-			return tex;
-		};
-
-		core::stack<const CElementBSDF*> stack;
-		stack.push(_bsdf);
-
-		while (!stack.empty())
-		{
-			auto* bsdf = stack.top();
-			stack.pop();
-			switch (bsdf->type)
-			{
-			case CElementBSDF::COATING:
-			case CElementBSDF::ROUGHCOATING:
-			case CElementBSDF::BUMPMAP:
-			case CElementBSDF::BLEND_BSDF:
-			case CElementBSDF::MIXTURE_BSDF:
-			case CElementBSDF::MASK:
-			case CElementBSDF::TWO_SIDED:
-				for (uint32_t i = 0u; i < bsdf->meta_common.childCount; ++i)
-					stack.push(bsdf->meta_common.bsdf[i]);
-			default: break;
-			}
-
-			SContext::tex_ass_type tex;
-			switch (bsdf->type)
-			{
-			case CElementBSDF::DIFFUSE:
-			case CElementBSDF::ROUGHDIFFUSE:
-				cachePropertyTexture(bsdf->diffuse.reflectance, tex);
-				cachePropertyTexture(bsdf->diffuse.alpha, tex);
-				break;
-			case CElementBSDF::DIFFUSE_TRANSMITTER:
-				cachePropertyTexture(bsdf->difftrans.transmittance, tex);
-				break;
-			case CElementBSDF::DIELECTRIC:
-			case CElementBSDF::THINDIELECTRIC:
-			case CElementBSDF::ROUGHDIELECTRIC:
-				cachePropertyTexture(bsdf->dielectric.alphaU, tex);
-				if (bsdf->dielectric.distribution == CElementBSDF::RoughSpecularBase::ASHIKHMIN_SHIRLEY)
-					cachePropertyTexture(bsdf->dielectric.alphaV, tex);
-				break;
-			case CElementBSDF::CONDUCTOR:
-				cachePropertyTexture(bsdf->conductor.alphaU, tex);
-				if (bsdf->conductor.distribution == CElementBSDF::RoughSpecularBase::ASHIKHMIN_SHIRLEY)
-					cachePropertyTexture(bsdf->conductor.alphaV, tex);
-				break;
-			case CElementBSDF::PLASTIC:
-			case CElementBSDF::ROUGHPLASTIC:
-				cachePropertyTexture(bsdf->plastic.diffuseReflectance, tex);
-				cachePropertyTexture(bsdf->plastic.alphaU, tex);
-				if (bsdf->plastic.distribution == CElementBSDF::RoughSpecularBase::ASHIKHMIN_SHIRLEY)
-					cachePropertyTexture(bsdf->plastic.alphaV, tex);
-				break;
-			case CElementBSDF::BUMPMAP:
-			{
-				using namespace std::string_literals;
-
-				auto* bumpmap_element = unrollScales(bsdf->bumpmap.texture);
-				auto bm = cacheTexture(ctx, 0u, bumpmap_element);
-				// TODO check and restore if dummy (image and sampler)
-				auto bumpmap = std::get<0>(bm)->getCreationParameters().image;
-				auto sampler = std::get<1>(bm);
-				const std::string key = ctx.derivMapCacheKey(bumpmap_element);
-
-				if (!getBuiltinAsset<asset::ICPUImage, asset::IAsset::ET_IMAGE>(key.c_str(), m_assetMgr))
-				{
-					auto derivmap = createDerivMap(bumpmap.get(), sampler.get());
-					asset::SAssetBundle imgBundle(nullptr,{ derivmap });
-					ctx.override_->insertAssetIntoCache(std::move(imgBundle), key, ctx.inner, 0u);
-					auto derivmap_view = createImageView(std::move(derivmap));
-					asset::SAssetBundle viewBundle(nullptr,{ derivmap_view });
-					ctx.override_->insertAssetIntoCache(std::move(viewBundle), ctx.imageViewCacheKey(key), ctx.inner, 0u);
-				}
-			}
-				break;
-			case CElementBSDF::BLEND_BSDF:
-				if (cachePropertyTexture(bsdf->blendbsdf.weight, tex))
-				{
-					auto* weight_element = unrollScales(bsdf->blendbsdf.weight.texture);
-					const std::string key = ctx.blendWeightImageCacheKey(weight_element);
-
-					if (!getBuiltinAsset<asset::ICPUImage, asset::IAsset::ET_IMAGE>(key.c_str(), m_assetMgr))
-					{
-						auto img = std::get<0>(tex)->getCreationParameters().image;
-
-						auto blendweight = createBlendWeightImage(img.get());
-						asset::SAssetBundle imgBundle(nullptr,{ blendweight });
-						ctx.override_->insertAssetIntoCache(std::move(imgBundle), key, ctx.inner, 0u);
-						auto blendweight_view = createImageView(std::move(blendweight));
-						asset::SAssetBundle viewBundle(nullptr,{ blendweight_view });
-						ctx.override_->insertAssetIntoCache(std::move(viewBundle), ctx.imageViewCacheKey(key), ctx.inner, 0u);
-					}
-				}
-				break;
-			case CElementBSDF::MASK:
-				cachePropertyTexture(bsdf->mask.opacity, tex);
-				break;
-			default: break;
-			}
-		}
-	}
+		if (!tex)
+			return;
+		cacheTexture(ctx,0u,tex);
+		if (usage!=EBTU_PLAIN)
+			cacheDerivedImage(ctx,unrollScales(tex),usage==EBTU_BUMPMAP);
+	});
 
 	return ctx.frontend.compileToIRTree(ctx.ir.get(), _bsdf);
 }
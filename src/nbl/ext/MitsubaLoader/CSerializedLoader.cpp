@@ -16,6 +16,9 @@
 #endif
 #include "zlib/zlib.h"
 
+#include <execution>
+#include <limits>
+
 namespace nbl
 {
 
@@ -42,13 +45,279 @@ constexpr auto COLOR_ATTRIBUTE = 1;
 constexpr auto UV_ATTRIBUTE = 2;
 constexpr auto NORMAL_ATTRIBUTE = 3;
 
-// maybe move to core
-#define PAGE_SIZE 4096
-struct alignas(PAGE_SIZE) Page_t
+namespace
 {
-	uint8_t data[PAGE_SIZE];
+
+constexpr uint32_t ATTRIBUTE_COUNT = NORMAL_ATTRIBUTE+1u;
+
+//! Everything about a mesh which doesn't need the asset manager, so all meshes can be built in parallel
+struct SInflatedMesh
+{
+	struct SAttribute
+	{
+		E_FORMAT format = EF_UNKNOWN;
+		size_t offset = 0ull;
+	};
+
+	core::smart_refctd_ptr<ICPUBuffer> buffer;
+	std::string name;
+	uint32_t flags = 0u;
+	uint64_t vertexCount = 0ull;
+	uint64_t triangleCount = 0ull;
+	core::aabbox3df aabb;
+	SAttribute attributes[ATTRIBUTE_COUNT];
+	size_t indexOffset = 0ull;
 };
-#undef PAGE_SIZE
+
+//! Decompresses one mesh's zlib stream piece by piece, into wherever each piece needs to end up
+class CInflater
+{
+	public:
+		CInflater(const uint8_t* in, const size_t inSize)
+		{
+			stream.next_in = const_cast<Bytef*>(in);
+			stream.avail_in = static_cast<uInt>(inSize);
+			stream.zalloc = Z_NULL;
+			stream.zfree = Z_NULL;
+			stream.opaque = Z_NULL;
+			initialized = inflateInit(&stream)==Z_OK;
+		}
+		~CInflater()
+		{
+			if (initialized)
+				inflateEnd(&stream);
+		}
+
+		//! @returns how many bytes were written, less than `size` only if the stream ended early or is corrupt
+		inline size_t read(void* out, size_t size)
+		{
+			if (!initialized)
+				return 0ull;
+			const auto totalBefore = stream.total_out;
+			stream.next_out = reinterpret_cast<Bytef*>(out);
+			while (size && !finished)
+			{
+				// `avail_out` is only 32bit
+				const uInt chunk = static_cast<uInt>(core::min<size_t>(size,0x1ull<<30ull));
+				stream.avail_out = chunk;
+				const int32_t err = inflate(&stream,Z_SYNC_FLUSH);
+				size -= chunk-stream.avail_out;
+				if (err==Z_STREAM_END)
+					finished = true;
+				else if (err!=Z_OK)
+					break;
+			}
+			return stream.total_out-totalBefore;
+		}
+
+	private:
+		z_stream stream = {};
+		bool initialized = false;
+		bool finished = false;
+};
+
+//! Shared exponent as per the `VK_FORMAT_E5B9G9R9_UFLOAT_PACK32` spec
+inline uint32_t encodeRGB9E5(double r, double g, double b)
+{
+	constexpr int32_t MantissaBits = 9;
+	constexpr int32_t ExpBias = 15;
+	constexpr int32_t MaxExp = 31;
+	const double sharedMax = double((0x1<<MantissaBits)-1)/double(0x1<<MantissaBits)*std::exp2(double(MaxExp-ExpBias));
+
+	r = core::clamp(r,0.0,sharedMax);
+	g = core::clamp(g,0.0,sharedMax);
+	b = core::clamp(b,0.0,sharedMax);
+	const double maxChannel = core::max(core::max(r,g),b);
+	int32_t exp = (maxChannel>0.0 ? core::max(-ExpBias-1,int32_t(std::floor(std::log2(maxChannel)))):(-ExpBias-1))+1+ExpBias;
+	double scale = std::exp2(double(exp-ExpBias-MantissaBits));
+	if (uint32_t(std::floor(maxChannel/scale+0.5))==(0x1u<<MantissaBits))
+	{
+		exp++;
+		scale *= 2.0;
+	}
+	auto quantize = [scale](double x) -> uint32_t { return uint32_t(std::floor(x/scale+0.5)); };
+	return quantize(r)|(quantize(g)<<9u)|(quantize(b)<<18u)|(uint32_t(exp)<<27u);
+}
+
+inline uint32_t encodeSNorm10x3(double x, double y, double z)
+{
+	auto quantize = [](double v) -> uint32_t { return uint32_t(int32_t(std::round(core::clamp(v,-1.0,1.0)*511.0)))&0x3ffu; };
+	return quantize(x)|(quantize(y)<<10u)|(quantize(z)<<20u);
+}
+
+inline uint32_t encodeHalf2(double u, double v)
+{
+	return uint32_t(core::Float16Compressor::compress(float(u)))|(uint32_t(core::Float16Compressor::compress(float(v)))<<16u);
+}
+
+//! `read` continues the decompressed stream right after the header
+template<typename T, class ReadFunc>
+bool inflateVertexData(ReadFunc& read, const bool quantize, SInflatedMesh& out)
+{
+	const uint64_t vertexCount = out.vertexCount;
+	const bool faceNormals = !(out.flags&MF_PER_VERTEX_NORMALS) && (out.flags&MF_FACE_NORMALS);
+	constexpr E_FORMAT FullFormats[2] = {
+		std::is_same_v<T,double> ? EF_R64G64_SFLOAT:EF_R32G32_SFLOAT,
+		std::is_same_v<T,double> ? EF_R64G64B64_SFLOAT:EF_R32G32B32_SFLOAT
+	};
+
+	// same order as in the file, with the indices last
+	size_t bufferSize = 0ull;
+	auto addAttribute = [&](const uint32_t attrId, const bool present, const E_FORMAT fullFormat, const E_FORMAT quantizedFormat) -> void
+	{
+		if (!present)
+			return;
+		auto& attr = out.attributes[attrId];
+		attr.format = quantize ? quantizedFormat:fullFormat;
+		attr.offset = bufferSize;
+		bufferSize += getTexelOrBlockBytesize(attr.format)*vertexCount;
+	};
+	addAttribute(POSITION_ATTRIBUTE,true,FullFormats[1],EF_R32G32B32_SFLOAT);
+	addAttribute(NORMAL_ATTRIBUTE,(out.flags&MF_PER_VERTEX_NORMALS)||faceNormals,FullFormats[1],EF_A2B10G10R10_SNORM_PACK32);
+	addAttribute(UV_ATTRIBUTE,out.flags&MF_TEXTURE_COORDINATES,FullFormats[0],EF_R16G16_SFLOAT);
+	addAttribute(COLOR_ATTRIBUTE,out.flags&MF_VERTEX_COLORS,FullFormats[1],EF_E5B9G9R9_UFLOAT_PACK32);
+	out.indexOffset = bufferSize;
+	bufferSize += sizeof(uint32_t)*3ull*out.triangleCount;
+	out.buffer = core::make_smart_refctd_ptr<ICPUBuffer>(bufferSize);
+	uint8_t* const outPtr = reinterpret_cast<uint8_t*>(out.buffer->getPointer());
+
+	// attributes which stay at full precision get decompressed straight into the buffer, the rest goes through scratch memory
+	core::vector<T> scratch;
+	auto readAttribute = [&](const uint32_t attrId, const uint32_t componentCount, auto encode) -> bool
+	{
+		const auto& attr = out.attributes[attrId];
+		const size_t size = sizeof(T)*componentCount*vertexCount;
+		if (attr.format==FullFormats[componentCount-2u])
+			return read(outPtr+attr.offset,size);
+
+		scratch.resize(componentCount*vertexCount);
+		if (!read(scratch.data(),size))
+			return false;
+		auto* dst = reinterpret_cast<decltype(encode(scratch.data()))*>(outPtr+attr.offset);
+		const T* in = scratch.data();
+		for (uint64_t j=0ull; j<vertexCount; j++,in+=componentCount)
+			dst[j] = encode(in);
+		return true;
+	};
+
+	struct float3
+	{
+		float x,y,z;
+	};
+	if (!readAttribute(POSITION_ATTRIBUTE,3u,[](const T* v) -> float3 { return {float(v[0]),float(v[1]),float(v[2])}; }))
+		return false;
+	auto getPosition = [&](const uint32_t ix) -> core::vectorSIMDf
+	{
+		const uint8_t* pos = outPtr+out.attributes[POSITION_ATTRIBUTE].offset;
+		if (out.attributes[POSITION_ATTRIBUTE].format==EF_R64G64B64_SFLOAT)
+		{
+			const double* v = reinterpret_cast<const double*>(pos)+ix*3ull;
+			return core::vectorSIMDf(v[0],v[1],v[2]);
+		}
+		const float* v = reinterpret_cast<const float*>(pos)+ix*3ull;
+		return core::vectorSIMDf(v[0],v[1],v[2]);
+	};
+	for (uint64_t j=0ull; j<vertexCount; j++)
+	{
+		const auto pos = getPosition(j);
+		if (j)
+			out.aabb.addInternalPoint(pos.x,pos.y,pos.z);
+		else
+			out.aabb.reset(pos.x,pos.y,pos.z);
+	}
+
+	if ((out.flags&MF_PER_VERTEX_NORMALS) && !readAttribute(NORMAL_ATTRIBUTE,3u,[](const T* v) -> uint32_t { return encodeSNorm10x3(v[0],v[1],v[2]); }))
+		return false;
+	if ((out.flags&MF_TEXTURE_COORDINATES) && !readAttribute(UV_ATTRIBUTE,2u,[](const T* v) -> uint32_t { return encodeHalf2(v[0],v[1]); }))
+		return false;
+	if ((out.flags&MF_VERTEX_COLORS) && !readAttribute(COLOR_ATTRIBUTE,3u,[](const T* v) -> uint32_t { return encodeRGB9E5(v[0],v[1],v[2]); }))
+		return false;
+
+	uint32_t* const indices = reinterpret_cast<uint32_t*>(outPtr+out.indexOffset);
+	const uint64_t indexCount = out.triangleCount*3ull;
+	if (!read(indices,sizeof(uint32_t)*indexCount))
+		return false;
+	for (uint64_t j=0ull; j<indexCount; j++)
+	if (indices[j]>=static_cast<uint32_t>(vertexCount))
+		return false;
+
+	// every vertex gets the normal of the last triangle referencing it
+	if (faceNormals)
+	{
+		uint8_t* const normals = outPtr+out.attributes[NORMAL_ATTRIBUTE].offset;
+		// vertices no triangle references would be left uninitialized
+		memset(normals,0,getTexelOrBlockBytesize(out.attributes[NORMAL_ATTRIBUTE].format)*vertexCount);
+		for (uint64_t j=0ull; j<indexCount; j+=3ull)
+		{
+			const uint32_t* triangle = indices+j;
+			const core::vectorSIMDf pos[3] = {getPosition(triangle[0]),getPosition(triangle[1]),getPosition(triangle[2])};
+			const auto cross = core::cross(pos[1]-pos[0],pos[2]-pos[0]);
+			// degenerate triangles (common in scans) get a zero normal instead of a NaN one
+			const bool degenerate = core::dot(cross,cross).x<=std::numeric_limits<float>::min();
+			const core::vectorSIMDf normal = degenerate ? core::vectorSIMDf(0.f):core::normalize(cross);
+			for (uint32_t k=0u; k<3u; k++)
+			{
+				if (quantize)
+					reinterpret_cast<uint32_t*>(normals)[triangle[k]] = encodeSNorm10x3(normal.x,normal.y,normal.z);
+				else
+				{
+					T* dst = reinterpret_cast<T*>(normals)+triangle[k]*3ull;
+					dst[0] = normal.x;
+					dst[1] = normal.y;
+					dst[2] = normal.z;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+bool inflateMesh(const uint8_t* in, const size_t inSize, const bool quantize, SInflatedMesh& out)
+{
+	CInflater inflater(in,inSize);
+
+	// the name has a variable length, so the header gets inflated into a staging area first
+	constexpr size_t StagingSize = 4096ull;
+	uint8_t staging[StagingSize];
+	const uint8_t* const stagedEnd = staging+inflater.read(staging,StagingSize);
+	const uint8_t* staged = staging;
+	// too small to hold anything
+	if (staged+sizeof(uint32_t)+sizeof(uint8_t)+sizeof(uint64_t)*2ull > stagedEnd)
+		return false;
+	memcpy(&out.flags,staged,sizeof(uint32_t));
+	staged += sizeof(uint32_t);
+	// get name
+	const char* stringPtr = reinterpret_cast<const char*>(staged);
+	while (staged<stagedEnd && *staged)
+		staged++;
+	// name too long
+	if (staged+sizeof(uint8_t)+sizeof(uint64_t)*2ull > stagedEnd)
+		return false;
+	out.name = std::string(stringPtr,reinterpret_cast<const char*>(staged));
+	staged++;
+	memcpy(&out.vertexCount,staged,sizeof(uint64_t));
+	staged += sizeof(uint64_t);
+	memcpy(&out.triangleCount,staged,sizeof(uint64_t));
+	staged += sizeof(uint64_t);
+	if (out.vertexCount<3ull || out.vertexCount>0xFFFFFFFFull || out.triangleCount<1ull)
+		return false;
+
+	// whatever got staged past the header is the start of the vertex data
+	auto read = [&](void* dst, const size_t size) -> bool
+	{
+		const size_t fromStaging = core::min<size_t>(stagedEnd-staged,size);
+		memcpy(dst,staged,fromStaging);
+		staged += fromStaging;
+		return inflater.read(reinterpret_cast<uint8_t*>(dst)+fromStaging,size-fromStaging)==size-fromStaging;
+	};
+	if (out.flags&MF_SINGLE_FLOAT)
+		return inflateVertexData<float>(read,quantize,out);
+	else if (out.flags&MF_DOUBLE_FLOAT)
+		return inflateVertexData<double>(read,quantize,out);
+	return false;
+}
+
+}
 
 //! creates/loads an animated mesh from the file.
 asset::SAssetBundle CSerializedLoader::loadAsset(io::IReadFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
@@ -61,7 +330,7 @@ asset::SAssetBundle CSerializedLoader::loadAsset(io::IReadFile* _file, const ass
 		0,
 		nullptr
 	};
-	size_t maxSize = 0u;
+	size_t meshDataEnd = 0u;
 	{
 		FileHeader header;
 		ctx.inner.mainFile->seek(0u);
@@ -91,159 +360,57 @@ asset::SAssetBundle CSerializedLoader::loadAsset(io::IReadFile* _file, const ass
 				localSize = ctx.meshOffsets->operator[](i+1u);
 			localSize -= ctx.meshOffsets->operator[](i);
 			ctx.meshOffsets->operator[](i+ctx.meshCount) = localSize;
-			if (localSize > maxSize)
-				maxSize = localSize;
 		}
+		meshDataEnd = backPos;
 	}
-	if (maxSize==0u)
-		return {};
 
-	auto meta = core::make_smart_refctd_ptr<CMitsubaSerializedMetadata>(ctx.meshCount,core::smart_refctd_ptr(IRenderpassIndependentPipelineLoader::m_basicViewParamsSemantics));
-	core::vector<core::smart_refctd_ptr<ICPUMesh>> meshes; meshes.reserve(ctx.meshCount);
-
-	uint8_t* data = reinterpret_cast<uint8_t*>(_NBL_ALIGNED_MALLOC(maxSize,alignof(double)));
-	constexpr size_t CHUNK = 256ull*1024ull;
-	core::vector<Page_t> decompressed(CHUNK/sizeof(Page_t));
-	for (uint32_t i=0; i<ctx.meshCount; i++)
+	// every mesh has its own zlib stream at a known offset, so they all get decompressed concurrently
+	core::vector<SInflatedMesh> inflated(ctx.meshCount);
+	core::vector<uint32_t> meshIDs(ctx.meshCount);
+	std::iota(meshIDs.begin(),meshIDs.end(),0u);
+	const auto* mapped = reinterpret_cast<const uint8_t*>(ctx.inner.mainFile->getMappedPointer());
+	std::for_each(std::execution::par,meshIDs.begin(),meshIDs.end(),[&](const uint32_t i) -> void
 	{
-		auto localSize = ctx.meshOffsets->operator[](i+ctx.meshCount);
-		ctx.inner.mainFile->seek(sizeof(FileHeader)+ctx.meshOffsets->operator[](i));
-		ctx.inner.mainFile->read(data,localSize);
-		// decompress
-		size_t decompressSize;
+		// skip the mesh's own copy of the file header
+		const size_t offset = ctx.meshOffsets->operator[](i)+sizeof(FileHeader);
+		const size_t localSize = ctx.meshOffsets->operator[](i+ctx.meshCount);
+		if (localSize<=sizeof(FileHeader) || offset-sizeof(FileHeader)+localSize>meshDataEnd)
+			return;
+		const size_t compressedSize = localSize-sizeof(FileHeader);
+
+		core::vector<uint8_t> compressed;
+		const uint8_t* in = mapped ? (mapped+offset):nullptr;
+		if (!in)
 		{
-			// Setup the inflate stream.
-			z_stream stream;
-			stream.next_in = (Bytef*)data;
-			stream.avail_in = (uInt)localSize;
-			stream.total_in = 0;
-			stream.next_out = (Bytef*)decompressed.data();
-			stream.avail_out = CHUNK;
-			stream.total_out = 0u;
-			stream.zalloc = (alloc_func)0;
-			stream.zfree = (free_func)0;
-
-			int32_t err = inflateInit(&stream, -MAX_WBITS);
-			if (err == Z_OK)
-			{
-				while (err == Z_OK && err != Z_STREAM_END)
-				{
-					err = inflate(&stream, Z_SYNC_FLUSH);
-					if (err!=Z_OK || err==Z_STREAM_END || stream.avail_out)
-						continue;
-
-					if (stream.total_out+CHUNK>decompressed.size()*sizeof(Page_t))
-						decompressed.resize(decompressed.size()+CHUNK/sizeof(Page_t));
-					stream.next_out = reinterpret_cast<Bytef*>(decompressed.data())+stream.total_out;
-					stream.avail_out = CHUNK;
-				}
-			}
-			decompressSize = stream.total_out;
-			int32_t err2 = inflateEnd(&stream);
-
-			if (err == Z_OK || err == Z_STREAM_END)
-				err = err2;
-			if (err != Z_OK)
-			{
-				std::wstring msg(L"Error decompressing mesh ix ");
-				msg += std::to_wstring(i);
-				os::Printer::log(msg, ELL_ERROR);
-				continue;
-			}
+			compressed.resize(compressedSize);
+			if (ctx.inner.mainFile->readAt(offset,compressed.data(),compressedSize)!=compressedSize)
+				return;
+			in = compressed.data();
 		}
-		// too small to hold anything
-		if (decompressSize < sizeof(uint8_t)+sizeof(uint64_t)*2ull)
-			continue;
-
-		// some tracking
-		uint8_t* ptr = reinterpret_cast<uint8_t*>(decompressed.data());
-		uint8_t* streamEnd = ptr+decompressSize;
-		// vertex size determination
-		auto flags = *(reinterpret_cast<uint32_t*&>(ptr)++);
-		size_t typeSize;
-		size_t vertexAttributeCount = 3u;
-		size_t vertexSize;
+		if (!inflateMesh(in,compressedSize,m_quantizeAttributes,inflated[i]))
 		{
-			if (flags & MF_SINGLE_FLOAT)
-				typeSize = sizeof(float);
-			else if (flags & MF_DOUBLE_FLOAT)
-				typeSize = sizeof(double);
-			else
-				continue;
-
-			if ((flags & MF_PER_VERTEX_NORMALS) || (flags & MF_FACE_NORMALS))
-				vertexAttributeCount += 3ull;
-			if (flags & MF_TEXTURE_COORDINATES)
-				vertexAttributeCount += 2ull;
-			if (flags & MF_VERTEX_COLORS)
-				vertexAttributeCount += 3ull;
-
-			vertexSize = vertexAttributeCount*typeSize;
+			inflated[i].buffer = nullptr;
+			std::wstring msg(L"Error decompressing mesh ix ");
+			msg += std::to_wstring(i);
+			os::Printer::log(msg, ELL_ERROR);
 		}
+	});
 
-		// get name
-		char* stringPtr = reinterpret_cast<char*>(ptr);
-		while (ptr < streamEnd)
-		if (! *(ptr++))
-				break;
-		// name too long
-		size_t stringLen = reinterpret_cast<char*>(ptr)-stringPtr;
-		if (ptr+sizeof(uint64_t)*2ull > streamEnd)
-			continue;
+	auto meta = core::make_smart_refctd_ptr<CMitsubaSerializedMetadata>(ctx.meshCount,core::smart_refctd_ptr(IRenderpassIndependentPipelineLoader::m_basicViewParamsSemantics));
+	core::vector<core::smart_refctd_ptr<ICPUMesh>> meshes; meshes.reserve(ctx.meshCount);
 
-		// 
-		uint64_t vertexCount = *(reinterpret_cast<uint64_t*&>(ptr)++);
-		if (vertexCount<3ull || vertexCount>0xFFFFFFFFull)
-			continue;
-		uint64_t triangleCount = *(reinterpret_cast<uint64_t*&>(ptr)++);
-		if (triangleCount<1ull)
-			continue;
-		size_t vertexDataSize = vertexCount*vertexSize;
-		if (ptr+vertexDataSize > streamEnd)
-			continue;
-		size_t indexDataSize = sizeof(uint32_t)*3ull*triangleCount;
-		size_t totalDataSize = vertexDataSize+indexDataSize;
-		if (ptr+totalDataSize > streamEnd)
+	auto mbPipelineLayout = _override->findDefaultAsset<ICPUPipelineLayout>("nbl/builtin/material/lambertian/no_texture/pipeline_layout",ctx.inner,_hierarchyLevel+ICPUMesh::PIPELINE_LAYOUT_HIERARCHYLEVELS_BELOW).first;
+	core::unordered_map<std::string,std::pair<core::smart_refctd_ptr<ICPUSpecializedShader>,core::smart_refctd_ptr<ICPUSpecializedShader>>> shaderCache;
+	for (uint32_t i=0; i<ctx.meshCount; i++)
+	{
+		auto& mesh = inflated[i];
+		if (!mesh.buffer)
 			continue;
-
-		auto buf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(totalDataSize);
-		void* outPtr = buf->getPointer();
-		auto readAttributes = [&](auto* outPtr, size_t attrOffset, auto* &inPtr, uint32_t attrCount, core::aabbox3df* aabb=nullptr) -> void
-		{
-			for (uint64_t j=0ull; j<vertexCount; j++)
-			{
-				if (aabb)
-				{
-					if (j)
-						aabb->addInternalPoint(inPtr[0],inPtr[1],inPtr[2]);
-					else
-						aabb->reset(inPtr[0],inPtr[1],inPtr[2]);
-				}
-				for (auto k=0u; k<attrCount; k++)
-					outPtr[j*vertexAttributeCount+attrOffset+k] = *(inPtr++);
-			}
-		};
+		const uint32_t flags = mesh.flags;
 
 		auto meshBuffer = core::make_smart_refctd_ptr<asset::ICPUMeshBuffer>();
 		meshBuffer->setPositionAttributeIx(POSITION_ATTRIBUTE);
 
-		auto makeAvailableAttributesVector = [&]()
-		{
-			core::vector<uint8_t> vec;
-			vec.reserve(4);
-
-			vec.push_back(POSITION_ATTRIBUTE);
-			if (flags & MF_VERTEX_COLORS)
-				vec.push_back(COLOR_ATTRIBUTE);
-			if (flags & MF_TEXTURE_COORDINATES)
-				vec.push_back(UV_ATTRIBUTE);
-			if (flags & MF_PER_VERTEX_NORMALS)
-				vec.push_back(NORMAL_ATTRIBUTE);
-			return vec;
-		};
-
-		const auto availableAttributes = makeAvailableAttributesVector();
-
 		auto chooseShaderPath = [&]() -> std::string
 		{
 			constexpr std::array<std::pair<uint8_t, std::string_view>, 3> avaiableOptionsForShaders
@@ -255,26 +422,26 @@ asset::SAssetBundle CSerializedLoader::loadAsset(io::IReadFile* _file, const ass
 
 			for (auto& it : avaiableOptionsForShaders)
 			{
-				auto found = std::find(availableAttributes.begin(), availableAttributes.end(), it.first);
-				if (found != availableAttributes.end())
+				// only normals which came with the file count
+				if (it.first==NORMAL_ATTRIBUTE ? (flags&MF_PER_VERTEX_NORMALS):(mesh.attributes[it.first].format!=EF_UNKNOWN))
 					return it.second.data();
 			}
 
 			return avaiableOptionsForShaders[0].second.data(); // if only positions are present, shaders with debug vertex colors are assumed
 		};
-		
-		core::smart_refctd_ptr<ICPUSpecializedShader> mbVertexShader;
-		core::smart_refctd_ptr<ICPUSpecializedShader> mbFragmentShader;
+
+		const std::string basepath = chooseShaderPath();
+		auto found = shaderCache.find(basepath);
+		if (found==shaderCache.end())
 		{
 			const IAsset::E_TYPE types[]{ IAsset::E_TYPE::ET_SPECIALIZED_SHADER, IAsset::E_TYPE::ET_SPECIALIZED_SHADER, static_cast<IAsset::E_TYPE>(0u) };
-			const std::string basepath = chooseShaderPath();
 
 			auto bundle = m_assetMgr->findAssets(basepath+".vert", types);
-			mbVertexShader = core::smart_refctd_ptr_static_cast<ICPUSpecializedShader>(bundle->begin()->getContents().begin()[0]);
+			auto mbVertexShader = core::smart_refctd_ptr_static_cast<ICPUSpecializedShader>(bundle->begin()->getContents().begin()[0]);
 			bundle = m_assetMgr->findAssets(basepath+".frag", types);
-			mbFragmentShader = core::smart_refctd_ptr_static_cast<ICPUSpecializedShader>(bundle->begin()->getContents().begin()[0]);
+			auto mbFragmentShader = core::smart_refctd_ptr_static_cast<ICPUSpecializedShader>(bundle->begin()->getContents().begin()[0]);
+			found = shaderCache.emplace(basepath,std::make_pair(std::move(mbVertexShader),std::move(mbFragmentShader))).first;
 		}
-		auto mbPipelineLayout = _override->findDefaultAsset<ICPUPipelineLayout>("nbl/builtin/material/lambertian/no_texture/pipeline_layout",ctx.inner,_hierarchyLevel+ICPUMesh::PIPELINE_LAYOUT_HIERARCHYLEVELS_BELOW).first;
 
 		asset::SBlendParams blendParams;
 		asset::SRasterizationParams rastarizationParams;
@@ -282,108 +449,45 @@ asset::SAssetBundle CSerializedLoader::loadAsset(io::IReadFile* _file, const ass
 		asset::SVertexInputParams inputParams;
 
 		primitiveAssemblyParams.primitiveType = asset::EPT_TRIANGLE_LIST;
-		inputParams.enabledBindingFlags |= core::createBitmask({ 0 });
-		inputParams.bindings[0].inputRate = asset::EVIR_PER_VERTEX;
-		inputParams.bindings[0].stride = vertexSize;
-
-		size_t attrOffset = 0ull;
-		auto readAttributeDispatch = [&](auto attrId, size_t attrCount, core::aabbox3df* aabb, bool read = true) -> void
+		// the attributes are not interleaved, every one gets its own binding into the same buffer
+		for (uint32_t attrId=0u; attrId<ATTRIBUTE_COUNT; attrId++)
 		{
-			asset::E_FORMAT format = asset::EF_UNKNOWN;
-			switch (attrCount)
-			{
-				case 2ull:
-					format = typeSize==sizeof(double) ? asset::EF_R64G64_SFLOAT:asset::EF_R32G32_SFLOAT;
-					break;
-				case 3ull:
-					format = typeSize==sizeof(double) ? asset::EF_R64G64B64_SFLOAT:asset::EF_R32G32B32_SFLOAT;
-					break;
-				default:
-					assert(false);
-					break;
-			}
-
+			const auto& attr = mesh.attributes[attrId];
+			if (attr.format==EF_UNKNOWN)
+				continue;
+			inputParams.enabledBindingFlags |= core::createBitmask({ attrId });
+			inputParams.bindings[attrId].inputRate = asset::EVIR_PER_VERTEX;
+			inputParams.bindings[attrId].stride = getTexelOrBlockBytesize(attr.format);
 			inputParams.enabledAttribFlags |= core::createBitmask({ attrId });
-			inputParams.attributes[attrId].binding = 0;
-			inputParams.attributes[attrId].format = format;
-			inputParams.attributes[attrId].relativeOffset = attrOffset * typeSize;
-			meshBuffer->setVertexBufferBinding({ 0, buf }, 0);
-	
-			if (read)
-			{
-				if (flags & MF_SINGLE_FLOAT)
-					readAttributes(reinterpret_cast<float*>(outPtr), attrOffset, reinterpret_cast<float*&>(ptr), attrCount, aabb);
-				else if (flags & MF_DOUBLE_FLOAT)
-					readAttributes(reinterpret_cast<double*>(outPtr), attrOffset, reinterpret_cast<double*&>(ptr), attrCount, aabb);
-			}
-			attrOffset += attrCount;
-		};
-
-		core::aabbox3df aabb;
-		readAttributeDispatch(POSITION_ATTRIBUTE, 3ull, &aabb);
-		meshBuffer->setBoundingBox(aabb);
-		if ((flags & MF_PER_VERTEX_NORMALS) || (flags & MF_FACE_NORMALS))
-			readAttributeDispatch(NORMAL_ATTRIBUTE, 3ull, nullptr, flags&MF_PER_VERTEX_NORMALS); // TODO: normal quantization and optimization
-		if (flags & MF_TEXTURE_COORDINATES) // TODO: UV quantization and optimization
-			readAttributeDispatch(UV_ATTRIBUTE, 2ull, nullptr);
-		if (flags & MF_VERTEX_COLORS) // TODO: quantize to 32bit format like RGB9E5
-			readAttributeDispatch(COLOR_ATTRIBUTE, 3ull, nullptr);
-
-		auto mbPipeline = core::make_smart_refctd_ptr<asset::ICPURenderpassIndependentPipeline>(std::move(mbPipelineLayout), nullptr, nullptr, inputParams, blendParams, primitiveAssemblyParams, rastarizationParams);
-		mbPipeline->setShaderAtStage(asset::ISpecializedShader::E_SHADER_STAGE::ESS_VERTEX, mbVertexShader.get());
-		mbPipeline->setShaderAtStage(asset::ISpecializedShader::E_SHADER_STAGE::ESS_FRAGMENT, mbFragmentShader.get());
-
-		meshBuffer->setIndexBufferBinding({ vertexDataSize, std::move(buf) });
-		meshBuffer->setIndexCount(triangleCount * 3u);
-		meshBuffer->setIndexType(asset::EIT_32BIT);
-
-		// read indices and possibly create per-face normals
-		auto readIndices = [&]() -> bool
-		{
-			uint32_t* indexPtr = reinterpret_cast<uint32_t*>(outPtr)+vertexDataSize/sizeof(uint32_t);
-			for (uint64_t j=0ull; j<triangleCount; j++)
-			{
-				uint32_t* triangleIndices = indexPtr;
-				for (uint64_t k=0ull; k<3ull; k++)
-				{
-					triangleIndices[k] = *(reinterpret_cast<uint32_t*&>(ptr)++);
-					if (triangleIndices[k] >= static_cast<uint32_t>(vertexCount))
-						return false;
-				}
-				indexPtr += 3u;
+			inputParams.attributes[attrId].binding = attrId;
+			inputParams.attributes[attrId].format = attr.format;
+			inputParams.attributes[attrId].relativeOffset = 0u;
+			meshBuffer->setVertexBufferBinding({ attr.offset, mesh.buffer }, attrId);
+		}
+		meshBuffer->setBoundingBox(mesh.aabb);
 
-				if (flags & MF_FACE_NORMALS)
-				{
-					core::vectorSIMDf pos[3];
-					for (uint64_t k=0ull; k<3ull; k++)
-						pos[k] = meshBuffer->getPosition(triangleIndices[k]);
-					auto normal = core::cross(pos[1]-pos[0],pos[2]-pos[0]);
-					for (uint64_t k=0ull; k<3ull; k++)
-						meshBuffer->setAttribute(normal,NORMAL_ATTRIBUTE,k);
-				}
-			}
-			return true;
-		};
-		if (!readIndices())
-			continue;
+		auto mbPipeline = core::make_smart_refctd_ptr<asset::ICPURenderpassIndependentPipeline>(core::smart_refctd_ptr(mbPipelineLayout), nullptr, nullptr, inputParams, blendParams, primitiveAssemblyParams, rastarizationParams);
+		mbPipeline->setShaderAtStage(asset::ISpecializedShader::E_SHADER_STAGE::ESS_VERTEX, found->second.first.get());
+		mbPipeline->setShaderAtStage(asset::ISpecializedShader::E_SHADER_STAGE::ESS_FRAGMENT, found->second.second.get());
 
+		meshBuffer->setIndexBufferBinding({ mesh.indexOffset, std::move(mesh.buffer) });
+		meshBuffer->setIndexCount(mesh.triangleCount * 3u);
+		meshBuffer->setIndexType(asset::EIT_32BIT);
 
-		auto mesh = core::make_smart_refctd_ptr<asset::ICPUMesh>();
+		auto outMesh = core::make_smart_refctd_ptr<asset::ICPUMesh>();
 
-		meta->placeMeta(meshes.size(),mbPipeline.get(),mesh.get(),{std::string(stringPtr,stringLen),i});
+		meta->placeMeta(meshes.size(),mbPipeline.get(),outMesh.get(),{std::move(mesh.name),i});
 
 		meshBuffer->setPipeline(std::move(mbPipeline));
 
-		mesh->setBoundingBox(meshBuffer->getBoundingBox());
-		mesh->getMeshBufferVector().emplace_back(std::move(meshBuffer));
-		meshes.push_back(std::move(mesh));
+		outMesh->setBoundingBox(meshBuffer->getBoundingBox());
+		outMesh->getMeshBufferVector().emplace_back(std::move(meshBuffer));
+		meshes.push_back(std::move(outMesh));
 	}
-	_NBL_ALIGNED_FREE(data);
 
 	return SAssetBundle(std::move(meta),std::move(meshes));
 }
 
-
 }
 }
 }